@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Games/FrameLimiter.h"
+#include "core/Stopwatch.h"
+#include "core/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace alimer
+{
+    namespace
+    {
+        // Weight of a new oversleep sample, about the last 20 sleeps dominate the estimate.
+        constexpr double kOversleepWeight = 0.1;
+        // Standard deviations of oversleep kept as margin so a late wakeup rarely overshoots the target.
+        constexpr double kOversleepDeviations = 3.0;
+    }
+
+    FrameLimiter::FrameLimiter()
+        : frequency(Stopwatch::GetFrequency())
+    {
+        // Spin at least 200 us and at most 4 ms, start by assuming 1 ms of oversleep.
+        minSpinMargin = frequency / 5000;
+        maxSpinMargin = frequency / 250;
+        oversleepMean = static_cast<double>(frequency) / 1000.0;
+    }
+
+    void FrameLimiter::WaitUntil(uint64_t targetTimestamp)
+    {
+        uint64_t now = Stopwatch::GetTimestamp();
+        if (now >= targetTimestamp)
+        {
+            return;
+        }
+
+        ALIMER_PROFILE_SCOPE("FrameLimiter::WaitUntil");
+
+        // Sleep while the remaining time exceeds the margin, a sleep can also return early so it may take a few.
+        uint64_t margin = GetSpinMargin();
+        while (now < targetTimestamp && targetTimestamp - now > margin)
+        {
+            const uint64_t request = targetTimestamp - now - margin;
+            std::this_thread::sleep_for(std::chrono::nanoseconds(static_cast<int64_t>(request * 1e9 / frequency)));
+
+            const uint64_t after = Stopwatch::GetTimestamp();
+            AddOversleepSample(static_cast<double>(after - now) - static_cast<double>(request));
+            now = after;
+            margin = GetSpinMargin();
+        }
+
+        // Spin the rest, yielding keeps the core available to other ready threads.
+        while (now < targetTimestamp)
+        {
+            std::this_thread::yield();
+            now = Stopwatch::GetTimestamp();
+        }
+    }
+
+    uint64_t FrameLimiter::GetSpinMargin() const
+    {
+        const double margin = oversleepMean + kOversleepDeviations * std::sqrt(oversleepVariance);
+        return std::min(std::max(static_cast<uint64_t>(margin), minSpinMargin), maxSpinMargin);
+    }
+
+    uint64_t FrameLimiter::GetOversleepEstimate() const
+    {
+        return static_cast<uint64_t>(oversleepMean);
+    }
+
+    void FrameLimiter::AddOversleepSample(double oversleep)
+    {
+        // Waking early counts as no oversleep, and one huge stall (e.g. a debugger break) must not pin the margin at the maximum.
+        oversleep = std::min(std::max(oversleep, 0.0), static_cast<double>(maxSpinMargin));
+
+        const double delta = oversleep - oversleepMean;
+        oversleepMean += kOversleepWeight * delta;
+        oversleepVariance = (1.0 - kOversleepWeight) * (oversleepVariance + kOversleepWeight * delta * delta);
+    }
+}
@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "core/Preprocessor.h"
+
+namespace alimer
+{
+    /// Waits for a Stopwatch timestamp without burning a core: sleeps while the target is far away
+    /// and spins only the final stretch. The spin margin follows the measured oversleep of the OS scheduler.
+    class ALIMER_API FrameLimiter final
+    {
+    public:
+        /// Constructor.
+        FrameLimiter();
+
+        /// Block until Stopwatch::GetTimestamp() reaches the target, returns at once if it already has.
+        void WaitUntil(uint64_t targetTimestamp);
+
+        /// Return how early, in Stopwatch units, sleeping stops and spinning takes over.
+        uint64_t GetSpinMargin() const;
+
+        /// Return the average oversleep measured so far, in Stopwatch units.
+        uint64_t GetOversleepEstimate() const;
+
+    private:
+        void AddOversleepSample(double oversleep);
+
+        uint64_t frequency;
+        uint64_t minSpinMargin;
+        uint64_t maxSpinMargin;
+
+        // Exponentially weighted mean and variance of the oversleep, in Stopwatch units.
+        double oversleepMean;
+        double oversleepVariance = 0.0;
+    };
+}
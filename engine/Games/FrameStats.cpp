@@ -0,0 +1,373 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Games/FrameStats.h"
+#include "core/Assert.h"
+#include "core/Stopwatch.h"
+#include "core/Log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace alimer
+{
+    namespace
+    {
+        // Nearest rank percentile of sorted values.
+        double Percentile(const std::vector<float>& sorted, double percent)
+        {
+            const size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * sorted.size()));
+            return sorted[rank > 0 ? rank - 1 : 0];
+        }
+
+        bool EndsWith(const std::string& value, const char* suffix)
+        {
+            const size_t length = strlen(suffix);
+            return value.size() >= length && value.compare(value.size() - length, length, suffix) == 0;
+        }
+
+        void WriteSummaryJson(FILE* file, const FrameTimeSummary& summary)
+        {
+            fprintf(file, "{\"frames\":%u,\"hitches\":%u,\"average\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f}",
+                summary.frameCount, summary.hitchCount, summary.average, summary.p50, summary.p95, summary.p99, summary.max);
+        }
+    }
+
+    FrameStats::FrameStats()
+        : millisecondsPerTick(1000.0 / static_cast<double>(Stopwatch::GetFrequency()))
+    {
+        Configure(FrameStatsDesc());
+    }
+
+    void FrameStats::Configure(const FrameStatsDesc& desc_)
+    {
+        desc = desc_;
+        desc.historySize = std::max(desc.historySize, 1u);
+        desc.hitchWindow = std::min(std::max(desc.hitchWindow, 1u), desc.historySize);
+
+        history.assign(desc.historySize, FrameRecord{});
+        sortBuffer.reserve(desc.historySize);
+        Reset();
+    }
+
+    void FrameStats::Reset()
+    {
+        head = 0;
+        count = 0;
+        totalFrameCount = 0;
+        hitchCount = 0;
+        memset(currentPhaseTimes, 0, sizeof(currentPhaseTimes));
+
+        for (SystemTimes& system : systems)
+        {
+            memset(system.total, 0, sizeof(system.total));
+            memset(system.max, 0, sizeof(system.max));
+            memset(system.frameTotal, 0, sizeof(system.frameTotal));
+        }
+    }
+
+    uint32_t FrameStats::RegisterSystem(const std::string& name)
+    {
+        SystemTimes system = {};
+        system.name = name;
+        systems.push_back(system);
+        return static_cast<uint32_t>(systems.size() - 1);
+    }
+
+    void FrameStats::AddPhaseTime(FramePhase phase, uint64_t qpcTicks)
+    {
+        currentPhaseTimes[static_cast<uint32_t>(phase)] += qpcTicks;
+    }
+
+    void FrameStats::AddSystemTime(FramePhase phase, uint32_t systemIndex, uint64_t qpcTicks)
+    {
+        if (systemIndex < systems.size())
+        {
+            systems[systemIndex].frameTotal[static_cast<uint32_t>(phase)] += qpcTicks;
+        }
+    }
+
+    void FrameStats::AddTimings(const FrameTimings& timings)
+    {
+        for (uint32_t phase = 0; phase < kPhaseCount; ++phase)
+        {
+            currentPhaseTimes[phase] += timings.GetPhaseTime(static_cast<FramePhase>(phase));
+        }
+
+        const uint32_t systemCount = std::min(timings.GetSystemCount(), static_cast<uint32_t>(systems.size()));
+        for (uint32_t i = 0; i < systemCount; ++i)
+        {
+            for (uint32_t phase = 0; phase < kPhaseCount; ++phase)
+            {
+                systems[i].frameTotal[phase] += timings.GetSystemTime(static_cast<FramePhase>(phase), i);
+            }
+        }
+    }
+
+    void FrameStats::EndFrame(uint64_t qpcDelta)
+    {
+        FrameRecord& record = history[head];
+        record.frameTime = static_cast<float>(qpcDelta * millisecondsPerTick);
+        for (uint32_t i = 0; i < kPhaseCount; ++i)
+        {
+            record.phaseTimes[i] = static_cast<float>(currentPhaseTimes[i] * millisecondsPerTick);
+            currentPhaseTimes[i] = 0;
+        }
+
+        // Compare against the median of the frames before this one, a single spike can't hide itself.
+        record.hitch = false;
+        if (count > 0)
+        {
+            const double median = GetMedian(std::min(count, desc.hitchWindow));
+            if (record.frameTime > median * desc.hitchThreshold
+                && record.frameTime - median >= desc.hitchMinMilliseconds)
+            {
+                record.hitch = true;
+                hitchCount++;
+                ALIMER_LOGD("Hitch: frame %llu took %.2f ms, median %.2f ms",
+                    static_cast<unsigned long long>(totalFrameCount), record.frameTime, median);
+            }
+        }
+
+        for (SystemTimes& system : systems)
+        {
+            for (uint32_t i = 0; i < kPhaseCount; ++i)
+            {
+                system.total[i] += system.frameTotal[i];
+                system.max[i] = std::max(system.max[i], system.frameTotal[i]);
+                system.frameTotal[i] = 0;
+            }
+        }
+
+        head = (head + 1) % desc.historySize;
+        count = std::min(count + 1, desc.historySize);
+        totalFrameCount++;
+    }
+
+    const FrameStats::FrameRecord& FrameStats::GetRecord(uint32_t age) const
+    {
+        ALIMER_ASSERT(age < count);
+        return history[(head + desc.historySize - 1 - age) % desc.historySize];
+    }
+
+    float FrameStats::GetMedian(uint32_t windowFrames) const
+    {
+        sortBuffer.clear();
+        for (uint32_t age = 0; age < windowFrames; ++age)
+        {
+            sortBuffer.push_back(GetRecord(age).frameTime);
+        }
+
+        auto middle = sortBuffer.begin() + sortBuffer.size() / 2;
+        std::nth_element(sortBuffer.begin(), middle, sortBuffer.end());
+        return *middle;
+    }
+
+    template <typename TGetValue>
+    FrameTimeSummary FrameStats::Summarize(uint32_t windowFrames, const TGetValue& getValue) const
+    {
+        FrameTimeSummary summary;
+        summary.frameCount = (windowFrames == 0) ? count : std::min(windowFrames, count);
+        if (summary.frameCount == 0)
+            return summary;
+
+        double sum = 0.0;
+        sortBuffer.clear();
+        for (uint32_t age = 0; age < summary.frameCount; ++age)
+        {
+            const FrameRecord& record = GetRecord(age);
+            const float value = getValue(record);
+            sortBuffer.push_back(value);
+            sum += value;
+            summary.hitchCount += record.hitch ? 1 : 0;
+        }
+
+        std::sort(sortBuffer.begin(), sortBuffer.end());
+        summary.average = sum / summary.frameCount;
+        summary.p50 = Percentile(sortBuffer, 50.0);
+        summary.p95 = Percentile(sortBuffer, 95.0);
+        summary.p99 = Percentile(sortBuffer, 99.0);
+        summary.max = sortBuffer.back();
+        return summary;
+    }
+
+    FrameTimeSummary FrameStats::GetFrameTimes(uint32_t windowFrames) const
+    {
+        return Summarize(windowFrames, [](const FrameRecord& record) { return record.frameTime; });
+    }
+
+    FrameTimeSummary FrameStats::GetPhaseTimes(FramePhase phase, uint32_t windowFrames) const
+    {
+        const uint32_t index = static_cast<uint32_t>(phase);
+        return Summarize(windowFrames, [index](const FrameRecord& record) { return record.phaseTimes[index]; });
+    }
+
+    bool FrameStats::IsLastFrameHitch() const
+    {
+        return count > 0 && GetRecord(0).hitch;
+    }
+
+    bool FrameStats::Dump(const std::string& fileName) const
+    {
+        if (EndsWith(fileName, ".json"))
+        {
+            return DumpJson(fileName);
+        }
+
+        return DumpCsv(fileName);
+    }
+
+    bool FrameStats::DumpCsv(const std::string& fileName) const
+    {
+        FILE* file = fopen(fileName.c_str(), "w");
+        if (file == nullptr)
+        {
+            ALIMER_LOGE("FrameStats: Failed to open '%s'", fileName.c_str());
+            return false;
+        }
+
+        // One row per frame, oldest first, times in milliseconds.
+        fputs("frame,frame_ms,hitch", file);
+        for (uint32_t i = 0; i < kPhaseCount; ++i)
+        {
+            fprintf(file, ",%s_ms", GetPhaseName(static_cast<FramePhase>(i)));
+        }
+        fputc('\n', file);
+
+        const uint64_t firstFrame = totalFrameCount - count;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const FrameRecord& record = GetRecord(count - 1 - i);
+            fprintf(file, "%llu,%.4f,%d", static_cast<unsigned long long>(firstFrame + i), record.frameTime, record.hitch ? 1 : 0);
+            for (uint32_t phase = 0; phase < kPhaseCount; ++phase)
+            {
+                fprintf(file, ",%.4f", record.phaseTimes[phase]);
+            }
+            fputc('\n', file);
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    bool FrameStats::DumpJson(const std::string& fileName) const
+    {
+        FILE* file = fopen(fileName.c_str(), "w");
+        if (file == nullptr)
+        {
+            ALIMER_LOGE("FrameStats: Failed to open '%s'", fileName.c_str());
+            return false;
+        }
+
+        fprintf(file, "{\n\"totalFrames\":%llu,\n\"hitches\":%llu,\n\"windows\":[",
+            static_cast<unsigned long long>(totalFrameCount), static_cast<unsigned long long>(hitchCount));
+        for (size_t i = 0; i < desc.reportWindows.size(); ++i)
+        {
+            const uint32_t window = desc.reportWindows[i];
+            fprintf(file, "%s\n{\"window\":%u,\"frame\":", i > 0 ? "," : "", window);
+            WriteSummaryJson(file, GetFrameTimes(window));
+            for (uint32_t phase = 0; phase < kPhaseCount; ++phase)
+            {
+                fprintf(file, ",\"%s\":", GetPhaseName(static_cast<FramePhase>(phase)));
+                WriteSummaryJson(file, GetPhaseTimes(static_cast<FramePhase>(phase), window));
+            }
+            fputc('}', file);
+        }
+
+        // Totals cover every frame since the last reset, average is per frame.
+        fputs("\n],\n\"systems\":[", file);
+        const double frames = static_cast<double>(std::max<uint64_t>(totalFrameCount, 1));
+        for (size_t i = 0; i < systems.size(); ++i)
+        {
+            const SystemTimes& system = systems[i];
+            fprintf(file, "%s\n{\"name\":\"%s\"", i > 0 ? "," : "", system.name.c_str());
+            for (uint32_t phase = 0; phase < kPhaseCount; ++phase)
+            {
+                fprintf(file, ",\"%s\":{\"total\":%.4f,\"average\":%.4f,\"max\":%.4f}",
+                    GetPhaseName(static_cast<FramePhase>(phase)),
+                    system.total[phase] * millisecondsPerTick,
+                    system.total[phase] * millisecondsPerTick / frames,
+                    system.max[phase] * millisecondsPerTick);
+            }
+            fputc('}', file);
+        }
+
+        fputs("\n],\n\"frames\":[", file);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const FrameRecord& record = GetRecord(count - 1 - i);
+            fprintf(file, "%s%s%.4f", i > 0 ? "," : "", (i % 16) == 0 ? "\n" : "", record.frameTime);
+        }
+        fputs("\n]\n}\n", file);
+
+        fclose(file);
+        return true;
+    }
+
+    /* FrameTimings */
+    void FrameTimings::Resize(uint32_t systemCount)
+    {
+        systemTimes.assign(systemCount * static_cast<uint32_t>(FramePhase::Count), 0);
+        Clear();
+    }
+
+    void FrameTimings::Clear()
+    {
+        memset(phaseTimes, 0, sizeof(phaseTimes));
+        std::fill(systemTimes.begin(), systemTimes.end(), 0);
+    }
+
+    void FrameTimings::AddSystemTime(FramePhase phase, uint32_t systemIndex, uint64_t qpcTicks)
+    {
+        const size_t index = systemIndex * static_cast<size_t>(FramePhase::Count) + static_cast<uint32_t>(phase);
+        if (index < systemTimes.size())
+        {
+            systemTimes[index] += qpcTicks;
+        }
+    }
+
+    uint64_t FrameTimings::GetSystemTime(FramePhase phase, uint32_t systemIndex) const
+    {
+        const size_t index = systemIndex * static_cast<size_t>(FramePhase::Count) + static_cast<uint32_t>(phase);
+        return index < systemTimes.size() ? systemTimes[index] : 0;
+    }
+
+    const char* FrameStats::GetPhaseName(FramePhase phase)
+    {
+        switch (phase)
+        {
+        case FramePhase::Update:
+            return "update";
+        case FramePhase::Extract:
+            return "extract";
+        case FramePhase::BeginDraw:
+            return "beginDraw";
+        case FramePhase::Draw:
+            return "draw";
+        case FramePhase::EndDraw:
+            return "endDraw";
+        default:
+            return "unknown";
+        }
+    }
+}
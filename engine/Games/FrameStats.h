@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "core/Preprocessor.h"
+#include <string>
+#include <vector>
+
+namespace alimer
+{
+    /// Phases of a frame that GameSystem callbacks run in.
+    enum class FramePhase : uint32_t
+    {
+        Update,
+        Extract,
+        BeginDraw,
+        Draw,
+        EndDraw,
+        Count
+    };
+
+    struct FrameStatsDesc
+    {
+        /// Number of frames kept in the rolling history.
+        uint32_t historySize = 4096;
+        /// Number of previous frames the hitch detector takes the median of.
+        uint32_t hitchWindow = 120;
+        /// A frame is a hitch when it takes this many times the median frame time.
+        double hitchThreshold = 2.0;
+        /// And at least this many milliseconds more than the median, so that fast frames don't trigger it.
+        double hitchMinMilliseconds = 4.0;
+        /// Windows, in frames, summarized by Dump. Zero covers the whole history.
+        std::vector<uint32_t> reportWindows = { 60, 600, 0 };
+    };
+
+    /// Frame time distribution over a window, in milliseconds.
+    struct FrameTimeSummary
+    {
+        uint32_t frameCount = 0;
+        uint32_t hitchCount = 0;
+        double average = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    /// Phase and per system times gathered outside FrameStats, so a render thread can time its frame and hand it over.
+    class ALIMER_API FrameTimings final
+    {
+    public:
+        /// Set the number of systems and clear the times.
+        void Resize(uint32_t systemCount);
+        /// Clear the times.
+        void Clear();
+
+        /// Add time in Stopwatch units spent in a phase.
+        void AddPhaseTime(FramePhase phase, uint64_t qpcTicks) { phaseTimes[static_cast<uint32_t>(phase)] += qpcTicks; }
+
+        /// Add time in Stopwatch units a system spent in a phase, distinct systems can be timed from different threads.
+        void AddSystemTime(FramePhase phase, uint32_t systemIndex, uint64_t qpcTicks);
+
+        uint64_t GetPhaseTime(FramePhase phase) const { return phaseTimes[static_cast<uint32_t>(phase)]; }
+        uint64_t GetSystemTime(FramePhase phase, uint32_t systemIndex) const;
+        uint32_t GetSystemCount() const { return static_cast<uint32_t>(systemTimes.size() / static_cast<uint32_t>(FramePhase::Count)); }
+
+    private:
+        uint64_t phaseTimes[static_cast<uint32_t>(FramePhase::Count)] = {};
+        std::vector<uint64_t> systemTimes;
+    };
+
+    /// Rolling frame time history with percentiles, hitch detection and per GameSystem phase breakdown.
+    class ALIMER_API FrameStats final
+    {
+    public:
+        FrameStats();
+        ~FrameStats() = default;
+
+        /// Set the history and hitch settings, clears the recorded frames.
+        void Configure(const FrameStatsDesc& desc);
+        const FrameStatsDesc& GetDesc() const { return desc; }
+
+        /// Clear the recorded frames and system timings.
+        void Reset();
+
+        /// Register a GameSystem for per system timings, the returned index is passed to AddSystemTime.
+        uint32_t RegisterSystem(const std::string& name);
+
+        /// Add time in Stopwatch units spent in a phase of the current frame.
+        void AddPhaseTime(FramePhase phase, uint64_t qpcTicks);
+
+        /// Add time in Stopwatch units a system spent in a phase, distinct systems can be timed from different threads.
+        void AddSystemTime(FramePhase phase, uint32_t systemIndex, uint64_t qpcTicks);
+
+        /// Add the times gathered in timings to the current frame.
+        void AddTimings(const FrameTimings& timings);
+
+        /// Record the duration in Stopwatch units of the frame that just ended, called by GameTime.
+        void EndFrame(uint64_t qpcDelta);
+
+        /// Get the frame time distribution over the last windowFrames frames, zero for the whole history.
+        FrameTimeSummary GetFrameTimes(uint32_t windowFrames = 0) const;
+
+        /// Get the time distribution of a phase over the last windowFrames frames, zero for the whole history.
+        FrameTimeSummary GetPhaseTimes(FramePhase phase, uint32_t windowFrames = 0) const;
+
+        /// Return true if the last recorded frame was a hitch.
+        bool IsLastFrameHitch() const;
+
+        /// Get the number of hitches since the last reset.
+        uint64_t GetHitchCount() const { return hitchCount; }
+
+        /// Get the number of frames recorded since the last reset, including the ones that left the history.
+        uint64_t GetTotalFrameCount() const { return totalFrameCount; }
+
+        /// Write the history and summaries to a .csv or .json file, chosen by extension.
+        bool Dump(const std::string& fileName) const;
+
+        static const char* GetPhaseName(FramePhase phase);
+
+    private:
+        static constexpr uint32_t kPhaseCount = static_cast<uint32_t>(FramePhase::Count);
+
+        struct FrameRecord
+        {
+            float frameTime;
+            float phaseTimes[kPhaseCount];
+            bool hitch;
+        };
+
+        struct SystemTimes
+        {
+            std::string name;
+            uint64_t total[kPhaseCount];
+            uint64_t max[kPhaseCount];
+            uint64_t frameTotal[kPhaseCount];
+        };
+
+        const FrameRecord& GetRecord(uint32_t age) const;
+        float GetMedian(uint32_t windowFrames) const;
+        template <typename TGetValue>
+        FrameTimeSummary Summarize(uint32_t windowFrames, const TGetValue& getValue) const;
+
+        bool DumpCsv(const std::string& fileName) const;
+        bool DumpJson(const std::string& fileName) const;
+
+        FrameStatsDesc desc;
+        double millisecondsPerTick;
+
+        std::vector<FrameRecord> history;
+        uint32_t head = 0;
+        uint32_t count = 0;
+        uint64_t totalFrameCount = 0;
+        uint64_t hitchCount = 0;
+
+        /// Phase times of the frame in progress.
+        uint64_t currentPhaseTimes[kPhaseCount] = {};
+        std::vector<SystemTimes> systems;
+
+        /// Scratch for sorting, avoids allocations per query.
+        mutable std::vector<float> sortBuffer;
+    };
+}
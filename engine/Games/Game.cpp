@@ -26,34 +26,98 @@
 #include "graphics/SwapChain.h"
 #include "Input/InputManager.h"
 #include "core/Log.h"
+#include "core/FrameAllocator.h"
+#include "core/Profiler.h"
+#include "core/Stopwatch.h"
+#include <algorithm>
 
 namespace alimer
 {
+    namespace
+    {
+        /// Events pulled from the os queue per poll_events call.
+        constexpr size_t kEventBatchSize = 64;
+    }
+
     Game::Game(const Configuration& config_)
         : config(config_)
         , input(new InputManager())
     {
+        if (config.asyncLogging)
+        {
+            Log::StartAsync(config.asyncLogDesc);
+        }
+
+        if (!config.binaryLogFile.empty())
+        {
+            BinaryLog::Open(config.binaryLogFile.c_str());
+        }
+
+        ALIMER_PROFILE_THREAD("Main");
+        time.GetFrameStats().Configure(config.frameStatsDesc);
+
         os::init();
+        JobSystem::Initialize(config.jobWorkerCount);
+
+        // Memory allocated while extracting a frame must outlive drawing it on the render thread.
+        config.renderFramesInFlight = std::min(std::max(config.renderFramesInFlight, 1u), FrameAllocator::kMaxBufferCount - 1);
+        const uint32_t frameBufferCount = config.pipelinedRendering ? std::max(3u, config.renderFramesInFlight + 1) : 3u;
+        FrameAllocator::Initialize(config.frameAllocatorSize, frameBufferCount);
         gameSystems.push_back(input);
     }
 
     Game::~Game()
     {
+        StopRenderThread();
+
+        const FrameStats& frameStats = time.GetFrameStats();
+        if (frameStats.GetTotalFrameCount() > 0)
+        {
+            const FrameTimeSummary summary = frameStats.GetFrameTimes();
+            ALIMER_LOGI("Frame times over %u frames: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms, %llu hitches",
+                summary.frameCount, summary.p50, summary.p95, summary.p99, summary.max,
+                static_cast<unsigned long long>(frameStats.GetHitchCount()));
+
+            if (!config.frameStatsFile.empty())
+            {
+                frameStats.Dump(config.frameStatsFile);
+            }
+        }
+
         for (auto gameSystem : gameSystems)
         {
             SafeDelete(gameSystem);
         }
 
         gameSystems.clear();
-        gpuDevice->WaitForIdle();
-        gpuDevice.Reset();
+        if (gpuDevice.IsNotNull())
+        {
+            gpuDevice->WaitForIdle();
+            gpuDevice.Reset();
+        }
+        JobSystem::Shutdown();
+        FrameAllocator::Shutdown();
         os::shutdown();
+        BinaryLog::Close();
+
+#if defined(ALIMER_PROFILING)
+        if (!config.profileTraceFile.empty())
+        {
+            Profiler::ExportTrace(config.profileTraceFile.c_str());
+        }
+        Profiler::Shutdown();
+#endif
+
+        Log::StopAsync();
     }
 
     void Game::InitBeforeRun()
     {
-        // Create main window.
-        mainWindow.reset(new Window(config.windowTitle, config.windowSize, WindowStyle::Resizable));
+        // Create main window, headless runs (for example with the null GPU backend) don't need one.
+        if (!config.headless)
+        {
+            mainWindow.reset(new Window(config.windowTitle, config.windowSize, WindowStyle::Resizable));
+        }
 
         GPUDevice::Desc desc = {};
         desc.powerPreference = GPUPowerPreference::HighPerformance;
@@ -79,9 +143,13 @@ namespace alimer
     {
         for (auto gameSystem : gameSystems)
         {
+            ALIMER_PROFILE_SCOPE(gameSystem->GetTypeName().c_str());
             gameSystem->Initialize();
+            time.GetFrameStats().RegisterSystem(gameSystem->GetTypeName());
         }
 
+        UpdateSystemSchedule();
+
 #if TODO
         struct Vertex
         {
@@ -152,11 +220,9 @@ float4 PSMain(PSInput input) : SV_TARGET
     bool Game::BeginDraw()
     {
         //vgpu_begin_frame();
+        ALIMER_PROFILE_SCOPE("Game::BeginDraw");
 
-        for (auto gameSystem : gameSystems)
-        {
-            gameSystem->BeginDraw();
-        }
+        drawScheduler.Run(FramePhase::BeginDraw, *drawTime, drawSlot, *drawTimings);
 
         return true;
     }
@@ -166,21 +232,17 @@ float4 PSMain(PSInput input) : SV_TARGET
         //auto context = graphicsDevice->GetGraphicsContext();
         //context->BeginRenderPass(mainSwapChain.get(), Colors::CornflowerBlue);
         //context->EndMarker();
+        ALIMER_PROFILE_SCOPE("Game::Draw");
 
-        for (auto gameSystem : gameSystems)
-        {
-            gameSystem->Draw(time);
-        }
+        drawScheduler.Run(FramePhase::Draw, gameTime, drawSlot, *drawTimings);
     }
 
     void Game::EndDraw()
     {
         //auto currentTexture = mainSwapChain->GetCurrentTexture();
+        ALIMER_PROFILE_SCOPE("Game::EndDraw");
 
-        for (auto gameSystem : gameSystems)
-        {
-            gameSystem->EndDraw();
-        }
+        drawScheduler.Run(FramePhase::EndDraw, *drawTime, drawSlot, *drawTimings);
 
         /*auto clear_color = Colors::CornflowerBlue;
         auto defaultRenderPass = vgpu_get_default_render_pass();
@@ -210,22 +272,34 @@ float4 PSMain(PSInput input) : SV_TARGET
             running = true;
 
             InitBeforeRun();
+            if (config.pipelinedRendering)
+            {
+                StartRenderThread();
+            }
 
             // Main message loop
             while (running)
             {
-                os::Event evt{};
-                while (os::poll_event(evt))
+                // Drain the pending events in batches, a full batch means more may be waiting.
+                os::Event events[kEventBatchSize]{};
+                size_t count = kEventBatchSize;
+                while (running && count == kEventBatchSize)
                 {
-                    if (evt.type == os::Event::Type::Quit)
+                    count = os::poll_events(events, kEventBatchSize);
+                    for (size_t i = 0; i < count; ++i)
                     {
-                        running = false;
-                        break;
+                        if (events[i].type == os::Event::Type::Quit)
+                        {
+                            running = false;
+                            break;
+                        }
                     }
                 }
 
                 Tick();
             }
+
+            StopRenderThread();
         }
 #if !defined(__GNUC__) && _HAS_EXCEPTIONS
         catch (std::bad_alloc&)
@@ -240,32 +314,234 @@ float4 PSMain(PSInput input) : SV_TARGET
 
     void Game::Tick()
     {
+        ALIMER_PROFILE_SCOPE("Game::Tick");
+
+        // A fixed timestep tick before the next step is due would only redraw the same state.
+        if (config.limitFixedTimeStep && time.IsFixedTimeStep())
+        {
+            frameLimiter.WaitUntil(time.GetNextUpdateTimestamp());
+        }
+
+        // Recycle the oldest scratch buffer, jobs from the previous frame have completed.
+        FrameAllocator::NextFrame();
+
         time.Tick([&]()
             {
+                const uint64_t start = Stopwatch::GetTimestamp();
                 Update(time);
+                frameTimings.AddPhaseTime(FramePhase::Update, Stopwatch::GetTimestamp() - start);
             });
 
         Render();
+
+        // Fence the frame and release the GPU objects the GPU is done with, the render thread does it when pipelined.
+        if (!renderThread.joinable() && gpuDevice.IsNotNull())
+        {
+            gpuDevice->EndFrame();
+        }
+
+        // Counted in the frame GameTime ends at the next Tick.
+        time.GetFrameStats().AddTimings(frameTimings);
+        frameTimings.Clear();
     }
 
     void Game::Update(const GameTime& gameTime)
     {
-        for (auto gameSystem : gameSystems)
+        ALIMER_PROFILE_SCOPE("Game::Update");
+
+        UpdateSystemSchedule();
+        systemScheduler.Run(FramePhase::Update, gameTime, 0, frameTimings);
+    }
+
+    void Game::Extract(uint32_t slot)
+    {
+        ALIMER_PROFILE_SCOPE("Game::Extract");
+
+        systemScheduler.Run(FramePhase::Extract, time, slot, frameTimings);
+    }
+
+    void Game::UpdateSystemSchedule()
+    {
+        if (systemScheduler.IsBuiltFor(gameSystems))
+            return;
+
+        // The render thread may be running the draw schedule.
+        WaitForRenderThread(0);
+
+        const uint32_t systemCount = static_cast<uint32_t>(gameSystems.size());
+        systemScheduler.Build(gameSystems);
+        drawScheduler.Build(gameSystems, true);
+        frameTimings.Resize(systemCount);
+        for (auto& frame : renderFrames)
         {
-            gameSystem->Update(gameTime);
+            frame->timings.Resize(systemCount);
         }
+
+        ALIMER_LOGD("%s", systemScheduler.Dump().c_str());
+        ALIMER_LOGD("%s", drawScheduler.Dump().c_str());
     }
 
     void Game::Render()
     {
+        ALIMER_PROFILE_SCOPE("Game::Render");
+
         // Don't try to render anything before the first Update.
-        if (running
-            && time.GetFrameCount() > 0
-            && !mainWindow->IsMinimized()
-            && BeginDraw())
+        if (!running
+            || time.GetFrameCount() == 0
+            || (mainWindow != nullptr && mainWindow->IsMinimized()))
         {
-            Draw(time);
+            return;
+        }
+
+        UpdateSystemSchedule();
+
+        if (renderThread.joinable())
+        {
+            // Wait for a free slot, so the update stays at most renderFramesInFlight frames ahead of drawing.
+            WaitForRenderThread(renderFrames.size() - 1);
+
+            const uint32_t slot = static_cast<uint32_t>(submittedFrames % renderFrames.size());
+            renderFrames[slot]->time.CopyTimeFrom(time);
+
+            const uint64_t start = Stopwatch::GetTimestamp();
+            Extract(slot);
+            frameTimings.AddPhaseTime(FramePhase::Extract, Stopwatch::GetTimestamp() - start);
+
+            {
+                std::lock_guard<std::mutex> lock(renderMutex);
+                submittedFrames++;
+            }
+            renderCondition.notify_all();
+            return;
+        }
+
+        const uint64_t start = Stopwatch::GetTimestamp();
+        Extract(0);
+        frameTimings.AddPhaseTime(FramePhase::Extract, Stopwatch::GetTimestamp() - start);
+
+        DrawFrame(time, 0, frameTimings);
+    }
+
+    void Game::DrawFrame(const GameTime& frameTime, uint32_t slot, FrameTimings& timings)
+    {
+        drawTime = &frameTime;
+        drawSlot = slot;
+        drawTimings = &timings;
+
+        uint64_t start = Stopwatch::GetTimestamp();
+        const bool drawing = BeginDraw();
+        uint64_t end = Stopwatch::GetTimestamp();
+        timings.AddPhaseTime(FramePhase::BeginDraw, end - start);
+
+        if (drawing)
+        {
+            start = end;
+            Draw(frameTime);
+            end = Stopwatch::GetTimestamp();
+            timings.AddPhaseTime(FramePhase::Draw, end - start);
+
+            start = end;
             EndDraw();
+            timings.AddPhaseTime(FramePhase::EndDraw, Stopwatch::GetTimestamp() - start);
+        }
+    }
+
+    void Game::StartRenderThread()
+    {
+        const uint32_t systemCount = static_cast<uint32_t>(gameSystems.size());
+        renderFrames.clear();
+        for (uint32_t i = 0; i < config.renderFramesInFlight; ++i)
+        {
+            renderFrames.emplace_back(new RenderFrame());
+            renderFrames.back()->timings.Resize(systemCount);
+        }
+
+        submittedFrames = 0;
+        drawnFrames = 0;
+        collectedFrames = 0;
+        renderThreadStopping = false;
+        renderThread = std::thread(&Game::RenderThreadMain, this);
+    }
+
+    void Game::StopRenderThread()
+    {
+        if (!renderThread.joinable())
+            return;
+
+        // The render thread draws the frames already submitted before it exits.
+        {
+            std::lock_guard<std::mutex> lock(renderMutex);
+            renderThreadStopping = true;
+        }
+        renderCondition.notify_all();
+        renderThread.join();
+
+        WaitForRenderThread(0);
+        renderFrames.clear();
+    }
+
+    void Game::WaitForRenderThread(uint64_t maxFramesInFlight)
+    {
+        uint64_t drawn;
+        {
+            std::unique_lock<std::mutex> lock(renderMutex);
+            renderCondition.wait(lock, [this, maxFramesInFlight] {
+                return submittedFrames - drawnFrames <= maxFramesInFlight;
+                });
+            drawn = drawnFrames;
+        }
+
+        // The render thread is done with these frames until they are submitted again.
+        FrameStats& frameStats = time.GetFrameStats();
+        for (; collectedFrames < drawn; ++collectedFrames)
+        {
+            FrameTimings& timings = renderFrames[collectedFrames % renderFrames.size()]->timings;
+            frameStats.AddTimings(timings);
+            timings.Clear();
+        }
+    }
+
+    void Game::RenderThreadMain()
+    {
+        ALIMER_PROFILE_THREAD("Render");
+
+        // With a job queue of its own, the draw phases spread thread safe systems across the workers.
+        const bool jobThread = JobSystem::RegisterThread();
+
+        for (;;)
+        {
+            uint64_t frameIndex;
+            {
+                std::unique_lock<std::mutex> lock(renderMutex);
+                renderCondition.wait(lock, [this] {
+                    return renderThreadStopping || drawnFrames < submittedFrames;
+                    });
+
+                if (drawnFrames == submittedFrames)
+                    break;
+
+                frameIndex = drawnFrames;
+            }
+
+            const uint32_t slot = static_cast<uint32_t>(frameIndex % renderFrames.size());
+            RenderFrame& frame = *renderFrames[slot];
+            DrawFrame(frame.time, slot, frame.timings);
+
+            if (gpuDevice.IsNotNull())
+            {
+                gpuDevice->EndFrame();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(renderMutex);
+                drawnFrames++;
+            }
+            renderCondition.notify_all();
+        }
+
+        if (jobThread)
+        {
+            JobSystem::UnregisterThread();
         }
     }
 }
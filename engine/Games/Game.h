@@ -24,12 +24,19 @@
 
 #include "core/Object.h"
 #include "Games/GameTime.h"
-#include "os/window.h"
+#include "Games/FrameLimiter.h"
+#include "os/Window.h"
 #include "Games/GameSystem.h"
-#include "math/Size.h"
-#include "graphics/types.h"
-#include <vector>
+#include "Games/GameSystemScheduler.h"
+#include "math/size.h"
+#include "graphics/Types.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace alimer
 {
@@ -49,6 +56,39 @@ namespace alimer
 
         /// Main window size.
         usize windowSize = { 1280, 720 };
+
+        /// Number of job worker threads, by default one worker per additional core.
+        uint32_t jobWorkerCount = JobSystem::kDefaultWorkerCount;
+
+        /// Size of each per frame scratch buffer, grows to the peak usage if exceeded.
+        size_t frameAllocatorSize = 4 * 1024 * 1024;
+
+        /// Write log messages from a background thread, see asyncLogDesc for what happens when a burst fills a buffer.
+        bool asyncLogging = false;
+        AsyncLogDesc asyncLogDesc;
+
+        /// When set, trace messages are recorded in binary form to this file, decode it with tools/LogDecoder.
+        std::string binaryLogFile;
+
+        /// Draw on a render thread while the main thread updates the next frame, the two meet at GameSystem::Extract.
+        /// Draw phase code then runs on the render thread and must only read what Extract copied. The render thread
+        /// registers with the JobSystem, if no registration slot is left its draw phases run serially.
+        bool pipelinedRendering = false;
+
+        /// With pipelined rendering, how many extracted frames the update can run ahead of drawing, 1 to 3.
+        uint32_t renderFramesInFlight = 2;
+
+        /// In fixed timestep mode, sleep until the next update is due instead of ticking as fast as possible.
+        bool limitFixedTimeStep = true;
+
+        /// With ALIMER_PROFILING, file the CPU profile is exported to at shutdown (.json for Chrome trace, Perfetto otherwise).
+        std::string profileTraceFile = "alimer-profile.json";
+
+        /// Frame time history and hitch detection settings.
+        FrameStatsDesc frameStatsDesc;
+
+        /// When set, frame times are dumped at shutdown to this .csv or .json file.
+        std::string frameStatsFile;
     };
 
     class InputManager;
@@ -75,6 +115,9 @@ namespace alimer
 
         inline InputManager* GetInput() const noexcept { return input; }
 
+        /// Get the scheduler running the GameSystems, its Dump shows the computed schedule.
+        inline const GameSystemScheduler& GetSystemScheduler() const noexcept { return systemScheduler; }
+
     protected:
         /// Setup before modules initialization. 
         virtual void Setup() {}
@@ -86,7 +129,10 @@ namespace alimer
         virtual void EndRun();
 
         virtual void Update(const GameTime& gameTime);
+        /// Copy the state drawing needs into a frame slot, by default runs Extract of all GameSystems.
+        virtual void Extract(uint32_t slot);
 
+        /// The draw phases run on the render thread with pipelined rendering.
         virtual bool BeginDraw();
         virtual void Draw(const GameTime& gameTime);
         virtual void EndDraw();
@@ -96,6 +142,24 @@ namespace alimer
         void InitBeforeRun();
         
         void Render();
+        /// Run the draw phases for an extracted frame.
+        void DrawFrame(const GameTime& frameTime, uint32_t slot, FrameTimings& timings);
+
+        /// Rebuild the system schedule if systems were added or removed.
+        void UpdateSystemSchedule();
+
+        void StartRenderThread();
+        void StopRenderThread();
+        /// Block until the render thread has drawn all submitted frames, then add their timings.
+        void WaitForRenderThread(uint64_t maxFramesInFlight);
+        void RenderThreadMain();
+
+        /// A frame handed from the main thread to the render thread.
+        struct RenderFrame
+        {
+            GameTime time;
+            FrameTimings timings;
+        };
 
     protected:
         int exitCode = 0;
@@ -103,8 +167,30 @@ namespace alimer
         bool running = false;
         // Rendering loop timer.
         GameTime time;
+        FrameLimiter frameLimiter;
         std::unique_ptr<Window> mainWindow;
         std::vector<GameSystem*> gameSystems;
+        /// Runs Update and Extract on the main thread.
+        GameSystemScheduler systemScheduler;
+        /// Runs the draw phases, on the render thread with pipelined rendering.
+        GameSystemScheduler drawScheduler;
+        /// Main thread timings of the current frame.
+        FrameTimings frameTimings;
+
+        // Pipelined rendering, frame k uses renderFrames[k % renderFrames.size()].
+        std::vector<std::unique_ptr<RenderFrame>> renderFrames;
+        std::thread renderThread;
+        std::mutex renderMutex;
+        std::condition_variable renderCondition;
+        uint64_t submittedFrames = 0;
+        uint64_t drawnFrames = 0;
+        uint64_t collectedFrames = 0;
+        bool renderThreadStopping = false;
+
+        // Frame the draw phases are running for.
+        const GameTime* drawTime = nullptr;
+        uint32_t drawSlot = 0;
+        FrameTimings* drawTimings = nullptr;
         RefPtr<GPUDevice> gpuDevice;
         InputManager* input;
         bool headless{ false };
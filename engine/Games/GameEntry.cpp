@@ -68,6 +68,10 @@ int main(int argc, char* argv[])
 
     alimer::Platform::SetArguments(args);
     alimer::Platform::OpenConsole();
+#else
+    // Ignore the first argument containing the application full path
+    vector<string> args(argv + 1, argv + argc);
+    alimer::Platform::SetArguments(args);
 #endif
 
     auto app = unique_ptr<alimer::Game>(alimer::ApplicationCreate(args));
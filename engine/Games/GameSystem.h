@@ -24,6 +24,7 @@
 
 #include "core/Object.h"
 #include "Games/GameTime.h"
+#include <vector>
 
 namespace alimer
 {
@@ -38,9 +39,48 @@ namespace alimer
         virtual ~GameSystem() = default;
 
         virtual void Initialize() {}
+
+        /// Return true if Update can run on a worker thread. Without access declarations it must also not touch state shared with other systems.
+        virtual bool IsUpdateThreadSafe() const { return false; }
+        /// Return true if BeginDraw, Draw and EndDraw can run on a worker thread.
+        virtual bool IsDrawThreadSafe() const { return false; }
+
         virtual void Update(const GameTime& gameTime) {}
+        /// Copy the state the draw phases need into a frame slot, runs on the main thread after Update.
+        /// With pipelined rendering the draw phases run on the render thread while the next frame updates.
+        virtual void Extract(uint32_t slot) {}
         virtual void BeginDraw() {}
         virtual void Draw(const GameTime& gameTime) {}
         virtual void EndDraw() {}
+
+        /// Return the frame slot filled by Extract that the running draw phase renders.
+        uint32_t GetDrawSlot() const { return drawSlot; }
+
+        /// Return true if the system declared the resources it reads or writes.
+        bool HasAccessDeclarations() const { return !reads.empty() || !writes.empty(); }
+        /// Return the resources the system reads.
+        const std::vector<StringId32>& GetReads() const { return reads; }
+        /// Return the resources the system writes.
+        const std::vector<StringId32>& GetWrites() const { return writes; }
+        /// Return the system types that must run before this one.
+        const std::vector<StringId32>& GetRunsAfter() const { return runsAfter; }
+
+    protected:
+        /// Declare a resource read by the system, systems only reading a resource can run at the same time.
+        void Reads(StringId32 resource) { reads.push_back(resource); }
+        /// Declare a resource written by the system, it runs alone against every other system using the resource.
+        void Writes(StringId32 resource) { writes.push_back(resource); }
+        /// Declare a system type that must run before this one when both are registered.
+        void RunsAfter(StringId32 systemType) { runsAfter.push_back(systemType); }
+        /// Declare a system class that must run before this one when both are registered.
+        template <typename T> void RunsAfter() { RunsAfter(T::GetTypeStatic()); }
+
+    private:
+        friend class GameSystemScheduler;
+
+        uint32_t drawSlot = 0;
+        std::vector<StringId32> reads;
+        std::vector<StringId32> writes;
+        std::vector<StringId32> runsAfter;
     };
 }
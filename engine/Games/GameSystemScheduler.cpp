@@ -0,0 +1,364 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Games/GameSystemScheduler.h"
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "core/Profiler.h"
+#include "core/Stopwatch.h"
+#include <algorithm>
+#include <thread>
+
+namespace alimer
+{
+    namespace
+    {
+        bool Contains(const std::vector<StringId32>& resources, StringId32 resource)
+        {
+            return std::find(resources.begin(), resources.end(), resource) != resources.end();
+        }
+
+        bool Intersects(const std::vector<StringId32>& a, const std::vector<StringId32>& b)
+        {
+            for (StringId32 resource : a)
+            {
+                if (Contains(b, resource))
+                    return true;
+            }
+
+            return false;
+        }
+
+        /// Systems without declarations are either isolated (thread safe for the phases) or exclusive.
+        bool IsIsolated(const GameSystem* system, bool drawPhases)
+        {
+            const bool threadSafe = drawPhases ? system->IsDrawThreadSafe() : system->IsUpdateThreadSafe();
+            return !system->HasAccessDeclarations() && threadSafe;
+        }
+
+        bool Conflicts(const GameSystem* a, const GameSystem* b, bool drawPhases)
+        {
+            if (IsIsolated(a, drawPhases) || IsIsolated(b, drawPhases))
+                return false;
+
+            if (!a->HasAccessDeclarations() || !b->HasAccessDeclarations())
+                return true;
+
+            return Intersects(a->GetWrites(), b->GetWrites())
+                || Intersects(a->GetWrites(), b->GetReads())
+                || Intersects(a->GetReads(), b->GetWrites());
+        }
+
+        void AppendList(std::string& text, const char* label, const std::vector<StringId32>& resources)
+        {
+            if (resources.empty())
+                return;
+
+            text += label;
+            for (size_t i = 0; i < resources.size(); ++i)
+            {
+                text += i == 0 ? " " : ", ";
+                text += resources[i].ToString();
+            }
+        }
+    }
+
+    void GameSystemScheduler::Build(const std::vector<GameSystem*>& systems, bool drawPhases_)
+    {
+        const uint32_t count = static_cast<uint32_t>(systems.size());
+        drawPhases = drawPhases_;
+        nodes.clear();
+        nodes.resize(count);
+        pendingCounts.reset(new std::atomic<uint32_t>[count]);
+
+        // Explicit RunsAfter edges, before[a * count + b] means a runs before b.
+        std::vector<uint8_t> before(count * count, 0);
+        for (uint32_t b = 0; b < count; ++b)
+        {
+            for (StringId32 type : systems[b]->GetRunsAfter())
+            {
+                for (uint32_t a = 0; a < count; ++a)
+                {
+                    if (a != b && systems[a]->GetTypeInfo()->IsTypeOf(type))
+                        before[a * count + b] = 1;
+                }
+            }
+        }
+
+        // Order the systems by the explicit edges, ties go to the earlier registered system.
+        std::vector<uint32_t> order;
+        std::vector<uint32_t> rank(count, 0);
+        std::vector<uint8_t> placed(count, 0);
+        order.reserve(count);
+        while (order.size() < count)
+        {
+            uint32_t next = count;
+            for (uint32_t b = 0; b < count && next == count; ++b)
+            {
+                if (placed[b])
+                    continue;
+
+                bool ready = true;
+                for (uint32_t a = 0; a < count && ready; ++a)
+                {
+                    ready = placed[a] || !before[a * count + b];
+                }
+
+                if (ready)
+                    next = b;
+            }
+
+            if (next == count)
+            {
+                // A RunsAfter cycle, break it at the earliest registered system left.
+                for (next = 0; placed[next]; ++next)
+                {
+                }
+
+                ALIMER_LOGE("GameSystem '%s' is part of a RunsAfter cycle, ignoring its unsatisfied dependencies",
+                    systems[next]->GetTypeName().c_str());
+            }
+
+            placed[next] = 1;
+            rank[next] = static_cast<uint32_t>(order.size());
+            order.push_back(next);
+        }
+
+        // Shared resources are used in that order.
+        for (uint32_t a = 0; a < count; ++a)
+        {
+            for (uint32_t b = a + 1; b < count; ++b)
+            {
+                const bool aFirst = rank[a] < rank[b];
+                const uint32_t first = aFirst ? a : b;
+                const uint32_t second = aFirst ? b : a;
+                if (before[second * count + first])
+                    before[second * count + first] = 0;
+
+                if (Conflicts(systems[a], systems[b], drawPhases))
+                    before[first * count + second] = 1;
+            }
+        }
+
+        // Keep only the edges not implied by others, walking back from the last system in the order.
+        std::vector<uint8_t> reachable(count * count, 0);
+        for (uint32_t position = count; position-- > 0;)
+        {
+            const uint32_t a = order[position];
+            for (uint32_t later = position + 1; later < count; ++later)
+            {
+                const uint32_t b = order[later];
+                if (!before[a * count + b] || reachable[a * count + b])
+                    continue;
+
+                nodes[a].successors.push_back(b);
+                nodes[b].predecessors.push_back(a);
+                reachable[a * count + b] = 1;
+                for (uint32_t c = 0; c < count; ++c)
+                {
+                    reachable[a * count + c] |= reachable[b * count + c];
+                }
+            }
+        }
+
+        for (uint32_t position = 0; position < count; ++position)
+        {
+            const uint32_t index = order[position];
+            Node& node = nodes[index];
+            node.system = systems[index];
+            node.updateOnMainThread = !node.system->IsUpdateThreadSafe();
+            node.drawOnMainThread = !node.system->IsDrawThreadSafe();
+            node.wave = 0;
+            for (uint32_t predecessor : node.predecessors)
+            {
+                node.wave = std::max(node.wave, nodes[predecessor].wave + 1);
+            }
+        }
+    }
+
+    bool GameSystemScheduler::IsBuiltFor(const std::vector<GameSystem*>& systems) const
+    {
+        if (systems.size() != nodes.size())
+            return false;
+
+        for (size_t i = 0; i < systems.size(); ++i)
+        {
+            if (nodes[i].system != systems[i])
+                return false;
+        }
+
+        return true;
+    }
+
+    void GameSystemScheduler::Run(FramePhase phase_, const GameTime& gameTime_, uint32_t slot_, FrameTimings& timings_)
+    {
+        const uint32_t count = GetSystemCount();
+        if (count == 0)
+            return;
+
+        ALIMER_ASSERT_MSG(drawPhases == (phase_ != FramePhase::Update && phase_ != FramePhase::Extract),
+            "GameSystemScheduler built for other phases");
+        phase = phase_;
+        gameTime = &gameTime_;
+        slot = slot_;
+        timings = &timings_;
+        mainThreadReady.clear();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            pendingCounts[i].store(static_cast<uint32_t>(nodes[i].predecessors.size()), std::memory_order_relaxed);
+        }
+        remaining.store(count, std::memory_order_relaxed);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (nodes[i].predecessors.empty())
+                Dispatch(i);
+        }
+
+        // Run the main thread systems as they become ready and help the workers in between.
+        while (remaining.load(std::memory_order_acquire) > 0)
+        {
+            uint32_t index;
+            if (PopMainThreadReady(index))
+            {
+                Execute(index);
+            }
+            else if (!JobSystem::ExecuteOne())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        JobSystem::Wait(jobCounter);
+    }
+
+    void GameSystemScheduler::Dispatch(uint32_t index)
+    {
+        const Node& node = nodes[index];
+        const bool mainThread = drawPhases ? node.drawOnMainThread : node.updateOnMainThread;
+        if (mainThread)
+        {
+            std::lock_guard<std::mutex> lock(mainThreadMutex);
+            mainThreadReady.push_back(index);
+            return;
+        }
+
+        JobSystem::Run([](void* data, uint32_t begin, uint32_t end) {
+            static_cast<GameSystemScheduler*>(data)->Execute(begin);
+            }, this, index, index + 1, &jobCounter);
+    }
+
+    void GameSystemScheduler::Execute(uint32_t index)
+    {
+        GameSystem* system = nodes[index].system;
+        {
+            ALIMER_PROFILE_SCOPE(system->GetTypeName().c_str());
+            const uint64_t start = Stopwatch::GetTimestamp();
+            switch (phase)
+            {
+            case FramePhase::Update:
+                system->Update(*gameTime);
+                break;
+            case FramePhase::Extract:
+                system->Extract(slot);
+                break;
+            case FramePhase::BeginDraw:
+                system->drawSlot = slot;
+                system->BeginDraw();
+                break;
+            case FramePhase::Draw:
+                system->drawSlot = slot;
+                system->Draw(*gameTime);
+                break;
+            case FramePhase::EndDraw:
+                system->drawSlot = slot;
+                system->EndDraw();
+                break;
+            default:
+                break;
+            }
+            timings->AddSystemTime(phase, index, Stopwatch::GetTimestamp() - start);
+        }
+
+        for (uint32_t successor : nodes[index].successors)
+        {
+            if (pendingCounts[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                Dispatch(successor);
+        }
+
+        remaining.fetch_sub(1, std::memory_order_release);
+    }
+
+    bool GameSystemScheduler::PopMainThreadReady(uint32_t& index)
+    {
+        std::lock_guard<std::mutex> lock(mainThreadMutex);
+        if (mainThreadReady.empty())
+            return false;
+
+        // Earliest registered first, so main thread systems keep their relative order.
+        auto it = std::min_element(mainThreadReady.begin(), mainThreadReady.end());
+        index = *it;
+        mainThreadReady.erase(it);
+        return true;
+    }
+
+    std::string GameSystemScheduler::Dump() const
+    {
+        uint32_t waveCount = 0;
+        for (const Node& node : nodes)
+        {
+            waveCount = std::max(waveCount, node.wave + 1);
+        }
+
+        std::string text = std::string(drawPhases ? "GameSystem draw schedule, " : "GameSystem update schedule, ") + std::to_string(nodes.size()) + " systems in "
+            + std::to_string(waveCount) + " waves:\n";
+        for (uint32_t wave = 0; wave < waveCount; ++wave)
+        {
+            for (const Node& node : nodes)
+            {
+                if (node.wave != wave)
+                    continue;
+
+                text += "  wave " + std::to_string(wave) + ": " + node.system->GetTypeName();
+                text += node.updateOnMainThread ? " [update: main" : " [update: worker";
+                text += node.drawOnMainThread ? ", draw: main]" : ", draw: worker]";
+                if (!node.system->HasAccessDeclarations())
+                    text += IsIsolated(node.system, drawPhases) ? " isolated" : " exclusive";
+
+                AppendList(text, " reads", node.system->GetReads());
+                AppendList(text, " writes", node.system->GetWrites());
+                if (!node.predecessors.empty())
+                {
+                    text += " after";
+                    for (size_t i = 0; i < node.predecessors.size(); ++i)
+                    {
+                        text += i == 0 ? " " : ", ";
+                        text += nodes[node.predecessors[i]].system->GetTypeName();
+                    }
+                }
+                text += "\n";
+            }
+        }
+
+        return text;
+    }
+}
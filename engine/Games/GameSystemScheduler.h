@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "Games/GameSystem.h"
+#include "Games/FrameStats.h"
+#include "core/JobSystem.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace alimer
+{
+    /// Runs a frame phase of the GameSystems as a task graph built from their declarations.
+    ///
+    /// A system waits for the systems whose type it runs after, and for earlier registered systems that
+    /// write a resource it uses or use a resource it writes. Systems without declarations that are not
+    /// thread safe conflict with every other declared or undeclared one, as in the old one by one loop,
+    /// while thread safe undeclared systems conflict with nothing. The update phases (Update, Extract) and
+    /// the draw phases use separate graphs, built from IsUpdateThreadSafe and IsDrawThreadSafe.
+    class ALIMER_API GameSystemScheduler final
+    {
+    public:
+        /// Constructor.
+        GameSystemScheduler() = default;
+
+        /// Build the graph for the update phases or the draw phases, call again whenever the system list changes.
+        void Build(const std::vector<GameSystem*>& systems, bool drawPhases = false);
+
+        /// Return true if the graph was built for exactly these systems.
+        bool IsBuiltFor(const std::vector<GameSystem*>& systems) const;
+
+        /// Run one phase of every system, systems that aren't thread safe for the phase run on the calling thread.
+        /// Slot is the frame slot passed to Extract or returned by GetDrawSlot during the draw phases.
+        void Run(FramePhase phase, const GameTime& gameTime, uint32_t slot, FrameTimings& timings);
+
+        /// Return the schedule as text, one line per system with its wave, thread, declarations and the systems it waits for.
+        std::string Dump() const;
+
+        /// Return the number of systems the graph was built for.
+        uint32_t GetSystemCount() const { return static_cast<uint32_t>(nodes.size()); }
+
+    private:
+        struct Node
+        {
+            GameSystem* system;
+            /// Systems waiting for this one.
+            std::vector<uint32_t> successors;
+            /// Systems this one waits for.
+            std::vector<uint32_t> predecessors;
+            /// Longest chain of predecessors, systems in the same wave can run at the same time.
+            uint32_t wave;
+            bool updateOnMainThread;
+            bool drawOnMainThread;
+        };
+
+        void Dispatch(uint32_t index);
+        void Execute(uint32_t index);
+        bool PopMainThreadReady(uint32_t& index);
+
+        std::vector<Node> nodes;
+        std::unique_ptr<std::atomic<uint32_t>[]> pendingCounts;
+
+        /// The graph runs BeginDraw, Draw and EndDraw rather than Update and Extract.
+        bool drawPhases = false;
+
+        // State of the phase being run.
+        FramePhase phase = FramePhase::Update;
+        const GameTime* gameTime = nullptr;
+        uint32_t slot = 0;
+        FrameTimings* timings = nullptr;
+        std::atomic<uint32_t> remaining{ 0 };
+        JobCounter jobCounter;
+        std::mutex mainThreadMutex;
+        std::vector<uint32_t> mainThreadReady;
+
+        GameSystemScheduler(const GameSystemScheduler&) = delete;
+        GameSystemScheduler& operator=(const GameSystemScheduler&) = delete;
+    };
+}
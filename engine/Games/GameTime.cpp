@@ -47,7 +47,35 @@ namespace alimer
         qpcSecondCounter = 0;
     }
 
-    void GameTime::Tick(const std::function<void()> update)
+    uint64_t GameTime::GetNextUpdateTimestamp() const
+    {
+        if (leftOverTicks >= targetElapsedTicks)
+        {
+            return qpcLastTime;
+        }
+
+        // Round up so the Tick at the returned time never falls a QPC unit short of the step.
+        const uint64_t remainingTicks = targetElapsedTicks - leftOverTicks;
+        return qpcLastTime + (remainingTicks * qpcFrequency + TicksPerSecond - 1) / TicksPerSecond;
+    }
+
+    void GameTime::CopyTimeFrom(const GameTime& source)
+    {
+        qpcFrequency = source.qpcFrequency;
+        qpcLastTime = source.qpcLastTime;
+        qpcMaxDelta = source.qpcMaxDelta;
+        elapsedTicks = source.elapsedTicks;
+        totalTicks = source.totalTicks;
+        leftOverTicks = source.leftOverTicks;
+        frameCount = source.frameCount;
+        framesPerSecond = source.framesPerSecond;
+        framesThisSecond = source.framesThisSecond;
+        qpcSecondCounter = source.qpcSecondCounter;
+        isFixedTimeStep = source.isFixedTimeStep;
+        targetElapsedTicks = source.targetElapsedTicks;
+    }
+
+    void GameTime::Tick(UpdateCallback update, void* userData)
     {
         // Query the current time.
         uint64_t currentTime = Stopwatch::GetTimestamp();
@@ -56,6 +84,9 @@ namespace alimer
         qpcLastTime = currentTime;
         qpcSecondCounter += timeDelta;
 
+        // The previous frame ends here, record it before clamping so stalls show up in the percentiles.
+        frameStats.EndFrame(timeDelta);
+
         // Clamp excessively large time deltas (e.g. after paused in the debugger).
         if (timeDelta > qpcMaxDelta)
         {
@@ -93,7 +124,7 @@ namespace alimer
                 leftOverTicks -= targetElapsedTicks;
                 frameCount++;
 
-                update();
+                update(userData);
             }
         }
         else
@@ -104,7 +135,7 @@ namespace alimer
             leftOverTicks = 0;
             frameCount++;
 
-            update();
+            update(userData);
         }
 
         // Track the current framerate.
@@ -22,8 +22,7 @@
 
 #pragma once
 
-#include "core/Preprocessor.h"
-#include <functional>
+#include "Games/FrameStats.h"
 
 namespace alimer
 {
@@ -36,7 +35,16 @@ namespace alimer
         GameTime();
          ~GameTime() = default;
 
-         void Tick(const std::function<void()> update);
+         using UpdateCallback = void(*)(void* userData);
+
+         /// Advance the timer, calling update once per elapsed step.
+         void Tick(UpdateCallback update, void* userData);
+
+         template <typename TUpdate>
+         void Tick(const TUpdate& update)
+         {
+             Tick([](void* userData) { (*static_cast<const TUpdate*>(userData))(); }, const_cast<TUpdate*>(&update));
+         }
 
          // Get elapsed time since the previous Update call.
          uint64_t GetElapsedTicks() const { return elapsedTicks; }
@@ -52,8 +60,13 @@ namespace alimer
          // Get the current framerate.
          uint32_t GetFramesPerSecond() const { return framesPerSecond; }
 
+         // Get the frame time history, percentiles and hitches.
+         FrameStats& GetFrameStats() { return frameStats; }
+         const FrameStats& GetFrameStats() const { return frameStats; }
+
          // Set whether to use fixed or variable timestep mode.
          void SetFixedTimeStep(bool isFixedTimestep) { isFixedTimeStep = isFixedTimestep; }
+         bool IsFixedTimeStep() const { return isFixedTimeStep; }
 
          // Set how often to call Update when in fixed timestep mode.
          void SetTargetElapsedTicks(uint64_t targetElapsed) { targetElapsedTicks = targetElapsed; }
@@ -61,6 +74,12 @@ namespace alimer
 
          void ResetElapsedTime();
 
+         /// Return the Stopwatch timestamp at which the next Tick runs a fixed timestep update.
+         uint64_t GetNextUpdateTimestamp() const;
+
+         /// Copy the time values of another GameTime but not its frame statistics, for snapshots handed to the render thread.
+         void CopyTimeFrom(const GameTime& source);
+
          // Integer format represents time using 10,000,000 ticks per second.
          static constexpr uint64_t TicksPerSecond = 10000000;
 
@@ -84,6 +103,9 @@ namespace alimer
         uint32_t framesThisSecond = 0;
         uint64_t qpcSecondCounter = 0;
 
+        // Frame time telemetry, records the unclamped time between ticks.
+        FrameStats frameStats;
+
         // Members for configuring fixed timestep mode.
         bool isFixedTimeStep = false;
         uint64_t targetElapsedTicks;
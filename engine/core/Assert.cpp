@@ -21,6 +21,9 @@
 //
 
 #include "core/Assert.h"
+#include "core/Log.h"
+#include "core/BinaryLog.h"
+#include <cstdarg>
 #include <cstdio>
 
 #if defined(_WIN64)
@@ -90,6 +93,10 @@ namespace alimer
             message = messageBuffer;
         }
 
+        // Get queued log messages out before a possible crash.
+        Log::Flush();
+        BinaryLog::Flush();
+
         return GetAssertHandlerInstance()(condition, message, file, line);
     }
 }
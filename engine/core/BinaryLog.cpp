@@ -0,0 +1,281 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "core/BinaryLog.h"
+#include "core/Assert.h"
+#include "core/Stopwatch.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace alimer
+{
+    std::atomic<bool> BinaryLog::s_open{ false };
+
+    namespace
+    {
+        using namespace BinaryLogFormat;
+
+        static constexpr uint32_t kThreadBufferSize = 64 * 1024;
+
+        struct ThreadBuffer;
+
+        /// A format registered by a call site, kept for the whole process.
+        struct RegisteredFormat
+        {
+            LogLevel level;
+            uint32_t line;
+            std::string file;
+            std::string format;
+        };
+
+        static struct {
+            std::mutex fileMutex;
+            FILE* file = nullptr;
+            /// Indexed by format id, guarded by fileMutex.
+            std::vector<RegisteredFormat> formats;
+            std::atomic<uint32_t> generation{ 0 };
+
+            std::mutex buffersMutex;
+            std::vector<ThreadBuffer*> buffers;
+        } s_binaryLog;
+
+        void WriteFile(const void* data, size_t size)
+        {
+            if (s_binaryLog.file != nullptr)
+            {
+                fwrite(data, 1, size, s_binaryLog.file);
+            }
+        }
+
+        /// Records of one thread waiting to be written, the owner fills it and any thread may write it out.
+        struct ThreadBuffer
+        {
+            std::unique_ptr<uint8_t[]> data;
+            uint32_t size = 0;
+            uint32_t generation = 0;
+            /// Held by the owner while it writes a record and by whoever writes the buffer to the file.
+            std::atomic<bool> locked{ false };
+
+            ~ThreadBuffer()
+            {
+                if (!data)
+                    return;
+
+                {
+                    std::lock_guard<std::mutex> lock(s_binaryLog.buffersMutex);
+                    auto& buffers = s_binaryLog.buffers;
+                    buffers.erase(std::remove(buffers.begin(), buffers.end(), this), buffers.end());
+                }
+
+                Lock();
+                WriteOut();
+                Unlock();
+            }
+
+            void Lock()
+            {
+                while (locked.exchange(true, std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            void Unlock()
+            {
+                locked.store(false, std::memory_order_release);
+            }
+
+            /// Write the records to the file and empty the buffer, the caller holds the lock.
+            void WriteOut()
+            {
+                if (size == 0)
+                    return;
+
+                // Records from a closed file are discarded.
+                if (generation == s_binaryLog.generation.load(std::memory_order_acquire))
+                {
+                    std::lock_guard<std::mutex> lock(s_binaryLog.fileMutex);
+                    WriteFile(data.get(), size);
+                }
+
+                size = 0;
+            }
+        };
+
+        static thread_local ThreadBuffer s_threadBuffer;
+
+        /// Write every thread buffer out, records being written meanwhile are waited for.
+        void WriteOutAllBuffers()
+        {
+            std::lock_guard<std::mutex> lock(s_binaryLog.buffersMutex);
+            for (ThreadBuffer* buffer : s_binaryLog.buffers)
+            {
+                buffer->Lock();
+                buffer->WriteOut();
+                buffer->Unlock();
+            }
+        }
+
+        /// Write a format definition, the caller holds fileMutex.
+        void WriteFormat(uint32_t formatId, const RegisteredFormat& format)
+        {
+            FormatRecord record = {};
+            record.formatId = formatId;
+            record.level = format.level;
+            record.line = format.line;
+            record.fileLength = static_cast<uint16_t>(format.file.size());
+            record.formatLength = static_cast<uint16_t>(format.format.size());
+
+            const RecordType type = RecordType::Format;
+            WriteFile(&type, sizeof(type));
+            WriteFile(&record, sizeof(record));
+            WriteFile(format.file.data(), record.fileLength);
+            WriteFile(format.format.data(), record.formatLength);
+        }
+    }
+
+    bool BinaryLog::Open(const char* fileName)
+    {
+        std::lock_guard<std::mutex> lock(s_binaryLog.fileMutex);
+        ALIMER_ASSERT(s_binaryLog.file == nullptr);
+
+        s_binaryLog.file = fopen(fileName, "wb");
+        if (s_binaryLog.file == nullptr)
+        {
+            ALIMER_LOGE("BinaryLog: Failed to open '%s'", fileName);
+            return false;
+        }
+
+        FileHeader header = {};
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.timestampFrequency = Stopwatch::GetFrequency();
+        WriteFile(&header, sizeof(header));
+
+        // Call sites register once per process, a file opened after the first one still needs their formats.
+        for (size_t i = 0; i < s_binaryLog.formats.size(); ++i)
+        {
+            WriteFormat(static_cast<uint32_t>(i), s_binaryLog.formats[i]);
+        }
+
+        s_binaryLog.generation.fetch_add(1, std::memory_order_release);
+        s_open.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void BinaryLog::Close()
+    {
+        if (!IsOpen())
+            return;
+
+        s_open.store(false, std::memory_order_release);
+        WriteOutAllBuffers();
+
+        std::lock_guard<std::mutex> lock(s_binaryLog.fileMutex);
+        fclose(s_binaryLog.file);
+        s_binaryLog.file = nullptr;
+        s_binaryLog.generation.fetch_add(1, std::memory_order_release);
+    }
+
+    uint32_t BinaryLog::RegisterFormat(LogLevel level, const char* format, const char* file, uint32_t line)
+    {
+        // Written straight to the file so it always precedes the messages using it.
+        std::lock_guard<std::mutex> lock(s_binaryLog.fileMutex);
+        const uint32_t formatId = static_cast<uint32_t>(s_binaryLog.formats.size());
+        s_binaryLog.formats.push_back({ level, line, file, format });
+        WriteFormat(formatId, s_binaryLog.formats.back());
+        return formatId;
+    }
+
+    uint8_t* BinaryLog::BeginMessage(uint32_t formatId, uint32_t argsSize)
+    {
+        const uint32_t size = sizeof(RecordType) + sizeof(MessageRecord) + argsSize;
+        ALIMER_ASSERT(size <= kThreadBufferSize);
+
+        ThreadBuffer& buffer = s_threadBuffer;
+        if (!buffer.data)
+        {
+            // First message from this thread, registering is the only step taking a shared lock.
+            buffer.data.reset(new uint8_t[kThreadBufferSize]);
+            std::lock_guard<std::mutex> lock(s_binaryLog.buffersMutex);
+            s_binaryLog.buffers.push_back(&buffer);
+        }
+
+        buffer.Lock();
+
+        const uint32_t generation = s_binaryLog.generation.load(std::memory_order_acquire);
+        if (buffer.generation != generation)
+        {
+            buffer.size = 0;
+            buffer.generation = generation;
+        }
+
+        if (buffer.size + size > kThreadBufferSize)
+        {
+            buffer.WriteOut();
+        }
+
+        uint8_t* data = buffer.data.get() + buffer.size;
+        buffer.size += size;
+
+        MessageRecord record;
+        record.formatId = formatId;
+        record.argsSize = argsSize;
+        record.timestamp = Stopwatch::GetTimestamp();
+
+        *data = static_cast<uint8_t>(RecordType::Message);
+        memcpy(data + sizeof(RecordType), &record, sizeof(record));
+        return data + sizeof(RecordType) + sizeof(record);
+    }
+
+    void BinaryLog::EndMessage()
+    {
+        s_threadBuffer.Unlock();
+    }
+
+    void BinaryLog::FlushThread()
+    {
+        ThreadBuffer& buffer = s_threadBuffer;
+        buffer.Lock();
+        buffer.WriteOut();
+        buffer.Unlock();
+    }
+
+    void BinaryLog::Flush()
+    {
+        if (!IsOpen())
+            return;
+
+        WriteOutAllBuffers();
+
+        std::lock_guard<std::mutex> lock(s_binaryLog.fileMutex);
+        if (s_binaryLog.file != nullptr)
+        {
+            fflush(s_binaryLog.file);
+        }
+    }
+}
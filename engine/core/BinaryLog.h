@@ -0,0 +1,241 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "core/Log.h"
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+namespace alimer
+{
+    /// Binary log file layout, shared with the offline decoder.
+    namespace BinaryLogFormat
+    {
+        static constexpr uint32_t kMagic = 0x4C424C41; // "ALBL"
+        static constexpr uint32_t kVersion = 1;
+
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            /// Stopwatch::GetFrequency of the recording machine.
+            uint64_t timestampFrequency;
+        };
+
+        enum class RecordType : uint8_t
+        {
+            /// Format definition, followed by the file name and format string.
+            Format,
+            /// Message, followed by argsSize bytes of encoded arguments.
+            Message
+        };
+
+        struct FormatRecord
+        {
+            uint32_t formatId;
+            LogLevel level;
+            uint32_t line;
+            uint16_t fileLength;
+            uint16_t formatLength;
+        };
+
+        struct MessageRecord
+        {
+            uint32_t formatId;
+            uint32_t argsSize;
+            uint64_t timestamp;
+        };
+
+        /// Type tag written before every argument value.
+        enum class ArgType : uint8_t
+        {
+            Int32,
+            UInt32,
+            Int64,
+            UInt64,
+            Double,
+            Pointer,
+            /// uint16_t length followed by the characters.
+            String
+        };
+    }
+
+    /// Log sink storing messages as format id, timestamp and raw argument bytes.
+    /// Formatting happens offline with the decoder tool, see tools/LogDecoder.
+    class ALIMER_API BinaryLog final
+    {
+    public:
+        /// Maximum bytes of a string argument, longer strings are truncated.
+        static constexpr uint32_t kMaxStringArg = 1024;
+
+        /// Start writing binary records to the given file.
+        static bool Open(const char* fileName);
+
+        /// Write the pending records of every thread and close the file.
+        static void Close();
+
+        static bool IsOpen() { return s_open.load(std::memory_order_relaxed); }
+
+        /// Register a call site format string, done once per call site by ALIMER_LOG_BINARY.
+        /// Ids stay valid for the whole process, every registered format is written again to a newly opened file.
+        static uint32_t RegisterFormat(LogLevel level, const char* format, const char* file, uint32_t line);
+
+        /// Record a message for a registered format.
+        template <typename... Args>
+        static void Write(uint32_t formatId, Args... args)
+        {
+            const uint32_t argsSize = ArgsSize(args...);
+            uint8_t* data = BeginMessage(formatId, argsSize);
+            EncodeArgs(data, args...);
+            EndMessage();
+        }
+
+        /// Write the calling thread buffer to the file.
+        static void FlushThread();
+
+        /// Write the buffers of every thread and flush the file, used for errors and asserts.
+        static void Flush();
+
+    private:
+        static uint8_t* BeginMessage(uint32_t formatId, uint32_t argsSize);
+        static void EndMessage();
+
+        using ArgType = BinaryLogFormat::ArgType;
+
+        template <typename T>
+        using EncodedType = typename std::conditional<std::is_enum<T>::value, std::underlying_type<T>, std::decay<T>>::type::type;
+
+        template <typename T>
+        static constexpr ArgType GetArgType()
+        {
+            using U = EncodedType<T>;
+            return std::is_floating_point<U>::value ? ArgType::Double
+                : std::is_pointer<U>::value ? ArgType::Pointer
+                : sizeof(U) <= 4 ? (std::is_signed<U>::value ? ArgType::Int32 : ArgType::UInt32)
+                : (std::is_signed<U>::value ? ArgType::Int64 : ArgType::UInt64);
+        }
+
+        static constexpr uint32_t GetArgSize(ArgType type)
+        {
+            return type == ArgType::Int32 || type == ArgType::UInt32 ? 4 : 8;
+        }
+
+        static uint32_t ArgSize(const char* value)
+        {
+            const size_t length = value != nullptr ? strlen(value) : 0;
+            return 1 + 2 + static_cast<uint32_t>(length < kMaxStringArg ? length : kMaxStringArg);
+        }
+
+        static uint32_t ArgSize(char* value) { return ArgSize(static_cast<const char*>(value)); }
+
+        template <typename T>
+        static uint32_t ArgSize(T)
+        {
+            return 1 + GetArgSize(GetArgType<T>());
+        }
+
+        static uint32_t ArgsSize() { return 0; }
+
+        template <typename T, typename... Args>
+        static uint32_t ArgsSize(T value, Args... args)
+        {
+            return ArgSize(value) + ArgsSize(args...);
+        }
+
+        static uint8_t* EncodeArg(uint8_t* data, const char* value)
+        {
+            const size_t length = value != nullptr ? strlen(value) : 0;
+            const uint16_t stored = static_cast<uint16_t>(length < kMaxStringArg ? length : kMaxStringArg);
+            *data++ = static_cast<uint8_t>(ArgType::String);
+            memcpy(data, &stored, sizeof(stored));
+            memcpy(data + sizeof(stored), value, stored);
+            return data + sizeof(stored) + stored;
+        }
+
+        static uint8_t* EncodeArg(uint8_t* data, char* value) { return EncodeArg(data, static_cast<const char*>(value)); }
+
+        template <typename T>
+        static uint8_t* EncodeArg(uint8_t* data, T value)
+        {
+            constexpr ArgType type = GetArgType<T>();
+            *data++ = static_cast<uint8_t>(type);
+            EncodeValue(data, static_cast<EncodedType<T>>(value));
+            return data + GetArgSize(type);
+        }
+
+        /// Values are widened to the stored type so the decoder can pass them straight to printf.
+        static void EncodeValue(uint8_t* data, double value) { memcpy(data, &value, 8); }
+        static void EncodeValue(uint8_t* data, float value) { EncodeValue(data, static_cast<double>(value)); }
+        static void EncodeValue(uint8_t* data, long double value) { EncodeValue(data, static_cast<double>(value)); }
+
+        template <typename U>
+        static typename std::enable_if<std::is_pointer<U>::value>::type EncodeValue(uint8_t* data, U value)
+        {
+            const uint64_t stored = reinterpret_cast<uintptr_t>(value);
+            memcpy(data, &stored, 8);
+        }
+
+        template <typename U>
+        static typename std::enable_if<std::is_integral<U>::value>::type EncodeValue(uint8_t* data, U value)
+        {
+            using Stored = typename std::conditional<sizeof(U) <= 4,
+                typename std::conditional<std::is_signed<U>::value, int32_t, uint32_t>::type,
+                typename std::conditional<std::is_signed<U>::value, int64_t, uint64_t>::type>::type;
+            const Stored stored = static_cast<Stored>(value);
+            memcpy(data, &stored, sizeof(Stored));
+        }
+
+        static void EncodeArgs(uint8_t*) {}
+
+        template <typename T, typename... Args>
+        static void EncodeArgs(uint8_t* data, T value, Args... args)
+        {
+            EncodeArgs(EncodeArg(data, value), args...);
+        }
+
+        static std::atomic<bool> s_open;
+    };
+}
+
+/// Log through the binary sink when it is open, otherwise format right away like ALIMER_LOGD and friends.
+#define ALIMER_LOG_BINARY(level, format, ...) \
+    do \
+    { \
+        if (alimer::Log::GetDefault()->IsLevelEnabled(level)) \
+        { \
+            if (alimer::BinaryLog::IsOpen()) \
+            { \
+                static const uint32_t s_formatId = alimer::BinaryLog::RegisterFormat(level, format, __FILE__, __LINE__); \
+                alimer::BinaryLog::Write(s_formatId, ##__VA_ARGS__); \
+                if (level >= alimer::LogLevel::Error) \
+                { \
+                    alimer::BinaryLog::Flush(); \
+                } \
+            } \
+            else \
+            { \
+                alimer::Log::GetDefault()->LogFormat(level, format, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
@@ -0,0 +1,533 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "core/Assert.h"
+#include "core/StringId.h"
+#include "math/simd.h"
+#include <cstring>
+#include <functional>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace alimer
+{
+    /// Hash functor for FlatHashMap and FlatHashSet. Generic keys go through std::hash and a multiplicative mix,
+    /// std::hash of integers is the identity on the common standard libraries.
+    template <typename Key>
+    struct FlatHash
+    {
+        uint64_t operator()(const Key& key) const
+        {
+            const uint64_t hash = uint64_t(std::hash<Key>()(key)) * 0x9E3779B97F4A7C15ull;
+            return hash ^ (hash >> 32);
+        }
+    };
+
+    /// StringId values are hashes already, lookups use them as is.
+    template <>
+    struct FlatHash<StringId32>
+    {
+        uint64_t operator()(StringId32 key) const { return key.Value(); }
+    };
+
+    template <>
+    struct FlatHash<StringId64>
+    {
+        uint64_t operator()(StringId64 key) const { return key.Value(); }
+    };
+
+    /// Control bytes of a flat hash table: the low 7 bits of the hash for full slots, negative for free ones.
+    namespace FlatHashControl
+    {
+        static constexpr int8_t kEmpty = -128;
+        static constexpr int8_t kDeleted = -2;
+        /// Control bytes compared at once.
+        static constexpr uint32_t kGroupWidth = 16;
+
+        ALIMER_FORCE_INLINE uint32_t CountTrailingZeros(uint64_t value)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward64(&index, value);
+            return uint32_t(index);
+#else
+            return uint32_t(__builtin_ctzll(value));
+#endif
+        }
+
+        /// Matching slots of a group, Shift is log2 of the bits per slot of the backend.
+        template <uint32_t Shift>
+        class BitMask
+        {
+        public:
+            explicit BitMask(uint64_t mask_)
+                : mask(mask_)
+            {
+            }
+
+            explicit operator bool() const { return mask != 0; }
+            uint32_t LowestIndex() const { return CountTrailingZeros(mask) >> Shift; }
+            void ClearLowest() { mask &= mask - 1; }
+
+        private:
+            uint64_t mask;
+        };
+
+#if defined(ALIMER_SIMD_SSE2)
+        /// 16 control bytes compared with one SSE2 instruction each.
+        class Group
+        {
+        public:
+            using Mask = BitMask<0>;
+
+            explicit Group(const int8_t* control)
+                : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(control)))
+            {
+            }
+
+            Mask Match(int8_t hash) const { return Mask(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(hash), bytes)))); }
+            Mask MatchEmpty() const { return Match(kEmpty); }
+            Mask MatchFree() const { return Mask(uint32_t(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), bytes)))); }
+
+        private:
+            __m128i bytes;
+        };
+#elif defined(ALIMER_SIMD_NEON)
+        /// 16 control bytes compared with NEON, masks are narrowed to 4 bits per slot.
+        class Group
+        {
+        public:
+            using Mask = BitMask<2>;
+
+            explicit Group(const int8_t* control)
+                : bytes(vld1q_s8(control))
+            {
+            }
+
+            Mask Match(int8_t hash) const { return Narrow(vceqq_s8(bytes, vdupq_n_s8(hash))); }
+            Mask MatchEmpty() const { return Match(kEmpty); }
+            Mask MatchFree() const { return Narrow(vcltq_s8(bytes, vdupq_n_s8(-1))); }
+
+        private:
+            static Mask Narrow(uint8x16_t matches)
+            {
+                const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(matches), 4);
+                return Mask(vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ull);
+            }
+
+            int8x16_t bytes;
+        };
+#else
+        class Group
+        {
+        public:
+            using Mask = BitMask<0>;
+
+            explicit Group(const int8_t* control_)
+                : control(control_)
+            {
+            }
+
+            Mask Match(int8_t hash) const
+            {
+                uint32_t mask = 0;
+                for (uint32_t i = 0; i < kGroupWidth; ++i)
+                {
+                    mask |= uint32_t(control[i] == hash) << i;
+                }
+                return Mask(mask);
+            }
+
+            Mask MatchEmpty() const { return Match(kEmpty); }
+
+            Mask MatchFree() const
+            {
+                uint32_t mask = 0;
+                for (uint32_t i = 0; i < kGroupWidth; ++i)
+                {
+                    mask |= uint32_t(control[i] < -1) << i;
+                }
+                return Mask(mask);
+            }
+
+        private:
+            const int8_t* control;
+        };
+#endif
+    }
+
+    /// Open addressing hash table storing slots inline, probed a group of control bytes at a time.
+    /// Capacity is a power of two of at least one group and the load factor stays below 7/8. The control bytes
+    /// of the first group are cloned past the end so any group load stays in bounds. Pointers to slots are
+    /// invalidated by inserts that grow the table. Base of FlatHashMap and FlatHashSet.
+    template <typename Key, typename Slot, typename Hash, typename GetKey>
+    class FlatHashTable
+    {
+    public:
+        template <typename SlotType>
+        class Iterator
+        {
+        public:
+            Iterator(const int8_t* control_, SlotType* slot_, SlotType* end_)
+                : control(control_)
+                , slot(slot_)
+                , end(end_)
+            {
+                SkipFree();
+            }
+
+            SlotType& operator*() const { return *slot; }
+            SlotType* operator->() const { return slot; }
+            bool operator==(const Iterator& rhs) const { return slot == rhs.slot; }
+            bool operator!=(const Iterator& rhs) const { return slot != rhs.slot; }
+
+            Iterator& operator++()
+            {
+                ++control;
+                ++slot;
+                SkipFree();
+                return *this;
+            }
+
+        private:
+            void SkipFree()
+            {
+                while (slot != end && *control < 0)
+                {
+                    ++control;
+                    ++slot;
+                }
+            }
+
+            const int8_t* control;
+            SlotType* slot;
+            SlotType* end;
+        };
+
+        using iterator = Iterator<Slot>;
+        using const_iterator = Iterator<const Slot>;
+
+        FlatHashTable() = default;
+
+        FlatHashTable(const FlatHashTable& other)
+        {
+            Reserve(other.size);
+            for (const Slot& slot : other)
+            {
+                const uint32_t index = PrepareInsert(hasher(GetKey()(slot)));
+                new (slots + index) Slot(slot);
+            }
+        }
+
+        FlatHashTable(FlatHashTable&& other) noexcept
+        {
+            Swap(other);
+        }
+
+        ~FlatHashTable()
+        {
+            Destroy();
+        }
+
+        FlatHashTable& operator=(FlatHashTable other) noexcept
+        {
+            Swap(other);
+            return *this;
+        }
+
+        void Swap(FlatHashTable& other) noexcept
+        {
+            std::swap(control, other.control);
+            std::swap(slots, other.slots);
+            std::swap(capacity, other.capacity);
+            std::swap(size, other.size);
+            std::swap(growthLeft, other.growthLeft);
+        }
+
+        uint32_t Size() const { return size; }
+        bool Empty() const { return size == 0; }
+        uint32_t Capacity() const { return capacity; }
+
+        iterator begin() { return iterator(control, slots, slots + capacity); }
+        iterator end() { return iterator(nullptr, slots + capacity, slots + capacity); }
+        const_iterator begin() const { return const_iterator(control, slots, slots + capacity); }
+        const_iterator end() const { return const_iterator(nullptr, slots + capacity, slots + capacity); }
+
+        /// Grow so count elements fit without rehashing.
+        void Reserve(uint32_t count)
+        {
+            uint32_t newCapacity = FlatHashControl::kGroupWidth;
+            while (newCapacity - newCapacity / 8 < count)
+            {
+                newCapacity *= 2;
+            }
+
+            if (newCapacity > capacity)
+                Rehash(newCapacity);
+        }
+
+        /// Destroy every element, keeping the storage.
+        void Clear()
+        {
+            for (uint32_t i = 0; i < capacity; ++i)
+            {
+                if (control[i] >= 0)
+                    slots[i].~Slot();
+            }
+
+            if (capacity != 0)
+            {
+                memset(control, FlatHashControl::kEmpty, capacity + FlatHashControl::kGroupWidth);
+                size = 0;
+                growthLeft = capacity - capacity / 8;
+            }
+        }
+
+        bool Contains(const Key& key) const { return FindSlot(key) != nullptr; }
+
+        /// Remove the element with the given key, returns false if there was none.
+        bool Erase(const Key& key)
+        {
+            Slot* slot = FindSlot(key);
+            if (slot == nullptr)
+                return false;
+
+            // Tombstones keep the probe chains of later elements intact, the next rehash drops them.
+            slot->~Slot();
+            SetControl(uint32_t(slot - slots), FlatHashControl::kDeleted);
+            --size;
+            return true;
+        }
+
+    protected:
+        Slot* FindSlot(const Key& key) const
+        {
+            if (size == 0)
+                return nullptr;
+
+            const uint64_t hash = hasher(key);
+            const int8_t tag = int8_t(hash & 0x7F);
+            const uint32_t mask = capacity - 1;
+            uint32_t position = uint32_t(hash >> 7) & mask;
+            uint32_t stride = 0;
+            for (;;)
+            {
+                const FlatHashControl::Group group(control + position);
+                for (auto match = group.Match(tag); match; match.ClearLowest())
+                {
+                    const uint32_t index = (position + match.LowestIndex()) & mask;
+                    if (GetKey()(slots[index]) == key)
+                        return slots + index;
+                }
+
+                if (group.MatchEmpty())
+                    return nullptr;
+
+                stride += FlatHashControl::kGroupWidth;
+                position = (position + stride) & mask;
+            }
+        }
+
+        /// Claim a free slot for a key known to be absent, growing first if needed. The caller constructs the slot.
+        uint32_t PrepareInsert(uint64_t hash)
+        {
+            if (capacity == 0)
+                Rehash(FlatHashControl::kGroupWidth);
+
+            uint32_t index = FindFree(hash);
+            if (growthLeft == 0 && control[index] != FlatHashControl::kDeleted)
+            {
+                // Grow when at least half of the load is live, otherwise reclaim the tombstones in place.
+                Rehash(uint64_t(size) * 16 >= uint64_t(capacity) * 7 ? capacity * 2 : capacity);
+                index = FindFree(hash);
+            }
+
+            if (control[index] == FlatHashControl::kEmpty)
+                --growthLeft;
+
+            ++size;
+            SetControl(index, int8_t(hash & 0x7F));
+            return index;
+        }
+
+        int8_t* control = nullptr;
+        Slot* slots = nullptr;
+        uint32_t capacity = 0;
+        uint32_t size = 0;
+        uint32_t growthLeft = 0;
+        Hash hasher;
+
+    private:
+        uint32_t FindFree(uint64_t hash) const
+        {
+            const uint32_t mask = capacity - 1;
+            uint32_t position = uint32_t(hash >> 7) & mask;
+            uint32_t stride = 0;
+            for (;;)
+            {
+                const auto match = FlatHashControl::Group(control + position).MatchFree();
+                if (match)
+                    return (position + match.LowestIndex()) & mask;
+
+                stride += FlatHashControl::kGroupWidth;
+                position = (position + stride) & mask;
+            }
+        }
+
+        void SetControl(uint32_t index, int8_t value)
+        {
+            control[index] = value;
+            if (index < FlatHashControl::kGroupWidth)
+                control[capacity + index] = value;
+        }
+
+        void Rehash(uint32_t newCapacity)
+        {
+            ALIMER_ASSERT((newCapacity & (newCapacity - 1)) == 0 && newCapacity >= size);
+
+            int8_t* oldControl = control;
+            Slot* oldSlots = slots;
+            const uint32_t oldCapacity = capacity;
+
+            control = new int8_t[newCapacity + FlatHashControl::kGroupWidth];
+            slots = static_cast<Slot*>(::operator new(sizeof(Slot) * newCapacity));
+            capacity = newCapacity;
+            growthLeft = newCapacity - newCapacity / 8 - size;
+            memset(control, FlatHashControl::kEmpty, newCapacity + FlatHashControl::kGroupWidth);
+
+            for (uint32_t i = 0; i < oldCapacity; ++i)
+            {
+                if (oldControl[i] < 0)
+                    continue;
+
+                const uint64_t hash = hasher(GetKey()(oldSlots[i]));
+                const uint32_t index = FindFree(hash);
+                SetControl(index, int8_t(hash & 0x7F));
+                new (slots + index) Slot(std::move(oldSlots[i]));
+                oldSlots[i].~Slot();
+            }
+
+            if (oldCapacity != 0)
+            {
+                delete[] oldControl;
+                ::operator delete(oldSlots);
+            }
+        }
+
+        void Destroy()
+        {
+            if (capacity == 0)
+                return;
+
+            Clear();
+            delete[] control;
+            ::operator delete(slots);
+            control = nullptr;
+            slots = nullptr;
+            capacity = 0;
+            growthLeft = 0;
+        }
+    };
+
+    template <typename Key, typename Value>
+    struct FlatHashMapKey
+    {
+        const Key& operator()(const std::pair<const Key, Value>& slot) const { return slot.first; }
+    };
+
+    template <typename Key>
+    struct FlatHashSetKey
+    {
+        const Key& operator()(const Key& slot) const { return slot; }
+    };
+
+    /// Flat hash map, see FlatHashTable. Keyed by StringId32 or StringId64 the id value is the hash.
+    template <typename Key, typename Value, typename Hash = FlatHash<Key>>
+    class FlatHashMap : public FlatHashTable<Key, std::pair<const Key, Value>, Hash, FlatHashMapKey<Key, Value>>
+    {
+    public:
+        using SlotType = std::pair<const Key, Value>;
+
+        /// Return the value for key or nullptr.
+        Value* Find(const Key& key)
+        {
+            SlotType* slot = this->FindSlot(key);
+            return slot != nullptr ? &slot->second : nullptr;
+        }
+
+        const Value* Find(const Key& key) const
+        {
+            const SlotType* slot = this->FindSlot(key);
+            return slot != nullptr ? &slot->second : nullptr;
+        }
+
+        /// Insert the value if the key is absent. Returns the stored value and whether it was inserted.
+        template <typename... Args>
+        std::pair<Value*, bool> Emplace(const Key& key, Args&&... args)
+        {
+            if (SlotType* slot = this->FindSlot(key))
+                return { &slot->second, false };
+
+            const uint32_t index = this->PrepareInsert(this->hasher(key));
+            SlotType* slot = this->slots + index;
+            new (slot) SlotType(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+            return { &slot->second, true };
+        }
+
+        std::pair<Value*, bool> Insert(const Key& key, const Value& value) { return Emplace(key, value); }
+
+        /// Insert or overwrite the value for key.
+        Value& Set(const Key& key, Value value)
+        {
+            auto result = Emplace(key);
+            *result.first = std::move(value);
+            return *result.first;
+        }
+
+        /// Return the value for key, default constructing it if absent.
+        Value& operator[](const Key& key) { return *Emplace(key).first; }
+    };
+
+    /// Flat hash set, see FlatHashTable.
+    template <typename Key, typename Hash = FlatHash<Key>>
+    class FlatHashSet : public FlatHashTable<Key, Key, Hash, FlatHashSetKey<Key>>
+    {
+    public:
+        /// Insert the key, returns false if it was present already.
+        bool Insert(const Key& key)
+        {
+            if (this->FindSlot(key) != nullptr)
+                return false;
+
+            const uint32_t index = this->PrepareInsert(this->hasher(key));
+            new (this->slots + index) Key(key);
+            return true;
+        }
+    };
+}
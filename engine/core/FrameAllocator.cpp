@@ -0,0 +1,233 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "core/FrameAllocator.h"
+#include "core/Assert.h"
+#include "core/Log.h"
+#include <atomic>
+#include <cstdlib>
+
+namespace alimer
+{
+    namespace
+    {
+        /// Heap allocation made when a frame buffer runs out of space.
+        struct OverflowBlock
+        {
+            OverflowBlock* next;
+            size_t size;
+        };
+
+        struct FrameBuffer
+        {
+            uint8_t* memory = nullptr;
+            size_t capacity = 0;
+            std::atomic<size_t> offset{ 0 };
+            std::atomic<size_t> overflowSize{ 0 };
+            std::atomic<OverflowBlock*> overflow{ nullptr };
+        };
+
+        struct ThreadArena
+        {
+            uint8_t* current = nullptr;
+            uint8_t* end = nullptr;
+            uint64_t frame = 0;
+        };
+
+        static struct {
+            FrameBuffer buffers[FrameAllocator::kMaxBufferCount];
+            uint32_t bufferCount = 0;
+            std::atomic<uint64_t> frame{ 1 };
+            size_t peak = 0;
+        } s_frame;
+
+        static thread_local ThreadArena s_threadArena;
+
+        inline FrameBuffer& GetCurrentBuffer(uint64_t frame)
+        {
+            return s_frame.buffers[frame % s_frame.bufferCount];
+        }
+
+        void* AllocateOverflow(FrameBuffer& buffer, size_t size, size_t alignment)
+        {
+            // malloc only guarantees alignof(max_align_t), over allocate so the payload can be aligned in place.
+            OverflowBlock* block = static_cast<OverflowBlock*>(malloc(sizeof(OverflowBlock) + alignment - 1 + size));
+            ALIMER_ASSERT(block);
+            block->size = size;
+            block->next = buffer.overflow.load(std::memory_order_relaxed);
+            while (!buffer.overflow.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+
+            buffer.overflowSize.fetch_add(size, std::memory_order_relaxed);
+            const uintptr_t payload = reinterpret_cast<uintptr_t>(block + 1);
+            return reinterpret_cast<void*>(AlignTo<uintptr_t>(payload, alignment));
+        }
+
+        void* AllocateShared(FrameBuffer& buffer, size_t size, size_t alignment)
+        {
+            // Over allocate by the alignment so any returned offset can be aligned in place.
+            const size_t offset = buffer.offset.fetch_add(size + alignment - 1, std::memory_order_relaxed);
+            if (offset + size + alignment - 1 > buffer.capacity)
+            {
+                return AllocateOverflow(buffer, size, alignment);
+            }
+
+            const uintptr_t address = reinterpret_cast<uintptr_t>(buffer.memory + offset);
+            return reinterpret_cast<void*>(AlignTo<uintptr_t>(address, alignment));
+        }
+    }
+
+    void FrameAllocator::Initialize(size_t size, uint32_t bufferCount)
+    {
+        ALIMER_ASSERT(!IsInitialized());
+        ALIMER_ASSERT(bufferCount > 0 && bufferCount <= kMaxBufferCount);
+
+        s_frame.bufferCount = bufferCount;
+        for (uint32_t i = 0; i < bufferCount; ++i)
+        {
+            s_frame.buffers[i].memory = static_cast<uint8_t*>(malloc(size));
+            s_frame.buffers[i].capacity = size;
+        }
+    }
+
+    void FrameAllocator::Shutdown()
+    {
+        if (!IsInitialized())
+            return;
+
+        for (uint32_t i = 0; i < s_frame.bufferCount; ++i)
+        {
+            FrameBuffer& buffer = s_frame.buffers[i];
+            OverflowBlock* block = buffer.overflow.exchange(nullptr);
+            while (block != nullptr)
+            {
+                OverflowBlock* next = block->next;
+                free(block);
+                block = next;
+            }
+
+            free(buffer.memory);
+            buffer.memory = nullptr;
+            buffer.capacity = 0;
+            buffer.offset = 0;
+            buffer.overflowSize = 0;
+        }
+
+        s_frame.bufferCount = 0;
+        s_frame.peak = 0;
+        s_frame.frame++;
+    }
+
+    bool FrameAllocator::IsInitialized()
+    {
+        return s_frame.bufferCount > 0;
+    }
+
+    void FrameAllocator::NextFrame()
+    {
+        ALIMER_ASSERT(IsInitialized());
+
+        const uint64_t frame = s_frame.frame.load(std::memory_order_relaxed) + 1;
+        FrameBuffer& buffer = GetCurrentBuffer(frame);
+
+        const size_t used = buffer.offset.load(std::memory_order_relaxed);
+        if (used > s_frame.peak)
+        {
+            s_frame.peak = used;
+        }
+
+        OverflowBlock* block = buffer.overflow.exchange(nullptr, std::memory_order_acquire);
+        while (block != nullptr)
+        {
+            OverflowBlock* next = block->next;
+            free(block);
+            block = next;
+        }
+
+        // Grow the buffer to the peak usage so the following frames don't touch the heap.
+        const size_t overflowSize = buffer.overflowSize.exchange(0, std::memory_order_relaxed);
+        if (overflowSize > 0)
+        {
+            const size_t newCapacity = AlignTo<size_t>(used + used / 2, kThreadChunkSize);
+            ALIMER_LOGD("FrameAllocator: buffer overflow of %zu bytes, growing from %zu to %zu bytes", overflowSize, buffer.capacity, newCapacity);
+
+            free(buffer.memory);
+            buffer.memory = static_cast<uint8_t*>(malloc(newCapacity));
+            buffer.capacity = newCapacity;
+        }
+
+        buffer.offset.store(0, std::memory_order_relaxed);
+        s_frame.frame.store(frame, std::memory_order_release);
+    }
+
+    void* FrameAllocator::Allocate(size_t size, size_t alignment)
+    {
+        ALIMER_ASSERT(IsInitialized());
+        ALIMER_ASSERT((alignment & (alignment - 1)) == 0);
+
+        const uint64_t frame = s_frame.frame.load(std::memory_order_acquire);
+        ThreadArena& arena = s_threadArena;
+        if (arena.frame != frame)
+        {
+            // The chunk belongs to a previous frame.
+            arena.current = nullptr;
+            arena.end = nullptr;
+            arena.frame = frame;
+        }
+
+        uint8_t* result = reinterpret_cast<uint8_t*>(AlignTo<uintptr_t>(reinterpret_cast<uintptr_t>(arena.current), alignment));
+        if (arena.current != nullptr && result + size <= arena.end)
+        {
+            arena.current = result + size;
+            return result;
+        }
+
+        FrameBuffer& buffer = GetCurrentBuffer(frame);
+
+        // Big or very aligned allocations would waste most of a chunk, take them from the shared buffer directly.
+        if (size > kThreadChunkSize / 4 || alignment > kThreadChunkSize / 4)
+        {
+            return AllocateShared(buffer, size, alignment);
+        }
+
+        uint8_t* chunk = static_cast<uint8_t*>(AllocateShared(buffer, kThreadChunkSize, 64));
+        result = reinterpret_cast<uint8_t*>(AlignTo<uintptr_t>(reinterpret_cast<uintptr_t>(chunk), alignment));
+        arena.current = result + size;
+        arena.end = chunk + kThreadChunkSize;
+        return result;
+    }
+
+    FrameAllocator::Stats FrameAllocator::GetStats()
+    {
+        Stats stats = {};
+        if (!IsInitialized())
+            return stats;
+
+        const FrameBuffer& buffer = GetCurrentBuffer(s_frame.frame.load(std::memory_order_acquire));
+        stats.capacity = buffer.capacity;
+        stats.used = buffer.offset.load(std::memory_order_relaxed);
+        stats.peak = s_frame.peak > stats.used ? s_frame.peak : stats.used;
+        stats.overflow = buffer.overflowSize.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
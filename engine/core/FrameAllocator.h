@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "core/Utils.h"
+#include <cstddef>
+#include <vector>
+
+namespace alimer
+{
+    /// Multi-buffered linear allocator for memory that lives until the same buffer is reused.
+    /// Memory allocated during a frame stays valid while the next bufferCount - 1 frames run.
+    /// Each thread bumps a pointer in its own chunk so jobs can allocate without locks.
+    class ALIMER_API FrameAllocator final
+    {
+    public:
+        /// Maximum number of frame buffers.
+        static constexpr uint32_t kMaxBufferCount = 4;
+        /// Size of the chunk a thread takes from the shared buffer at a time.
+        static constexpr size_t kThreadChunkSize = 64 * 1024;
+
+        struct Stats
+        {
+            size_t capacity;
+            size_t used;
+            size_t peak;
+            size_t overflow;
+        };
+
+        /// Allocate the frame buffers, size is per buffer.
+        static void Initialize(size_t size, uint32_t bufferCount = 3);
+
+        /// Release all the frame buffers.
+        static void Shutdown();
+
+        /// Return true if the allocator is initialized.
+        static bool IsInitialized();
+
+        /// Move to the next buffer and reset it, no allocation may be in flight while called.
+        static void NextFrame();
+
+        /// Allocate uninitialized memory, falls back to the heap if the buffer is full.
+        static void* Allocate(size_t size, size_t alignment = 16);
+
+        /// Allocate uninitialized storage for count objects of type T.
+        template <typename T>
+        static T* Allocate(size_t count)
+        {
+            return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        /// Return usage statistics of the current frame buffer.
+        static Stats GetStats();
+    };
+
+    /// STL allocator adapter for FrameAllocator, deallocation is a no-op.
+    template <typename T>
+    class FrameStlAllocator
+    {
+    public:
+        using value_type = T;
+
+        FrameStlAllocator() noexcept = default;
+
+        template <typename U>
+        FrameStlAllocator(const FrameStlAllocator<U>&) noexcept {}
+
+        T* allocate(size_t count)
+        {
+            return FrameAllocator::Allocate<T>(count);
+        }
+
+        void deallocate(T*, size_t) noexcept
+        {
+        }
+
+        template <typename U>
+        bool operator==(const FrameStlAllocator<U>&) const noexcept { return true; }
+
+        template <typename U>
+        bool operator!=(const FrameStlAllocator<U>&) const noexcept { return false; }
+    };
+
+    template <typename T>
+    using FrameVector = std::vector<T, FrameStlAllocator<T>>;
+}
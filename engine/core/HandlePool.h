@@ -0,0 +1,293 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "core/Assert.h"
+#include "core/JobSystem.h"
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace alimer
+{
+    /// Generational handle to an object of type T stored in a HandlePool.
+    template <typename T>
+    struct Handle
+    {
+        static constexpr uint32_t kIndexBits = 24;
+        static constexpr uint32_t kShardBits = 8;
+        static constexpr uint32_t kMaxIndex = (1u << kIndexBits) - 1;
+        static constexpr uint32_t kMaxShards = 1u << kShardBits;
+
+        /// Packed index (low 24 bits), shard (next 8 bits) and generation (high 32 bits), zero is invalid.
+        uint64_t value = 0;
+
+        Handle() = default;
+        Handle(uint32_t index, uint32_t shard, uint32_t generation)
+            : value(uint64_t(index) | (uint64_t(shard) << kIndexBits) | (uint64_t(generation) << 32))
+        {
+        }
+
+        uint32_t GetIndex() const { return static_cast<uint32_t>(value) & kMaxIndex; }
+        uint32_t GetShard() const { return static_cast<uint32_t>(value >> kIndexBits) & (kMaxShards - 1); }
+        uint32_t GetGeneration() const { return static_cast<uint32_t>(value >> 32); }
+        bool IsNull() const { return value == 0; }
+
+        bool operator==(const Handle& rhs) const { return value == rhs.value; }
+        bool operator!=(const Handle& rhs) const { return value != rhs.value; }
+    };
+
+    /// Pool handing out generational handles to densely packed SoA columns, one std::vector per column type.
+    /// Allocate and Free are O(1), Free moves the last element into the hole so the columns stay dense.
+    /// The pool is not thread safe, see ConcurrentHandlePool.
+    template <typename T, typename... Columns>
+    class HandlePool final
+    {
+    public:
+        using HandleType = Handle<T>;
+        static constexpr uint32_t kInvalidIndex = ~0u;
+
+        /// New slots start at firstGeneration, starting close to the 32-bit limit exercises the wrap.
+        explicit HandlePool(uint32_t shard_ = 0, uint32_t firstGeneration_ = 1)
+            : shard(shard_)
+            , firstGeneration(firstGeneration_ != 0 ? firstGeneration_ : 1)
+        {
+        }
+
+        void Reserve(uint32_t capacity)
+        {
+            slots.reserve(capacity);
+            denseToSlot.reserve(capacity);
+            ForEachColumn([capacity](auto& column) { column.reserve(capacity); });
+        }
+
+        HandleType Allocate(Columns... values)
+        {
+            uint32_t index;
+            if (freeHead != kInvalidIndex)
+            {
+                index = freeHead;
+                freeHead = slots[index].denseIndex;
+            }
+            else
+            {
+                index = static_cast<uint32_t>(slots.size());
+                ALIMER_ASSERT(index <= HandleType::kMaxIndex);
+                slots.push_back({ firstGeneration, 0u });
+            }
+
+            slots[index].denseIndex = static_cast<uint32_t>(denseToSlot.size());
+            denseToSlot.push_back(index);
+            PushColumns(std::index_sequence_for<Columns...>{}, std::move(values)...);
+            return HandleType(index, shard, slots[index].generation);
+        }
+
+        /// Free the handle, returns false if the handle is stale or invalid.
+        bool Free(HandleType handle)
+        {
+            if (!IsValid(handle))
+                return false;
+
+            const uint32_t index = handle.GetIndex();
+            const uint32_t dense = slots[index].denseIndex;
+            const uint32_t last = static_cast<uint32_t>(denseToSlot.size()) - 1;
+            if (dense != last)
+            {
+                ForEachColumn([dense, last](auto& column) { column[dense] = std::move(column[last]); });
+                denseToSlot[dense] = denseToSlot[last];
+                slots[denseToSlot[dense]].denseIndex = dense;
+            }
+
+            ForEachColumn([](auto& column) { column.pop_back(); });
+            denseToSlot.pop_back();
+
+            // Bump the generation so outstanding handles become stale, zero stays reserved for null handles.
+            Slot& slot = slots[index];
+            slot.generation = slot.generation + 1 != 0 ? slot.generation + 1 : 1;
+            slot.denseIndex = freeHead;
+            freeHead = index;
+            return true;
+        }
+
+        bool IsValid(HandleType handle) const
+        {
+            const uint32_t index = handle.GetIndex();
+            return !handle.IsNull()
+                && handle.GetShard() == shard
+                && index < slots.size()
+                && slots[index].generation == handle.GetGeneration();
+        }
+
+        /// Return the element of column I for a valid handle.
+        template <size_t I>
+        auto& Get(HandleType handle)
+        {
+            ALIMER_ASSERT(IsValid(handle));
+            return std::get<I>(columns)[slots[handle.GetIndex()].denseIndex];
+        }
+
+        /// Return the dense storage of column I, GetCount() elements long.
+        template <size_t I>
+        auto* GetData() { return std::get<I>(columns).data(); }
+
+        uint32_t GetCount() const { return static_cast<uint32_t>(denseToSlot.size()); }
+
+        /// Return the handle of the element at the given dense index.
+        HandleType GetHandle(uint32_t denseIndex) const
+        {
+            const uint32_t index = denseToSlot[denseIndex];
+            return HandleType(index, shard, slots[index].generation);
+        }
+
+        /// Free every handle.
+        void Clear()
+        {
+            for (uint32_t i = GetCount(); i > 0; --i)
+            {
+                Free(GetHandle(i - 1));
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            uint32_t generation;
+            /// Index in the dense columns while alive, next free slot otherwise.
+            uint32_t denseIndex;
+        };
+
+        template <size_t... I>
+        void PushColumns(std::index_sequence<I...>, Columns&&... values)
+        {
+            int unused[] = { 0, (std::get<I>(columns).push_back(std::move(values)), 0)... };
+            (void)unused;
+        }
+
+        template <typename Function>
+        void ForEachColumn(Function&& function)
+        {
+            ForEachColumn(std::forward<Function>(function), std::index_sequence_for<Columns...>{});
+        }
+
+        template <typename Function, size_t... I>
+        void ForEachColumn(Function&& function, std::index_sequence<I...>)
+        {
+            int unused[] = { 0, (function(std::get<I>(columns)), 0)... };
+            (void)unused;
+        }
+
+        uint32_t shard;
+        uint32_t firstGeneration;
+        uint32_t freeHead = kInvalidIndex;
+        std::vector<Slot> slots;
+        std::vector<uint32_t> denseToSlot;
+        std::tuple<std::vector<Columns>...> columns;
+    };
+
+    /// HandlePool split in shards with their own lock, threads allocate from the shard picked by their thread index.
+    template <typename T, typename... Columns>
+    class ConcurrentHandlePool final
+    {
+    public:
+        using PoolType = HandlePool<T, Columns...>;
+        using HandleType = Handle<T>;
+        static constexpr uint32_t kShardCount = 16;
+        static_assert(kShardCount <= HandleType::kMaxShards, "Too many shards");
+
+        ConcurrentHandlePool()
+        {
+            for (uint32_t i = 0; i < kShardCount; ++i)
+            {
+                shards[i].pool = PoolType(i);
+            }
+        }
+
+        HandleType Allocate(Columns... values)
+        {
+            Shard& shard = shards[GetThreadShard()];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.pool.Allocate(std::move(values)...);
+        }
+
+        bool Free(HandleType handle)
+        {
+            Shard& shard = shards[handle.GetShard() % kShardCount];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.pool.Free(handle);
+        }
+
+        bool IsValid(HandleType handle)
+        {
+            Shard& shard = shards[handle.GetShard() % kShardCount];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.pool.IsValid(handle);
+        }
+
+        /// Copy the element of column I into result, returns false if the handle is stale or invalid.
+        template <size_t I, typename U>
+        bool TryGet(HandleType handle, U& result)
+        {
+            Shard& shard = shards[handle.GetShard() % kShardCount];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (!shard.pool.IsValid(handle))
+                return false;
+
+            result = shard.pool.template Get<I>(handle);
+            return true;
+        }
+
+        /// Call function(pool) for every shard while holding its lock.
+        template <typename Function>
+        void ForEachShard(Function&& function)
+        {
+            for (Shard& shard : shards)
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                function(shard.pool);
+            }
+        }
+
+    private:
+        static uint32_t GetThreadShard()
+        {
+            const uint32_t threadIndex = JobSystem::GetThreadIndex();
+            if (threadIndex != ~0u)
+                return threadIndex % kShardCount;
+
+            return static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()) % kShardCount);
+        }
+
+        struct Shard
+        {
+            std::mutex mutex;
+            PoolType pool;
+            /// Keep shards on separate cache lines.
+            uint8_t padding[64];
+        };
+
+        Shard shards[kShardCount];
+    };
+}
@@ -21,9 +21,32 @@
 //
 /// MurmurHash2, by Austin Appleby
 #include "core/Hash.h"
+#include "math/simd.h"
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#   include <intrin.h>
+#endif
 
 namespace alimer
 {
+    namespace
+    {
+        ALIMER_FORCE_INLINE uint32_t Read32(const uint8_t* data)
+        {
+            uint32_t value;
+            memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        ALIMER_FORCE_INLINE uint64_t Read64(const uint8_t* data)
+        {
+            uint64_t value;
+            memcpy(&value, data, sizeof(value));
+            return value;
+        }
+    }
+
     uint32_t murmur32(const void* key, uint32_t len, uint32_t seed)
     {
         // 'm' and 'r' are mixing constants generated offline.
@@ -39,7 +62,7 @@ namespace alimer
 
         while (len >= 4)
         {
-            unsigned int k = *(unsigned int*)data;
+            unsigned int k = Read32(data);
 
             k *= m;
             k ^= k >> r;
@@ -77,12 +100,13 @@ namespace alimer
 
         uint64_t h = seed ^ (len * m);
 
-        const uint64_t* data = (const uint64_t*)key;
-        const uint64_t* end = data + (len / 8);
+        const uint8_t* data = (const uint8_t*)key;
+        const uint8_t* end = data + (len / 8) * 8;
 
         while (data != end)
         {
-            uint64_t k = *data++;
+            uint64_t k = Read64(data);
+            data += 8;
 
             k *= m;
             k ^= k >> r;
@@ -92,7 +116,7 @@ namespace alimer
             h *= m;
         }
 
-        const uint8_t* data2 = (const uint8_t*)data;
+        const uint8_t* data2 = data;
 
         switch (len & 7)
         {
@@ -112,4 +136,420 @@ namespace alimer
 
         return h;
     }
+
+    /* hash64 / hash128 */
+    namespace
+    {
+        constexpr uint64_t kPrime32_1 = 0x9E3779B1u;
+        constexpr uint64_t kPrime32_2 = 0x85EBCA77u;
+        constexpr uint64_t kPrime32_3 = 0xC2B2AE3Du;
+        constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ull;
+        constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ull;
+        constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ull;
+        constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ull;
+
+        constexpr size_t kStripeSize = Hasher::kStripeSize;
+        constexpr size_t kSecretSize = Hasher::kSecretSize;
+        /// Inputs up to this size are hashed without the stripe accumulators.
+        constexpr size_t kMidSizeMax = Hasher::kBufferSize;
+        /// Each stripe in a block moves 8 bytes further into the secret, then the accumulators are scrambled.
+        constexpr uint32_t kStripesPerBlock = static_cast<uint32_t>((kSecretSize - kStripeSize) / 8);
+        constexpr size_t kLastStripeSecretOffset = kSecretSize - kStripeSize - 7;
+        constexpr size_t kMergeSecretOffset = 11;
+
+        /// Default secret, 24 words of splitmix64 output.
+        const uint64_t kSecretWords[kSecretSize / 8] = {
+            0xC0E16B163A85A4DCull, 0x890ACD8DD443C47Cull, 0xB3889D8A6DC47761ull,
+            0x6A0398E528F0AE6Aull, 0x048344ECE48A855Eull, 0xF175CFEA21871330ull,
+            0x391CEEF02702C2FDull, 0x4BAF8CAC4784CB12ull, 0x3547744583A3F88Eull,
+            0xD9CF2B15C6B6C90Eull, 0x961FACC76D5FE21Cull, 0x0094AB49D50F11F9ull,
+            0xE3211E37BDBEB6DCull, 0x62FE6C274FF3511Aull, 0x5AC30B329FDF0574ull,
+            0x1450582C6B65B406ull, 0x7A30FCC7888EB791ull, 0x5540F5BA6A15576Eull,
+            0x16CEF0559096D3E9ull, 0x2CF8F14B06874899ull, 0xC9C9263B6E2CE103ull,
+            0xD6FF920B0A9FAA6Dull, 0x53192697DB998DC1ull, 0x73EA9B9BC7CD18D7ull,
+        };
+
+        const uint8_t* const kSecret = reinterpret_cast<const uint8_t*>(kSecretWords);
+
+        const uint64_t kInitAcc[8] = {
+            kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3,
+            kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1
+        };
+
+        ALIMER_FORCE_INLINE uint64_t RotateLeft(uint64_t value, int shift)
+        {
+            return (value << shift) | (value >> (64 - shift));
+        }
+
+        /// Full 64x64 multiply with the high and low halves folded together.
+        ALIMER_FORCE_INLINE uint64_t MultiplyFold64(uint64_t a, uint64_t b)
+        {
+#if defined(__SIZEOF_INT128__)
+            const __uint128_t product = static_cast<__uint128_t>(a) * b;
+            return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            uint64_t high;
+            const uint64_t low = _umul128(a, b, &high);
+            return low ^ high;
+#else
+            const uint64_t loLo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+            const uint64_t hiLo = (a >> 32) * (b & 0xFFFFFFFF);
+            const uint64_t loHi = (a & 0xFFFFFFFF) * (b >> 32);
+            const uint64_t hiHi = (a >> 32) * (b >> 32);
+            const uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+            const uint64_t high = (hiLo >> 32) + (cross >> 32) + hiHi;
+            const uint64_t low = (cross << 32) | (loLo & 0xFFFFFFFF);
+            return low ^ high;
+#endif
+        }
+
+        ALIMER_FORCE_INLINE uint64_t Avalanche(uint64_t h)
+        {
+            h ^= h >> 37;
+            h *= 0x165667919E3779F9ull;
+            h ^= h >> 32;
+            return h;
+        }
+
+        /// Stronger finalizer for the 4 to 8 byte path, where the input fills the word.
+        ALIMER_FORCE_INLINE uint64_t Remix(uint64_t h, uint64_t size)
+        {
+            h ^= RotateLeft(h, 49) ^ RotateLeft(h, 24);
+            h *= 0x9FB21C651E98DF25ull;
+            h ^= (h >> 35) + size;
+            h *= 0x9FB21C651E98DF25ull;
+            h ^= h >> 28;
+            return h;
+        }
+
+        ALIMER_FORCE_INLINE uint64_t Mix16(const uint8_t* data, const uint8_t* secret, uint64_t seed)
+        {
+            return MultiplyFold64(
+                Read64(data) ^ (Read64(secret) + seed),
+                Read64(data + 8) ^ (Read64(secret + 8) - seed));
+        }
+
+        /// 0 to 16 bytes, secret needs 64 readable bytes.
+        uint64_t HashSmall(const uint8_t* data, size_t size, const uint8_t* secret, uint64_t seed)
+        {
+            if (size > 8)
+            {
+                const uint64_t low = Read64(data) ^ ((Read64(secret + 24) ^ Read64(secret + 32)) + seed);
+                const uint64_t high = Read64(data + size - 8) ^ ((Read64(secret + 40) ^ Read64(secret + 48)) - seed);
+                return Avalanche(size + RotateLeft(low, 32) + high + MultiplyFold64(low, high));
+            }
+
+            if (size >= 4)
+            {
+                seed ^= static_cast<uint64_t>(static_cast<uint32_t>(RotateLeft(seed, 32))) << 32;
+                const uint64_t input = Read32(data + size - 4) + (static_cast<uint64_t>(Read32(data)) << 32);
+                return Remix(input ^ ((Read64(secret + 8) ^ Read64(secret + 16)) - seed), size);
+            }
+
+            if (size > 0)
+            {
+                const uint32_t combined = (static_cast<uint32_t>(data[0]) << 16) | (static_cast<uint32_t>(data[size >> 1]) << 24)
+                    | static_cast<uint32_t>(data[size - 1]) | (static_cast<uint32_t>(size) << 8);
+                uint64_t h = combined ^ ((Read32(secret) ^ Read32(secret + 4)) + seed);
+                h ^= h >> 33;
+                h *= kPrime64_2;
+                h ^= h >> 29;
+                h *= kPrime64_3;
+                h ^= h >> 32;
+                return h;
+            }
+
+            return Avalanche(seed ^ Read64(secret + 56) ^ Read64(secret + 64));
+        }
+
+        /// 17 to 256 bytes, pairs of 16 byte chunks from both ends meet in the middle.
+        Hash128 HashMid(const uint8_t* data, size_t size, uint64_t seed)
+        {
+            uint64_t low = size * kPrime64_1;
+            uint64_t high = 0;
+
+            const size_t rounds = (size - 1) / 32 + 1;
+            for (size_t round = 0; round < rounds; ++round)
+            {
+                const uint8_t* front = data + 16 * round;
+                const uint8_t* back = data + size - 16 - 16 * round;
+                const uint8_t* secret = kSecret + (round < 5 ? 32 * round : 3 + 32 * (round - 5));
+                low += Mix16(front, secret, seed) ^ (Read64(back) + Read64(back + 8));
+                high += Mix16(back, secret + 16, seed) ^ (Read64(front) + Read64(front + 8));
+            }
+
+            Hash128 result;
+            result.low = Avalanche(low + high);
+            result.high = 0 - Avalanche(low * kPrime64_1 + high * kPrime64_4 + (size - seed) * kPrime64_2);
+            return result;
+        }
+
+        /// Mix one 64 byte stripe into the 8 accumulators.
+        ALIMER_FORCE_INLINE void Accumulate512(uint64_t* acc, const uint8_t* data, const uint8_t* secret)
+        {
+#if defined(__AVX2__)
+            __m256i* lanes = reinterpret_cast<__m256i*>(acc);
+            for (int i = 0; i < 2; ++i)
+            {
+                const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data) + i);
+                const __m256i key = _mm256_xor_si256(value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i));
+                const __m256i product = _mm256_mul_epu32(key, _mm256_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+                const __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+                const __m256i sum = _mm256_add_epi64(_mm256_loadu_si256(lanes + i), swapped);
+                _mm256_storeu_si256(lanes + i, _mm256_add_epi64(product, sum));
+            }
+#elif defined(ALIMER_SIMD_SSE2)
+            __m128i* lanes = reinterpret_cast<__m128i*>(acc);
+            for (int i = 0; i < 4; ++i)
+            {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data) + i);
+                const __m128i key = _mm_xor_si128(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+                const __m128i product = _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+                const __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+                const __m128i sum = _mm_add_epi64(_mm_loadu_si128(lanes + i), swapped);
+                _mm_storeu_si128(lanes + i, _mm_add_epi64(product, sum));
+            }
+#elif defined(ALIMER_SIMD_NEON)
+            for (int i = 0; i < 4; ++i)
+            {
+                const uint64x2_t value = vreinterpretq_u64_u8(vld1q_u8(data + 16 * i));
+                const uint64x2_t key = veorq_u64(value, vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i)));
+                uint64x2_t lane = vaddq_u64(vld1q_u64(acc + 2 * i), vextq_u64(value, value, 1));
+                lane = vmlal_u32(lane, vmovn_u64(key), vshrn_n_u64(key, 32));
+                vst1q_u64(acc + 2 * i, lane);
+            }
+#else
+            for (int i = 0; i < 8; ++i)
+            {
+                const uint64_t value = Read64(data + 8 * i);
+                const uint64_t key = value ^ Read64(secret + 8 * i);
+                acc[i ^ 1] += value;
+                acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+            }
+#endif
+        }
+
+        /// Fold the high bits back in at the end of each block so the accumulators don't saturate.
+        ALIMER_FORCE_INLINE void Scramble(uint64_t* acc, const uint8_t* secret)
+        {
+#if defined(ALIMER_SIMD_SSE2)
+            __m128i* lanes = reinterpret_cast<__m128i*>(acc);
+            const __m128i prime = _mm_set1_epi32(static_cast<int>(kPrime32_1));
+            for (int i = 0; i < 4; ++i)
+            {
+                __m128i lane = _mm_loadu_si128(lanes + i);
+                lane = _mm_xor_si128(lane, _mm_srli_epi64(lane, 47));
+                lane = _mm_xor_si128(lane, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+                const __m128i low = _mm_mul_epu32(lane, prime);
+                const __m128i high = _mm_mul_epu32(_mm_srli_epi64(lane, 32), prime);
+                _mm_storeu_si128(lanes + i, _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+            }
+#elif defined(ALIMER_SIMD_NEON)
+            const uint32x2_t prime = vdup_n_u32(static_cast<uint32_t>(kPrime32_1));
+            for (int i = 0; i < 4; ++i)
+            {
+                uint64x2_t lane = vld1q_u64(acc + 2 * i);
+                lane = veorq_u64(lane, vshrq_n_u64(lane, 47));
+                lane = veorq_u64(lane, vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i)));
+                const uint64x2_t high = vshlq_n_u64(vmull_u32(vshrn_n_u64(lane, 32), prime), 32);
+                vst1q_u64(acc + 2 * i, vmlal_u32(high, vmovn_u64(lane), prime));
+            }
+#else
+            for (int i = 0; i < 8; ++i)
+            {
+                uint64_t lane = acc[i];
+                lane ^= lane >> 47;
+                lane ^= Read64(secret + 8 * i);
+                acc[i] = lane * kPrime32_1;
+            }
+#endif
+        }
+
+        void AccumulateStripes(uint64_t* acc, uint32_t& stripesInBlock, const uint8_t* data, size_t stripeCount, const uint8_t* secret)
+        {
+            while (stripeCount > 0)
+            {
+                const size_t count = stripeCount < kStripesPerBlock - stripesInBlock ? stripeCount : kStripesPerBlock - stripesInBlock;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    Accumulate512(acc, data + i * kStripeSize, secret + (stripesInBlock + i) * 8);
+                }
+
+                data += count * kStripeSize;
+                stripeCount -= count;
+                stripesInBlock += static_cast<uint32_t>(count);
+                if (stripesInBlock == kStripesPerBlock)
+                {
+                    Scramble(acc, secret + kSecretSize - kStripeSize);
+                    stripesInBlock = 0;
+                }
+            }
+        }
+
+        uint64_t MergeAccumulators(const uint64_t* acc, const uint8_t* secret, uint64_t start)
+        {
+            uint64_t result = start;
+            for (int i = 0; i < 4; ++i)
+            {
+                result += MultiplyFold64(acc[2 * i] ^ Read64(secret + 16 * i), acc[2 * i + 1] ^ Read64(secret + 16 * i + 8));
+            }
+            return Avalanche(result);
+        }
+
+        Hash128 FinalizeLong(const uint64_t* acc, const uint8_t* secret, uint64_t size)
+        {
+            Hash128 result;
+            result.low = MergeAccumulators(acc, secret + kMergeSecretOffset, size * kPrime64_1);
+            result.high = MergeAccumulators(acc, secret + kSecretSize - kStripeSize - kMergeSecretOffset, ~(size * kPrime64_2));
+            return result;
+        }
+
+        void DeriveSecret(uint8_t* secret, uint64_t seed)
+        {
+            for (size_t i = 0; i < kSecretSize / 8; ++i)
+            {
+                const uint64_t word = kSecretWords[i] + ((i & 1) ? 0 - seed : seed);
+                memcpy(secret + 8 * i, &word, sizeof(word));
+            }
+        }
+
+        Hash128 HashLong(const uint8_t* data, size_t size, uint64_t seed)
+        {
+            uint8_t derivedSecret[kSecretSize];
+            const uint8_t* secret = kSecret;
+            if (seed != 0)
+            {
+                DeriveSecret(derivedSecret, seed);
+                secret = derivedSecret;
+            }
+
+            uint64_t acc[8];
+            memcpy(acc, kInitAcc, sizeof(acc));
+
+            // The last stripe is always hashed separately, aligned to the end of the input.
+            uint32_t stripesInBlock = 0;
+            AccumulateStripes(acc, stripesInBlock, data, (size - 1) / kStripeSize, secret);
+            Accumulate512(acc, data + size - kStripeSize, secret + kLastStripeSecretOffset);
+            return FinalizeLong(acc, secret, size);
+        }
+    }
+
+    uint64_t hash64(const void* data, size_t size, uint64_t seed)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        if (size <= 16)
+            return HashSmall(bytes, size, kSecret, seed);
+        if (size <= kMidSizeMax)
+            return HashMid(bytes, size, seed).low;
+        return HashLong(bytes, size, seed).low;
+    }
+
+    Hash128 hash128(const void* data, size_t size, uint64_t seed)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        if (size <= 16)
+        {
+            Hash128 result;
+            result.low = HashSmall(bytes, size, kSecret, seed);
+            result.high = HashSmall(bytes, size, kSecret + 64, seed);
+            return result;
+        }
+        if (size <= kMidSizeMax)
+            return HashMid(bytes, size, seed);
+        return HashLong(bytes, size, seed);
+    }
+
+    /* Hasher */
+    constexpr uint32_t Hasher::kStripeSize;
+    constexpr uint32_t Hasher::kBufferSize;
+    constexpr uint32_t Hasher::kSecretSize;
+
+    Hasher::Hasher(uint64_t seed_)
+    {
+        Reset(seed_);
+    }
+
+    void Hasher::Reset(uint64_t seed_)
+    {
+        memcpy(acc, kInitAcc, sizeof(acc));
+        DeriveSecret(secret, seed_);
+        totalSize = 0;
+        seed = seed_;
+        bufferSize = 0;
+        stripesInBlock = 0;
+    }
+
+    void Hasher::Update(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        totalSize += size;
+
+        if (bufferSize + size <= kBufferSize)
+        {
+            memcpy(buffer + bufferSize, bytes, size);
+            bufferSize += static_cast<uint32_t>(size);
+            return;
+        }
+
+        // Stripes are only consumed once more data is known to follow, the final stripe is hashed by Final.
+        if (bufferSize > 0)
+        {
+            const size_t fill = kBufferSize - bufferSize;
+            memcpy(buffer + bufferSize, bytes, fill);
+            bytes += fill;
+            size -= fill;
+
+            AccumulateStripes(acc, stripesInBlock, buffer, kBufferSize / kStripeSize, secret);
+            memcpy(lastStripe, buffer + kBufferSize - kStripeSize, kStripeSize);
+            bufferSize = 0;
+        }
+
+        if (size > kBufferSize)
+        {
+            const size_t stripeCount = (size - 1) / kStripeSize;
+            AccumulateStripes(acc, stripesInBlock, bytes, stripeCount, secret);
+            bytes += stripeCount * kStripeSize;
+            size -= stripeCount * kStripeSize;
+            memcpy(lastStripe, bytes - kStripeSize, kStripeSize);
+        }
+
+        memcpy(buffer, bytes, size);
+        bufferSize = static_cast<uint32_t>(size);
+    }
+
+    uint64_t Hasher::Final64() const
+    {
+        if (totalSize <= kBufferSize)
+            return hash64(buffer, bufferSize, seed);
+
+        return Final128().low;
+    }
+
+    Hash128 Hasher::Final128() const
+    {
+        // Until the buffer first overflows, everything is still in it.
+        if (totalSize <= kBufferSize)
+            return hash128(buffer, bufferSize, seed);
+
+        uint64_t finalAcc[8];
+        memcpy(finalAcc, acc, sizeof(finalAcc));
+        uint32_t finalStripesInBlock = stripesInBlock;
+        AccumulateStripes(finalAcc, finalStripesInBlock, buffer, (bufferSize - 1) / kStripeSize, secret);
+
+        if (bufferSize >= kStripeSize)
+        {
+            Accumulate512(finalAcc, buffer + bufferSize - kStripeSize, secret + kLastStripeSecretOffset);
+        }
+        else
+        {
+            uint8_t stripe[kStripeSize];
+            const size_t carried = kStripeSize - bufferSize;
+            memcpy(stripe, lastStripe + bufferSize, carried);
+            memcpy(stripe + carried, buffer, bufferSize);
+            Accumulate512(finalAcc, stripe, secret + kLastStripeSecretOffset);
+        }
+
+        return FinalizeLong(finalAcc, secret, totalSize);
+    }
 }
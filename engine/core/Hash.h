@@ -28,4 +28,127 @@ namespace alimer
 {
     ALIMER_API uint32_t murmur32(const void* key, uint32_t len, uint32_t seed);
     ALIMER_API uint64_t murmur64(const void* key, uint64_t len, uint64_t seed);
+
+    /// 128-bit hash value.
+    struct Hash128
+    {
+        uint64_t low;
+        uint64_t high;
+
+        bool operator ==(const Hash128& rhs) const { return low == rhs.low && high == rhs.high; }
+        bool operator !=(const Hash128& rhs) const { return !(*this == rhs); }
+    };
+
+    /// Fast 64-bit hash for keys and bulk data, inputs above 256 bytes take a SIMD path of 64 byte stripes.
+    ALIMER_API uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+    /// Fast 128-bit hash, the wider variant of hash64 for content hashes and cache validation.
+    ALIMER_API Hash128 hash128(const void* data, size_t size, uint64_t seed = 0);
+
+    /// Incremental hash64/hash128, feeding the data in pieces gives the same result as hashing it at once.
+    class ALIMER_API Hasher final
+    {
+    public:
+        static constexpr uint32_t kStripeSize = 64;
+        static constexpr uint32_t kBufferSize = 4 * kStripeSize;
+        static constexpr uint32_t kSecretSize = 192;
+
+        /// Construct and reset with seed.
+        explicit Hasher(uint64_t seed = 0);
+
+        /// Start a new hash.
+        void Reset(uint64_t seed = 0);
+        /// Append data.
+        void Update(const void* data, size_t size);
+        /// Return the 64-bit hash of all data so far, the hasher can keep being updated.
+        uint64_t Final64() const;
+        /// Return the 128-bit hash of all data so far, the hasher can keep being updated.
+        Hash128 Final128() const;
+
+    private:
+        uint64_t acc[8];
+        uint8_t secret[kSecretSize];
+        uint8_t buffer[kBufferSize];
+        /// Last stripe already accumulated, completes the final stripe when the buffer holds less than one.
+        uint8_t lastStripe[kStripeSize];
+        uint64_t totalSize;
+        uint64_t seed;
+        uint32_t bufferSize;
+        uint32_t stripesInBlock;
+    };
+
+    /// Compile time murmur32, matches the runtime result on little endian targets.
+    constexpr uint32_t const_murmur32(const char* str, uint32_t len, uint32_t seed)
+    {
+        const uint32_t m = 0x5bd1e995;
+        uint32_t h = seed ^ len;
+
+        uint32_t i = 0;
+        for (; i + 4 <= len; i += 4)
+        {
+            uint32_t k = uint32_t(uint8_t(str[i]))
+                | (uint32_t(uint8_t(str[i + 1])) << 8)
+                | (uint32_t(uint8_t(str[i + 2])) << 16)
+                | (uint32_t(uint8_t(str[i + 3])) << 24);
+
+            k *= m;
+            k ^= k >> 24;
+            k *= m;
+
+            h *= m;
+            h ^= k;
+        }
+
+        const uint32_t tail = len - i;
+        if (tail >= 3) h ^= uint32_t(uint8_t(str[i + 2])) << 16;
+        if (tail >= 2) h ^= uint32_t(uint8_t(str[i + 1])) << 8;
+        if (tail >= 1)
+        {
+            h ^= uint32_t(uint8_t(str[i]));
+            h *= m;
+        }
+
+        h ^= h >> 13;
+        h *= m;
+        h ^= h >> 15;
+        return h;
+    }
+
+    /// Compile time murmur64, matches the runtime result on little endian targets.
+    constexpr uint64_t const_murmur64(const char* str, uint64_t len, uint64_t seed)
+    {
+        const uint64_t m = 0xc6a4a7935bd1e995ull;
+        uint64_t h = seed ^ (len * m);
+
+        uint64_t i = 0;
+        for (; i + 8 <= len; i += 8)
+        {
+            uint64_t k = 0;
+            for (uint64_t b = 0; b < 8; ++b)
+            {
+                k |= uint64_t(uint8_t(str[i + b])) << (b * 8);
+            }
+
+            k *= m;
+            k ^= k >> 47;
+            k *= m;
+
+            h ^= k;
+            h *= m;
+        }
+
+        const uint64_t tail = len - i;
+        if (tail > 0)
+        {
+            for (uint64_t b = 0; b < tail; ++b)
+            {
+                h ^= uint64_t(uint8_t(str[i + b])) << (b * 8);
+            }
+            h *= m;
+        }
+
+        h ^= h >> 47;
+        h *= m;
+        h ^= h >> 47;
+        return h;
+    }
 }
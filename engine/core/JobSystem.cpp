@@ -0,0 +1,409 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "config.h"
+#include "core/JobSystem.h"
+#include "core/Assert.h"
+#include "core/Profiler.h"
+#include <cstdio>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace alimer
+{
+    namespace
+    {
+        static constexpr uint32_t kInvalidThreadIndex = ~0u;
+        static constexpr uint32_t kJobMask = JobSystem::kMaxJobsPerThread - 1;
+        static_assert((JobSystem::kMaxJobsPerThread & kJobMask) == 0, "kMaxJobsPerThread must be power of two");
+
+        /// Job storage, queued stays set until whoever runs the job has copied it out.
+        struct JobSlot
+        {
+            Job job;
+            std::atomic<bool> queued{ false };
+        };
+
+        /// Chase-Lev work-stealing deque, the owner pushes and pops at the bottom, thieves steal from the top.
+        class WorkStealingQueue final
+        {
+        public:
+            bool Push(JobSlot* job)
+            {
+                int64_t b = bottom.load(std::memory_order_relaxed);
+                int64_t t = top.load(std::memory_order_acquire);
+                if (b - t >= static_cast<int64_t>(JobSystem::kMaxJobsPerThread))
+                    return false;
+
+                buffer[b & kJobMask].store(job, std::memory_order_release);
+                std::atomic_thread_fence(std::memory_order_release);
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return true;
+            }
+
+            JobSlot* Pop()
+            {
+                int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+                bottom.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t t = top.load(std::memory_order_relaxed);
+
+                if (t > b)
+                {
+                    // Queue is empty.
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+
+                JobSlot* job = buffer[b & kJobMask].load(std::memory_order_relaxed);
+                if (t == b)
+                {
+                    // Last job, race against thieves.
+                    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    {
+                        job = nullptr;
+                    }
+
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                }
+
+                return job;
+            }
+
+            JobSlot* Steal()
+            {
+                int64_t t = top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t b = bottom.load(std::memory_order_acquire);
+
+                if (t >= b)
+                    return nullptr;
+
+                JobSlot* job = buffer[t & kJobMask].load(std::memory_order_acquire);
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    return nullptr;
+
+                return job;
+            }
+
+        private:
+            // Keep top and bottom on separate cache lines, thieves only touch top.
+            std::atomic<int64_t> top{ 0 };
+            uint8_t padding0[64 - sizeof(std::atomic<int64_t>)];
+            std::atomic<int64_t> bottom{ 0 };
+            uint8_t padding1[64 - sizeof(std::atomic<int64_t>)];
+            std::atomic<JobSlot*> buffer[JobSystem::kMaxJobsPerThread];
+        };
+
+        struct ThreadState
+        {
+            WorkStealingQueue queue;
+            /// Ring of job storage, only the owning thread allocates from it.
+            /// Jobs complete out of order, so a slot is reused only once its queued flag is clear.
+            JobSlot jobs[JobSystem::kMaxJobsPerThread];
+            uint32_t nextJob = 0;
+            uint32_t random = 0;
+        };
+
+        static struct {
+            std::vector<std::thread> workers;
+            /// The main thread and workers first, then the states of registered threads.
+            ThreadState* states = nullptr;
+            uint32_t threadCount = 0;
+            uint32_t stateCount = 0;
+            std::atomic<bool> registered[JobSystem::kMaxRegisteredThreads];
+            std::atomic<bool> running{ false };
+
+            /// Sleeping workers wake up when the generation changes.
+            std::mutex wakeMutex;
+            std::condition_variable wakeCondition;
+            std::atomic<uint32_t> sleepingCount{ 0 };
+            std::atomic<uint64_t> generation{ 0 };
+        } s_jobs;
+
+        static thread_local uint32_t s_threadIndex = kInvalidThreadIndex;
+    }
+
+    void JobSystem::Execute(const Job& job)
+    {
+        job.function(job.data, job.begin, job.end);
+
+        if (job.counter != nullptr)
+        {
+            job.counter->value.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    bool JobSystem::TryExecuteOne(uint32_t threadIndex)
+    {
+        JobSlot* job = nullptr;
+        if (threadIndex != kInvalidThreadIndex)
+        {
+            job = s_jobs.states[threadIndex].queue.Pop();
+        }
+
+        if (job == nullptr)
+        {
+            // Steal from another thread, starting at a random victim to spread contention.
+            uint32_t offset = 0;
+            if (threadIndex != kInvalidThreadIndex)
+            {
+                uint32_t& random = s_jobs.states[threadIndex].random;
+                random = random * 1664525u + 1013904223u;
+                offset = random >> 16;
+            }
+
+            for (uint32_t i = 0; i < s_jobs.stateCount && job == nullptr; ++i)
+            {
+                uint32_t victim = (offset + i) % s_jobs.stateCount;
+                if (victim != threadIndex)
+                {
+                    job = s_jobs.states[victim].queue.Steal();
+                }
+            }
+        }
+
+        if (job == nullptr)
+            return false;
+
+        // Copy out before executing and hand the storage slot back to its owner.
+        const Job localJob = job->job;
+        job->queued.store(false, std::memory_order_release);
+        Execute(localJob);
+        return true;
+    }
+
+    void JobSystem::WorkerMain(uint32_t threadIndex)
+    {
+        s_threadIndex = threadIndex;
+
+#if defined(ALIMER_PROFILING)
+        char threadName[32];
+        snprintf(threadName, sizeof(threadName), "Worker %u", threadIndex);
+        ALIMER_PROFILE_THREAD(threadName);
+#endif
+
+        while (s_jobs.running.load(std::memory_order_acquire))
+        {
+            uint64_t generation = s_jobs.generation.load();
+
+            if (TryExecuteOne(threadIndex))
+                continue;
+
+            std::unique_lock<std::mutex> lock(s_jobs.wakeMutex);
+            s_jobs.sleepingCount++;
+            s_jobs.wakeCondition.wait(lock, [generation] {
+                return !s_jobs.running.load(std::memory_order_acquire) || s_jobs.generation.load() != generation;
+                });
+            s_jobs.sleepingCount--;
+        }
+    }
+
+    void JobSystem::Initialize(uint32_t workerCount)
+    {
+        ALIMER_ASSERT(!IsInitialized());
+
+#if defined(ALIMER_THREADING)
+        if (workerCount == kDefaultWorkerCount)
+        {
+            uint32_t coreCount = std::thread::hardware_concurrency();
+            workerCount = coreCount > 1 ? coreCount - 1 : 0;
+        }
+#else
+        workerCount = 0;
+#endif
+
+        s_jobs.threadCount = workerCount + 1;
+        s_jobs.stateCount = s_jobs.threadCount + kMaxRegisteredThreads;
+        s_jobs.states = new ThreadState[s_jobs.stateCount];
+        for (uint32_t i = 0; i < s_jobs.stateCount; ++i)
+        {
+            s_jobs.states[i].random = i * 2654435761u + 1u;
+        }
+
+        s_jobs.running = true;
+        s_threadIndex = 0;
+
+        s_jobs.workers.reserve(workerCount);
+        for (uint32_t i = 1; i <= workerCount; ++i)
+        {
+            s_jobs.workers.emplace_back(WorkerMain, i);
+        }
+    }
+
+    void JobSystem::Shutdown()
+    {
+        if (!IsInitialized())
+            return;
+
+        // Finish pending work before stopping the workers.
+        while (TryExecuteOne(s_threadIndex))
+        {
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(s_jobs.wakeMutex);
+            s_jobs.running = false;
+        }
+        s_jobs.wakeCondition.notify_all();
+
+        for (auto& worker : s_jobs.workers)
+        {
+            worker.join();
+        }
+
+        s_jobs.workers.clear();
+        delete[] s_jobs.states;
+        s_jobs.states = nullptr;
+        s_jobs.threadCount = 0;
+        s_jobs.stateCount = 0;
+        s_threadIndex = kInvalidThreadIndex;
+    }
+
+    bool JobSystem::IsInitialized()
+    {
+        return s_jobs.states != nullptr;
+    }
+
+    uint32_t JobSystem::GetThreadCount()
+    {
+        return s_jobs.threadCount > 0 ? s_jobs.threadCount : 1;
+    }
+
+    uint32_t JobSystem::GetThreadIndex()
+    {
+        return s_threadIndex;
+    }
+
+    bool JobSystem::RegisterThread()
+    {
+        ALIMER_ASSERT(s_threadIndex == kInvalidThreadIndex);
+
+        // Without workers, jobs run inline on every thread anyway.
+        if (!IsInitialized() || s_jobs.threadCount <= 1)
+            return false;
+
+        for (uint32_t i = 0; i < kMaxRegisteredThreads; ++i)
+        {
+            bool expected = false;
+            if (s_jobs.registered[i].compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                s_threadIndex = s_jobs.threadCount + i;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void JobSystem::UnregisterThread()
+    {
+        const uint32_t threadIndex = s_threadIndex;
+        if (threadIndex == kInvalidThreadIndex || threadIndex < s_jobs.threadCount)
+            return;
+
+        // Jobs nobody waits for may still be queued, the next owner of the queue would overwrite them.
+        WorkStealingQueue& queue = s_jobs.states[threadIndex].queue;
+        while (JobSlot* job = queue.Pop())
+        {
+            const Job localJob = job->job;
+            job->queued.store(false, std::memory_order_release);
+            Execute(localJob);
+        }
+
+        s_threadIndex = kInvalidThreadIndex;
+        s_jobs.registered[threadIndex - s_jobs.threadCount].store(false, std::memory_order_release);
+    }
+
+    void JobSystem::Run(JobFunction function, void* data, JobCounter* counter)
+    {
+        Run(function, data, 0, 1, counter);
+    }
+
+    void JobSystem::Run(JobFunction function, void* data, uint32_t begin, uint32_t end, JobCounter* counter)
+    {
+        ALIMER_ASSERT(function);
+
+        const uint32_t threadIndex = s_threadIndex;
+
+        // Without workers, or from a thread the job system doesn't own, run the job right away.
+        if (s_jobs.threadCount <= 1 || threadIndex == kInvalidThreadIndex)
+        {
+            function(data, begin, end);
+            return;
+        }
+
+        if (counter != nullptr)
+        {
+            counter->value.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const Job localJob = { function, data, begin, end, counter };
+
+        // The next storage slot still holds a job nobody has picked up, the thread has too many in flight.
+        ThreadState& state = s_jobs.states[threadIndex];
+        JobSlot* slot = &state.jobs[state.nextJob & kJobMask];
+        if (slot->queued.load(std::memory_order_acquire))
+        {
+            // Don't block, run it here without touching the storage.
+            Execute(localJob);
+            return;
+        }
+
+        state.nextJob++;
+        slot->job = localJob;
+        slot->queued.store(true, std::memory_order_relaxed);
+
+        if (!state.queue.Push(slot))
+        {
+            slot->queued.store(false, std::memory_order_relaxed);
+            Execute(localJob);
+            return;
+        }
+
+        s_jobs.generation.fetch_add(1);
+        if (s_jobs.sleepingCount.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(s_jobs.wakeMutex);
+            s_jobs.wakeCondition.notify_one();
+        }
+    }
+
+    void JobSystem::Wait(JobCounter& counter)
+    {
+        const uint32_t threadIndex = s_threadIndex;
+        while (!counter.IsDone())
+        {
+            if (!IsInitialized() || !TryExecuteOne(threadIndex))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool JobSystem::ExecuteOne()
+    {
+        return IsInitialized() && TryExecuteOne(s_threadIndex);
+    }
+}
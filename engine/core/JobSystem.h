@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "core/Preprocessor.h"
+#include <atomic>
+
+namespace alimer
+{
+    /// Job entry point, called with the job user data and its [begin, end) range.
+    using JobFunction = void(*)(void* data, uint32_t begin, uint32_t end);
+
+    /// Counter used to wait for a group of jobs to complete.
+    class ALIMER_API JobCounter final
+    {
+        friend class JobSystem;
+
+    public:
+        /// Constructor.
+        JobCounter() = default;
+
+        /// Return true if all jobs tracked by the counter have completed.
+        bool IsDone() const { return value.load(std::memory_order_acquire) == 0; }
+
+    private:
+        std::atomic<uint32_t> value{ 0 };
+
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+    };
+
+    /// Defines a job scheduled by the JobSystem.
+    struct Job
+    {
+        JobFunction function;
+        void* data;
+        uint32_t begin;
+        uint32_t end;
+        JobCounter* counter;
+    };
+
+    /// Work-stealing job system with one worker thread per core.
+    class ALIMER_API JobSystem final
+    {
+    public:
+        /// Maximum number of jobs a single thread can have in flight.
+        static constexpr uint32_t kMaxJobsPerThread = 4096;
+        /// Worker count that starts one worker per additional core.
+        static constexpr uint32_t kDefaultWorkerCount = ~0u;
+        /// Maximum number of threads not started by the job system that can register at the same time.
+        static constexpr uint32_t kMaxRegisteredThreads = 4;
+
+        /// Start the worker threads, without workers jobs run inline on the calling thread.
+        static void Initialize(uint32_t workerCount = kDefaultWorkerCount);
+
+        /// Stop and join the worker threads.
+        static void Shutdown();
+
+        /// Return true if the job system is running.
+        static bool IsInitialized();
+
+        /// Return the number of threads executing jobs, including the main thread.
+        static uint32_t GetThreadCount();
+
+        /// Return the job thread index of the calling thread, main thread is zero.
+        static uint32_t GetThreadIndex();
+
+        /// Give the calling thread, one the job system didn't start, its own job queue, so the jobs it runs are
+        /// spread across the workers and it can help with other jobs while waiting. Returns false if none is left.
+        static bool RegisterThread();
+
+        /// Give back the job queue of a registered thread, all the jobs it scheduled must have completed.
+        static void UnregisterThread();
+
+        /// Schedule a job, the counter (if any) is decremented once the job completes.
+        static void Run(JobFunction function, void* data, JobCounter* counter = nullptr);
+
+        /// Schedule a job working on the [begin, end) range.
+        static void Run(JobFunction function, void* data, uint32_t begin, uint32_t end, JobCounter* counter);
+
+        /// Execute pending jobs on the calling thread until the counter reaches zero.
+        static void Wait(JobCounter& counter);
+
+        /// Execute one pending job on the calling thread, returns false if there was none.
+        static bool ExecuteOne();
+
+        /// Call function(index) for every index in [0, count), split in groups of groupSize and run in parallel.
+        template <typename Function>
+        static void ParallelFor(uint32_t count, uint32_t groupSize, const Function& function);
+
+    private:
+        static void Execute(const Job& job);
+        static bool TryExecuteOne(uint32_t threadIndex);
+        static void WorkerMain(uint32_t threadIndex);
+    };
+
+    template <typename Function>
+    void JobSystem::ParallelFor(uint32_t count, uint32_t groupSize, const Function& function)
+    {
+        if (count == 0)
+            return;
+
+        // Keep the number of jobs bounded so the per thread job storage never overflows.
+        const uint32_t maxGroups = GetThreadCount() * 4u;
+        if (groupSize == 0)
+            groupSize = 1;
+
+        if ((count + groupSize - 1) / groupSize > maxGroups)
+            groupSize = (count + maxGroups - 1) / maxGroups;
+
+        JobFunction execute = [](void* data, uint32_t begin, uint32_t end) {
+            const Function& func = *static_cast<const Function*>(data);
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                func(i);
+            }
+        };
+
+        void* data = const_cast<void*>(static_cast<const void*>(&function));
+
+        // The calling thread takes the last group itself.
+        JobCounter counter;
+        uint32_t begin = 0;
+        for (; count - begin > groupSize; begin += groupSize)
+        {
+            Run(execute, data, begin, begin + groupSize, &counter);
+        }
+
+        execute(data, begin, count);
+        Wait(counter);
+    }
+}
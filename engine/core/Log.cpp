@@ -20,7 +20,15 @@
 // THE SOFTWARE.
 //
 
+#include "config.h"
 #include "core/Log.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstring>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #if defined(__APPLE__)
@@ -33,6 +41,7 @@
 #   include <sys/syslog.h>
 #elif TARGET_OS_MAC || defined(__linux__)
 #   include <unistd.h>
+#   include <sys/uio.h>
 #elif defined(_WIN32)
 #   ifndef NOMINMAX
 #       define NOMINMAX
@@ -53,6 +62,373 @@ namespace alimer
 {
     static vector<Logger*> _loggers;
 
+    namespace
+    {
+#if TARGET_OS_MAC || defined(__linux__)
+        int GetOutputFileDescriptor(LogLevel level)
+        {
+            switch (level)
+            {
+            case LogLevel::Trace:
+            case LogLevel::Debug:
+            case LogLevel::Info:
+                return STDERR_FILENO;
+            case LogLevel::Warning:
+            case LogLevel::Error:
+                return STDOUT_FILENO;
+            default:
+                return -1;
+            }
+        }
+
+        /// Write all the parts, retrying on partial writes.
+        void WriteAll(int fd, iovec* parts, int count)
+        {
+            int partIndex = 0;
+            while (partIndex < count)
+            {
+                const ssize_t written = writev(fd, parts + partIndex, count - partIndex);
+                if (written == -1)
+                    return;
+
+                size_t remaining = static_cast<size_t>(written);
+                while (partIndex < count && remaining >= parts[partIndex].iov_len)
+                {
+                    remaining -= parts[partIndex].iov_len;
+                    partIndex++;
+                }
+
+                if (partIndex < count)
+                {
+                    parts[partIndex].iov_base = static_cast<char*>(parts[partIndex].iov_base) + remaining;
+                    parts[partIndex].iov_len -= remaining;
+                }
+            }
+        }
+#endif
+
+        /// Header preceding every message in a ring.
+        /// Padding up to the end of the ring only writes the first 8 bytes, size and a kPaddingLength length,
+        /// since records are 8 byte aligned the ring may end right after them.
+        struct LogRecord
+        {
+            uint32_t size;
+            uint32_t length;
+            Logger* logger;
+            LogLevel level;
+            uint32_t reserved;
+        };
+
+        static constexpr uint32_t kPaddingLength = ~0u;
+
+        /// Single producer single consumer ring of log records, the owning thread writes and the writer thread reads.
+        struct LogRing
+        {
+            uint8_t* data = nullptr;
+            uint32_t capacity = 0;
+            std::atomic<uint64_t> writePosition{ 0 };
+            uint8_t padding0[64];
+            std::atomic<uint64_t> readPosition{ 0 };
+            uint8_t padding1[64];
+            /// Set while the owning thread writes a record, StopAsync waits for it before the last drain.
+            std::atomic<bool> busy{ false };
+            /// Set when the owning thread exits, the writer frees the ring once drained.
+            std::atomic<bool> retired{ false };
+        };
+
+        void FreeRing(LogRing* ring)
+        {
+            delete[] ring->data;
+            delete ring;
+        }
+
+        static struct {
+            AsyncLogDesc desc;
+            std::atomic<bool> running{ false };
+            std::atomic<uint32_t> generation{ 0 };
+            std::thread writer;
+
+            std::mutex ringsMutex;
+            vector<LogRing*> rings;
+
+            std::mutex wakeMutex;
+            std::condition_variable wakeCondition;
+            std::condition_variable flushedCondition;
+            bool wakeRequested = false;
+            bool stopRequested = false;
+
+            std::atomic<uint64_t> enqueued{ 0 };
+            std::atomic<uint64_t> written{ 0 };
+            std::atomic<uint64_t> dropped{ 0 };
+        } s_async;
+
+        struct ThreadLogRing
+        {
+            LogRing* ring = nullptr;
+            uint32_t generation = 0;
+
+            ~ThreadLogRing()
+            {
+                if (ring == nullptr)
+                    return;
+
+                // A ring is listed while its generation is current, StopAsync unlists older ones and leaves them to this thread.
+                std::lock_guard<std::mutex> lock(s_async.ringsMutex);
+                if (generation == s_async.generation.load(std::memory_order_relaxed))
+                {
+                    ring->retired.store(true, std::memory_order_release);
+                }
+                else
+                {
+                    FreeRing(ring);
+                }
+            }
+        };
+
+        static thread_local ThreadLogRing s_threadRing;
+
+        void WakeWriter()
+        {
+            {
+                std::lock_guard<std::mutex> lock(s_async.wakeMutex);
+                s_async.wakeRequested = true;
+            }
+            s_async.wakeCondition.notify_one();
+        }
+
+        LogRing* GetThreadRing()
+        {
+            const uint32_t generation = s_async.generation.load(std::memory_order_acquire);
+            if (s_threadRing.ring != nullptr && s_threadRing.generation == generation)
+                return s_threadRing.ring;
+
+            // First message from this thread since async logging started, registering is the only locked step.
+            // The lock also orders the buffer size read with a StartAsync racing a message queued before StopAsync.
+            LogRing* ring = new LogRing();
+
+            {
+                std::lock_guard<std::mutex> lock(s_async.ringsMutex);
+                ring->capacity = s_async.desc.bufferSize;
+                ring->data = new uint8_t[ring->capacity];
+
+                // The previous ring was unlisted by StopAsync, only this thread still knows about it.
+                if (s_threadRing.ring != nullptr)
+                {
+                    FreeRing(s_threadRing.ring);
+                }
+
+                s_threadRing.generation = s_async.generation.load(std::memory_order_relaxed);
+                s_async.rings.push_back(ring);
+            }
+
+            s_threadRing.ring = ring;
+            return ring;
+        }
+
+        inline uint32_t AlignRecordSize(size_t size)
+        {
+            return static_cast<uint32_t>((size + 7) & ~size_t(7));
+        }
+
+        bool EnqueueAsync(Logger* logger, LogLevel level, const char* message, size_t length)
+        {
+            if (!s_async.running.load(std::memory_order_acquire))
+                return false;
+
+            // Only this thread frees its ring, it stays valid even if StopAsync runs from here on.
+            LogRing* ring = GetThreadRing();
+
+            // Pairs with StopAsync, which clears running before waiting for busy rings.
+            ring->busy.store(true, std::memory_order_seq_cst);
+            if (!s_async.running.load(std::memory_order_seq_cst))
+            {
+                ring->busy.store(false, std::memory_order_release);
+                return false;
+            }
+
+            // Keep records small enough to always fit, long messages are truncated.
+            const size_t maxLength = ring->capacity / 4 - sizeof(LogRecord);
+            if (length > maxLength)
+                length = maxLength;
+
+            const uint32_t size = AlignRecordSize(sizeof(LogRecord) + length);
+            uint64_t writePosition = ring->writePosition.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                const uint32_t offset = static_cast<uint32_t>(writePosition & (ring->capacity - 1));
+                const uint32_t contiguous = ring->capacity - offset;
+                const uint32_t needed = size <= contiguous ? size : size + contiguous;
+                const uint64_t readPosition = ring->readPosition.load(std::memory_order_acquire);
+                const uint64_t used = writePosition - readPosition;
+
+                if (used + needed <= ring->capacity)
+                {
+                    if (size > contiguous)
+                    {
+                        // Pad to the end of the ring so the record stays contiguous.
+                        LogRecord* padding = reinterpret_cast<LogRecord*>(ring->data + offset);
+                        padding->size = contiguous;
+                        padding->length = kPaddingLength;
+                        writePosition += contiguous;
+                    }
+
+                    // Wake the writer early when the ring starts filling up.
+                    if (used + needed > ring->capacity / 2)
+                    {
+                        WakeWriter();
+                    }
+
+                    break;
+                }
+
+                if (s_async.desc.overflowPolicy == LogOverflowPolicy::Drop)
+                {
+                    s_async.dropped.fetch_add(1, std::memory_order_relaxed);
+                    ring->busy.store(false, std::memory_order_release);
+                    return true;
+                }
+
+                WakeWriter();
+                std::this_thread::yield();
+            }
+
+            LogRecord* record = reinterpret_cast<LogRecord*>(ring->data + (writePosition & (ring->capacity - 1)));
+            record->size = size;
+            record->length = static_cast<uint32_t>(length);
+            record->logger = logger;
+            record->level = level;
+            memcpy(record + 1, message, length);
+
+            s_async.enqueued.fetch_add(1, std::memory_order_relaxed);
+            ring->writePosition.store(writePosition + size, std::memory_order_release);
+            ring->busy.store(false, std::memory_order_release);
+            return true;
+        }
+
+        /// Drain every ring, returns the number of messages written.
+        uint64_t DrainRings(vector<LogRing*>& rings)
+        {
+            uint64_t count = 0;
+
+#if TARGET_OS_MAC || defined(__linux__)
+            // Batch messages into one writev per output, each message is followed by a newline part.
+            static constexpr int kMaxParts = 1024;
+            static iovec parts[2][kMaxParts];
+            int partCount[2] = {};
+            char newline = '\n';
+
+            auto flushParts = [&](int output) {
+                if (partCount[output] > 0)
+                {
+                    WriteAll(output == 0 ? STDERR_FILENO : STDOUT_FILENO, parts[output], partCount[output]);
+                    partCount[output] = 0;
+                }
+            };
+#endif
+
+            for (LogRing* ring : rings)
+            {
+                uint64_t readPosition = ring->readPosition.load(std::memory_order_relaxed);
+                const uint64_t writePosition = ring->writePosition.load(std::memory_order_acquire);
+
+                while (readPosition < writePosition)
+                {
+                    const LogRecord* record = reinterpret_cast<const LogRecord*>(ring->data + (readPosition & (ring->capacity - 1)));
+                    if (record->length != kPaddingLength)
+                    {
+                        const char* message = reinterpret_cast<const char*>(record + 1);
+#if TARGET_OS_MAC || defined(__linux__)
+                        const int fd = GetOutputFileDescriptor(record->level);
+                        const int output = fd == STDOUT_FILENO ? 1 : 0;
+                        if (partCount[output] + 2 > kMaxParts)
+                        {
+                            flushParts(output);
+                        }
+
+                        parts[output][partCount[output]++] = { const_cast<char*>(message), record->length };
+                        parts[output][partCount[output]++] = { &newline, 1 };
+#else
+                        // Platform outputs want null terminated strings.
+                        char buffer[kMaxLogMessage + 1];
+                        const size_t length = record->length < kMaxLogMessage ? record->length : kMaxLogMessage;
+                        memcpy(buffer, message, length);
+                        buffer[length] = '\0';
+                        record->logger->Write(record->level, buffer, length);
+#endif
+                        count++;
+                    }
+
+                    readPosition += record->size;
+                }
+
+#if TARGET_OS_MAC || defined(__linux__)
+                // The ring memory has to stay valid until the parts pointing into it are written.
+                flushParts(0);
+                flushParts(1);
+#endif
+                ring->readPosition.store(readPosition, std::memory_order_release);
+            }
+
+            return count;
+        }
+
+        void WriterMain()
+        {
+            vector<LogRing*> rings;
+
+            for (;;)
+            {
+                bool stopping;
+                {
+                    std::unique_lock<std::mutex> lock(s_async.wakeMutex);
+                    s_async.wakeCondition.wait_for(lock, std::chrono::milliseconds(s_async.desc.flushIntervalMs), [] {
+                        return s_async.wakeRequested || s_async.stopRequested;
+                        });
+                    s_async.wakeRequested = false;
+                    stopping = s_async.stopRequested;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(s_async.ringsMutex);
+                    rings = s_async.rings;
+                }
+
+                const uint64_t count = DrainRings(rings);
+
+                // Free the rings of exited threads once they are empty.
+                {
+                    std::lock_guard<std::mutex> lock(s_async.ringsMutex);
+                    for (size_t i = 0; i < s_async.rings.size();)
+                    {
+                        LogRing* ring = s_async.rings[i];
+                        if (ring->retired.load(std::memory_order_acquire)
+                            && ring->readPosition.load(std::memory_order_relaxed) == ring->writePosition.load(std::memory_order_acquire))
+                        {
+                            FreeRing(ring);
+                            s_async.rings[i] = s_async.rings.back();
+                            s_async.rings.pop_back();
+                        }
+                        else
+                        {
+                            ++i;
+                        }
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(s_async.wakeMutex);
+                    s_async.written.fetch_add(count, std::memory_order_release);
+                }
+                s_async.flushedCondition.notify_all();
+
+                // Producers have finished by the time a stop is requested, this drain was the last one.
+                if (stopping)
+                    break;
+            }
+        }
+    }
+
     Logger::Logger(const string& name)
         : _name(name)
 #ifdef _DEBUG
@@ -79,117 +455,129 @@ namespace alimer
         return _enabled && level != LogLevel::Off && level >= _level;
     }
 
-    void Logger::Log(LogLevel level, const char* message)
+    void Logger::Write(LogLevel level, const char* message, size_t length)
     {
-        if (IsLevelEnabled(level))
-        {
+        ALIMER_UNUSED(length);
 #if defined(__ANDROID__)
-            int priority = 0;
-            switch (level)
-            {
-            case LogLevel::Trace: priority = ANDROID_LOG_VERBOSE; break;
-            case LogLevel::Debug: priority = ANDROID_LOG_DEBUG; break;
-            case LogLevel::Info: priority = ANDROID_LOG_INFO; break;
-            case LogLevel::Warning: priority = ANDROID_LOG_WARN; break;
-            case LogLevel::Error: priority = ANDROID_LOG_ERROR; break;
-            default: return;
-            }
-            __android_log_print(priority, _name.c_str(), "%s", message);
+        int priority = 0;
+        switch (level)
+        {
+        case LogLevel::Trace: priority = ANDROID_LOG_VERBOSE; break;
+        case LogLevel::Debug: priority = ANDROID_LOG_DEBUG; break;
+        case LogLevel::Info: priority = ANDROID_LOG_INFO; break;
+        case LogLevel::Warning: priority = ANDROID_LOG_WARN; break;
+        case LogLevel::Error: priority = ANDROID_LOG_ERROR; break;
+        default: return;
+        }
+        __android_log_print(priority, _name.c_str(), "%s", message);
 #elif TARGET_OS_IOS || TARGET_OS_TV
-            int priority = 0;
-            switch (level)
-            {
-            case LogLevel::Trace: priority = LOG_DEBUG; break;
-            case LogLevel::Debug: priority = LOG_DEBUG; break;
-            case LogLevel::Info: priority = LOG_INFO; break;
-            case LogLevel::Warning: priority = LOG_WARNING; break;
-            case LogLevel::Error: priority = LOG_ERR; break;
-            default: return;
-            }
-            syslog(priority, "%s", message);
+        int priority = 0;
+        switch (level)
+        {
+        case LogLevel::Trace: priority = LOG_DEBUG; break;
+        case LogLevel::Debug: priority = LOG_DEBUG; break;
+        case LogLevel::Info: priority = LOG_INFO; break;
+        case LogLevel::Warning: priority = LOG_WARNING; break;
+        case LogLevel::Error: priority = LOG_ERR; break;
+        default: return;
+        }
+        syslog(priority, "%s", message);
 #elif TARGET_OS_MAC || defined(__linux__)
-            int fd = 0;
-            switch (level)
-            {
-            case LogLevel::Trace:
-            case LogLevel::Debug:
-            case LogLevel::Info:
-                fd = STDERR_FILENO;
-                break;
-            case LogLevel::Warning:
-            case LogLevel::Error:
-                fd = STDOUT_FILENO;
-                break;
-            default: return;
-            }
+        const int fd = GetOutputFileDescriptor(level);
+        if (fd == -1)
+            return;
 
-            vector<char> output(str.begin(), str.end());
-            output.push_back('\n');
-
-            size_t offset = 0;
-            while (offset < output.size())
-            {
-                const ssize_t written = write(fd, output.data() + offset, output.size() - offset);
-                if (written == -1)
-                    return;
-
-                offset += static_cast<size_t>(written);
-            }
+        // Write message and newline together without copying into a temporary buffer.
+        iovec parts[2];
+        parts[0].iov_base = const_cast<char*>(message);
+        parts[0].iov_len = length;
+        parts[1].iov_base = const_cast<char*>("\n");
+        parts[1].iov_len = 1;
+        WriteAll(fd, parts, 2);
 #elif defined(_WIN32)
-            const int bufferSize = MultiByteToWideChar(CP_UTF8, 0, message, -1, nullptr, 0);
-            if (bufferSize == 0)
-                return;
+        const int bufferSize = MultiByteToWideChar(CP_UTF8, 0, message, -1, nullptr, 0);
+        if (bufferSize == 0)
+            return;
 
-            vector<WCHAR> buffer(bufferSize + 1); // +1 for the newline
-            if (MultiByteToWideChar(CP_UTF8, 0, message, -1, buffer.data(), static_cast<int>(buffer.size())) == 0)
-                return;
+        // Use a stack buffer for regular messages, only very long messages touch the heap.
+        WCHAR stackBuffer[kMaxLogMessage + 1];
+        vector<WCHAR> heapBuffer;
+        WCHAR* buffer = stackBuffer;
+        size_t bufferLength = kMaxLogMessage + 1;
+        if (static_cast<size_t>(bufferSize) + 1 > bufferLength)
+        {
+            heapBuffer.resize(bufferSize + 1); // +1 for the newline
+            buffer = heapBuffer.data();
+            bufferLength = heapBuffer.size();
+        }
 
-            if (FAILED(StringCchCatW(buffer.data(), buffer.size(), L"\n")))
-                return;
+        if (MultiByteToWideChar(CP_UTF8, 0, message, -1, buffer, static_cast<int>(bufferLength)) == 0)
+            return;
 
-            OutputDebugStringW(buffer.data());
+        if (FAILED(StringCchCatW(buffer, bufferLength, L"\n")))
+            return;
+
+        OutputDebugStringW(buffer);
 #   ifdef _DEBUG
-            HANDLE handle;
-            switch (level)
-            {
-            case LogLevel::Warning:
-            case LogLevel::Error:
-                handle = GetStdHandle(STD_ERROR_HANDLE);
-                break;
-            default:
-                handle = GetStdHandle(STD_OUTPUT_HANDLE);
-                break;
-            }
+        HANDLE handle;
+        switch (level)
+        {
+        case LogLevel::Warning:
+        case LogLevel::Error:
+            handle = GetStdHandle(STD_ERROR_HANDLE);
+            break;
+        default:
+            handle = GetStdHandle(STD_OUTPUT_HANDLE);
+            break;
+        }
 
-            DWORD bytesWritten;
-            WriteConsoleW(handle, buffer.data(), static_cast<DWORD>(wcslen(buffer.data())), &bytesWritten, nullptr);
+        DWORD bytesWritten;
+        WriteConsoleW(handle, buffer, static_cast<DWORD>(wcslen(buffer)), &bytesWritten, nullptr);
 #   endif
 #elif defined(__EMSCRIPTEN__)
-            int flags = EM_LOG_NO_PATHS;
-            int flags = EM_LOG_CONSOLE;
-            switch (level)
-            {
-            case LogLevel::Trace:
-            case LogLevel::Debug:
-            case LogLevel::Info:
-                flags |= EM_LOG_CONSOLE;
-                break;
+        int flags = EM_LOG_NO_PATHS;
+        int flags = EM_LOG_CONSOLE;
+        switch (level)
+        {
+        case LogLevel::Trace:
+        case LogLevel::Debug:
+        case LogLevel::Info:
+            flags |= EM_LOG_CONSOLE;
+            break;
 
-            case LogLevel::Warning:
-                flags |= EM_LOG_CONSOLE | EM_LOG_WARN;
-                break;
+        case LogLevel::Warning:
+            flags |= EM_LOG_CONSOLE | EM_LOG_WARN;
+            break;
 
-            case LogLevel::Error:
-                flags |= EM_LOG_CONSOLE | EM_LOG_ERROR;
-                break;
+        case LogLevel::Error:
+            flags |= EM_LOG_CONSOLE | EM_LOG_ERROR;
+            break;
 
-            case Log::Level::Info:
-            case Log::Level::All:
-                break;
-            default: return;
-            }
-            emscripten_log(flags, "%s", message);
+        case Log::Level::Info:
+        case Log::Level::All:
+            break;
+        default: return;
+        }
+        emscripten_log(flags, "%s", message);
 #endif
+    }
+
+    void Logger::Log(LogLevel level, const char* message)
+    {
+        if (!IsLevelEnabled(level))
+            return;
+
+        const size_t length = strlen(message);
+        if (!EnqueueAsync(this, level, message, length))
+        {
+            Write(level, message, length);
+            return;
+        }
+
+        // Errors usually precede a crash, make sure they reach the output.
+        if (level >= LogLevel::Error)
+        {
+            Log::Flush();
         }
     }
 
@@ -223,4 +611,103 @@ namespace alimer
         static Logger defaultLogger("alimer");
         return &defaultLogger;
     }
+
+    void Log::StartAsync(const AsyncLogDesc& desc)
+    {
+#if defined(ALIMER_THREADING)
+        if (IsAsync())
+            return;
+
+        // Round up to a power of two so positions wrap with a mask.
+        uint32_t bufferSize = 4096;
+        while (bufferSize < desc.bufferSize)
+        {
+            bufferSize <<= 1;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(s_async.ringsMutex);
+            s_async.desc = desc;
+            s_async.desc.bufferSize = bufferSize;
+        }
+
+        s_async.running.store(true, std::memory_order_release);
+        s_async.writer = std::thread(WriterMain);
+#else
+        ALIMER_UNUSED(desc);
+#endif
+    }
+
+    void Log::StopAsync()
+    {
+        if (!IsAsync())
+            return;
+
+        // New messages go to the platform output from here on, wait for the ones being queued.
+        // The lock is dropped between checks, a blocked producer needs the writer to keep draining.
+        s_async.running.store(false, std::memory_order_seq_cst);
+        for (;;)
+        {
+            bool busy = false;
+            {
+                std::lock_guard<std::mutex> lock(s_async.ringsMutex);
+                for (LogRing* ring : s_async.rings)
+                {
+                    busy = busy || ring->busy.load(std::memory_order_seq_cst);
+                }
+            }
+
+            if (!busy)
+                break;
+
+            std::this_thread::yield();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(s_async.wakeMutex);
+            s_async.stopRequested = true;
+        }
+        s_async.wakeCondition.notify_one();
+        s_async.writer.join();
+        s_async.stopRequested = false;
+
+        // The writer drained everything on its way out. Rings of exited threads are freed, the others are only
+        // unlisted since their threads may still hold them, the new generation makes them free and replace them.
+        std::lock_guard<std::mutex> lock(s_async.ringsMutex);
+        for (LogRing* ring : s_async.rings)
+        {
+            if (ring->retired.load(std::memory_order_acquire))
+            {
+                FreeRing(ring);
+            }
+        }
+
+        s_async.rings.clear();
+        s_async.generation.fetch_add(1, std::memory_order_release);
+    }
+
+    bool Log::IsAsync()
+    {
+        return s_async.running.load(std::memory_order_acquire);
+    }
+
+    void Log::Flush()
+    {
+        if (!IsAsync())
+            return;
+
+        const uint64_t target = s_async.enqueued.load(std::memory_order_relaxed);
+
+        std::unique_lock<std::mutex> lock(s_async.wakeMutex);
+        s_async.wakeRequested = true;
+        s_async.wakeCondition.notify_one();
+        s_async.flushedCondition.wait_for(lock, std::chrono::milliseconds(s_async.desc.flushTimeoutMs), [target] {
+            return s_async.written.load(std::memory_order_acquire) >= target;
+            });
+    }
+
+    uint64_t Log::GetDroppedCount()
+    {
+        return s_async.dropped.load(std::memory_order_relaxed);
+    }
 }
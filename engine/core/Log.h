@@ -39,6 +39,27 @@ namespace alimer
         Off
     };
 
+    /// What a thread does when its async log buffer is full.
+    enum class LogOverflowPolicy : uint32_t
+    {
+        /// Drop the message and count it, logging never blocks.
+        Drop,
+        /// Wait for the writer thread to make room.
+        Block
+    };
+
+    /// Async logging configuration.
+    struct AsyncLogDesc
+    {
+        /// Size in bytes of each per thread ring buffer, rounded up to a power of two.
+        uint32_t bufferSize = 64 * 1024;
+        LogOverflowPolicy overflowPolicy = LogOverflowPolicy::Drop;
+        /// How often the writer thread wakes up to drain the buffers.
+        uint32_t flushIntervalMs = 10;
+        /// Maximum time an error message or an assert waits for the log to be written.
+        uint32_t flushTimeoutMs = 100;
+    };
+
     class ALIMER_API Logger final
     {
     public:
@@ -53,6 +74,9 @@ namespace alimer
         void Log(LogLevel level, const std::string& message);
         void LogFormat(LogLevel level, const char* format, ...);
 
+        /// Write a message to the platform output right away, bypassing async logging.
+        void Write(LogLevel level, const char* message, size_t length);
+
     private:
         std::string _name;
         bool _enabled = true;
@@ -63,6 +87,18 @@ namespace alimer
     {
     public:
         static Logger* GetDefault();
+
+        /// Start the background writer, messages are queued in per thread lock-free buffers.
+        static void StartAsync(const AsyncLogDesc& desc);
+        /// Write pending messages and stop the background writer, messages logged meanwhile go to the platform output.
+        static void StopAsync();
+        static bool IsAsync();
+
+        /// Wait until messages queued so far are written, or the flush timeout expires.
+        static void Flush();
+
+        /// Return the number of messages dropped because a buffer was full.
+        static uint64_t GetDroppedCount();
     };
 }
 
@@ -71,8 +107,11 @@ namespace alimer
 #define ALIMER_LOGWARN(message) alimer::Log::GetDefault()->Log(alimer::LogLevel::Warning, message)
 #define ALIMER_LOGERROR(message) alimer::Log::GetDefault()->Log(alimer::LogLevel::Error, message)
 
-#define ALIMER_TRACE(message, ...) alimer::Log::GetDefault()->LogFormat(alimer::LogLevel::Trace, message, ##__VA_ARGS__)
+/// Trace messages go through the binary log when it is open, see BinaryLog.
+#define ALIMER_TRACE(message, ...) ALIMER_LOG_BINARY(alimer::LogLevel::Trace, message, ##__VA_ARGS__)
 #define ALIMER_LOGD(message, ...) alimer::Log::GetDefault()->LogFormat(alimer::LogLevel::Debug, message, ##__VA_ARGS__)
 #define ALIMER_LOGI(message, ...) alimer::Log::GetDefault()->LogFormat(alimer::LogLevel::Info, message, ##__VA_ARGS__)
 #define ALIMER_LOGW(message, ...) alimer::Log::GetDefault()->LogFormat(alimer::LogLevel::Warning, message, ##__VA_ARGS__)
 #define ALIMER_LOGE(message, ...) alimer::Log::GetDefault()->LogFormat(alimer::LogLevel::Error, message, ##__VA_ARGS__)
+
+#include "core/BinaryLog.h"
@@ -20,7 +20,9 @@
 // THE SOFTWARE.
 //
 
+#include "config.h"
 #include "core/Object.h"
+#include "core/Assert.h"
 
 namespace alimer
 {
@@ -29,35 +31,40 @@ namespace alimer
         , typeName(typeName_)
         , baseTypeInfo(baseTypeInfo_)
     {
+        InitializeAncestors();
+    }
 
+    TypeInfo::TypeInfo(StringId32 type_, const char* typeName_, const TypeInfo* baseTypeInfo_)
+        : type(type_)
+        , typeName(typeName_)
+        , baseTypeInfo(baseTypeInfo_)
+    {
+#if defined(ALIMER_STRINGID_NAMES)
+        // Hashing the name at runtime records it for ToString and checks the compile time hash.
+        ALIMER_ASSERT(StringId32(typeName_) == type);
+#endif
+        InitializeAncestors();
     }
 
-    bool TypeInfo::IsTypeOf(StringId32 type) const
+    void TypeInfo::InitializeAncestors()
     {
-        const TypeInfo* current = this;
-        while (current)
+        // Base type infos are constructed first, so their chain is already complete.
+        if (baseTypeInfo != nullptr)
         {
-            if (current->GetType() == type)
-                return true;
-
-            current = current->GetBaseTypeInfo();
+            ancestorTypes.reserve(baseTypeInfo->ancestorTypes.size() + 1);
+            ancestorTypes.assign(baseTypeInfo->ancestorTypes.begin(), baseTypeInfo->ancestorTypes.end());
         }
 
-        return false;
+        ancestorTypes.push_back(type);
+        depth = static_cast<uint32_t>(ancestorTypes.size() - 1);
     }
 
-    bool TypeInfo::IsTypeOf(const TypeInfo* typeInfo) const
+    bool TypeInfo::IsTypeOf(StringId32 type) const
     {
-        if (typeInfo == nullptr)
-            return false;
-
-        const TypeInfo* current = this;
-        while (current)
+        for (StringId32 ancestorType : ancestorTypes)
         {
-            if (current == typeInfo || current->GetType() == typeInfo->GetType())
+            if (ancestorType == type)
                 return true;
-
-            current = current->GetBaseTypeInfo();
         }
 
         return false;
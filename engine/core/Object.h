@@ -35,13 +35,20 @@ namespace alimer
     public:
         /// Construct.
         TypeInfo(const char* typeName_, const TypeInfo* baseTypeInfo_);
+        /// Construct with the type hash computed at compile time.
+        TypeInfo(StringId32 type_, const char* typeName_, const TypeInfo* baseTypeInfo_);
         /// Destruct.
         ~TypeInfo() = default;
 
         /// Check current type is type of specified type.
         bool IsTypeOf(StringId32 type) const;
-        /// Check current type is type of specified type.
-        bool IsTypeOf(const TypeInfo* typeInfo) const;
+        /// Check current type is type of specified type, a single compare against the ancestor at its depth.
+        bool IsTypeOf(const TypeInfo* typeInfo) const
+        {
+            return typeInfo != nullptr
+                && typeInfo->depth <= depth
+                && ancestorTypes[typeInfo->depth] == typeInfo->type;
+        }
         /// Check current type is type of specified class type.
         template<typename T> bool IsTypeOf() const { return IsTypeOf(T::GetTypeInfoStatic()); }
 
@@ -51,14 +58,23 @@ namespace alimer
         const std::string& GetTypeName() const { return typeName; }
         /// Return base type info.
         const TypeInfo* GetBaseTypeInfo() const { return baseTypeInfo; }
+        /// Return number of base classes.
+        uint32_t GetDepth() const { return depth; }
 
     private:
+        /// Fill the ancestor types from the base type info.
+        void InitializeAncestors();
+
         /// Type.
         StringId32 type;
         /// Type name.
         std::string typeName;
         /// Base class type info.
         const TypeInfo* baseTypeInfo;
+        /// Number of base classes.
+        uint32_t depth;
+        /// Types from the root class down to this one, indexed by depth.
+        std::vector<StringId32> ancestorTypes;
     };
 
     /// Base class for objects with type identification, subsystem access
@@ -98,9 +114,9 @@ namespace alimer
     public: \
         using ClassName = typeName; \
         using BaseClassName = baseTypeName; \
-        virtual alimer::StringId32 GetType() const override { return GetTypeInfoStatic()->GetType(); } \
+        virtual alimer::StringId32 GetType() const override { return GetTypeStatic(); } \
         virtual const std::string& GetTypeName() const override { return GetTypeInfoStatic()->GetTypeName(); } \
         virtual const alimer::TypeInfo* GetTypeInfo() const override { return GetTypeInfoStatic(); } \
-        static alimer::StringId32 GetTypeStatic() { return GetTypeInfoStatic()->GetType(); } \
+        static alimer::StringId32 GetTypeStatic() { return ALIMER_STRINGID32(#typeName); } \
         static const std::string& GetTypeNameStatic() { return GetTypeInfoStatic()->GetTypeName(); } \
-        static const alimer::TypeInfo* GetTypeInfoStatic() { static const alimer::TypeInfo typeInfoStatic(#typeName, BaseClassName::GetTypeInfoStatic()); return &typeInfoStatic; } \
+        static const alimer::TypeInfo* GetTypeInfoStatic() { static const alimer::TypeInfo typeInfoStatic(GetTypeStatic(), #typeName, BaseClassName::GetTypeInfoStatic()); return &typeInfoStatic; } \
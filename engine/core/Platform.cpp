@@ -34,6 +34,15 @@
 #include <unistd.h>
 #endif
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#   define ALIMER_CPU_X86 1
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   else
+#       include <cpuid.h>
+#   endif
+#endif
+
 using namespace std;
 
 namespace alimer
@@ -163,6 +172,76 @@ namespace alimer
 #endif
     }
 
+#if defined(ALIMER_CPU_X86)
+    namespace
+    {
+        void QueryCpuId(uint32_t leaf, uint32_t subLeaf, uint32_t regs[4])
+        {
+#if defined(_MSC_VER)
+            __cpuidex(reinterpret_cast<int*>(regs), static_cast<int>(leaf), static_cast<int>(subLeaf));
+#else
+            if (!__get_cpuid_count(leaf, subLeaf, &regs[0], &regs[1], &regs[2], &regs[3]))
+            {
+                regs[0] = regs[1] = regs[2] = regs[3] = 0;
+            }
+#endif
+        }
+
+        uint64_t QueryXCR0()
+        {
+#if defined(_MSC_VER)
+            return _xgetbv(0);
+#else
+            uint32_t eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+        }
+    }
+#endif
+
+    static CpuFeatures DetectCpuFeatures()
+    {
+        CpuFeatures features;
+
+#if defined(ALIMER_CPU_X86)
+        uint32_t regs[4];
+        QueryCpuId(0, 0, regs);
+        const uint32_t maxLeaf = regs[0];
+
+        QueryCpuId(1, 0, regs);
+        features.sse2 = (regs[3] & (1u << 26)) != 0;
+        features.sse41 = (regs[2] & (1u << 19)) != 0;
+
+        // AVX state must also be enabled by the OS, otherwise using ymm/zmm registers faults.
+        const bool osxsave = (regs[2] & (1u << 27)) != 0;
+        const uint64_t xcr0 = osxsave ? QueryXCR0() : 0;
+        const bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+        const bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+
+        features.avx = ymmEnabled && (regs[2] & (1u << 28)) != 0;
+        features.fma = features.avx && (regs[2] & (1u << 12)) != 0;
+        features.f16c = features.avx && (regs[2] & (1u << 29)) != 0;
+
+        if (maxLeaf >= 7)
+        {
+            QueryCpuId(7, 0, regs);
+            features.avx2 = features.avx && (regs[1] & (1u << 5)) != 0;
+            features.avx512f = zmmEnabled && (regs[1] & (1u << 16)) != 0;
+        }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM) || defined(_M_ARM64)
+        features.neon = true;
+#endif
+
+        return features;
+    }
+
+    const CpuFeatures& Platform::GetCpuFeatures()
+    {
+        static const CpuFeatures features = DetectCpuFeatures();
+        return features;
+    }
+
     void Platform::SetArguments(const vector<string>& args)
     {
         arguments = args;
@@ -79,6 +79,19 @@ namespace alimer
 
     using ProcessId = uint32_t;
 
+    /// Instruction set extensions supported by the CPU and enabled by the OS.
+    struct CpuFeatures
+    {
+        bool sse2 = false;
+        bool sse41 = false;
+        bool avx = false;
+        bool avx2 = false;
+        bool fma = false;
+        bool f16c = false;
+        bool avx512f = false;
+        bool neon = false;
+    };
+
     class ALIMER_API Platform
     {
     public:
@@ -99,6 +112,9 @@ namespace alimer
         /// Returns the current process id (pid)
         ALIMER_API ProcessId GetCurrentProcessId();
 
+        /// Return the CPU features, detected once on first call.
+        static const CpuFeatures& GetCpuFeatures();
+
         /// Set command line arguments.
         static void SetArguments(const std::vector<std::string>& args);
 
@@ -0,0 +1,392 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "core/Profiler.h"
+#include "core/Stopwatch.h"
+#include "core/Log.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace alimer
+{
+    namespace
+    {
+        struct ProfileEvent
+        {
+            uint64_t timestamp;
+            /// Zone name for begin events, null for end events.
+            const char* name;
+        };
+
+        /// Ring of events written by one thread, the exporter reads it while the thread is idle.
+        struct ThreadEvents
+        {
+            ProfileEvent events[Profiler::kMaxEventsPerThread];
+            std::atomic<uint64_t> count{ 0 };
+            uint32_t threadId = 0;
+            char name[64] = {};
+        };
+
+        /// Matched zone ready to export.
+        struct Zone
+        {
+            const char* name;
+            uint64_t begin;
+            uint64_t end;
+            uint32_t depth;
+        };
+
+        static struct {
+            std::mutex mutex;
+            std::vector<ThreadEvents*> threads;
+            std::atomic<uint32_t> nextThreadId{ 0 };
+        } s_profiler;
+
+        ThreadEvents* RegisterThread()
+        {
+            ThreadEvents* events = new ThreadEvents();
+            events->threadId = s_profiler.nextThreadId.fetch_add(1);
+            snprintf(events->name, sizeof(events->name), "Thread %u", events->threadId);
+
+            std::lock_guard<std::mutex> lock(s_profiler.mutex);
+            s_profiler.threads.push_back(events);
+            return events;
+        }
+
+        static thread_local ThreadEvents* s_threadEvents = nullptr;
+
+        /// Buffers outlive their thread so zones of finished threads can still be exported.
+        inline ThreadEvents* GetThreadEvents()
+        {
+            if (s_threadEvents == nullptr)
+            {
+                s_threadEvents = RegisterThread();
+            }
+
+            return s_threadEvents;
+        }
+
+        inline void Record(const char* name)
+        {
+            ThreadEvents* thread = GetThreadEvents();
+            const uint64_t index = thread->count.load(std::memory_order_relaxed);
+            ProfileEvent& event = thread->events[index & (Profiler::kMaxEventsPerThread - 1)];
+            event.timestamp = Stopwatch::GetTimestamp();
+            event.name = name;
+            thread->count.store(index + 1, std::memory_order_release);
+        }
+
+        /// Pair begin and end events, zones cut by the ring wrapping around or still open are skipped.
+        void CollectZones(const ThreadEvents& thread, std::vector<Zone>& zones)
+        {
+            const uint64_t count = thread.count.load(std::memory_order_acquire);
+            const uint64_t first = count > Profiler::kMaxEventsPerThread ? count - Profiler::kMaxEventsPerThread : 0;
+
+            std::vector<Zone> stack;
+            for (uint64_t i = first; i < count; ++i)
+            {
+                const ProfileEvent& event = thread.events[i & (Profiler::kMaxEventsPerThread - 1)];
+                if (event.name != nullptr)
+                {
+                    stack.push_back({ event.name, event.timestamp, 0, static_cast<uint32_t>(stack.size()) });
+                }
+                else if (!stack.empty())
+                {
+                    Zone zone = stack.back();
+                    stack.pop_back();
+                    zone.end = event.timestamp;
+                    zones.push_back(zone);
+                }
+            }
+        }
+
+        void WriteJsonString(FILE* file, const char* value)
+        {
+            fputc('"', file);
+            for (const char* c = value; *c; ++c)
+            {
+                switch (*c)
+                {
+                case '"': fputs("\\\"", file); break;
+                case '\\': fputs("\\\\", file); break;
+                case '\n': fputs("\\n", file); break;
+                default:
+                    if (static_cast<unsigned char>(*c) < 0x20)
+                        fprintf(file, "\\u%04x", *c);
+                    else
+                        fputc(*c, file);
+                    break;
+                }
+            }
+            fputc('"', file);
+        }
+
+        /// Minimal protobuf writer for the Perfetto trace format.
+        class ProtoWriter
+        {
+        public:
+            void Varint(uint64_t value)
+            {
+                while (value >= 0x80)
+                {
+                    data.push_back(static_cast<uint8_t>(value | 0x80));
+                    value >>= 7;
+                }
+                data.push_back(static_cast<uint8_t>(value));
+            }
+
+            void Tag(uint32_t field, uint32_t wireType) { Varint((uint64_t(field) << 3) | wireType); }
+            void UInt(uint32_t field, uint64_t value) { Tag(field, 0); Varint(value); }
+
+            void Bytes(uint32_t field, const void* bytes, size_t size)
+            {
+                Tag(field, 2);
+                Varint(size);
+                const uint8_t* begin = static_cast<const uint8_t*>(bytes);
+                data.insert(data.end(), begin, begin + size);
+            }
+
+            void String(uint32_t field, const char* value) { Bytes(field, value, strlen(value)); }
+            void Message(uint32_t field, const ProtoWriter& message) { Bytes(field, message.data.data(), message.data.size()); }
+
+            std::vector<uint8_t> data;
+        };
+
+        /// Field numbers from perfetto/trace/trace_packet.proto and track_event.proto.
+        namespace Perfetto
+        {
+            static constexpr uint32_t kTracePacket = 1;
+            static constexpr uint32_t kPacketTimestamp = 8;
+            static constexpr uint32_t kPacketSequenceId = 10;
+            static constexpr uint32_t kPacketTrackEvent = 11;
+            static constexpr uint32_t kPacketTrackDescriptor = 60;
+            static constexpr uint32_t kTrackEventType = 9;
+            static constexpr uint32_t kTrackEventTrackUuid = 11;
+            static constexpr uint32_t kTrackEventName = 23;
+            static constexpr uint32_t kTrackDescriptorUuid = 1;
+            static constexpr uint32_t kTrackDescriptorThread = 4;
+            static constexpr uint32_t kThreadPid = 1;
+            static constexpr uint32_t kThreadTid = 2;
+            static constexpr uint32_t kThreadName = 5;
+            static constexpr uint64_t kSliceBegin = 1;
+            static constexpr uint64_t kSliceEnd = 2;
+        }
+
+        inline uint64_t ToNanoseconds(uint64_t timestamp, uint64_t start, uint64_t frequency)
+        {
+            const uint64_t ticks = timestamp - start;
+            return (ticks / frequency) * 1000000000ull + (ticks % frequency) * 1000000000ull / frequency;
+        }
+
+        uint64_t GetStartTimestamp(const std::vector<std::vector<Zone>>& threadZones)
+        {
+            uint64_t start = UINT64_MAX;
+            for (const auto& zones : threadZones)
+            {
+                for (const Zone& zone : zones)
+                {
+                    start = zone.begin < start ? zone.begin : start;
+                }
+            }
+
+            return start == UINT64_MAX ? 0 : start;
+        }
+    }
+
+    void Profiler::BeginZone(const char* name)
+    {
+        Record(name);
+    }
+
+    void Profiler::EndZone()
+    {
+        Record(nullptr);
+    }
+
+    void Profiler::SetThreadName(const char* name)
+    {
+        ThreadEvents* thread = GetThreadEvents();
+        snprintf(thread->name, sizeof(thread->name), "%s", name);
+    }
+
+    void Profiler::Shutdown()
+    {
+        std::lock_guard<std::mutex> lock(s_profiler.mutex);
+        for (ThreadEvents* thread : s_profiler.threads)
+        {
+            delete thread;
+        }
+
+        s_profiler.threads.clear();
+        s_threadEvents = nullptr;
+    }
+
+    bool Profiler::ExportTrace(const char* fileName)
+    {
+        const size_t length = strlen(fileName);
+        if (length >= 5 && strcmp(fileName + length - 5, ".json") == 0)
+        {
+            return ExportChromeTrace(fileName);
+        }
+
+        return ExportPerfettoTrace(fileName);
+    }
+
+    bool Profiler::ExportChromeTrace(const char* fileName)
+    {
+        FILE* file = fopen(fileName, "w");
+        if (file == nullptr)
+        {
+            ALIMER_LOGE("Profiler: Failed to open '%s'", fileName);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(s_profiler.mutex);
+        std::vector<std::vector<Zone>> threadZones(s_profiler.threads.size());
+        for (size_t i = 0; i < s_profiler.threads.size(); ++i)
+        {
+            CollectZones(*s_profiler.threads[i], threadZones[i]);
+        }
+
+        const uint64_t start = GetStartTimestamp(threadZones);
+        const uint64_t frequency = Stopwatch::GetFrequency();
+
+        fputs("{\"traceEvents\":[\n", file);
+        bool first = true;
+        for (size_t i = 0; i < s_profiler.threads.size(); ++i)
+        {
+            const ThreadEvents& thread = *s_profiler.threads[i];
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", thread.threadId);
+            WriteJsonString(file, thread.name);
+            fputs("}}", file);
+            first = false;
+
+            // Complete events, timestamps in microseconds.
+            for (const Zone& zone : threadZones[i])
+            {
+                fputs(",\n{\"name\":", file);
+                WriteJsonString(file, zone.name);
+                fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    thread.threadId,
+                    double(ToNanoseconds(zone.begin, start, frequency)) / 1000.0,
+                    double(ToNanoseconds(zone.end, zone.begin, frequency)) / 1000.0);
+            }
+        }
+
+        fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+        fclose(file);
+        return true;
+    }
+
+    bool Profiler::ExportPerfettoTrace(const char* fileName)
+    {
+        FILE* file = fopen(fileName, "wb");
+        if (file == nullptr)
+        {
+            ALIMER_LOGE("Profiler: Failed to open '%s'", fileName);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(s_profiler.mutex);
+        std::vector<std::vector<Zone>> threadZones(s_profiler.threads.size());
+        for (size_t i = 0; i < s_profiler.threads.size(); ++i)
+        {
+            CollectZones(*s_profiler.threads[i], threadZones[i]);
+        }
+
+        const uint64_t start = GetStartTimestamp(threadZones);
+        const uint64_t frequency = Stopwatch::GetFrequency();
+
+        ProtoWriter trace;
+        for (size_t i = 0; i < s_profiler.threads.size(); ++i)
+        {
+            const ThreadEvents& thread = *s_profiler.threads[i];
+            const uint64_t trackUuid = thread.threadId + 1;
+            const uint32_t sequenceId = thread.threadId + 1;
+
+            // One track per thread.
+            ProtoWriter threadDescriptor;
+            threadDescriptor.UInt(Perfetto::kThreadPid, 1);
+            threadDescriptor.UInt(Perfetto::kThreadTid, thread.threadId + 1);
+            threadDescriptor.String(Perfetto::kThreadName, thread.name);
+
+            ProtoWriter trackDescriptor;
+            trackDescriptor.UInt(Perfetto::kTrackDescriptorUuid, trackUuid);
+            trackDescriptor.Message(Perfetto::kTrackDescriptorThread, threadDescriptor);
+
+            ProtoWriter descriptorPacket;
+            descriptorPacket.UInt(Perfetto::kPacketSequenceId, sequenceId);
+            descriptorPacket.Message(Perfetto::kPacketTrackDescriptor, trackDescriptor);
+            trace.Message(Perfetto::kTracePacket, descriptorPacket);
+
+            // Zones are collected in end order, emit slices in begin order so nesting is preserved.
+            std::vector<Zone> ordered(threadZones[i]);
+            std::sort(ordered.begin(), ordered.end(), [](const Zone& a, const Zone& b) {
+                return a.begin < b.begin || (a.begin == b.begin && a.depth < b.depth);
+                });
+
+            std::vector<const Zone*> open;
+            auto writeEvent = [&](uint64_t timestamp, uint64_t type, const char* name) {
+                ProtoWriter trackEvent;
+                trackEvent.UInt(Perfetto::kTrackEventType, type);
+                trackEvent.UInt(Perfetto::kTrackEventTrackUuid, trackUuid);
+                if (name != nullptr)
+                {
+                    trackEvent.String(Perfetto::kTrackEventName, name);
+                }
+
+                ProtoWriter packet;
+                packet.UInt(Perfetto::kPacketTimestamp, ToNanoseconds(timestamp, start, frequency));
+                packet.UInt(Perfetto::kPacketSequenceId, sequenceId);
+                packet.Message(Perfetto::kPacketTrackEvent, trackEvent);
+                trace.Message(Perfetto::kTracePacket, packet);
+            };
+
+            for (const Zone& zone : ordered)
+            {
+                while (!open.empty() && open.back()->end <= zone.begin)
+                {
+                    writeEvent(open.back()->end, Perfetto::kSliceEnd, nullptr);
+                    open.pop_back();
+                }
+
+                writeEvent(zone.begin, Perfetto::kSliceBegin, zone.name);
+                open.push_back(&zone);
+            }
+
+            while (!open.empty())
+            {
+                writeEvent(open.back()->end, Perfetto::kSliceEnd, nullptr);
+                open.pop_back();
+            }
+        }
+
+        fwrite(trace.data.data(), 1, trace.data.size(), file);
+        fclose(file);
+        return true;
+    }
+}
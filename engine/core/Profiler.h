@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "config.h"
+#include "core/Preprocessor.h"
+
+namespace alimer
+{
+    /// Hierarchical CPU profiler, records zone begin/end timestamps into per thread buffers.
+    class ALIMER_API Profiler final
+    {
+    public:
+        /// Number of events each thread keeps, older events are overwritten.
+        static constexpr uint32_t kMaxEventsPerThread = 64 * 1024;
+
+        /// Begin a zone, name must stay valid until the trace is exported.
+        static void BeginZone(const char* name);
+        static void EndZone();
+
+        /// Set the name the calling thread shows with in the trace.
+        static void SetThreadName(const char* name);
+
+        /// Export the recorded zones, threads must not record while exporting.
+        /// Files ending in .json are written in Chrome trace format, anything else as a Perfetto protobuf trace.
+        static bool ExportTrace(const char* fileName);
+        static bool ExportChromeTrace(const char* fileName);
+        static bool ExportPerfettoTrace(const char* fileName);
+
+        /// Free the buffers of all threads, no thread may record afterwards.
+        static void Shutdown();
+    };
+
+    /// Records a zone for the lifetime of the object.
+    class ProfileScope final
+    {
+    public:
+        explicit ProfileScope(const char* name) { Profiler::BeginZone(name); }
+        ~ProfileScope() { Profiler::EndZone(); }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+    };
+}
+
+#define ALIMER_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ALIMER_PROFILE_CONCAT(a, b) ALIMER_PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(ALIMER_PROFILING)
+#   define ALIMER_PROFILE_SCOPE(name) alimer::ProfileScope ALIMER_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#   define ALIMER_PROFILE_FUNCTION() ALIMER_PROFILE_SCOPE(__FUNCTION__)
+#   define ALIMER_PROFILE_THREAD(name) alimer::Profiler::SetThreadName(name)
+#else
+#   define ALIMER_PROFILE_SCOPE(name)
+#   define ALIMER_PROFILE_FUNCTION()
+#   define ALIMER_PROFILE_THREAD(name)
+#endif
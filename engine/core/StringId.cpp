@@ -20,29 +20,90 @@
 // THE SOFTWARE.
 //
 
+#include "config.h"
 #include "core/StringId.h"
 #include "core/String.h"
 #include "core/Hash.h"
+#include <cstring>
 #include <inttypes.h> // PRIx64
 
+#if defined(ALIMER_STRINGID_NAMES)
+#include "core/Assert.h"
+#include "core/FlatHashMap.h"
+#include <mutex>
+#endif
+
 namespace alimer
 {
+#if defined(ALIMER_STRINGID_NAMES)
+    namespace
+    {
+        /// Strings behind runtime hashed ids, looked up by ToString.
+        template <typename Id>
+        class NameTable
+        {
+        public:
+            static NameTable& Get()
+            {
+                static NameTable table;
+                return table;
+            }
+
+            void Record(Id id, const char* str, size_t length)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto result = names.Emplace(id, str, length);
+                ALIMER_ASSERT_MSG(result.second || result.first->compare(0, std::string::npos, str, length) == 0,
+                    "StringId collision between '%s' and '%.*s'", result.first->c_str(), static_cast<int>(length), str);
+            }
+
+            bool Find(Id id, std::string& name)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                const std::string* found = names.Find(id);
+                if (found == nullptr)
+                    return false;
+
+                name = *found;
+                return true;
+            }
+
+        private:
+            std::mutex mutex;
+            FlatHashMap<Id, std::string> names;
+        };
+    }
+#endif
+
     const StringId32 StringId32::Zero;
     const StringId64 StringId64::Zero;
 
     /* StringId32 */
     StringId32::StringId32(const char* str) noexcept
     {
-        value = murmur32(str, (uint32_t)strlen(str), 0);
+        const size_t length = strlen(str);
+        value = murmur32(str, (uint32_t)length, 0);
+#if defined(ALIMER_STRINGID_NAMES)
+        NameTable<StringId32>::Get().Record(*this, str, length);
+#endif
     }
 
     StringId32::StringId32(const std::string& str) noexcept
     {
         value = murmur32(str.c_str(), (uint32_t)str.length(), 0);
+#if defined(ALIMER_STRINGID_NAMES)
+        NameTable<StringId32>::Get().Record(*this, str.c_str(), str.length());
+#endif
     }
 
     std::string StringId32::ToString() const
     {
+#if defined(ALIMER_STRINGID_NAMES)
+        std::string name;
+        if (NameTable<StringId32>::Get().Find(*this, name))
+            return name;
+#endif
+
         char tempBuffer[CONVERSION_BUFFER_LENGTH];
         sprintf(tempBuffer, "%08X", value);
         return std::string(tempBuffer);
@@ -51,16 +112,29 @@ namespace alimer
     /* StringId64 */
     StringId64::StringId64(const char* str) noexcept
     {
-        value = murmur64(str, (uint64_t)strlen(str), 0);
+        const size_t length = strlen(str);
+        value = murmur64(str, (uint64_t)length, 0);
+#if defined(ALIMER_STRINGID_NAMES)
+        NameTable<StringId64>::Get().Record(*this, str, length);
+#endif
     }
 
     StringId64::StringId64(const std::string& str) noexcept
     {
         value = murmur64(str.c_str(), (uint64_t)str.length(), 0);
+#if defined(ALIMER_STRINGID_NAMES)
+        NameTable<StringId64>::Get().Record(*this, str.c_str(), str.length());
+#endif
     }
 
     std::string StringId64::ToString() const
     {
+#if defined(ALIMER_STRINGID_NAMES)
+        std::string name;
+        if (NameTable<StringId64>::Get().Find(*this, name))
+            return name;
+#endif
+
         char tempBuffer[CONVERSION_BUFFER_LENGTH];
         sprintf(tempBuffer, "%16" PRIx64, value);
         return std::string(tempBuffer);
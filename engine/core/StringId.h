@@ -22,8 +22,10 @@
 
 #pragma once
 
-#include "core/Preprocessor.h"
+#include "config.h"
+#include "core/Hash.h"
 #include <string>
+#include <type_traits>
 
 namespace alimer
 {
@@ -32,7 +34,7 @@ namespace alimer
     {
     public:
         /// Construct with zero value.
-        StringId32() noexcept
+        constexpr StringId32() noexcept
             : value(0)
         {
         }
@@ -41,12 +43,12 @@ namespace alimer
         StringId32(const StringId32& rhs) noexcept = default;
 
         /// Construct with an initial value.
-        explicit StringId32(uint32_t value_) noexcept
+        constexpr explicit StringId32(uint32_t value_) noexcept
             : value(value_)
         {
         }
 
-        /// Construct from a C string.
+        /// Construct from a C string. The name is recorded for ToString when ALIMER_STRINGID_NAMES is enabled.
         StringId32(const char* str) noexcept;
         /// Construct from a string.
         StringId32(const std::string& str) noexcept;
@@ -70,26 +72,30 @@ namespace alimer
         }
 
         /// Test for equality with another hash.
-        bool operator ==(const StringId32& rhs) const { return value == rhs.value; }
+        constexpr bool operator ==(const StringId32& rhs) const { return value == rhs.value; }
 
         /// Test for inequality with another hash.
-        bool operator !=(const StringId32& rhs) const { return value != rhs.value; }
+        constexpr bool operator !=(const StringId32& rhs) const { return value != rhs.value; }
 
         /// Test if less than another hash.
-        bool operator <(const StringId32& rhs) const { return value < rhs.value; }
+        constexpr bool operator <(const StringId32& rhs) const { return value < rhs.value; }
 
         /// Test if greater than another hash.
-        bool operator >(const StringId32& rhs) const { return value > rhs.value; }
+        constexpr bool operator >(const StringId32& rhs) const { return value > rhs.value; }
 
         /// Return true if nonzero hash value.
-        explicit operator bool() const { return value != 0; }
+        constexpr explicit operator bool() const { return value != 0; }
 
         /// Return hash value.
-        uint32_t Value() const { return value; }
+        constexpr uint32_t Value() const { return value; }
 
-        /// Return as string.
+        /// Return the recorded name if known, the hex value otherwise.
         std::string ToString() const;
 
+        /// Hash a string literal at compile time. The name is never recorded, prefer ALIMER_STRINGID32 or _sid.
+        template <size_t N>
+        static constexpr StringId32 FromLiteral(const char (&str)[N]) { return StringId32(const_murmur32(str, N - 1, 0)); }
+
         /// Zero hash.
         static const StringId32 Zero;
 
@@ -103,7 +109,7 @@ namespace alimer
     {
     public:
         /// Construct with zero value.
-        StringId64() noexcept
+        constexpr StringId64() noexcept
             : value(0)
         {
         }
@@ -112,12 +118,12 @@ namespace alimer
         StringId64(const StringId64& rhs) noexcept = default;
 
         /// Construct with an initial value.
-        explicit StringId64(uint64_t value_) noexcept
+        constexpr explicit StringId64(uint64_t value_) noexcept
             : value(value_)
         {
         }
 
-        /// Construct from a C string.
+        /// Construct from a C string. The name is recorded for ToString when ALIMER_STRINGID_NAMES is enabled.
         StringId64(const char* str) noexcept;
         /// Construct from a string.
         StringId64(const std::string& str) noexcept;
@@ -141,26 +147,30 @@ namespace alimer
         }
 
         /// Test for equality with another hash.
-        bool operator ==(const StringId64& rhs) const { return value == rhs.value; }
+        constexpr bool operator ==(const StringId64& rhs) const { return value == rhs.value; }
 
         /// Test for inequality with another hash.
-        bool operator !=(const StringId64& rhs) const { return value != rhs.value; }
+        constexpr bool operator !=(const StringId64& rhs) const { return value != rhs.value; }
 
         /// Test if less than another hash.
-        bool operator <(const StringId64& rhs) const { return value < rhs.value; }
+        constexpr bool operator <(const StringId64& rhs) const { return value < rhs.value; }
 
         /// Test if greater than another hash.
-        bool operator >(const StringId64& rhs) const { return value > rhs.value; }
+        constexpr bool operator >(const StringId64& rhs) const { return value > rhs.value; }
 
         /// Return true if nonzero hash value.
-        explicit operator bool() const { return value != 0; }
+        constexpr explicit operator bool() const { return value != 0; }
 
         /// Return hash value.
-        uint64_t Value() const { return value; }
+        constexpr uint64_t Value() const { return value; }
 
-        /// Return as string.
+        /// Return the recorded name if known, the hex value otherwise.
         std::string ToString() const;
 
+        /// Hash a string literal at compile time. The name is never recorded, prefer ALIMER_STRINGID64 or _sid64.
+        template <size_t N>
+        static constexpr StringId64 FromLiteral(const char (&str)[N]) { return StringId64(const_murmur64(str, N - 1, 0)); }
+
         /// Zero hash.
         static const StringId64 Zero;
 
@@ -168,4 +178,38 @@ namespace alimer
         /// Hash value.
         uint64_t value;
     };
+
+#if defined(ALIMER_STRINGID_NAMES)
+    // Name table builds hash literals at runtime so ToString knows them, they are not constant expressions there.
+    inline StringId32 operator"" _sid(const char* str, size_t length)
+    {
+        return StringId32(std::string(str, length));
+    }
+
+    inline StringId64 operator"" _sid64(const char* str, size_t length)
+    {
+        return StringId64(std::string(str, length));
+    }
+#else
+    /// Compile time StringId32, "Name"_sid equals StringId32("Name").
+    constexpr StringId32 operator"" _sid(const char* str, size_t length)
+    {
+        return StringId32(const_murmur32(str, static_cast<uint32_t>(length), 0));
+    }
+
+    /// Compile time StringId64, "Name"_sid64 equals StringId64("Name").
+    constexpr StringId64 operator"" _sid64(const char* str, size_t length)
+    {
+        return StringId64(const_murmur64(str, static_cast<uint64_t>(length), 0));
+    }
+#endif
 }
+
+/// Id of a string literal, hashed at compile time. ALIMER_STRINGID_NAMES builds hash it once at runtime to record the name.
+#if defined(ALIMER_STRINGID_NAMES)
+#   define ALIMER_STRINGID32(literal) ([]() { static const alimer::StringId32 id(literal); return id; }())
+#   define ALIMER_STRINGID64(literal) ([]() { static const alimer::StringId64 id(literal); return id; }())
+#else
+#   define ALIMER_STRINGID32(literal) alimer::StringId32(std::integral_constant<uint32_t, alimer::StringId32::FromLiteral(literal).Value()>::value)
+#   define ALIMER_STRINGID64(literal) alimer::StringId64(std::integral_constant<uint64_t, alimer::StringId64::FromLiteral(literal).Value()>::value)
+#endif
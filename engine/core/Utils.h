@@ -33,6 +33,13 @@ namespace alimer
         delete resource;
         resource = nullptr;
     }
+
+    /// Round value up to a multiple of alignment, alignment must be a power of two.
+    template <typename T>
+    constexpr T AlignTo(T value, T alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
 }
 
 #define ALIMER_DISABLE_COPY(ClassType) \
@@ -44,5 +44,9 @@ namespace alimer
     using SwapChainHandle = IDXGISwapChain3*;
 #elif defined(ALIMER_GRAPHICS_D3D11)
 #elif defined(ALIMER_GRAPHICS_OPENGL)
+#elif defined(ALIMER_GRAPHICS_NULL)
+    using DeviceHandle = void*;
+    using CommandQueueHandle = void*;
+    using SwapChainHandle = void*;
 #endif
 }
@@ -0,0 +1,1030 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "graphics/BlockCompression.h"
+#include "graphics/PixelFormatConversion.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+#include "math/half.h"
+#include "math/simd.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace alimer
+{
+    namespace
+    {
+        constexpr uint32_t kBlockPixels = 16;
+
+        /// Least squares passes of the high quality encoder, later passes rarely change any index.
+        constexpr uint32_t kRefineIterations = 3;
+
+        /// BC6H and BC7 4-bit index weights, out of 64.
+        const int kWeights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        /// A 4x4 block in structure of arrays layout, so SIMD lanes work on four pixels at once.
+        struct alignas(16) Block
+        {
+            float channels[4][kBlockPixels];
+            /// 1 for pixels that place the initial endpoints.
+            float fitMask[kBlockPixels];
+            /// 1 for pixels whose error counts, 0 for pixels the encoder overrides (BC1 transparent texels).
+            float errorMask[kBlockPixels];
+        };
+
+        struct Endpoints
+        {
+            float colors[2][4];
+        };
+
+        struct Palette
+        {
+            float colors[16][4];
+            uint32_t count;
+        };
+
+        /// Little endian bit packer for the 128-bit BC6H and BC7 blocks.
+        class BitWriter
+        {
+        public:
+            void Write(uint32_t value, uint32_t bits)
+            {
+                const uint64_t masked = uint64_t(value) & ((1ull << bits) - 1);
+                const uint32_t word = position >> 6;
+                const uint32_t shift = position & 63;
+                words[word] |= masked << shift;
+                if (shift + bits > 64)
+                    words[word + 1] |= masked >> (64 - shift);
+                position += bits;
+            }
+
+            void Store(uint8_t* output) const
+            {
+                ALIMER_ASSERT(position == 128);
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    output[i] = uint8_t(words[i >> 3] >> ((i & 7) * 8));
+                }
+            }
+
+        private:
+            uint64_t words[2] = { 0, 0 };
+            uint32_t position = 0;
+        };
+
+        inline int RoundClamp(float value, int minimum, int maximum)
+        {
+            return std::min(maximum, std::max(minimum, int(std::floor(value + 0.5f))));
+        }
+
+        /// Project the pixels on origin + t * axis, four pixels per iteration.
+        void Project(const Block& block, uint32_t channels, const float* origin, const float* axis, float* t)
+        {
+            for (uint32_t i = 0; i < kBlockPixels; i += 4)
+            {
+                simd::float4v sum = simd::zero();
+                for (uint32_t c = 0; c < channels; ++c)
+                {
+                    const simd::float4v offset = simd::sub(simd::load_aligned(&block.channels[c][i]), simd::splat(origin[c]));
+                    sum = simd::madd(offset, simd::splat(axis[c]), sum);
+                }
+                simd::store_aligned(t + i, sum);
+            }
+        }
+
+        /// Endpoints at the corners of the bounding box, on the diagonal that follows the widest channel.
+        void FitBoundingBox(const Block& block, uint32_t channels, Endpoints& endpoints)
+        {
+            float minimum[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+            float maximum[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+            float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float count = 0.0f;
+            for (uint32_t i = 0; i < kBlockPixels; ++i)
+            {
+                if (block.fitMask[i] == 0.0f)
+                    continue;
+
+                count += 1.0f;
+                for (uint32_t c = 0; c < channels; ++c)
+                {
+                    minimum[c] = std::min(minimum[c], block.channels[c][i]);
+                    maximum[c] = std::max(maximum[c], block.channels[c][i]);
+                    mean[c] += block.channels[c][i];
+                }
+            }
+
+            if (count == 0.0f)
+            {
+                memset(&endpoints, 0, sizeof(endpoints));
+                return;
+            }
+
+            uint32_t widest = 0;
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                mean[c] /= count;
+                if (maximum[c] - minimum[c] > maximum[widest] - minimum[widest])
+                    widest = c;
+            }
+
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                float covariance = 0.0f;
+                for (uint32_t i = 0; c != widest && i < kBlockPixels; ++i)
+                {
+                    covariance += block.fitMask[i] * (block.channels[widest][i] - mean[widest]) * (block.channels[c][i] - mean[c]);
+                }
+
+                endpoints.colors[0][c] = covariance < 0.0f ? maximum[c] : minimum[c];
+                endpoints.colors[1][c] = covariance < 0.0f ? minimum[c] : maximum[c];
+            }
+        }
+
+        /// Endpoints at the extreme projections on the principal axis of the pixel covariance.
+        void FitPrincipalAxis(const Block& block, uint32_t channels, Endpoints& endpoints)
+        {
+            // The box diagonal seeds the power iteration.
+            FitBoundingBox(block, channels, endpoints);
+
+            float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float count = 0.0f;
+            for (uint32_t i = 0; i < kBlockPixels; ++i)
+            {
+                count += block.fitMask[i];
+                for (uint32_t c = 0; c < channels; ++c)
+                {
+                    mean[c] += block.fitMask[i] * block.channels[c][i];
+                }
+            }
+
+            if (count == 0.0f)
+                return;
+
+            float covariance[4][4] = {};
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                mean[c] /= count;
+            }
+
+            for (uint32_t i = 0; i < kBlockPixels; ++i)
+            {
+                for (uint32_t c = 0; c < channels; ++c)
+                {
+                    const float offset = block.fitMask[i] * (block.channels[c][i] - mean[c]);
+                    for (uint32_t d = c; d < channels; ++d)
+                    {
+                        covariance[c][d] += offset * (block.channels[d][i] - mean[d]);
+                    }
+                }
+            }
+
+            float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float length = 0.0f;
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                for (uint32_t d = 0; d < c; ++d)
+                {
+                    covariance[c][d] = covariance[d][c];
+                }
+
+                axis[c] = endpoints.colors[1][c] - endpoints.colors[0][c];
+                length = std::max(length, std::fabs(axis[c]));
+            }
+
+            if (length == 0.0f)
+                return;
+
+            for (uint32_t iteration = 0; iteration < 8; ++iteration)
+            {
+                float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                float largest = 0.0f;
+                for (uint32_t c = 0; c < channels; ++c)
+                {
+                    for (uint32_t d = 0; d < channels; ++d)
+                    {
+                        next[c] += covariance[c][d] * axis[d];
+                    }
+                    largest = std::max(largest, std::fabs(next[c]));
+                }
+
+                if (largest < 1e-6f)
+                    break;
+
+                for (uint32_t c = 0; c < channels; ++c)
+                {
+                    axis[c] = next[c] / largest;
+                }
+            }
+
+            float axisLengthSquared = 0.0f;
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                axisLengthSquared += axis[c] * axis[c];
+            }
+
+            alignas(16) float t[kBlockPixels];
+            Project(block, channels, mean, axis, t);
+
+            float minimum = FLT_MAX;
+            float maximum = -FLT_MAX;
+            for (uint32_t i = 0; i < kBlockPixels; ++i)
+            {
+                if (block.fitMask[i] != 0.0f)
+                {
+                    minimum = std::min(minimum, t[i]);
+                    maximum = std::max(maximum, t[i]);
+                }
+            }
+
+            minimum /= axisLengthSquared;
+            maximum /= axisLengthSquared;
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                endpoints.colors[0][c] = mean[c] + minimum * axis[c];
+                endpoints.colors[1][c] = mean[c] + maximum * axis[c];
+            }
+        }
+
+        /// Pick the closest palette entry for every pixel and return the summed squared error.
+        float FindIndices(const Block& block, uint32_t channels, const Palette& palette, uint8_t* indices)
+        {
+            alignas(16) float best[kBlockPixels];
+            alignas(16) float distance[kBlockPixels];
+            for (uint32_t i = 0; i < kBlockPixels; ++i)
+            {
+                best[i] = FLT_MAX;
+            }
+
+            for (uint32_t entry = 0; entry < palette.count; ++entry)
+            {
+                for (uint32_t i = 0; i < kBlockPixels; i += 4)
+                {
+                    simd::float4v sum = simd::zero();
+                    for (uint32_t c = 0; c < channels; ++c)
+                    {
+                        const simd::float4v delta = simd::sub(simd::load_aligned(&block.channels[c][i]), simd::splat(palette.colors[entry][c]));
+                        sum = simd::madd(delta, delta, sum);
+                    }
+                    simd::store_aligned(distance + i, sum);
+                }
+
+                for (uint32_t i = 0; i < kBlockPixels; ++i)
+                {
+                    if (distance[i] < best[i])
+                    {
+                        best[i] = distance[i];
+                        indices[i] = uint8_t(entry);
+                    }
+                }
+            }
+
+            simd::float4v error = simd::zero();
+            for (uint32_t i = 0; i < kBlockPixels; i += 4)
+            {
+                error = simd::madd(simd::load_aligned(best + i), simd::load_aligned(&block.errorMask[i]), error);
+            }
+            return simd::get_x(simd::horizontal_sum(error));
+        }
+
+        /// Least squares endpoints for fixed indices. weights[index] is the interpolation factor of a palette entry,
+        /// or negative for entries that do not depend on the endpoints.
+        bool SolveEndpoints(const Block& block, uint32_t channels, const float* weights, const uint8_t* indices, Endpoints& endpoints)
+        {
+            alignas(16) float first[kBlockPixels];
+            alignas(16) float second[kBlockPixels];
+            float aa = 0.0f;
+            float ab = 0.0f;
+            float bb = 0.0f;
+            for (uint32_t i = 0; i < kBlockPixels; ++i)
+            {
+                const float weight = weights[indices[i]];
+                const float mask = weight < 0.0f ? 0.0f : block.errorMask[i];
+                first[i] = mask * (1.0f - weight);
+                second[i] = mask * weight;
+                aa += first[i] * (1.0f - weight);
+                ab += first[i] * weight;
+                bb += second[i] * weight;
+            }
+
+            const float determinant = aa * bb - ab * ab;
+            if (determinant < 1e-4f)
+                return false;
+
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                simd::float4v x = simd::zero();
+                simd::float4v y = simd::zero();
+                for (uint32_t i = 0; i < kBlockPixels; i += 4)
+                {
+                    const simd::float4v value = simd::load_aligned(&block.channels[c][i]);
+                    x = simd::madd(simd::load_aligned(first + i), value, x);
+                    y = simd::madd(simd::load_aligned(second + i), value, y);
+                }
+
+                const float sumFirst = simd::get_x(simd::horizontal_sum(x));
+                const float sumSecond = simd::get_x(simd::horizontal_sum(y));
+                endpoints.colors[0][c] = (bb * sumFirst - ab * sumSecond) / determinant;
+                endpoints.colors[1][c] = (aa * sumSecond - ab * sumFirst) / determinant;
+            }
+
+            return true;
+        }
+
+        /// Fit, quantize and index one mode, refined with least squares passes in high quality.
+        template <typename Mode>
+        float EncodeMode(const Block& block, Mode& mode, BlockCompressionQuality quality)
+        {
+            Endpoints endpoints;
+            if (quality == BlockCompressionQuality::Fast)
+                FitBoundingBox(block, Mode::kChannels, endpoints);
+            else
+                FitPrincipalAxis(block, Mode::kChannels, endpoints);
+
+            Palette palette;
+            mode.Quantize(endpoints);
+            mode.BuildPalette(palette);
+            float error = FindIndices(block, Mode::kChannels, palette, mode.indices);
+
+            if (quality == BlockCompressionQuality::High)
+            {
+                Mode candidate = mode;
+                for (uint32_t iteration = 0; iteration < kRefineIterations && error > 0.0f; ++iteration)
+                {
+                    if (!SolveEndpoints(block, Mode::kChannels, mode.GetWeights(), mode.indices, endpoints))
+                        break;
+
+                    candidate.Quantize(endpoints);
+                    candidate.BuildPalette(palette);
+                    const float candidateError = FindIndices(block, Mode::kChannels, palette, candidate.indices);
+                    if (candidateError >= error)
+                        break;
+
+                    mode = candidate;
+                    error = candidateError;
+                }
+            }
+
+            return error;
+        }
+
+        /// BC1 to BC3 color: RGB565 endpoints with four colors, or three colors and transparent black.
+        struct ColorMode
+        {
+            static constexpr uint32_t kChannels = 3;
+
+            bool threeColor = false;
+            uint16_t colors[2];
+            uint8_t indices[kBlockPixels];
+
+            static uint16_t Pack565(const float* color)
+            {
+                const int r = RoundClamp(color[0] * (31.0f / 255.0f), 0, 31);
+                const int g = RoundClamp(color[1] * (63.0f / 255.0f), 0, 63);
+                const int b = RoundClamp(color[2] * (31.0f / 255.0f), 0, 31);
+                return uint16_t((r << 11) | (g << 5) | b);
+            }
+
+            static void Unpack565(uint16_t value, float* color)
+            {
+                const uint32_t r = (value >> 11) & 31;
+                const uint32_t g = (value >> 5) & 63;
+                const uint32_t b = value & 31;
+                color[0] = float((r << 3) | (r >> 2));
+                color[1] = float((g << 2) | (g >> 4));
+                color[2] = float((b << 3) | (b >> 2));
+            }
+
+            void Quantize(const Endpoints& endpoints)
+            {
+                colors[0] = Pack565(endpoints.colors[0]);
+                colors[1] = Pack565(endpoints.colors[1]);
+
+                // The endpoint order selects the mode.
+                if (threeColor ? colors[0] > colors[1] : colors[0] < colors[1])
+                    std::swap(colors[0], colors[1]);
+            }
+
+            void BuildPalette(Palette& palette) const
+            {
+                float* c0 = palette.colors[0];
+                float* c1 = palette.colors[1];
+                Unpack565(colors[0], c0);
+                Unpack565(colors[1], c1);
+                for (uint32_t c = 0; c < kChannels; ++c)
+                {
+                    palette.colors[2][c] = threeColor ? (c0[c] + c1[c]) * 0.5f : (2.0f * c0[c] + c1[c]) * (1.0f / 3.0f);
+                    palette.colors[3][c] = (c0[c] + 2.0f * c1[c]) * (1.0f / 3.0f);
+                }
+
+                // Equal endpoints decode in three color mode, only the first entry is safe.
+                palette.count = threeColor ? 3 : (colors[0] == colors[1] ? 1 : 4);
+            }
+
+            const float* GetWeights() const
+            {
+                static const float kFourColor[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+                static const float kThreeColor[3] = { 0.0f, 1.0f, 0.5f };
+                return threeColor ? kThreeColor : kFourColor;
+            }
+
+            void Store(const Block& block, uint8_t* output) const
+            {
+                uint32_t bits = 0;
+                for (uint32_t i = 0; i < kBlockPixels; ++i)
+                {
+                    const uint32_t index = (threeColor && block.errorMask[i] == 0.0f) ? 3 : indices[i];
+                    bits |= index << (i * 2);
+                }
+
+                output[0] = uint8_t(colors[0]);
+                output[1] = uint8_t(colors[0] >> 8);
+                output[2] = uint8_t(colors[1]);
+                output[3] = uint8_t(colors[1] >> 8);
+                output[4] = uint8_t(bits);
+                output[5] = uint8_t(bits >> 8);
+                output[6] = uint8_t(bits >> 16);
+                output[7] = uint8_t(bits >> 24);
+            }
+        };
+
+        /// BC3 alpha, BC4 and BC5: two 8-bit endpoints with eight values, or six values plus the range limits.
+        struct AlphaMode
+        {
+            static constexpr uint32_t kChannels = 1;
+
+            float minimum;
+            float maximum;
+            bool sixValue;
+            int values[2];
+            uint8_t indices[kBlockPixels];
+
+            AlphaMode(float minimum_, float maximum_, bool sixValue_)
+                : minimum(minimum_)
+                , maximum(maximum_)
+                , sixValue(sixValue_)
+            {
+            }
+
+            void Quantize(const Endpoints& endpoints)
+            {
+                values[0] = RoundClamp(endpoints.colors[0][0], int(minimum), int(maximum));
+                values[1] = RoundClamp(endpoints.colors[1][0], int(minimum), int(maximum));
+                if (sixValue ? values[0] > values[1] : values[0] < values[1])
+                    std::swap(values[0], values[1]);
+            }
+
+            void BuildPalette(Palette& palette) const
+            {
+                const float v0 = float(values[0]);
+                const float v1 = float(values[1]);
+                palette.colors[0][0] = v0;
+                palette.colors[1][0] = v1;
+                if (sixValue)
+                {
+                    for (uint32_t i = 2; i < 6; ++i)
+                    {
+                        palette.colors[i][0] = (float(6 - i) * v0 + float(i - 1) * v1) * (1.0f / 5.0f);
+                    }
+                    palette.colors[6][0] = minimum;
+                    palette.colors[7][0] = maximum;
+                    palette.count = 8;
+                }
+                else
+                {
+                    for (uint32_t i = 2; i < 8; ++i)
+                    {
+                        palette.colors[i][0] = (float(8 - i) * v0 + float(i - 1) * v1) * (1.0f / 7.0f);
+                    }
+
+                    // Equal endpoints decode in six value mode, only the first entry is safe.
+                    palette.count = values[0] == values[1] ? 1 : 8;
+                }
+            }
+
+            const float* GetWeights() const
+            {
+                static const float kEightValue[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+                static const float kSixValue[8] = { 0.0f, 1.0f, 0.2f, 0.4f, 0.6f, 0.8f, -1.0f, -1.0f };
+                return sixValue ? kSixValue : kEightValue;
+            }
+
+            void Store(uint8_t* output) const
+            {
+                uint64_t bits = 0;
+                for (uint32_t i = 0; i < kBlockPixels; ++i)
+                {
+                    bits |= uint64_t(indices[i]) << (i * 3);
+                }
+
+                output[0] = uint8_t(values[0]);
+                output[1] = uint8_t(values[1]);
+                for (uint32_t i = 0; i < 6; ++i)
+                {
+                    output[2 + i] = uint8_t(bits >> (i * 8));
+                }
+            }
+        };
+
+        /// BC7 mode 6: one subset, RGBA 7-bit endpoints with a p-bit each and 4-bit indices.
+        struct Bc7Mode6
+        {
+            static constexpr uint32_t kChannels = 4;
+
+            uint8_t endpoints[2][4];
+            uint8_t pbits[2];
+            uint8_t indices[kBlockPixels];
+
+            void Quantize(const Endpoints& input)
+            {
+                for (uint32_t e = 0; e < 2; ++e)
+                {
+                    float bestError = FLT_MAX;
+                    for (uint32_t p = 0; p < 2; ++p)
+                    {
+                        uint8_t quantized[4];
+                        float error = 0.0f;
+                        for (uint32_t c = 0; c < kChannels; ++c)
+                        {
+                            quantized[c] = uint8_t(RoundClamp((input.colors[e][c] - float(p)) * 0.5f, 0, 127));
+                            const float delta = float((quantized[c] << 1) | p) - input.colors[e][c];
+                            error += delta * delta;
+                        }
+
+                        if (error < bestError)
+                        {
+                            bestError = error;
+                            memcpy(endpoints[e], quantized, sizeof(quantized));
+                            pbits[e] = uint8_t(p);
+                        }
+                    }
+                }
+            }
+
+            void BuildPalette(Palette& palette) const
+            {
+                for (uint32_t c = 0; c < kChannels; ++c)
+                {
+                    const int v0 = (endpoints[0][c] << 1) | pbits[0];
+                    const int v1 = (endpoints[1][c] << 1) | pbits[1];
+                    for (uint32_t i = 0; i < 16; ++i)
+                    {
+                        palette.colors[i][c] = float(((64 - kWeights4[i]) * v0 + kWeights4[i] * v1 + 32) >> 6);
+                    }
+                }
+                palette.count = 16;
+            }
+
+            const float* GetWeights() const
+            {
+                static const float kWeights[16] = {
+                    0.0f / 64.0f, 4.0f / 64.0f, 9.0f / 64.0f, 13.0f / 64.0f, 17.0f / 64.0f, 21.0f / 64.0f, 26.0f / 64.0f, 30.0f / 64.0f,
+                    34.0f / 64.0f, 38.0f / 64.0f, 43.0f / 64.0f, 47.0f / 64.0f, 51.0f / 64.0f, 55.0f / 64.0f, 60.0f / 64.0f, 64.0f / 64.0f
+                };
+                return kWeights;
+            }
+
+            void Store(uint8_t* output) const
+            {
+                // The anchor index drops its top bit, swap the endpoints so it stays clear.
+                const uint32_t first = indices[0] >= 8 ? 1 : 0;
+                const uint32_t flip = first ? 15 : 0;
+
+                BitWriter writer;
+                writer.Write(1 << 6, 7);
+                for (uint32_t c = 0; c < kChannels; ++c)
+                {
+                    writer.Write(endpoints[first][c], 7);
+                    writer.Write(endpoints[first ^ 1][c], 7);
+                }
+                writer.Write(pbits[first], 1);
+                writer.Write(pbits[first ^ 1], 1);
+                for (uint32_t i = 0; i < kBlockPixels; ++i)
+                {
+                    writer.Write(indices[i] ^ flip, i == 0 ? 3 : 4);
+                }
+                writer.Store(output);
+            }
+        };
+
+        /// BC6H mode 11: one region, 10-bit endpoints without deltas and 4-bit indices. Pixels are
+        /// half float bit patterns read as integers, the space the hardware interpolates in.
+        struct Bc6hMode11
+        {
+            static constexpr uint32_t kChannels = 3;
+
+            bool isSigned;
+            int endpoints[2][3];
+            uint8_t indices[kBlockPixels];
+
+            explicit Bc6hMode11(bool isSigned_)
+                : isSigned(isSigned_)
+            {
+            }
+
+            int Unquantize(int value) const
+            {
+                if (!isSigned)
+                {
+                    if (value == 0)
+                        return 0;
+                    if (value == 1023)
+                        return 0xFFFF;
+                    return ((value << 16) + 0x8000) >> 10;
+                }
+
+                const int magnitude = std::abs(value);
+                int result;
+                if (magnitude == 0)
+                    result = 0;
+                else if (magnitude >= 511)
+                    result = 0x7FFF;
+                else
+                    result = ((magnitude << 15) + 0x4000) >> 9;
+                return value < 0 ? -result : result;
+            }
+
+            int Finish(int value) const
+            {
+                if (!isSigned)
+                    return (value * 31) >> 6;
+                return value < 0 ? -(((-value) * 31) >> 5) : (value * 31) >> 5;
+            }
+
+            void Quantize(const Endpoints& input)
+            {
+                const int limit = isSigned ? 511 : 1023;
+                const float scale = isSigned ? 1.0f / 62.0f : 1.0f / 31.0f;
+                for (uint32_t e = 0; e < 2; ++e)
+                {
+                    for (uint32_t c = 0; c < kChannels; ++c)
+                    {
+                        // The estimate is within one step, pick the neighbor that decodes closest.
+                        const float value = input.colors[e][c];
+                        const int estimate = RoundClamp(value * scale, -limit * int(isSigned), limit);
+                        float bestError = FLT_MAX;
+                        for (int candidate = std::max(estimate - 1, -limit * int(isSigned)); candidate <= std::min(estimate + 1, limit); ++candidate)
+                        {
+                            const float error = std::fabs(float(Finish(Unquantize(candidate))) - value);
+                            if (error < bestError)
+                            {
+                                bestError = error;
+                                endpoints[e][c] = candidate;
+                            }
+                        }
+                    }
+                }
+            }
+
+            void BuildPalette(Palette& palette) const
+            {
+                for (uint32_t c = 0; c < kChannels; ++c)
+                {
+                    const int v0 = Unquantize(endpoints[0][c]);
+                    const int v1 = Unquantize(endpoints[1][c]);
+                    for (uint32_t i = 0; i < 16; ++i)
+                    {
+                        palette.colors[i][c] = float(Finish(((64 - kWeights4[i]) * v0 + kWeights4[i] * v1 + 32) >> 6));
+                    }
+                }
+                palette.count = 16;
+            }
+
+            const float* GetWeights() const
+            {
+                static const float kWeights[16] = {
+                    0.0f / 64.0f, 4.0f / 64.0f, 9.0f / 64.0f, 13.0f / 64.0f, 17.0f / 64.0f, 21.0f / 64.0f, 26.0f / 64.0f, 30.0f / 64.0f,
+                    34.0f / 64.0f, 38.0f / 64.0f, 43.0f / 64.0f, 47.0f / 64.0f, 51.0f / 64.0f, 55.0f / 64.0f, 60.0f / 64.0f, 64.0f / 64.0f
+                };
+                return kWeights;
+            }
+
+            void Store(uint8_t* output) const
+            {
+                const uint32_t first = indices[0] >= 8 ? 1 : 0;
+                const uint32_t flip = first ? 15 : 0;
+
+                BitWriter writer;
+                writer.Write(0x03, 5);
+                for (uint32_t e = 0; e < 2; ++e)
+                {
+                    for (uint32_t c = 0; c < kChannels; ++c)
+                    {
+                        writer.Write(uint32_t(endpoints[first ^ e][c]), 10);
+                    }
+                }
+                for (uint32_t i = 0; i < kBlockPixels; ++i)
+                {
+                    writer.Write(indices[i] ^ flip, i == 0 ? 3 : 4);
+                }
+                writer.Store(output);
+            }
+        };
+
+        /// Channel layout the blocks are read from.
+        enum class WorkingLayout
+        {
+            Unorm8,
+            Snorm8,
+            Float32
+        };
+
+        PixelFormat GetWorkingFormat(PixelFormat format)
+        {
+            switch (format)
+            {
+            case PixelFormat::BC1RGBAUnorm:
+            case PixelFormat::BC2RGBAUnorm:
+            case PixelFormat::BC3RGBAUnorm:
+            case PixelFormat::BC4RUnorm:
+            case PixelFormat::BC5RGUnorm:
+            case PixelFormat::BC7RGBAUnorm:
+                return PixelFormat::RGBA8Unorm;
+            case PixelFormat::BC1RGBAUnormSrgb:
+            case PixelFormat::BC2RGBAUnormSrgb:
+            case PixelFormat::BC3RGBAUnormSrgb:
+            case PixelFormat::BC7RGBAUnormSrgb:
+                return PixelFormat::RGBA8UnormSrgb;
+            case PixelFormat::BC4RSnorm:
+            case PixelFormat::BC5RGSnorm:
+                return PixelFormat::RGBA8Snorm;
+            case PixelFormat::BC6HRGBUfloat:
+            case PixelFormat::BC6HRGBSfloat:
+                return PixelFormat::RGBA32Float;
+            default:
+                return PixelFormat::Unknown;
+            }
+        }
+
+        /// Map a float to its half bit pattern as an ordered integer, clamped to the finite range.
+        float ToHalfOrdinal(float value, bool isSigned)
+        {
+            const uint16_t bits = float_to_half_bits(value);
+            const uint32_t magnitude = bits & 0x7FFFu;
+            if (magnitude > 0x7C00u)
+                return 0.0f;
+
+            const float clamped = float(std::min(magnitude, 0x7BFFu));
+            if (bits & 0x8000u)
+                return isSigned ? -clamped : 0.0f;
+            return clamped;
+        }
+
+        void LoadBlock(
+            WorkingLayout layout, bool isSigned, const uint8_t* pixels, uint32_t rowPitch,
+            uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, Block& block)
+        {
+            for (uint32_t y = 0; y < 4; ++y)
+            {
+                const uint8_t* row = pixels + size_t(std::min(blockY * 4 + y, height - 1)) * rowPitch;
+                for (uint32_t x = 0; x < 4; ++x)
+                {
+                    const uint32_t i = y * 4 + x;
+                    const uint32_t column = std::min(blockX * 4 + x, width - 1);
+                    block.fitMask[i] = 1.0f;
+                    block.errorMask[i] = 1.0f;
+                    switch (layout)
+                    {
+                    case WorkingLayout::Unorm8:
+                        for (uint32_t c = 0; c < 4; ++c)
+                        {
+                            block.channels[c][i] = float(row[column * 4 + c]);
+                        }
+                        break;
+
+                    case WorkingLayout::Snorm8:
+                        for (uint32_t c = 0; c < 4; ++c)
+                        {
+                            block.channels[c][i] = float(std::max(int8_t(row[column * 4 + c]), int8_t(-127)));
+                        }
+                        break;
+
+                    case WorkingLayout::Float32:
+                    {
+                        float rgba[4];
+                        memcpy(rgba, row + column * 16, sizeof(rgba));
+                        for (uint32_t c = 0; c < 4; ++c)
+                        {
+                            block.channels[c][i] = ToHalfOrdinal(rgba[c], isSigned);
+                        }
+                        break;
+                    }
+                    }
+                }
+            }
+        }
+
+        void EncodeColor(const Block& block, bool allowPunchThrough, BlockCompressionQuality quality, uint8_t* output)
+        {
+            ColorMode mode;
+            if (allowPunchThrough)
+            {
+                bool transparent = false;
+                for (uint32_t i = 0; i < kBlockPixels; ++i)
+                {
+                    transparent |= block.channels[3][i] < 128.0f;
+                }
+
+                if (transparent)
+                {
+                    // Transparent texels take index 3 and stay out of the fit.
+                    Block opaque = block;
+                    for (uint32_t i = 0; i < kBlockPixels; ++i)
+                    {
+                        opaque.fitMask[i] = opaque.errorMask[i] = block.channels[3][i] < 128.0f ? 0.0f : 1.0f;
+                    }
+
+                    mode.threeColor = true;
+                    EncodeMode(opaque, mode, quality);
+                    mode.Store(opaque, output);
+                    return;
+                }
+            }
+
+            EncodeMode(block, mode, quality);
+            mode.Store(block, output);
+        }
+
+        void EncodeAlpha(const Block& block, uint32_t channel, float minimum, float maximum, BlockCompressionQuality quality, uint8_t* output)
+        {
+            Block single;
+            memcpy(single.channels[0], block.channels[channel], sizeof(single.channels[0]));
+            memcpy(single.fitMask, block.fitMask, sizeof(single.fitMask));
+            memcpy(single.errorMask, block.errorMask, sizeof(single.errorMask));
+
+            AlphaMode mode(minimum, maximum, false);
+            const float error = EncodeMode(single, mode, quality);
+            if (quality == BlockCompressionQuality::High && error > 0.0f)
+            {
+                // Six value mode spends its interpolated values on the pixels between the exact limits.
+                for (uint32_t i = 0; i < kBlockPixels; ++i)
+                {
+                    single.fitMask[i] = (single.channels[0][i] > minimum && single.channels[0][i] < maximum) ? 1.0f : 0.0f;
+                }
+
+                AlphaMode sixValue(minimum, maximum, true);
+                if (EncodeMode(single, sixValue, quality) < error)
+                    mode = sixValue;
+            }
+
+            mode.Store(output);
+        }
+
+        void EncodeExplicitAlpha(const Block& block, uint8_t* output)
+        {
+            for (uint32_t i = 0; i < kBlockPixels; i += 2)
+            {
+                const int a0 = RoundClamp(block.channels[3][i] * (15.0f / 255.0f), 0, 15);
+                const int a1 = RoundClamp(block.channels[3][i + 1] * (15.0f / 255.0f), 0, 15);
+                output[i / 2] = uint8_t(a0 | (a1 << 4));
+            }
+        }
+
+        void EncodeBlock(PixelFormat format, const Block& block, BlockCompressionQuality quality, uint8_t* output)
+        {
+            switch (format)
+            {
+            case PixelFormat::BC1RGBAUnorm:
+            case PixelFormat::BC1RGBAUnormSrgb:
+                EncodeColor(block, true, quality, output);
+                break;
+
+            case PixelFormat::BC2RGBAUnorm:
+            case PixelFormat::BC2RGBAUnormSrgb:
+                EncodeExplicitAlpha(block, output);
+                EncodeColor(block, false, quality, output + 8);
+                break;
+
+            case PixelFormat::BC3RGBAUnorm:
+            case PixelFormat::BC3RGBAUnormSrgb:
+                EncodeAlpha(block, 3, 0.0f, 255.0f, quality, output);
+                EncodeColor(block, false, quality, output + 8);
+                break;
+
+            case PixelFormat::BC4RUnorm:
+                EncodeAlpha(block, 0, 0.0f, 255.0f, quality, output);
+                break;
+
+            case PixelFormat::BC4RSnorm:
+                EncodeAlpha(block, 0, -127.0f, 127.0f, quality, output);
+                break;
+
+            case PixelFormat::BC5RGUnorm:
+                EncodeAlpha(block, 0, 0.0f, 255.0f, quality, output);
+                EncodeAlpha(block, 1, 0.0f, 255.0f, quality, output + 8);
+                break;
+
+            case PixelFormat::BC5RGSnorm:
+                EncodeAlpha(block, 0, -127.0f, 127.0f, quality, output);
+                EncodeAlpha(block, 1, -127.0f, 127.0f, quality, output + 8);
+                break;
+
+            case PixelFormat::BC6HRGBUfloat:
+            case PixelFormat::BC6HRGBSfloat:
+            {
+                Bc6hMode11 mode(format == PixelFormat::BC6HRGBSfloat);
+                EncodeMode(block, mode, quality);
+                mode.Store(output);
+                break;
+            }
+
+            case PixelFormat::BC7RGBAUnorm:
+            case PixelFormat::BC7RGBAUnormSrgb:
+            {
+                Bc7Mode6 mode;
+                EncodeMode(block, mode, quality);
+                mode.Store(output);
+                break;
+            }
+
+            default:
+                ALIMER_ASSERT(false);
+                break;
+            }
+        }
+    }
+
+    bool CanCompressBlocks(PixelFormat source, PixelFormat destination)
+    {
+        if (source == PixelFormat::Unknown || source >= PixelFormat::Count || destination >= PixelFormat::Count)
+            return false;
+
+        const PixelFormat workingFormat = GetWorkingFormat(destination);
+        return workingFormat != PixelFormat::Unknown && CanConvertPixels(source, workingFormat);
+    }
+
+    bool CompressBlocks(
+        PixelFormat sourceFormat, const void* source, uint32_t sourceRowPitch,
+        PixelFormat destinationFormat, void* destination, uint32_t destinationRowPitch,
+        uint32_t width, uint32_t height, BlockCompressionQuality quality)
+    {
+        ALIMER_PROFILE_SCOPE("CompressBlocks");
+
+        if (!CanCompressBlocks(sourceFormat, destinationFormat))
+            return false;
+
+        if (width == 0 || height == 0)
+            return true;
+
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blocksY = (height + 3) / 4;
+        const uint32_t blockSize = GetFormatBlockSize(destinationFormat);
+        ALIMER_ASSERT(source != nullptr && destination != nullptr);
+        ALIMER_ASSERT(destinationRowPitch >= blocksX * blockSize);
+
+        // Blocks read a single working format, anything else is converted up front.
+        const PixelFormat workingFormat = GetWorkingFormat(destinationFormat);
+        const uint8_t* pixels = static_cast<const uint8_t*>(source);
+        uint32_t rowPitch = sourceRowPitch;
+        std::vector<uint8_t> converted;
+        if (sourceFormat != workingFormat)
+        {
+            rowPitch = width * GetFormatBitsPerPixel(workingFormat) / 8;
+            converted.resize(size_t(rowPitch) * height);
+            if (!ConvertPixels(sourceFormat, source, sourceRowPitch, workingFormat, converted.data(), rowPitch, width, height))
+                return false;
+            pixels = converted.data();
+        }
+
+        WorkingLayout layout = WorkingLayout::Unorm8;
+        if (workingFormat == PixelFormat::RGBA8Snorm)
+            layout = WorkingLayout::Snorm8;
+        else if (workingFormat == PixelFormat::RGBA32Float)
+            layout = WorkingLayout::Float32;
+        const bool isSigned = destinationFormat == PixelFormat::BC6HRGBSfloat;
+
+        uint8_t* output = static_cast<uint8_t*>(destination);
+        JobSystem::ParallelFor(blocksY, 1, [&](uint32_t blockY) {
+            uint8_t* row = output + size_t(blockY) * destinationRowPitch;
+            for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+            {
+                Block block;
+                LoadBlock(layout, isSigned, pixels, rowPitch, width, height, blockX, blockY, block);
+                EncodeBlock(destinationFormat, block, quality, row + size_t(blockX) * blockSize);
+            }
+        });
+
+        return true;
+    }
+}
@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "graphics/PixelFormat.h"
+
+namespace alimer
+{
+    /// Encoder effort for CompressBlocks.
+    enum class BlockCompressionQuality : uint32_t
+    {
+        /// Bounding box endpoints, meant for runtime and preview encodes.
+        Fast,
+        /// Principal axis endpoints refined with least squares, meant for the asset cook.
+        High
+    };
+
+    /// Return true if CompressBlocks can encode source pixels into the destination BC format.
+    /// Any source supported by ConvertPixels works, BC6H reads float data and the other formats 8-bit data.
+    ALIMER_API bool CanCompressBlocks(PixelFormat source, PixelFormat destination);
+
+    /// Encode a whole image into BC1 to BC7 blocks, rows of blocks are split across the job system threads.
+    /// Partial blocks on the right and bottom edges repeat the last column and row. BC1 switches to punch-through
+    /// alpha for blocks with alpha below one half, BC6H encodes mode 11 and BC7 encodes mode 6.
+    /// The destination row pitch is the size of a row of blocks. Returns false for unsupported formats.
+    ALIMER_API bool CompressBlocks(
+        PixelFormat sourceFormat, const void* source, uint32_t sourceRowPitch,
+        PixelFormat destinationFormat, void* destination, uint32_t destinationRowPitch,
+        uint32_t width, uint32_t height, BlockCompressionQuality quality = BlockCompressionQuality::High);
+}
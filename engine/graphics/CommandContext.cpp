@@ -20,15 +20,17 @@
 // THE SOFTWARE.
 //
 
+#include "core/Profiler.h"
 #include "graphics/CommandContext.h"
 #include "graphics/GPUDevice.h"
 #include "graphics/Texture.h"
 #include "graphics/SwapChain.h"
+#include "graphics/CommandQueue.h"
 
 namespace alimer
 {
     /* CopyContext */
-    CopyContext::CopyContext(GraphicsDevice& device_)
+    CopyContext::CopyContext(GPUDevice& device_)
         : device(device_)
     {
     }
@@ -38,30 +40,42 @@ namespace alimer
         //device.GetImpl()->DestroyCommandBuffer(handle);
     }
 
-    void CopyContext::BeginMarker(const std::string& name)
+    void CopyContext::TrackCommand()
     {
+        device.commandCount.fetch_add(1, std::memory_order_relaxed);
+    }
 
+    void CopyContext::BeginMarker(const std::string& name)
+    {
+        TrackCommand();
     }
 
     void CopyContext::EndMarker()
     {
-
+        TrackCommand();
     }
 
     void CopyContext::Flush(bool wait)
     {
         //handle->Flush(wait);
+        ALIMER_PROFILE_SCOPE("CopyContext::Flush");
+        auto queue = device.GetCommandQueue(CommandQueueType::Graphics);
+        uint64_t fenceValue = queue->Signal();
+        if (wait)
+        {
+            queue->WaitForFence(fenceValue);
+        }
     }
 
     /* ComputeContext */
-    ComputeContext::ComputeContext(GraphicsDevice& device_)
+    ComputeContext::ComputeContext(GPUDevice& device_)
         : CopyContext(device_)
     {
 
     }
 
     /* GraphicsContext */
-    GraphicsContext::GraphicsContext(GraphicsDevice& device_)
+    GraphicsContext::GraphicsContext(GPUDevice& device_)
         : ComputeContext(device_)
     {
         //handle = device_.GetImpl()->CreateCommandBuffer(QueueType::Graphics);
@@ -70,10 +84,12 @@ namespace alimer
     void GraphicsContext::BeginRenderPass(SwapChain* swapchain, const Color& clearColor)
     {
         //handle->BeginRenderPass(swapchain->GetCurrentTexture()->GetHandle(), clearColor);
+        TrackCommand();
     }
 
     void GraphicsContext::EndRenderPass()
     {
         //handle->EndRenderPass();
+        TrackCommand();
     }
 }
@@ -27,13 +27,13 @@
 
 namespace alimer
 {
-    class GraphicsDevice;
+    class GPUDevice;
     class SwapChain;
 
     /// Command context class for recording copy GPU commands.
     class CopyContext
     {
-        friend class GraphicsDevice;
+        friend class GPUDevice;
 
     public:
         /// Destructor.
@@ -46,11 +46,14 @@ namespace alimer
 
     protected:
         /// Constructor.
-        CopyContext(GraphicsDevice& device_);
+        CopyContext(GPUDevice& device_);
 
         void SetName(const std::string& name_) { name = name_; }
 
-        GraphicsDevice& device;
+        /// Count a recorded command in the device statistics.
+        void TrackCommand();
+
+        GPUDevice& device;
         std::string name;
     };
 
@@ -61,7 +64,7 @@ namespace alimer
 
     protected:
         /// Constructor.
-        ComputeContext(GraphicsDevice& device_);
+        ComputeContext(GPUDevice& device_);
     };
 
     /// Command context class for recording graphics GPU commands.
@@ -69,7 +72,7 @@ namespace alimer
     {
     public:
         /// Constructor.
-        GraphicsContext(GraphicsDevice& device_);
+        GraphicsContext(GPUDevice& device_);
 
         void BeginRenderPass(SwapChain* swapchain, const Color& clearColor);
         void EndRenderPass();
@@ -40,6 +40,24 @@ namespace alimer
         /// Destructor
         ~CommandQueue();
 
+        /// Signal the queue fence and return the signaled value.
+        uint64_t Signal();
+
+        /// Return true if the GPU has reached the given fence value.
+        bool IsFenceComplete(uint64_t fenceValue);
+
+        /// Block the calling thread until the GPU reaches the given fence value.
+        void WaitForFence(uint64_t fenceValue);
+
+        /// Return the value the next Signal call will use.
+        uint64_t GetNextFenceValue() const;
+
+        /// Block until all work submitted to this queue has completed.
+        void WaitForIdle() { WaitForFence(Signal()); }
+
+        /// Return the type of this queue.
+        CommandQueueType GetQueueType() const { return queueType; }
+
         /**
         * Get the native API handle.
         */
@@ -25,9 +25,9 @@
 
 namespace alimer
 {
-    GPUBuffer::GPUBuffer(GPUDevice* device)
-        : GPUResource(device, Type::Buffer)
+    GPUBuffer::GPUBuffer(GPUDevice* device, const BufferDescriptor* descriptor)
+        : GPUResource(device, Type::Buffer, descriptor->size)
+        , usage(descriptor->usage)
     {
-
     }
 }
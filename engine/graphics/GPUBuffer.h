@@ -32,8 +32,12 @@ namespace alimer
 
     public:
         /// Constructor.
-        GPUBuffer(GPUDevice* device);
+        GPUBuffer(GPUDevice* device, const BufferDescriptor* descriptor);
+
+        /// Return the buffer usage.
+        BufferUsage GetUsage() const { return usage; }
 
     private:
+        BufferUsage usage;
     };
 } 
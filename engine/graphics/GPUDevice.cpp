@@ -22,17 +22,17 @@
 
 #include "core/Log.h"
 #include "core/Assert.h"
-#include "os/window.h"
+#include "core/Profiler.h"
+#include "os/Window.h"
 #include "graphics/GPUDevice.h"
 #include "graphics/GPUBuffer.h"
 #include "graphics/CommandQueue.h"
+#include <vector>
 
 namespace alimer
 {
     RefPtr<GPUDevice> GPUDevice::Create(Window* window, const Desc& desc)
     {
-        ALIMER_ASSERT(window);
-
         RefPtr<GPUDevice> device(new GPUDevice(window, desc));
         if (device->Init() == false) {
             device = nullptr;
@@ -51,8 +51,8 @@ namespace alimer
     {
         WaitForIdle();
 
+        ExecuteDeferredReleases(true);
         ReleaseTrackedResources();
-        //ExecuteDeferredReleases();
 
         copyCommandQueue.reset();
         computeCommandQueue.reset();
@@ -65,6 +65,8 @@ namespace alimer
 
     bool GPUDevice::Init()
     {
+        ALIMER_PROFILE_SCOPE("GPUDevice::Init");
+
         if (ApiInit() == false) {
             return false;
         }
@@ -73,7 +75,10 @@ namespace alimer
         computeCommandQueue = std::make_shared<CommandQueue>(*this, CommandQueueType::Compute);
         copyCommandQueue = std::make_shared<CommandQueue>(*this, CommandQueueType::Copy);
 
-        mainSwapChain.reset(new SwapChain(*this, window->GetHandle(), window->GetSize()));
+        if (window != nullptr)
+        {
+            mainSwapChain.reset(new SwapChain(*this, (void*)window->GetHandle(), window->GetSize()));
+        }
 
         return true;
     }
@@ -99,30 +104,170 @@ namespace alimer
         return commandQueue;
     }
 
-    void GPUDevice::AddGPUResource(GPUResource* resource)
+    GPUResourceHandle GPUDevice::AddGPUResource(GPUResource* resource)
     {
-        std::lock_guard<std::mutex> lock(_gpuResourceMutex);
-        _gpuResources.push_back(resource);
+        return _gpuResources[static_cast<uint32_t>(resource->GetResourceType())].Allocate(resource);
     }
 
     void GPUDevice::RemoveGPUResource(GPUResource* resource)
     {
-        std::lock_guard<std::mutex> lock(_gpuResourceMutex);
-        _gpuResources.erase(std::remove(_gpuResources.begin(), _gpuResources.end(), resource), _gpuResources.end());
+        _gpuResources[static_cast<uint32_t>(resource->GetResourceType())].Free(resource->GetResourceHandle());
     }
 
-    void GPUDevice::ReleaseTrackedResources()
+    GPUResource* GPUDevice::GetGPUResource(GPUResource::Type type, GPUResourceHandle handle)
+    {
+        GPUResource* resource = nullptr;
+        _gpuResources[static_cast<uint32_t>(type)].TryGet<0>(handle, resource);
+        return resource;
+    }
+
+    void GPUDevice::DeferRelease(void* object, DeferredReleaseFunction release)
+    {
+        ALIMER_ASSERT(release);
+
+        // Safe once every queue reaches the fence value it signals next, which covers work still being recorded.
+        DeferredRelease entry = {};
+        entry.release = release;
+        entry.object = object;
+
+        const CommandQueue* queues[] = { graphicsCommandQueue.get(), computeCommandQueue.get(), copyCommandQueue.get() };
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            entry.fenceValues[i] = queues[i] != nullptr ? queues[i]->GetNextFenceValue() : 0;
+        }
+
+        std::lock_guard<std::mutex> lock(_deferredReleaseMutex);
+        _deferredReleases.push_back(entry);
+    }
+
+    void GPUDevice::DeferDestroy(GPUResource* resource)
     {
+        if (resource == nullptr)
+            return;
+
+        resource->AddRef();
+        DeferRelease(resource, [](void* object) {
+            GPUResource* resource = static_cast<GPUResource*>(object);
+            resource->Destroy();
+            resource->Release();
+            });
+    }
+
+    void GPUDevice::ExecuteDeferredReleases(bool force)
+    {
+        ALIMER_PROFILE_SCOPE("GPUDevice::ExecuteDeferredReleases");
+        std::lock_guard<std::mutex> executeLock(_deferredExecuteMutex);
+
+        {
+            std::lock_guard<std::mutex> lock(_deferredReleaseMutex);
+            if (_deferredReleases.empty())
+                return;
+
+            _deferredReleaseBatch.swap(_deferredReleases);
+        }
+
+        CommandQueue* queues[] = { graphicsCommandQueue.get(), computeCommandQueue.get(), copyCommandQueue.get() };
+        uint64_t completedFenceValues[3] = {};
+
+        for (const DeferredRelease& entry : _deferredReleaseBatch)
         {
-            std::lock_guard<std::mutex> lock(_gpuResourceMutex);
+            bool ready = true;
+            for (uint32_t i = 0; i < 3 && ready && !force; ++i)
+            {
+                // Cache the highest value known to be complete so most entries don't query the fence.
+                if (queues[i] == nullptr || entry.fenceValues[i] <= completedFenceValues[i])
+                    continue;
+
+                ready = queues[i]->IsFenceComplete(entry.fenceValues[i]);
+                if (ready)
+                {
+                    completedFenceValues[i] = entry.fenceValues[i];
+                }
+            }
 
-            // Release all GPU objects that still exist
-            for (auto i = _gpuResources.begin(); i != _gpuResources.end(); ++i)
+            if (ready)
+            {
+                entry.release(entry.object);
+            }
+            else
             {
-                (*i)->Release();
+                _deferredReleaseNotReady.push_back(entry);
             }
+        }
 
-            _gpuResources.clear();
+        _deferredReleaseBatch.clear();
+
+        if (!_deferredReleaseNotReady.empty())
+        {
+            std::lock_guard<std::mutex> lock(_deferredReleaseMutex);
+            _deferredReleases.insert(_deferredReleases.begin(), _deferredReleaseNotReady.begin(), _deferredReleaseNotReady.end());
+            _deferredReleaseNotReady.clear();
+        }
+    }
+
+    void GPUDevice::EndFrame()
+    {
+        ALIMER_PROFILE_SCOPE("GPUDevice::EndFrame");
+
+        // Deferred releases wait for the next fence value of every queue, without a signal they never become ready.
+        CommandQueue* queues[] = { graphicsCommandQueue.get(), computeCommandQueue.get(), copyCommandQueue.get() };
+        for (CommandQueue* queue : queues)
+        {
+            if (queue != nullptr)
+            {
+                queue->Signal();
+            }
+        }
+
+        ExecuteDeferredReleases();
+    }
+
+    GPUDevice::Stats GPUDevice::GetStats()
+    {
+        Stats stats;
+        stats.commands = commandCount.load(std::memory_order_relaxed);
+        stats.submits = submitCount.load(std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(_deferredReleaseMutex);
+            stats.pendingReleases = _deferredReleases.size();
+        }
+
+        for (GPUResourcePool& resources : _gpuResources)
+        {
+            resources.ForEachShard([&stats](GPUResourcePool::PoolType& pool) {
+                GPUResource** data = pool.GetData<0>();
+                stats.resources += pool.GetCount();
+                for (uint32_t i = 0; i < pool.GetCount(); ++i)
+                {
+                    stats.memoryUsage += data[i]->GetSize();
+                }
+                });
+        }
+
+        return stats;
+    }
+
+    void GPUDevice::ReleaseTrackedResources()
+    {
+        ALIMER_PROFILE_SCOPE("GPUDevice::ReleaseTrackedResources");
+
+        // Untrack first so Destroy can run without holding the pool locks.
+        std::vector<GPUResource*> resources;
+        for (GPUResourcePool& pool : _gpuResources)
+        {
+            pool.ForEachShard([&resources](GPUResourcePool::PoolType& shard) {
+                GPUResource** data = shard.GetData<0>();
+                resources.insert(resources.end(), data, data + shard.GetCount());
+                shard.Clear();
+                });
+        }
+
+        // Release the GPU data of all objects that still exist, the objects are owned elsewhere and may outlive the device.
+        for (GPUResource* resource : resources)
+        {
+            resource->Destroy();
+            resource->_device = nullptr;
         }
     }
 }
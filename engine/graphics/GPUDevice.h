@@ -26,8 +26,10 @@
 #include "graphics/SwapChain.h"
 #include "graphics/GPUResource.h"
 #include "graphics/CommandContext.h"
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace alimer
 {
@@ -44,6 +46,9 @@ namespace alimer
     /// Defines the logical GPU device class.
     class ALIMER_API GPUDevice final : public RefCounted
     {
+        friend class CommandQueue;
+        friend class CopyContext;
+
     public:
         /**
         * Device configuration
@@ -56,10 +61,30 @@ namespace alimer
             PixelFormat depthStencilFormat = PixelFormat::D32Float;
         };
 
+        /**
+        * Device statistics, tracked by every backend.
+        */
+        struct Stats
+        {
+            /// Number of live tracked GPU resources.
+            uint64_t resources = 0;
+            /// Size in bytes of all live tracked GPU resources.
+            uint64_t memoryUsage = 0;
+            /// Number of recorded commands.
+            uint64_t commands = 0;
+            /// Number of queue submissions (fence signals).
+            uint64_t submits = 0;
+            /// Number of objects waiting for the GPU before being released.
+            uint64_t pendingReleases = 0;
+        };
+
+        /// Function releasing an object queued with DeferRelease.
+        using DeferredReleaseFunction = void(*)(void* object);
+
         /// Destructor.
         ~GPUDevice();
 
-        /// Create new GPUDevice.
+        /// Create new GPUDevice, window can be null for headless devices.
         static RefPtr<GPUDevice> Create(Window* window, const Desc& desc);
 
         /// Waits for the device to become idle.
@@ -74,13 +99,30 @@ namespace alimer
         std::shared_ptr<CommandQueue> GetCommandQueue(CommandQueueType type = CommandQueueType::Graphics) const;
 
         /// Add a GPU resource to keep track of. Called by GPUResource.
-        void AddGPUResource(GPUResource* resource);
+        GPUResourceHandle AddGPUResource(GPUResource* resource);
         /// Remove a tracked GPU resource. Called by GPUResource.
         void RemoveGPUResource(GPUResource* resource);
+        /// Return the tracked resource for the handle, null if the handle is stale.
+        GPUResource* GetGPUResource(GPUResource::Type type, GPUResourceHandle handle);
+
+        /// Queue an object to be released once the GPU finished all work submitted so far. Thread safe.
+        void DeferRelease(void* object, DeferredReleaseFunction release);
+
+        /// Queue a resource to be destroyed once the GPU no longer uses it, the device holds a reference until then.
+        void DeferDestroy(GPUResource* resource);
+
+        /// Release in one batch the queued objects the GPU has finished with, force releases everything.
+        void ExecuteDeferredReleases(bool force = false);
+
+        /// Signal every queue so the work recorded this frame gets a fence, then execute the deferred releases. Call once per frame.
+        void EndFrame();
 
         /// Get the features.
         inline const GPUDeviceCaps& GetCaps() const { return caps; }
 
+        /// Get the current device statistics.
+        Stats GetStats();
+
         /**
         * Get the native API handle.
         */
@@ -111,9 +153,28 @@ namespace alimer
         Desc desc;
         GPUDeviceApiData* apiData = nullptr;
 
-        /// Tracked gpu resource.
-        std::mutex _gpuResourceMutex;
-        std::vector<GPUResource*> _gpuResources;
+        /// Tracked gpu resources, one pool per resource type.
+        using GPUResourcePool = ConcurrentHandlePool<GPUResource, GPUResource*>;
+        GPUResourcePool _gpuResources[static_cast<uint32_t>(GPUResource::Type::Count)];
+
+        struct DeferredRelease
+        {
+            uint64_t fenceValues[3];
+            DeferredReleaseFunction release;
+            void* object;
+        };
+
+        /// Objects waiting for the GPU, producers only append under the short queue lock.
+        std::mutex _deferredReleaseMutex;
+        std::vector<DeferredRelease> _deferredReleases;
+        /// Batch being executed, keeps its capacity between frames.
+        std::mutex _deferredExecuteMutex;
+        std::vector<DeferredRelease> _deferredReleaseBatch;
+        std::vector<DeferredRelease> _deferredReleaseNotReady;
+
+        /// Command statistics.
+        std::atomic<uint64_t> commandCount{ 0 };
+        std::atomic<uint64_t> submitCount{ 0 };
 
     private:
         ALIMER_DISABLE_COPY_MOVE(GPUDevice);
@@ -26,16 +26,23 @@
 
 namespace alimer
 {
-    GPUResource::GPUResource(GPUDevice* device, Type type)
+    GPUResource::GPUResource(GPUDevice* device, Type type, uint64_t size)
         : _device(device)
         , _type(type)
+        , _size(size)
     {
-        //device->AddGPUResource(this);
+        if (_device != nullptr)
+        {
+            _handle = _device->AddGPUResource(this);
+        }
     }
 
     GPUResource::~GPUResource()
     {
-        //device->RemoveGPUResource(this);
+        if (_device != nullptr)
+        {
+            _device->RemoveGPUResource(this);
+        }
     }
 
     GPUDevice* GPUResource::GetDevice() const
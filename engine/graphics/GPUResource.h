@@ -25,15 +25,20 @@
 #include "graphics/Types.h"
 #include "graphics/BackendTypes.h"
 #include "core/Object.h"
+#include "core/HandlePool.h"
 
 namespace alimer
 {
     class GPUDevice;
+    class GPUResource;
+
+    using GPUResourceHandle = Handle<GPUResource>;
 
     /// Defines a GPUResource created by GPU device.
     class ALIMER_API GPUResource : public Object
     {
         ALIMER_OBJECT(GPUResource, Object);
+        friend class GPUDevice;
 
     public:
         /// Resource types. 
@@ -44,12 +49,13 @@ namespace alimer
             /// Buffer. Can be bound to all shader-stages
             Buffer,
             ///Texture. Can be bound as render-target, shader-resource and UAV
-            Texture
+            Texture,
+            Count
         };
 
     protected:
-        /// Constructor.
-        GPUResource(GPUDevice* device, Type type);
+        /// Constructor, the size is set before the device starts tracking the resource.
+        GPUResource(GPUDevice* device, Type type, uint64_t size = 0);
 
         /// Destructor.
         virtual ~GPUResource();
@@ -60,11 +66,21 @@ namespace alimer
 
         GPUDevice* GetDevice() const;
 
+        /// Return the resource type.
+        Type GetResourceType() const { return _type; }
+
+        /// Return the handle the device tracks the resource with.
+        GPUResourceHandle GetResourceHandle() const { return _handle; }
+
+        /// Return the size in bytes of the resource.
+        uint64_t GetSize() const { return _size; }
+
     protected:
         GPUDevice* _device;
         Type _type;
+        GPUResourceHandle _handle;
         /// Size in bytes of the resource.
-        uint64_t _size{ 0 };
+        uint64_t _size;
 
     private:
         ALIMER_DISABLE_COPY_MOVE(GPUResource);
@@ -0,0 +1,299 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "graphics/MipGeneration.h"
+#include "graphics/PixelFormatConversion.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+#include "math/math.h"
+#include "math/simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace alimer
+{
+    namespace
+    {
+        /// Output rows per job, large enough to amortize the rows shared with the neighboring bands.
+        constexpr uint32_t kRowsPerBand = 16;
+
+        /// Kaiser window shape, the same defaults as most texture tools.
+        constexpr float kKaiserAlpha = 4.0f;
+        constexpr float kWindowedSincRadius = 3.0f;
+
+        float Sinc(float x)
+        {
+            if (std::fabs(x) < 1e-5f)
+                return 1.0f;
+
+            x *= pi<float>();
+            return std::sin(x) / x;
+        }
+
+        /// Modified Bessel function of the first kind, order zero.
+        float BesselI0(float x)
+        {
+            const float halfSquared = 0.25f * x * x;
+            float sum = 1.0f;
+            float term = 1.0f;
+            for (uint32_t k = 1; k < 32 && term > 1e-7f * sum; ++k)
+            {
+                term *= halfSquared / float(k * k);
+                sum += term;
+            }
+            return sum;
+        }
+
+        float GetFilterRadius(MipFilter filter)
+        {
+            return filter == MipFilter::Box ? 0.5f : kWindowedSincRadius;
+        }
+
+        /// Kernel value at x, in destination pixels from the center.
+        float EvaluateKernel(MipFilter filter, float x)
+        {
+            const float t = x / kWindowedSincRadius;
+            if (t <= -1.0f || t >= 1.0f)
+                return 0.0f;
+
+            if (filter == MipFilter::Kaiser)
+                return Sinc(x) * BesselI0(kKaiserAlpha * std::sqrt(1.0f - t * t)) / BesselI0(kKaiserAlpha);
+            return Sinc(x) * Sinc(t);
+        }
+
+        /// Precomputed taps of one axis: every destination pixel reads tapCount source pixels, already clamped to the edge.
+        struct FilterAxis
+        {
+            uint32_t tapCount;
+            std::vector<uint32_t> indices;
+            std::vector<float> weights;
+        };
+
+        void BuildAxis(MipFilter filter, uint32_t sourceSize, uint32_t destinationSize, FilterAxis& axis)
+        {
+            const float scale = float(sourceSize) / float(destinationSize);
+            const float radius = GetFilterRadius(filter) * scale;
+            axis.tapCount = uint32_t(std::ceil(radius * 2.0f)) + 1;
+            axis.indices.resize(size_t(destinationSize) * axis.tapCount);
+            axis.weights.resize(size_t(destinationSize) * axis.tapCount);
+
+            for (uint32_t i = 0; i < destinationSize; ++i)
+            {
+                const float center = (float(i) + 0.5f) * scale;
+                const int first = int(std::floor(center - radius));
+                uint32_t* indices = &axis.indices[size_t(i) * axis.tapCount];
+                float* weights = &axis.weights[size_t(i) * axis.tapCount];
+
+                float total = 0.0f;
+                for (uint32_t tap = 0; tap < axis.tapCount; ++tap)
+                {
+                    const int index = first + int(tap);
+                    float weight;
+                    if (filter == MipFilter::Box)
+                    {
+                        // Exact coverage of the source pixel by the box, for fractional ratios too.
+                        const float left = std::max(float(index), center - radius);
+                        const float right = std::min(float(index + 1), center + radius);
+                        weight = std::max(0.0f, right - left);
+                    }
+                    else
+                    {
+                        weight = EvaluateKernel(filter, (float(index) + 0.5f - center) / scale);
+                    }
+
+                    indices[tap] = uint32_t(std::min(std::max(index, 0), int(sourceSize) - 1));
+                    weights[tap] = weight;
+                    total += weight;
+                }
+
+                for (uint32_t tap = 0; tap < axis.tapCount; ++tap)
+                {
+                    weights[tap] /= total;
+                }
+            }
+        }
+
+        /// Filter one band of destination rows, RGBA float pixels are one SIMD vector each.
+        void FilterBand(
+            const FilterAxis& horizontal, const FilterAxis& vertical,
+            const float* source, uint32_t sourceWidth,
+            float* destination, uint32_t destinationWidth,
+            uint32_t firstRow, uint32_t lastRow, std::vector<float>& scratch)
+        {
+            // Source rows the band reads, indices are clamped so they stay within the span of the taps.
+            uint32_t minimumRow = UINT32_MAX;
+            uint32_t maximumRow = 0;
+            for (size_t i = size_t(firstRow) * vertical.tapCount; i < size_t(lastRow) * vertical.tapCount; ++i)
+            {
+                if (vertical.weights[i] != 0.0f)
+                {
+                    minimumRow = std::min(minimumRow, vertical.indices[i]);
+                    maximumRow = std::max(maximumRow, vertical.indices[i]);
+                }
+            }
+
+            const size_t rowFloats = size_t(destinationWidth) * 4;
+            scratch.resize((maximumRow - minimumRow + 1) * rowFloats);
+
+            for (uint32_t row = minimumRow; row <= maximumRow; ++row)
+            {
+                const float* input = source + size_t(row) * sourceWidth * 4;
+                float* output = scratch.data() + (row - minimumRow) * rowFloats;
+                for (uint32_t x = 0; x < destinationWidth; ++x)
+                {
+                    const uint32_t* indices = &horizontal.indices[size_t(x) * horizontal.tapCount];
+                    const float* weights = &horizontal.weights[size_t(x) * horizontal.tapCount];
+                    simd::float4v sum = simd::zero();
+                    for (uint32_t tap = 0; tap < horizontal.tapCount; ++tap)
+                    {
+                        sum = simd::madd(simd::load(input + size_t(indices[tap]) * 4), simd::splat(weights[tap]), sum);
+                    }
+                    simd::store(output + size_t(x) * 4, sum);
+                }
+            }
+
+            for (uint32_t y = firstRow; y < lastRow; ++y)
+            {
+                const uint32_t* indices = &vertical.indices[size_t(y) * vertical.tapCount];
+                const float* weights = &vertical.weights[size_t(y) * vertical.tapCount];
+                float* output = destination + size_t(y) * rowFloats;
+                for (size_t x = 0; x < rowFloats; x += 4)
+                {
+                    simd::float4v sum = simd::zero();
+                    for (uint32_t tap = 0; tap < vertical.tapCount; ++tap)
+                    {
+                        if (weights[tap] != 0.0f)
+                        {
+                            const float* input = scratch.data() + (indices[tap] - minimumRow) * rowFloats + x;
+                            sum = simd::madd(simd::load(input), simd::splat(weights[tap]), sum);
+                        }
+                    }
+                    simd::store(output + x, sum);
+                }
+            }
+        }
+
+        void Downsample(
+            MipFilter filter,
+            const float* source, uint32_t sourceWidth, uint32_t sourceHeight,
+            float* destination, uint32_t destinationWidth, uint32_t destinationHeight)
+        {
+            FilterAxis horizontal;
+            FilterAxis vertical;
+            BuildAxis(filter, sourceWidth, destinationWidth, horizontal);
+            BuildAxis(filter, sourceHeight, destinationHeight, vertical);
+
+            const uint32_t bandCount = (destinationHeight + kRowsPerBand - 1) / kRowsPerBand;
+            JobSystem::ParallelFor(bandCount, 1, [&](uint32_t band) {
+                // Reused by every band a thread filters, it only grows.
+                static thread_local std::vector<float> scratch;
+                const uint32_t firstRow = band * kRowsPerBand;
+                const uint32_t lastRow = std::min(destinationHeight, firstRow + kRowsPerBand);
+                FilterBand(horizontal, vertical, source, sourceWidth, destination, destinationWidth, firstRow, lastRow, scratch);
+            });
+        }
+    }
+
+    uint32_t GetMipLevelCount(uint32_t width, uint32_t height)
+    {
+        uint32_t size = std::max(width, height);
+        uint32_t levels = 1;
+        while (size > 1)
+        {
+            size >>= 1;
+            ++levels;
+        }
+        return levels;
+    }
+
+    size_t GetMipChainSize(PixelFormat format, uint32_t width, uint32_t height, uint32_t levelCount)
+    {
+        const size_t bytesPerPixel = GetFormatBitsPerPixel(format) / 8;
+        size_t size = 0;
+        for (uint32_t level = 0; level < levelCount; ++level)
+        {
+            size += size_t(width) * height * bytesPerPixel;
+            width = std::max(1u, width / 2);
+            height = std::max(1u, height / 2);
+        }
+        return size;
+    }
+
+    bool CanGenerateMips(PixelFormat format)
+    {
+        return !IsDepthFormat(format) && CanConvertPixels(format, PixelFormat::RGBA32Float);
+    }
+
+    bool GenerateMipChain(
+        PixelFormat format, const void* source, uint32_t sourceRowPitch, uint32_t width, uint32_t height,
+        uint32_t levelCount, MipFilter filter, void* destination)
+    {
+        ALIMER_PROFILE_SCOPE("GenerateMipChain");
+
+        if (!CanGenerateMips(format))
+            return false;
+
+        if (width == 0 || height == 0)
+            return true;
+
+        const uint32_t fullLevelCount = GetMipLevelCount(width, height);
+        ALIMER_ASSERT(source != nullptr && destination != nullptr);
+        if (levelCount == 0 || levelCount > fullLevelCount)
+            levelCount = fullLevelCount;
+
+        // The first level is the source itself.
+        const uint32_t bytesPerPixel = GetFormatBitsPerPixel(format) / 8;
+        const uint8_t* input = static_cast<const uint8_t*>(source);
+        uint8_t* output = static_cast<uint8_t*>(destination);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            memcpy(output + size_t(y) * width * bytesPerPixel, input + size_t(y) * sourceRowPitch, size_t(width) * bytesPerPixel);
+        }
+
+        if (levelCount == 1)
+            return true;
+
+        // Every level filters the previous one in float, then packs back to the format.
+        std::vector<float> current(size_t(width) * height * 4);
+        std::vector<float> next;
+        ConvertPixels(format, source, sourceRowPitch, PixelFormat::RGBA32Float, current.data(), width * 16, width, height);
+
+        for (uint32_t level = 1; level < levelCount; ++level)
+        {
+            output += size_t(width) * height * bytesPerPixel;
+
+            const uint32_t levelWidth = std::max(1u, width / 2);
+            const uint32_t levelHeight = std::max(1u, height / 2);
+            next.resize(size_t(levelWidth) * levelHeight * 4);
+            Downsample(filter, current.data(), width, height, next.data(), levelWidth, levelHeight);
+            ConvertPixels(PixelFormat::RGBA32Float, next.data(), levelWidth * 16, format, output, levelWidth * bytesPerPixel, levelWidth, levelHeight);
+
+            std::swap(current, next);
+            width = levelWidth;
+            height = levelHeight;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,56 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "graphics/PixelFormat.h"
+
+namespace alimer
+{
+    /// Filter used to downsample each mip level from the previous one.
+    enum class MipFilter : uint32_t
+    {
+        /// Area average, a plain 2x2 average for even sizes.
+        Box,
+        /// Kaiser windowed sinc, sharper than box with little ringing.
+        Kaiser,
+        /// Lanczos 3, the sharpest, rings on hard edges.
+        Lanczos
+    };
+
+    /// Number of levels in a full mip chain down to 1x1.
+    ALIMER_API uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+
+    /// Size in bytes of levelCount tightly packed levels of an uncompressed format, starting at width x height.
+    ALIMER_API size_t GetMipChainSize(PixelFormat format, uint32_t width, uint32_t height, uint32_t levelCount);
+
+    /// Return true if GenerateMipChain supports the format: any format ConvertPixels handles except depth.
+    ALIMER_API bool CanGenerateMips(PixelFormat format);
+
+    /// Build a mip chain and write every level, the source included, tightly packed to destination, the layout
+    /// TextureDescriptor::content expects for one array layer. Textures created with generateMips call it. Each level halves the previous one rounding down, so odd sizes are
+    /// resampled rather than averaged. Filtering runs on linear float data (sRGB formats are decoded first) and
+    /// each level is split in bands of rows across the job system threads. A levelCount of 0 builds the full chain.
+    ALIMER_API bool GenerateMipChain(
+        PixelFormat format, const void* source, uint32_t sourceRowPitch, uint32_t width, uint32_t height,
+        uint32_t levelCount, MipFilter filter, void* destination);
+}
@@ -0,0 +1,797 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "graphics/PixelFormatConversion.h"
+#include "core/JobSystem.h"
+#include "core/Profiler.h"
+#include "math/half.h"
+#include "math/simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace alimer
+{
+    namespace
+    {
+        enum class Packing
+        {
+            Uniform,
+            RGB10A2,
+            RG11B10
+        };
+
+        /// Memory layout of a format, derived from kFormatDesc.
+        struct Layout
+        {
+            PixelFormatType type;
+            Packing packing;
+            uint32_t channels;
+            uint32_t channelBits;
+            uint32_t bytesPerPixel;
+            bool bgra;
+        };
+
+        enum class ConversionPath
+        {
+            Copy,
+            SwapRedBlue,
+            Integer,
+            Float
+        };
+
+        bool GetLayout(PixelFormat format, Layout& layout)
+        {
+            if (format == PixelFormat::Unknown || format >= PixelFormat::Count || IsCompressedFormat(format))
+                return false;
+
+            const PixelFormatDesc& desc = kFormatDesc[(uint32_t)format];
+            layout.type = desc.type;
+            layout.packing = Packing::Uniform;
+            layout.bytesPerPixel = desc.bitsPerPixel / 8;
+            layout.bgra = format == PixelFormat::BGRA8Unorm || format == PixelFormat::BGRA8UnormSrgb;
+
+            switch (format)
+            {
+            case PixelFormat::RGB10A2Unorm:
+                layout.packing = Packing::RGB10A2;
+                layout.channels = 4;
+                layout.channelBits = 0;
+                return true;
+            case PixelFormat::RG11B10Float:
+                layout.packing = Packing::RG11B10;
+                layout.channels = 3;
+                layout.channelBits = 0;
+                return true;
+            case PixelFormat::D16Unorm:
+                layout.channels = 1;
+                layout.channelBits = 16;
+                return true;
+            case PixelFormat::D32Float:
+                layout.type = PixelFormatType::Float;
+                layout.channels = 1;
+                layout.channelBits = 32;
+                return true;
+            case PixelFormat::D24UnormS8:
+            case PixelFormat::D32FloatS8X24:
+                return false;
+            default:
+                break;
+            }
+
+            layout.channels = (desc.bits.red > 0) + (desc.bits.green > 0) + (desc.bits.blue > 0) + (desc.bits.alpha > 0);
+            layout.channelBits = desc.bits.red;
+            return layout.channels > 0;
+        }
+
+        bool IsIntegerType(PixelFormatType type)
+        {
+            return type == PixelFormatType::UInt || type == PixelFormatType::SInt;
+        }
+
+        /// Lookup tables for exact sRGB decode of 8 bit values and correctly rounded encode to 8 bits.
+        struct SrgbTables
+        {
+            static constexpr uint32_t kEncodeBuckets = 4096;
+
+            float decode[256];
+            /// Linear value halfway between two consecutive sRGB codes.
+            float thresholds[255];
+            /// First candidate code for every bucket of linear values.
+            uint8_t encodeStart[kEncodeBuckets];
+
+            SrgbTables()
+            {
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    decode[i] = float(DecodeExact(i / 255.0));
+                }
+
+                for (uint32_t i = 0; i < 255; ++i)
+                {
+                    thresholds[i] = float(DecodeExact((i + 0.5) / 255.0));
+                }
+
+                uint32_t code = 0;
+                for (uint32_t bucket = 0; bucket < kEncodeBuckets; ++bucket)
+                {
+                    const float value = float(bucket) / kEncodeBuckets;
+                    while (code < 255 && value >= thresholds[code])
+                    {
+                        ++code;
+                    }
+                    encodeStart[bucket] = uint8_t(code);
+                }
+            }
+
+            static double DecodeExact(double value)
+            {
+                return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+            }
+
+            uint8_t Encode(float value) const
+            {
+                if (!(value > 0.0f))
+                    return 0;
+                if (value >= 1.0f)
+                    return 255;
+
+                uint32_t code = encodeStart[uint32_t(value * kEncodeBuckets)];
+                while (code < 255 && value >= thresholds[code])
+                {
+                    ++code;
+                }
+                return uint8_t(code);
+            }
+        };
+
+        const SrgbTables& GetSrgbTables()
+        {
+            static const SrgbTables tables;
+            return tables;
+        }
+
+        /// Clamp to [low, high] with NaN going to low, then round to nearest.
+        inline double ClampRound(double value, double low, double high)
+        {
+            if (!(value > low))
+                value = low;
+            if (value > high)
+                value = high;
+            return std::floor(value + 0.5);
+        }
+
+        inline float Saturate(float value)
+        {
+            return value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+        }
+
+        /// Decode an unsigned float with a 5 bit exponent and mantissaBits of mantissa (float11 / float10).
+        inline float DecodeSmallFloat(uint32_t bits, uint32_t mantissaBits)
+        {
+            const uint32_t mantissa = bits & ((1u << mantissaBits) - 1);
+            const uint32_t exponent = bits >> mantissaBits;
+            if (exponent == 31)
+                return mantissa != 0 ? NAN : INFINITY;
+            if (exponent == 0)
+                return std::ldexp(float(mantissa), -14 - int(mantissaBits));
+            return std::ldexp(float(mantissa | (1u << mantissaBits)), int(exponent) - 15 - int(mantissaBits));
+        }
+
+        /// Encode to an unsigned small float rounding to nearest even, negatives give zero and finite overflow the largest value.
+        inline uint32_t EncodeSmallFloat(float value, uint32_t mantissaBits)
+        {
+            if (std::isnan(value))
+                return (31u << mantissaBits) | 1u;
+            if (!(value > 0.0f))
+                return 0;
+            if (std::isinf(value))
+                return 31u << mantissaBits;
+
+            uint32_t f;
+            memcpy(&f, &value, sizeof(f));
+            const int exponent = int((f >> 23) & 0xff) - 127 + 15;
+            uint32_t result;
+            if (exponent <= 0)
+            {
+                // Subnormal, a carry into the exponent field gives the smallest normal.
+                result = uint32_t(std::nearbyint(std::ldexp(value, 14 + int(mantissaBits))));
+            }
+            else
+            {
+                const uint32_t shift = 23 - mantissaBits;
+                const uint32_t mantissa = f & 0x7fffff;
+                result = (uint32_t(exponent) << mantissaBits) | (mantissa >> shift);
+                const uint32_t remainder = mantissa & ((1u << shift) - 1);
+                const uint32_t halfway = 1u << (shift - 1);
+                if (remainder > halfway || (remainder == halfway && (result & 1u)))
+                {
+                    ++result;
+                }
+            }
+
+            const uint32_t maxFinite = (31u << mantissaBits) - 1;
+            return std::min(result, maxFinite);
+        }
+
+        void Unorm8ToFloat(const uint8_t* input, float* output, size_t count)
+        {
+            size_t i = 0;
+#if defined(ALIMER_SIMD_SSE2)
+            const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 16 <= count; i += 16)
+            {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+                const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+                _mm_storeu_ps(output + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale));
+                _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale));
+                _mm_storeu_ps(output + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale));
+                _mm_storeu_ps(output + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scale));
+            }
+#elif defined(ALIMER_SIMD_NEON)
+            const float32x4_t scale = vdupq_n_f32(1.0f / 255.0f);
+            for (; i + 16 <= count; i += 16)
+            {
+                const uint8x16_t bytes = vld1q_u8(input + i);
+                const uint16x8_t low = vmovl_u8(vget_low_u8(bytes));
+                const uint16x8_t high = vmovl_u8(vget_high_u8(bytes));
+                vst1q_f32(output + i + 0, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(low))), scale));
+                vst1q_f32(output + i + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(low))), scale));
+                vst1q_f32(output + i + 8, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(high))), scale));
+                vst1q_f32(output + i + 12, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(high))), scale));
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                output[i] = input[i] * (1.0f / 255.0f);
+            }
+        }
+
+        /// Saturate, scale and round half up, NaN gives zero.
+        void FloatToUnorm8(const float* input, uint8_t* output, size_t count)
+        {
+            size_t i = 0;
+#if defined(ALIMER_SIMD_SSE2)
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 scale = _mm_set1_ps(255.0f);
+            const __m128 bias = _mm_set1_ps(0.5f);
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i values[4];
+                for (int j = 0; j < 4; ++j)
+                {
+                    // maxps returns its second operand for NaN.
+                    const __m128 saturated = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(input + i + j * 4), zero), one);
+                    values[j] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(saturated, scale), bias));
+                }
+
+                const __m128i low = _mm_packs_epi32(values[0], values[1]);
+                const __m128i high = _mm_packs_epi32(values[2], values[3]);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(low, high));
+            }
+#elif defined(ALIMER_SIMD_NEON)
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+            const float32x4_t one = vdupq_n_f32(1.0f);
+            const float32x4_t scale = vdupq_n_f32(255.0f);
+            const float32x4_t bias = vdupq_n_f32(0.5f);
+            for (; i + 8 <= count; i += 8)
+            {
+                const float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(input + i), zero), one);
+                const float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(input + i + 4), zero), one);
+                const uint16x4_t a16 = vmovn_u32(vcvtq_u32_f32(vmlaq_f32(bias, a, scale)));
+                const uint16x4_t b16 = vmovn_u32(vcvtq_u32_f32(vmlaq_f32(bias, b, scale)));
+                vst1_u8(output + i, vmovn_u16(vcombine_u16(a16, b16)));
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                output[i] = uint8_t(Saturate(input[i]) * 255.0f + 0.5f);
+            }
+        }
+
+        template <typename T>
+        void Load(const uint8_t* input, size_t index, T& value)
+        {
+            memcpy(&value, input + index * sizeof(T), sizeof(T));
+        }
+
+        template <typename T>
+        void Store(uint8_t* output, size_t index, T value)
+        {
+            memcpy(output + index * sizeof(T), &value, sizeof(T));
+        }
+
+        /// Convert count components of a uniform format to float.
+        void ComponentsToFloat(const Layout& layout, const uint8_t* input, float* output, size_t count)
+        {
+            switch (layout.channelBits)
+            {
+            case 8:
+                switch (layout.type)
+                {
+                case PixelFormatType::UNorm:
+                case PixelFormatType::UnormSrgb:
+                    Unorm8ToFloat(input, output, count);
+                    break;
+                case PixelFormatType::SNorm:
+                    for (size_t i = 0; i < count; ++i)
+                        output[i] = std::max(int8_t(input[i]) / 127.0f, -1.0f);
+                    break;
+                case PixelFormatType::SInt:
+                    for (size_t i = 0; i < count; ++i)
+                        output[i] = float(int8_t(input[i]));
+                    break;
+                default:
+                    for (size_t i = 0; i < count; ++i)
+                        output[i] = float(input[i]);
+                    break;
+                }
+                break;
+
+            case 16:
+                if (layout.type == PixelFormatType::Float)
+                {
+                    convert_to_float(reinterpret_cast<const half*>(input), output, count);
+                    break;
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    uint16_t value;
+                    Load(input, i, value);
+                    switch (layout.type)
+                    {
+                    case PixelFormatType::UNorm: output[i] = value / 65535.0f; break;
+                    case PixelFormatType::SNorm: output[i] = std::max(int16_t(value) / 32767.0f, -1.0f); break;
+                    case PixelFormatType::SInt: output[i] = float(int16_t(value)); break;
+                    default: output[i] = float(value); break;
+                    }
+                }
+                break;
+
+            case 32:
+                if (layout.type == PixelFormatType::Float)
+                {
+                    memcpy(output, input, count * sizeof(float));
+                    break;
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    uint32_t value;
+                    Load(input, i, value);
+                    output[i] = layout.type == PixelFormatType::SInt ? float(int32_t(value)) : float(value);
+                }
+                break;
+            }
+        }
+
+        /// Convert count floats to components of a uniform format.
+        void FloatToComponents(const Layout& layout, const float* input, uint8_t* output, size_t count)
+        {
+            switch (layout.channelBits)
+            {
+            case 8:
+                switch (layout.type)
+                {
+                case PixelFormatType::UNorm:
+                case PixelFormatType::UnormSrgb:
+                    FloatToUnorm8(input, output, count);
+                    break;
+                case PixelFormatType::SNorm:
+                    for (size_t i = 0; i < count; ++i)
+                        output[i] = uint8_t(int8_t(ClampRound(input[i] * 127.0, -127.0, 127.0)));
+                    break;
+                case PixelFormatType::SInt:
+                    for (size_t i = 0; i < count; ++i)
+                        output[i] = uint8_t(int8_t(ClampRound(input[i], -128.0, 127.0)));
+                    break;
+                default:
+                    for (size_t i = 0; i < count; ++i)
+                        output[i] = uint8_t(ClampRound(input[i], 0.0, 255.0));
+                    break;
+                }
+                break;
+
+            case 16:
+                if (layout.type == PixelFormatType::Float)
+                {
+                    convert_to_half(input, reinterpret_cast<half*>(output), count);
+                    break;
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    uint16_t value;
+                    switch (layout.type)
+                    {
+                    case PixelFormatType::UNorm: value = uint16_t(Saturate(input[i]) * 65535.0f + 0.5f); break;
+                    case PixelFormatType::SNorm: value = uint16_t(int16_t(ClampRound(input[i] * 32767.0, -32767.0, 32767.0))); break;
+                    case PixelFormatType::SInt: value = uint16_t(int16_t(ClampRound(input[i], -32768.0, 32767.0))); break;
+                    default: value = uint16_t(ClampRound(input[i], 0.0, 65535.0)); break;
+                    }
+                    Store(output, i, value);
+                }
+                break;
+
+            case 32:
+                if (layout.type == PixelFormatType::Float)
+                {
+                    memcpy(output, input, count * sizeof(float));
+                    break;
+                }
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const uint32_t value = layout.type == PixelFormatType::SInt
+                        ? uint32_t(int32_t(ClampRound(input[i], -2147483648.0, 2147483647.0)))
+                        : uint32_t(ClampRound(input[i], 0.0, 4294967295.0));
+                    Store(output, i, value);
+                }
+                break;
+            }
+        }
+
+        /// Scratch rows owned by one group of rows.
+        struct RowScratch
+        {
+            std::vector<float> rgba;
+            std::vector<float> components;
+            std::vector<int64_t> integers;
+        };
+
+        void UnpackRow(const Layout& layout, const uint8_t* input, float* rgba, float* components, uint32_t width)
+        {
+            if (layout.packing == Packing::RGB10A2)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    uint32_t value;
+                    Load(input, x, value);
+                    rgba[x * 4 + 0] = (value & 0x3ff) / 1023.0f;
+                    rgba[x * 4 + 1] = ((value >> 10) & 0x3ff) / 1023.0f;
+                    rgba[x * 4 + 2] = ((value >> 20) & 0x3ff) / 1023.0f;
+                    rgba[x * 4 + 3] = (value >> 30) / 3.0f;
+                }
+                return;
+            }
+
+            if (layout.packing == Packing::RG11B10)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    uint32_t value;
+                    Load(input, x, value);
+                    rgba[x * 4 + 0] = DecodeSmallFloat(value & 0x7ff, 6);
+                    rgba[x * 4 + 1] = DecodeSmallFloat((value >> 11) & 0x7ff, 6);
+                    rgba[x * 4 + 2] = DecodeSmallFloat(value >> 22, 5);
+                    rgba[x * 4 + 3] = 1.0f;
+                }
+                return;
+            }
+
+            if (layout.type == PixelFormatType::UnormSrgb)
+            {
+                // Always four 8 bit channels, alpha is linear.
+                const float* decode = GetSrgbTables().decode;
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    rgba[x * 4 + 0] = decode[input[x * 4 + 0]];
+                    rgba[x * 4 + 1] = decode[input[x * 4 + 1]];
+                    rgba[x * 4 + 2] = decode[input[x * 4 + 2]];
+                    rgba[x * 4 + 3] = input[x * 4 + 3] * (1.0f / 255.0f);
+                }
+            }
+            else if (layout.channels == 4)
+            {
+                ComponentsToFloat(layout, input, rgba, size_t(width) * 4);
+            }
+            else
+            {
+                const uint32_t channels = layout.channels;
+                ComponentsToFloat(layout, input, components, size_t(width) * channels);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        rgba[x * 4 + c] = c < channels ? components[x * channels + c] : (c == 3 ? 1.0f : 0.0f);
+                    }
+                }
+            }
+
+            if (layout.bgra)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    std::swap(rgba[x * 4 + 0], rgba[x * 4 + 2]);
+                }
+            }
+        }
+
+        /// Pack a float RGBA row, rgba is used as scratch and modified.
+        void PackRow(const Layout& layout, float* rgba, float* components, uint8_t* output, uint32_t width)
+        {
+            if (layout.packing == Packing::RGB10A2)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    const uint32_t r = uint32_t(Saturate(rgba[x * 4 + 0]) * 1023.0f + 0.5f);
+                    const uint32_t g = uint32_t(Saturate(rgba[x * 4 + 1]) * 1023.0f + 0.5f);
+                    const uint32_t b = uint32_t(Saturate(rgba[x * 4 + 2]) * 1023.0f + 0.5f);
+                    const uint32_t a = uint32_t(Saturate(rgba[x * 4 + 3]) * 3.0f + 0.5f);
+                    Store(output, x, r | (g << 10) | (b << 20) | (a << 30));
+                }
+                return;
+            }
+
+            if (layout.packing == Packing::RG11B10)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    const uint32_t r = EncodeSmallFloat(rgba[x * 4 + 0], 6);
+                    const uint32_t g = EncodeSmallFloat(rgba[x * 4 + 1], 6);
+                    const uint32_t b = EncodeSmallFloat(rgba[x * 4 + 2], 5);
+                    Store(output, x, r | (g << 11) | (b << 22));
+                }
+                return;
+            }
+
+            if (layout.bgra)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    std::swap(rgba[x * 4 + 0], rgba[x * 4 + 2]);
+                }
+            }
+
+            if (layout.type == PixelFormatType::UnormSrgb)
+            {
+                const SrgbTables& tables = GetSrgbTables();
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    output[x * 4 + 0] = tables.Encode(rgba[x * 4 + 0]);
+                    output[x * 4 + 1] = tables.Encode(rgba[x * 4 + 1]);
+                    output[x * 4 + 2] = tables.Encode(rgba[x * 4 + 2]);
+                    output[x * 4 + 3] = uint8_t(Saturate(rgba[x * 4 + 3]) * 255.0f + 0.5f);
+                }
+            }
+            else if (layout.channels == 4)
+            {
+                FloatToComponents(layout, rgba, output, size_t(width) * 4);
+            }
+            else
+            {
+                const uint32_t channels = layout.channels;
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    for (uint32_t c = 0; c < channels; ++c)
+                    {
+                        components[x * channels + c] = rgba[x * 4 + c];
+                    }
+                }
+                FloatToComponents(layout, components, output, size_t(width) * channels);
+            }
+        }
+
+        int64_t LoadInteger(const Layout& layout, const uint8_t* input, size_t index)
+        {
+            const bool isSigned = layout.type == PixelFormatType::SInt;
+            switch (layout.channelBits)
+            {
+            case 8:
+                return isSigned ? int64_t(int8_t(input[index])) : int64_t(input[index]);
+            case 16:
+            {
+                uint16_t value;
+                Load(input, index, value);
+                return isSigned ? int64_t(int16_t(value)) : int64_t(value);
+            }
+            default:
+            {
+                uint32_t value;
+                Load(input, index, value);
+                return isSigned ? int64_t(int32_t(value)) : int64_t(value);
+            }
+            }
+        }
+
+        void StoreInteger(const Layout& layout, uint8_t* output, size_t index, int64_t value)
+        {
+            const bool isSigned = layout.type == PixelFormatType::SInt;
+            const int64_t low = isSigned ? -(int64_t(1) << (layout.channelBits - 1)) : 0;
+            const int64_t high = isSigned ? (int64_t(1) << (layout.channelBits - 1)) - 1 : (int64_t(1) << layout.channelBits) - 1;
+            value = std::min(std::max(value, low), high);
+
+            switch (layout.channelBits)
+            {
+            case 8:
+                output[index] = uint8_t(value);
+                break;
+            case 16:
+                Store(output, index, uint16_t(value));
+                break;
+            default:
+                Store(output, index, uint32_t(value));
+                break;
+            }
+        }
+
+        /// Integer to integer conversion keeps full 32 bit precision, values saturate to the destination range.
+        void ConvertIntegerRow(const Layout& source, const uint8_t* input, const Layout& destination, uint8_t* output, int64_t* rgba, uint32_t width)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    rgba[x * 4 + c] = c < source.channels ? LoadInteger(source, input, size_t(x) * source.channels + c) : (c == 3 ? 1 : 0);
+                }
+            }
+
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                for (uint32_t c = 0; c < destination.channels; ++c)
+                {
+                    StoreInteger(destination, output, size_t(x) * destination.channels + c, rgba[x * 4 + c]);
+                }
+            }
+        }
+
+        void SwapRedBlueRow(const uint8_t* input, uint8_t* output, uint32_t width)
+        {
+            uint32_t x = 0;
+#if defined(ALIMER_SIMD_SSE2)
+            const __m128i greenAlphaMask = _mm_set1_epi32(int32_t(0xff00ff00u));
+            const __m128i redBlueMask = _mm_set1_epi32(0x00ff00ff);
+            for (; x + 4 <= width; x += 4)
+            {
+                const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + x * 4));
+                const __m128i redBlue = _mm_and_si128(pixels, redBlueMask);
+                const __m128i swapped = _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + x * 4), _mm_or_si128(_mm_and_si128(pixels, greenAlphaMask), swapped));
+            }
+#elif defined(ALIMER_SIMD_NEON)
+            for (; x + 16 <= width; x += 16)
+            {
+                uint8x16x4_t pixels = vld4q_u8(input + x * 4);
+                const uint8x16_t red = pixels.val[0];
+                pixels.val[0] = pixels.val[2];
+                pixels.val[2] = red;
+                vst4q_u8(output + x * 4, pixels);
+            }
+#endif
+
+            for (; x < width; ++x)
+            {
+                const uint8_t red = input[x * 4 + 0];
+                output[x * 4 + 0] = input[x * 4 + 2];
+                output[x * 4 + 1] = input[x * 4 + 1];
+                output[x * 4 + 2] = red;
+                output[x * 4 + 3] = input[x * 4 + 3];
+            }
+        }
+
+        ConversionPath SelectPath(PixelFormat sourceFormat, const Layout& source, PixelFormat destinationFormat, const Layout& destination)
+        {
+            if (sourceFormat == destinationFormat)
+                return ConversionPath::Copy;
+
+            const bool source8 = source.packing == Packing::Uniform && source.channels == 4 && source.channelBits == 8;
+            const bool destination8 = destination.packing == Packing::Uniform && destination.channels == 4 && destination.channelBits == 8;
+            if (source8 && destination8 && source.type == destination.type)
+            {
+                return source.bgra != destination.bgra ? ConversionPath::SwapRedBlue : ConversionPath::Copy;
+            }
+
+            if (IsIntegerType(source.type) && IsIntegerType(destination.type))
+                return ConversionPath::Integer;
+
+            return ConversionPath::Float;
+        }
+    }
+
+    bool CanConvertPixels(PixelFormat source, PixelFormat destination)
+    {
+        Layout sourceLayout, destinationLayout;
+        return GetLayout(source, sourceLayout) && GetLayout(destination, destinationLayout);
+    }
+
+    bool ConvertPixels(
+        PixelFormat sourceFormat, const void* source, uint32_t sourceRowPitch,
+        PixelFormat destinationFormat, void* destination, uint32_t destinationRowPitch,
+        uint32_t width, uint32_t height)
+    {
+        ALIMER_PROFILE_SCOPE("ConvertPixels");
+
+        Layout sourceLayout, destinationLayout;
+        if (!GetLayout(sourceFormat, sourceLayout) || !GetLayout(destinationFormat, destinationLayout))
+            return false;
+
+        if (width == 0 || height == 0)
+            return true;
+
+        ALIMER_ASSERT(source != nullptr && destination != nullptr);
+        ALIMER_ASSERT(sourceRowPitch >= width * sourceLayout.bytesPerPixel);
+        ALIMER_ASSERT(destinationRowPitch >= width * destinationLayout.bytesPerPixel);
+
+        const ConversionPath path = SelectPath(sourceFormat, sourceLayout, destinationFormat, destinationLayout);
+        if (sourceLayout.type == PixelFormatType::UnormSrgb || destinationLayout.type == PixelFormatType::UnormSrgb)
+        {
+            // Build the tables before the workers race for them.
+            GetSrgbTables();
+        }
+
+        // Groups of rows covering about 64KB keep the scratch rows in cache and the job count low.
+        const uint32_t rowBytes = width * std::max(std::max(sourceLayout.bytesPerPixel, destinationLayout.bytesPerPixel), 16u);
+        const uint32_t rowsPerGroup = std::max(1u, (64u * 1024u) / rowBytes);
+        const uint32_t groupCount = (height + rowsPerGroup - 1) / rowsPerGroup;
+
+        const uint8_t* input = static_cast<const uint8_t*>(source);
+        uint8_t* output = static_cast<uint8_t*>(destination);
+
+        JobSystem::ParallelFor(groupCount, 1, [&](uint32_t group) {
+            const uint32_t firstRow = group * rowsPerGroup;
+            const uint32_t lastRow = std::min(height, firstRow + rowsPerGroup);
+
+            RowScratch scratch;
+            if (path == ConversionPath::Float)
+            {
+                scratch.rgba.resize(size_t(width) * 4);
+                scratch.components.resize(size_t(width) * 4);
+            }
+            else if (path == ConversionPath::Integer)
+            {
+                scratch.integers.resize(size_t(width) * 4);
+            }
+
+            for (uint32_t y = firstRow; y < lastRow; ++y)
+            {
+                const uint8_t* sourceRow = input + size_t(y) * sourceRowPitch;
+                uint8_t* destinationRow = output + size_t(y) * destinationRowPitch;
+
+                switch (path)
+                {
+                case ConversionPath::Copy:
+                    memcpy(destinationRow, sourceRow, size_t(width) * sourceLayout.bytesPerPixel);
+                    break;
+                case ConversionPath::SwapRedBlue:
+                    SwapRedBlueRow(sourceRow, destinationRow, width);
+                    break;
+                case ConversionPath::Integer:
+                    ConvertIntegerRow(sourceLayout, sourceRow, destinationLayout, destinationRow, scratch.integers.data(), width);
+                    break;
+                case ConversionPath::Float:
+                    UnpackRow(sourceLayout, sourceRow, scratch.rgba.data(), scratch.components.data(), width);
+                    PackRow(destinationLayout, scratch.rgba.data(), scratch.components.data(), destinationRow, width);
+                    break;
+                }
+            }
+        });
+
+        return true;
+    }
+}
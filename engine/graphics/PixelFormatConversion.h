@@ -0,0 +1,40 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "graphics/PixelFormat.h"
+
+namespace alimer
+{
+    /// Return true if ConvertPixels supports converting from source to destination.
+    /// Any pair of uncompressed color formats plus D16Unorm and D32Float is supported.
+    ALIMER_API bool CanConvertPixels(PixelFormat source, PixelFormat destination);
+
+    /// Convert a whole image between two uncompressed formats, rows are split across the job system threads.
+    /// Missing channels read as (0, 0, 0, 1), sRGB formats are decoded to linear and encoded back, integer
+    /// formats convert by value and normalized formats by range. Returns false for unsupported formats.
+    ALIMER_API bool ConvertPixels(
+        PixelFormat sourceFormat, const void* source, uint32_t sourceRowPitch,
+        PixelFormat destinationFormat, void* destination, uint32_t destinationRowPitch,
+        uint32_t width, uint32_t height);
+}
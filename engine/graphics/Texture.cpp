@@ -22,11 +22,49 @@
 
 #include "graphics/Texture.h"
 #include "graphics/GPUDevice.h"
+#include "graphics/MipGeneration.h"
+#include "core/Log.h"
+#include <algorithm>
 
 namespace alimer
 {
+    namespace
+    {
+        /// Number of levels of the texture, zero mip levels means the full chain.
+        uint32_t GetLevelCount(TextureType type, const usize3& extent, uint32_t mipLevels)
+        {
+            if (mipLevels > 0)
+                return mipLevels;
+
+            const bool is3D = type == TextureType::Type3D;
+            return GetMipLevelCount(std::max(extent.width, is3D ? extent.depth : 1u), extent.height);
+        }
+
+        /// Size in bytes of every level of every layer and sample, backends may pad this for alignment.
+        uint64_t GetTextureSize(const TextureDescriptor* descriptor)
+        {
+            const bool is3D = descriptor->type == TextureType::Type3D;
+            const usize3& extent = descriptor->extent;
+            const uint32_t layerCount = is3D ? 1 : extent.depth * (descriptor->type == TextureType::TypeCube ? 6 : 1);
+            const uint32_t levelCount = GetLevelCount(descriptor->type, extent, descriptor->mipLevels);
+            const uint32_t blockWidth = GetFormatBlockWidth(descriptor->format);
+            const uint32_t blockHeight = GetFormatBlockHeight(descriptor->format);
+
+            uint64_t layerSize = 0;
+            for (uint32_t level = 0; level < levelCount; ++level)
+            {
+                const uint64_t width = (std::max(1u, extent.width >> level) + blockWidth - 1) / blockWidth;
+                const uint64_t height = (std::max(1u, extent.height >> level) + blockHeight - 1) / blockHeight;
+                const uint64_t depth = is3D ? std::max(1u, extent.depth >> level) : 1u;
+                layerSize += width * height * depth * GetFormatBlockSize(descriptor->format);
+            }
+
+            return layerSize * layerCount * static_cast<uint32_t>(descriptor->sampleCount);
+        }
+    }
+
     Texture::Texture(GPUDevice* device, const TextureDescriptor* descriptor)
-        : GPUResource(device, Type::Texture)
+        : GPUResource(device, Type::Texture, GetTextureSize(descriptor))
         , type(descriptor->type)
         , usage(descriptor->usage)
         , format(descriptor->format)
@@ -36,5 +74,71 @@ namespace alimer
         , external(descriptor->externalHandle != nullptr)
     {
     }
-}
 
+    bool Texture::GetSubresourceData(const TextureDescriptor* descriptor, std::vector<uint8_t>& storage, std::vector<SubresourceData>& subresources) const
+    {
+        subresources.clear();
+        if (descriptor->content == nullptr || external || sampleCount != TextureSampleCount::Count1)
+            return true;
+
+        const bool is3D = type == TextureType::Type3D;
+        const uint32_t layerCount = is3D ? 1 : extent.depth * (type == TextureType::TypeCube ? 6 : 1);
+        const uint32_t levelCount = GetLevelCount(type, extent, mipLevels);
+        const uint32_t blockWidth = GetFormatBlockWidth(format);
+        const uint32_t blockHeight = GetFormatBlockHeight(format);
+        const uint32_t blockSize = GetFormatBlockSize(format);
+
+        // Every layer has the same levels, offsets are relative to the start of the layer.
+        std::vector<SubresourceData> levels(levelCount);
+        std::vector<size_t> levelOffsets(levelCount);
+        size_t layerSize = 0;
+        for (uint32_t level = 0; level < levelCount; ++level)
+        {
+            const uint32_t width = std::max(1u, extent.width >> level);
+            const uint32_t height = std::max(1u, extent.height >> level);
+            const uint32_t depth = is3D ? std::max(1u, extent.depth >> level) : 1u;
+
+            levels[level].rowPitch = ((width + blockWidth - 1) / blockWidth) * blockSize;
+            levels[level].slicePitch = levels[level].rowPitch * ((height + blockHeight - 1) / blockHeight);
+            levelOffsets[level] = layerSize;
+            layerSize += size_t(levels[level].slicePitch) * depth;
+        }
+
+        const uint8_t* content = static_cast<const uint8_t*>(descriptor->content);
+        if (descriptor->generateMips && levelCount > 1)
+        {
+            if (is3D || IsCompressedFormat(format) || !CanGenerateMips(format))
+            {
+                ALIMER_LOGE("Texture: cannot generate mips for a %s texture in %s format",
+                    is3D ? "3D" : "2D", to_string(format).c_str());
+                return false;
+            }
+
+            // Content holds the top level of every layer, one after the other.
+            storage.resize(layerSize * layerCount);
+            for (uint32_t layer = 0; layer < layerCount; ++layer)
+            {
+                if (!GenerateMipChain(format, content + size_t(levels[0].slicePitch) * layer, levels[0].rowPitch, extent.width, extent.height,
+                    levelCount, MipFilter::Kaiser, storage.data() + layerSize * layer))
+                {
+                    ALIMER_LOGE("Texture: mip generation failed for layer %u in %s format", layer, to_string(format).c_str());
+                    return false;
+                }
+            }
+
+            content = storage.data();
+        }
+
+        subresources.reserve(size_t(layerCount) * levelCount);
+        for (uint32_t layer = 0; layer < layerCount; ++layer)
+        {
+            for (uint32_t level = 0; level < levelCount; ++level)
+            {
+                const uint8_t* data = content + layerSize * layer + levelOffsets[level];
+                subresources.push_back({ data, levels[level].rowPitch, levels[level].slicePitch });
+            }
+        }
+
+        return true;
+    }
+}
@@ -24,6 +24,7 @@
 
 #include "graphics/GPUResource.h"
 #include "math/size.h"
+#include <vector>
 
 namespace alimer
 {
@@ -39,6 +40,18 @@ namespace alimer
         /// Constructor.
         Texture(GPUDevice* device, const TextureDescriptor* descriptor);
 
+        /// One mip level of one array layer of the initial content.
+        struct SubresourceData
+        {
+            const void* data;
+            uint32_t rowPitch;
+            uint32_t slicePitch;
+        };
+
+        /// Split the descriptor content in subresources, layer major like D3D subresource indices, none without content.
+        /// Levels to generate are built in storage first. Returns false when they can't be, the texture must not be created.
+        bool GetSubresourceData(const TextureDescriptor* descriptor, std::vector<uint8_t>& storage, std::vector<SubresourceData>& subresources) const;
+
         TextureType type = TextureType::Type2D;
         TextureUsage usage = TextureUsage::Sampled;
         /// Texture format.
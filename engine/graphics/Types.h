@@ -154,8 +154,11 @@ namespace alimer
         PixelFormat format = PixelFormat::RGBA8Unorm;
         uint32_t mipLevels = 1;
         TextureSampleCount sampleCount = TextureSampleCount::Count1;
-        /// Initial content to initialize with.
+        /// Initial content to initialize with: array layer after array layer, every mip level of a layer tightly packed.
         const void* content = nullptr;
+        /// Content holds only the top level of each layer, the other mipLevels - 1 levels are generated on the CPU
+        /// (see GenerateMipChain). Not supported for 3D textures or block compressed formats.
+        bool generateMips = false;
         /// Pointer to external texture handle
         const void* externalHandle = nullptr;
         const char* label = nullptr;
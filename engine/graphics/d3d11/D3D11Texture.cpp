@@ -41,6 +41,21 @@ namespace alimer
             auto d3dDevice = static_cast<D3D11GPUDevice*>(device)->GetD3DDevice();
             UINT bindFlags = ToD3D11BindFlags(usage, IsDepthStencilFormat(format));
 
+            std::vector<uint8_t> storage;
+            std::vector<SubresourceData> subresources;
+            std::vector<D3D11_SUBRESOURCE_DATA> initialData;
+            if (!GetSubresourceData(descriptor, storage, subresources))
+            {
+                // Creating it without the requested content would hide the error, the texture stays without a resource.
+                return;
+            }
+
+            initialData.reserve(subresources.size());
+            for (const SubresourceData& subresource : subresources)
+            {
+                initialData.push_back({ subresource.data, subresource.rowPitch, subresource.slicePitch });
+            }
+
             if (type == TextureType::Type3D)
             {
                 D3D11_TEXTURE3D_DESC d3d11Desc = {};
@@ -54,7 +69,7 @@ namespace alimer
                 d3d11Desc.Depth = extent.depth;
                 d3d11Desc.Usage = D3D11_USAGE_DEFAULT;
 
-                ThrowIfFailed(d3dDevice->CreateTexture3D(&d3d11Desc, nullptr, &handle.tex3d));
+                ThrowIfFailed(d3dDevice->CreateTexture3D(&d3d11Desc, initialData.empty() ? nullptr : initialData.data(), &handle.tex3d));
             }
             else
             {
@@ -80,7 +95,7 @@ namespace alimer
                     d3d11Desc.MiscFlags |= D3D11_RESOURCE_MISC_TEXTURECUBE;
                 }
 
-                ThrowIfFailed(d3dDevice->CreateTexture2D(&d3d11Desc, NULL, &handle.tex2d));
+                ThrowIfFailed(d3dDevice->CreateTexture2D(&d3d11Desc, initialData.empty() ? nullptr : initialData.data(), &handle.tex2d));
             }
         }
     }
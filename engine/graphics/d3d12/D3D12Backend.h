@@ -25,6 +25,7 @@
 #include "core/Utils.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/Profiler.h"
 #include "graphics/Types.h"
 #include "../d3d/D3DCommon.h"
 
@@ -24,6 +24,7 @@
 #include "graphics/CommandQueue.h"
 #include "graphics/GPUDevice.h"
 #include <algorithm>
+#include <mutex>
 
 namespace alimer
 {
@@ -43,6 +44,8 @@ namespace alimer
         uint64_t lastCompletedFenceValue;
         ID3D12Fence* fence = nullptr;
         HANDLE fenceEvent = INVALID_HANDLE_VALUE;
+        std::mutex fenceMutex;
+        std::mutex eventMutex;
     };
 
     void CommandQueue::ApiInit()
@@ -103,29 +106,36 @@ namespace alimer
         return apiData->handle;
     }
 
-#if TODO
-    uint64_t D3D12CommandQueue::IncrementFence(void)
+    uint64_t CommandQueue::Signal()
     {
-        std::lock_guard<std::mutex> lockGuard(fenceMutex);
-        handle->Signal(d3d12Fence, nextFenceValue);
-        return nextFenceValue++;
+        std::lock_guard<std::mutex> lockGuard(apiData->fenceMutex);
+        apiData->handle->Signal(apiData->fence, apiData->nextFenceValue);
+        device.submitCount++;
+        return apiData->nextFenceValue++;
+    }
+
+    uint64_t CommandQueue::GetNextFenceValue() const
+    {
+        std::lock_guard<std::mutex> lockGuard(apiData->fenceMutex);
+        return apiData->nextFenceValue;
     }
 
-    bool D3D12CommandQueue::IsFenceComplete(uint64_t fenceValue)
+    bool CommandQueue::IsFenceComplete(uint64_t fenceValue)
     {
         // Avoid querying the fence value by testing against the last one seen.
         // The max() is to protect against an unlikely race condition that could cause the last
         // completed fence value to regress.
-        if (fenceValue > lastCompletedFenceValue)
+        if (fenceValue > apiData->lastCompletedFenceValue)
         {
-            lastCompletedFenceValue = std::max(lastCompletedFenceValue, d3d12Fence->GetCompletedValue());
+            apiData->lastCompletedFenceValue = std::max(apiData->lastCompletedFenceValue, apiData->fence->GetCompletedValue());
         }
 
-        return fenceValue <= lastCompletedFenceValue;
+        return fenceValue <= apiData->lastCompletedFenceValue;
     }
 
-    void D3D12CommandQueue::WaitForFence(uint64_t fenceValue)
+    void CommandQueue::WaitForFence(uint64_t fenceValue)
     {
+        ALIMER_PROFILE_SCOPE("CommandQueue::WaitForFence");
         if (IsFenceComplete(fenceValue))
         {
             return;
@@ -136,14 +146,16 @@ namespace alimer
         // the fence can only have one event set on completion, then thread B has to wait for 
         // 100 before it knows 99 is ready.  Maybe insert sequential events?
         {
-            std::lock_guard<std::mutex> LockGuard(eventMutex);
+            std::lock_guard<std::mutex> LockGuard(apiData->eventMutex);
 
-            d3d12Fence->SetEventOnCompletion(fenceValue, fenceEvent);
-            WaitForSingleObject(fenceEvent, INFINITE);
-            lastCompletedFenceValue = fenceValue;
+            apiData->fence->SetEventOnCompletion(fenceValue, apiData->fenceEvent);
+            WaitForSingleObject(apiData->fenceEvent, INFINITE);
+            apiData->lastCompletedFenceValue = fenceValue;
         }
     }
 
+#if TODO
+
     ID3D12CommandAllocator* D3D12CommandQueue::RequestAllocator()
     {
         uint64_t completedFenceValue = d3d12Fence->GetCompletedValue();
@@ -22,6 +22,7 @@
 
 #include "D3D12Backend.h"
 #include "graphics/GPUDevice.h"
+#include "graphics/CommandQueue.h"
 #include "D3D12MemAlloc.h"
 #include "core/String.h"
 
@@ -498,7 +499,16 @@ namespace alimer
 
     void GPUDevice::WaitForIdle()
     {
+        ALIMER_PROFILE_SCOPE("GPUDevice::WaitForIdle");
 
+        if (graphicsCommandQueue)
+            graphicsCommandQueue->WaitForIdle();
+
+        if (computeCommandQueue)
+            computeCommandQueue->WaitForIdle();
+
+        if (copyCommandQueue)
+            copyCommandQueue->WaitForIdle();
     }
 
     DeviceHandle GPUDevice::GetHandle() const
@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "NullBackend.h"
+#include "graphics/CommandQueue.h"
+#include "graphics/GPUDevice.h"
+
+namespace alimer
+{
+    struct CommandQueueApiData {
+        std::atomic<uint64_t> nextFenceValue;
+        std::atomic<uint64_t> lastCompletedFenceValue;
+    };
+
+    void CommandQueue::ApiInit()
+    {
+        CommandQueueApiData* pData = new CommandQueueApiData;
+        apiData = pData;
+
+        // Match the D3D12 backend layout, the queue type lives in the top byte.
+        pData->lastCompletedFenceValue = ((uint64_t)queueType << 56);
+        pData->nextFenceValue = ((uint64_t)queueType << 56) | 1;
+    }
+
+    void CommandQueue::ApiDestroy()
+    {
+        SafeDelete(apiData);
+    }
+
+    CommandQueueHandle CommandQueue::GetHandle() const
+    {
+        return apiData;
+    }
+
+    uint64_t CommandQueue::Signal()
+    {
+        // There is no GPU timeline, work completes as soon as it is submitted.
+        uint64_t fenceValue = apiData->nextFenceValue.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t completed = apiData->lastCompletedFenceValue.load(std::memory_order_relaxed);
+        while (completed < fenceValue
+            && !apiData->lastCompletedFenceValue.compare_exchange_weak(completed, fenceValue, std::memory_order_release))
+        {
+        }
+
+        device.submitCount.fetch_add(1, std::memory_order_relaxed);
+        return fenceValue;
+    }
+
+    uint64_t CommandQueue::GetNextFenceValue() const
+    {
+        return apiData->nextFenceValue.load(std::memory_order_relaxed);
+    }
+
+    bool CommandQueue::IsFenceComplete(uint64_t fenceValue)
+    {
+        return fenceValue <= apiData->lastCompletedFenceValue.load(std::memory_order_acquire);
+    }
+
+    void CommandQueue::WaitForFence(uint64_t fenceValue)
+    {
+        ALIMER_PROFILE_SCOPE("CommandQueue::WaitForFence");
+        ALIMER_ASSERT(fenceValue < apiData->nextFenceValue.load(std::memory_order_relaxed));
+        ALIMER_UNUSED(fenceValue);
+    }
+}
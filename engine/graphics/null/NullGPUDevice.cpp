@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "NullBackend.h"
+#include "graphics/GPUDevice.h"
+#include "graphics/CommandQueue.h"
+
+namespace alimer
+{
+    struct GPUDeviceApiData {
+        uint32_t id;
+    };
+
+    static std::atomic<uint32_t> s_nullDeviceCount{ 0 };
+
+    bool GPUDevice::ApiInit()
+    {
+        GPUDeviceApiData* pData = new GPUDeviceApiData;
+        pData->id = s_nullDeviceCount.fetch_add(1) + 1;
+        apiData = pData;
+
+        // Init capabilities
+        caps.backendType = BackendType::Null;
+        caps.vendorId = static_cast<uint32_t>(GPUVendorId::None);
+        caps.deviceId = 0;
+        caps.adapterType = GPUAdapterType::CPU;
+        caps.adapterName = "Null Device";
+
+        // The null device accepts everything.
+        caps.features.independentBlend = true;
+        caps.features.computeShader = true;
+        caps.features.geometryShader = true;
+        caps.features.tessellationShader = true;
+        caps.features.logicOp = true;
+        caps.features.multiViewport = true;
+        caps.features.fullDrawIndexUint32 = true;
+        caps.features.multiDrawIndirect = true;
+        caps.features.fillModeNonSolid = true;
+        caps.features.samplerAnisotropy = true;
+        caps.features.textureCompressionETC2 = true;
+        caps.features.textureCompressionASTC_LDR = true;
+        caps.features.textureCompressionBC = true;
+        caps.features.textureCubeArray = true;
+        caps.features.raytracing = true;
+
+        // Limits
+        caps.limits.maxVertexAttributes = kMaxVertexAttributes;
+        caps.limits.maxVertexBindings = kMaxVertexAttributes;
+        caps.limits.maxVertexAttributeOffset = kMaxVertexAttributeOffset;
+        caps.limits.maxVertexBindingStride = kMaxVertexBufferStride;
+        caps.limits.maxTextureDimension2D = 16384u;
+        caps.limits.maxTextureDimension3D = 2048u;
+        caps.limits.maxTextureDimensionCube = 16384u;
+        caps.limits.maxTextureArrayLayers = 2048u;
+        caps.limits.maxColorAttachments = kMaxColorAttachments;
+        caps.limits.maxUniformBufferSize = 65536u;
+        caps.limits.minUniformBufferOffsetAlignment = 256u;
+        caps.limits.maxStorageBufferSize = UINT32_MAX;
+        caps.limits.minStorageBufferOffsetAlignment = 16;
+        caps.limits.maxSamplerAnisotropy = 16u;
+        caps.limits.maxViewports = 16u;
+        caps.limits.maxViewportWidth = 32768u;
+        caps.limits.maxViewportHeight = 32768u;
+        caps.limits.maxTessellationPatchSize = 32u;
+        caps.limits.pointSizeRangeMin = 1.0f;
+        caps.limits.pointSizeRangeMax = 1.0f;
+        caps.limits.lineWidthRangeMin = 1.0f;
+        caps.limits.lineWidthRangeMax = 1.0f;
+        caps.limits.maxComputeSharedMemorySize = 32768u;
+        caps.limits.maxComputeWorkGroupCountX = 65535u;
+        caps.limits.maxComputeWorkGroupCountY = 65535u;
+        caps.limits.maxComputeWorkGroupCountZ = 65535u;
+        caps.limits.maxComputeWorkGroupInvocations = 1024u;
+        caps.limits.maxComputeWorkGroupSizeX = 1024u;
+        caps.limits.maxComputeWorkGroupSizeY = 1024u;
+        caps.limits.maxComputeWorkGroupSizeZ = 64u;
+
+        ALIMER_LOGINFO("Null GPU backend initialized, no rendering will be performed");
+        return true;
+    }
+
+    void GPUDevice::ApiDestroy()
+    {
+        if (apiData == nullptr)
+            return;
+
+        Stats stats = GetStats();
+        ALIMER_LOGD("Null device: %llu commands recorded, %llu submits.",
+            (unsigned long long)stats.commands,
+            (unsigned long long)stats.submits);
+
+        SafeDelete(apiData);
+        s_nullDeviceCount--;
+    }
+
+    void GPUDevice::WaitForIdle()
+    {
+        ALIMER_PROFILE_SCOPE("GPUDevice::WaitForIdle");
+
+        if (graphicsCommandQueue)
+            graphicsCommandQueue->WaitForIdle();
+
+        if (computeCommandQueue)
+            computeCommandQueue->WaitForIdle();
+
+        if (copyCommandQueue)
+            copyCommandQueue->WaitForIdle();
+    }
+
+    DeviceHandle GPUDevice::GetHandle() const
+    {
+        return apiData;
+    }
+}
@@ -1,5 +1,5 @@
 //
-// Copyright (c) 2019-2020 Amer Koleci and contributors.
+// Copyright (c) 2020 Amer Koleci and contributors.
 //
 // Permission is hereby granted, free of charge, to any person obtaining a copy
 // of this software and associated documentation files (the "Software"), to deal
@@ -22,9 +22,132 @@
 
 #include "math/Quaternion.h"
 #include "core/String.h"
+#include <algorithm>
 
 namespace alimer
 {
+    const Quaternion Quaternion::Identity(0.0f, 0.0f, 0.0f, 1.0f);
+
+    float3x3 Quaternion::ToRotationMatrix() const noexcept
+    {
+        const float xx = x * x, yy = y * y, zz = z * z;
+        const float xy = x * y, xz = x * z, yz = y * z;
+        const float wx = w * x, wy = w * y, wz = w * z;
+
+        return float3x3(
+            float3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy)),
+            float3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx)),
+            float3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)));
+    }
+
+    float4x4 Quaternion::ToMatrix() const noexcept
+    {
+        const float3x3 m = ToRotationMatrix();
+        return float4x4(float4(m[0], 0.0f), float4(m[1], 0.0f), float4(m[2], 0.0f), float4(0.0f, 0.0f, 0.0f, 1.0f));
+    }
+
+    void Quaternion::ToAxisAngle(float3& axis, float& radians) const noexcept
+    {
+        const Quaternion q = Normalized();
+        const float cosHalf = std::min(std::max(q.w, -1.0f), 1.0f);
+        radians = 2.0f * std::acos(cosHalf);
+
+        const float sinHalf = std::sqrt(1.0f - cosHalf * cosHalf);
+        if (sinHalf < 1e-6f)
+        {
+            axis = float3(1.0f, 0.0f, 0.0f);
+        }
+        else
+        {
+            axis = q.GetVector() / sinHalf;
+        }
+    }
+
+    float3 Quaternion::ToEuler() const noexcept
+    {
+        // Matrix terms of R = Ry * Rx * Rz, R(1, 2) = -sin(pitch).
+        const float m12 = 2.0f * (y * z - w * x);
+        if (std::abs(m12) < 0.999999f)
+        {
+            const float pitch = std::asin(-m12);
+            const float yaw = std::atan2(2.0f * (x * z + w * y), 1.0f - 2.0f * (x * x + y * y));
+            const float roll = std::atan2(2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z));
+            return float3(pitch, yaw, roll);
+        }
+
+        // Gimbal lock, yaw and roll rotate around the same axis so put it all in yaw.
+        const float pitch = m12 < 0.0f ? half_pi<float>() : -half_pi<float>();
+        const float yaw = std::atan2(-2.0f * (x * z - w * y), 1.0f - 2.0f * (y * y + z * z));
+        return float3(pitch, yaw, 0.0f);
+    }
+
+    Quaternion Quaternion::FromAxisAngle(const float3& axis, float radians) noexcept
+    {
+        const float halfAngle = radians * 0.5f;
+        return Quaternion(axis * std::sin(halfAngle), std::cos(halfAngle));
+    }
+
+    Quaternion Quaternion::FromEuler(const float3& pitchYawRoll) noexcept
+    {
+        return FromAxisAngle(float3(0.0f, 1.0f, 0.0f), pitchYawRoll.y)
+            * FromAxisAngle(float3(1.0f, 0.0f, 0.0f), pitchYawRoll.x)
+            * FromAxisAngle(float3(0.0f, 0.0f, 1.0f), pitchYawRoll.z);
+    }
+
+    Quaternion Quaternion::FromRotationMatrix(const float3x3& m) noexcept
+    {
+        // Pick the largest diagonal term to keep the division stable, m[column][row].
+        const float trace = m[0].x + m[1].y + m[2].z;
+        if (trace > 0.0f)
+        {
+            const float s = std::sqrt(trace + 1.0f) * 2.0f;
+            return Quaternion((m[1].z - m[2].y) / s, (m[2].x - m[0].z) / s, (m[0].y - m[1].x) / s, 0.25f * s);
+        }
+
+        if (m[0].x > m[1].y && m[0].x > m[2].z)
+        {
+            const float s = std::sqrt(1.0f + m[0].x - m[1].y - m[2].z) * 2.0f;
+            return Quaternion(0.25f * s, (m[1].x + m[0].y) / s, (m[2].x + m[0].z) / s, (m[1].z - m[2].y) / s);
+        }
+
+        if (m[1].y > m[2].z)
+        {
+            const float s = std::sqrt(1.0f + m[1].y - m[0].x - m[2].z) * 2.0f;
+            return Quaternion((m[1].x + m[0].y) / s, 0.25f * s, (m[2].y + m[1].z) / s, (m[2].x - m[0].z) / s);
+        }
+
+        const float s = std::sqrt(1.0f + m[2].z - m[0].x - m[1].y) * 2.0f;
+        return Quaternion((m[2].x + m[0].z) / s, (m[2].y + m[1].z) / s, 0.25f * s, (m[0].y - m[1].x) / s);
+    }
+
+    Quaternion Quaternion::FromRotationMatrix(const float4x4& m) noexcept
+    {
+        return FromRotationMatrix(float3x3(m));
+    }
+
+    Quaternion Quaternion::Nlerp(const Quaternion& a, const Quaternion& b, float t) noexcept
+    {
+        const Quaternion target = a.Dot(b) < 0.0f ? -b : b;
+        return (a + (target - a) * t).Normalized();
+    }
+
+    Quaternion Quaternion::Slerp(const Quaternion& a, const Quaternion& b, float t) noexcept
+    {
+        float cosTheta = a.Dot(b);
+        const Quaternion target = cosTheta < 0.0f ? -b : b;
+        cosTheta = std::abs(cosTheta);
+
+        // Nearly parallel, sin(theta) goes to zero and nlerp is exact enough.
+        if (cosTheta > 0.9995f)
+        {
+            return Nlerp(a, target, t);
+        }
+
+        const float theta = std::acos(cosTheta);
+        const float invSinTheta = 1.0f / std::sin(theta);
+        return a * (std::sin((1.0f - t) * theta) * invSinTheta) + target * (std::sin(t * theta) * invSinTheta);
+    }
+
     std::string Quaternion::ToString() const
     {
         char tempBuffer[CONVERSION_BUFFER_LENGTH];
@@ -1,5 +1,5 @@
 //
-// Copyright (c) 2019-2020 Amer Koleci and contributors.
+// Copyright (c) 2020 Amer Koleci and contributors.
 //
 // Permission is hereby granted, free of charge, to any person obtaining a copy
 // of this software and associated documentation files (the "Software"), to deal
@@ -22,12 +22,13 @@
 
 #pragma once
 
-#include "core/Preprocessor.h"
+#include "math/math.h"
 #include <string>
 
 namespace alimer
 {
     /// Class specifying a four-dimensional quaternion.
+    /// Rotations compose like matrices: a * b rotates by b first, then by a.
     class ALIMER_API Quaternion
     {
     public:
@@ -43,10 +44,114 @@ namespace alimer
         /// Constructor.
         Quaternion() noexcept = default;
 
+        Quaternion(float x_, float y_, float z_, float w_) noexcept
+            : x(x_), y(y_), z(z_), w(w_)
+        {
+        }
+
+        /// Construct from the vector part and the scalar part.
+        Quaternion(const float3& v, float w_) noexcept
+            : x(v.x), y(v.y), z(v.z), w(w_)
+        {
+        }
+
+        Quaternion operator*(const Quaternion& rhs) const noexcept
+        {
+            return Quaternion(
+                w * rhs.x + x * rhs.w + y * rhs.z - z * rhs.y,
+                w * rhs.y - x * rhs.z + y * rhs.w + z * rhs.x,
+                w * rhs.z + x * rhs.y - y * rhs.x + z * rhs.w,
+                w * rhs.w - x * rhs.x - y * rhs.y - z * rhs.z);
+        }
+
+        Quaternion& operator*=(const Quaternion& rhs) noexcept { return *this = *this * rhs; }
+
+        Quaternion operator*(float rhs) const noexcept { return Quaternion(x * rhs, y * rhs, z * rhs, w * rhs); }
+        Quaternion operator+(const Quaternion& rhs) const noexcept { return Quaternion(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w); }
+        Quaternion operator-(const Quaternion& rhs) const noexcept { return Quaternion(x - rhs.x, y - rhs.y, z - rhs.z, w - rhs.w); }
+        Quaternion operator-() const noexcept { return Quaternion(-x, -y, -z, -w); }
+
+        bool operator==(const Quaternion& rhs) const noexcept { return x == rhs.x && y == rhs.y && z == rhs.z && w == rhs.w; }
+        bool operator!=(const Quaternion& rhs) const noexcept { return !(*this == rhs); }
+
+        /// Rotate a vector, the quaternion must be normalized.
+        float3 operator*(const float3& v) const noexcept { return Rotate(v); }
+
+        /// Rotate a vector, the quaternion must be normalized.
+        float3 Rotate(const float3& v) const noexcept
+        {
+            const float3 axis(x, y, z);
+            const float3 t = cross(axis, v) * 2.0f;
+            return v + t * w + cross(axis, t);
+        }
+
+        /// Return the vector part.
+        float3 GetVector() const noexcept { return float3(x, y, z); }
+
+        float Dot(const Quaternion& rhs) const noexcept { return x * rhs.x + y * rhs.y + z * rhs.z + w * rhs.w; }
+        float LengthSquared() const noexcept { return Dot(*this); }
+        float Length() const noexcept { return std::sqrt(LengthSquared()); }
+
+        /// Return the normalized quaternion, identity when the length is zero.
+        Quaternion Normalized() const noexcept
+        {
+            const float lengthSquared = LengthSquared();
+            if (lengthSquared <= 0.0f)
+                return Quaternion();
+
+            return *this * (1.0f / std::sqrt(lengthSquared));
+        }
+
+        /// Return the conjugate, the inverse rotation for normalized quaternions.
+        Quaternion Conjugate() const noexcept { return Quaternion(-x, -y, -z, w); }
+
+        /// Return the inverse, identity when the length is zero.
+        Quaternion Inverse() const noexcept
+        {
+            const float lengthSquared = LengthSquared();
+            if (lengthSquared <= 0.0f)
+                return Quaternion();
+
+            return Conjugate() * (1.0f / lengthSquared);
+        }
+
+        /// Return the rotation as a 3x3 matrix, the quaternion must be normalized.
+        float3x3 ToRotationMatrix() const noexcept;
+
+        /// Return the rotation as a 4x4 matrix with no translation.
+        float4x4 ToMatrix() const noexcept;
+
+        /// Return the rotation axis and angle in radians, the axis is +X for the identity.
+        void ToAxisAngle(float3& axis, float& radians) const noexcept;
+
+        /// Return the euler angles in radians as (pitch, yaw, roll), see FromEuler.
+        float3 ToEuler() const noexcept;
+
+        /// Rotation of radians around a normalized axis.
+        static Quaternion FromAxisAngle(const float3& axis, float radians) noexcept;
+
+        /// Rotation from euler angles in radians (pitch around X, yaw around Y, roll around Z), applied roll, pitch, then yaw.
+        static Quaternion FromEuler(const float3& pitchYawRoll) noexcept;
+
+        /// Rotation from an orthonormal matrix.
+        static Quaternion FromRotationMatrix(const float3x3& m) noexcept;
+
+        /// Rotation from the upper 3x3 part of a matrix, which must be orthonormal.
+        static Quaternion FromRotationMatrix(const float4x4& m) noexcept;
+
+        /// Normalized linear interpolation along the shortest path.
+        static Quaternion Nlerp(const Quaternion& a, const Quaternion& b, float t) noexcept;
+
+        /// Spherical linear interpolation along the shortest path.
+        static Quaternion Slerp(const Quaternion& a, const Quaternion& b, float t) noexcept;
+
         /// Return float data.
         const float* Data() const { return &x; }
 
         /// Return as string.
         std::string ToString() const;
+
+        /// The identity rotation.
+        static const Quaternion Identity;
     };
-} 
+}
@@ -0,0 +1,736 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "math/batch.h"
+#include "core/Platform.h"
+#include <atomic>
+
+#if !defined(ALIMER_NO_SIMD) && (defined(_M_X64) || defined(__x86_64__))
+#   define ALIMER_BATCH_X86
+#   include <immintrin.h>
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       define ALIMER_TARGET_AVX2
+#       define ALIMER_TARGET_AVX512
+#   else
+#       define ALIMER_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#       define ALIMER_TARGET_AVX512 __attribute__((target("avx512f")))
+#   endif
+#endif
+
+namespace alimer
+{
+    namespace batch
+    {
+        namespace
+        {
+            using TransformFunction = void(*)(const float4x4& m, const_float3_stream input, float3_stream output, size_t begin, size_t count);
+            using AabbFunction = void(*)(const float4x4* matrices, const_float3_stream localMin, const_float3_stream localMax, float3_stream worldMin, float3_stream worldMax, size_t begin, size_t count);
+            using NormalizeFunction = void(*)(const_float3_stream input, float3_stream output, size_t begin, size_t count);
+            using MultiplyFunction = void(*)(const float4x4* a, const float4x4* b, float4x4* output, size_t begin, size_t count);
+            /// Interpolation weights come from t, or are all tScalar when t is null.
+            using InterpolateFunction = void(*)(const_float4_stream a, const_float4_stream b, const float* t, float tScalar, float4_stream output, size_t begin, size_t count);
+
+            struct Kernels
+            {
+                Isa isa;
+                TransformFunction transformPoints;
+                TransformFunction transformVectors;
+                AabbFunction computeAabbs;
+                NormalizeFunction normalize;
+                MultiplyFunction multiply;
+                InterpolateFunction nlerp;
+                InterpolateFunction slerp;
+            };
+
+            /// Coefficients of the slerp polynomial from "A Fast and Accurate Algorithm for Computing SLERP" (Eberly).
+            static constexpr float kSlerpMu = 1.90110745351730037f;
+            static constexpr float kSlerpU[8] = { 1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9), 1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), kSlerpMu / (8 * 17) };
+            static constexpr float kSlerpV[8] = { 1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9, 5.0f / 11, 6.0f / 13, 7.0f / 15, kSlerpMu * 8 / 17 };
+
+            /* Scalar kernels, also used for the tails of the vector kernels. */
+            void TransformPointsScalar(const float4x4& m, const_float3_stream input, float3_stream output, size_t begin, size_t count)
+            {
+                for (size_t i = begin; i < count; ++i)
+                {
+                    const float x = input.x[i], y = input.y[i], z = input.z[i];
+                    output.x[i] = m[0].x * x + m[1].x * y + m[2].x * z + m[3].x;
+                    output.y[i] = m[0].y * x + m[1].y * y + m[2].y * z + m[3].y;
+                    output.z[i] = m[0].z * x + m[1].z * y + m[2].z * z + m[3].z;
+                }
+            }
+
+            void TransformVectorsScalar(const float4x4& m, const_float3_stream input, float3_stream output, size_t begin, size_t count)
+            {
+                for (size_t i = begin; i < count; ++i)
+                {
+                    const float x = input.x[i], y = input.y[i], z = input.z[i];
+                    output.x[i] = m[0].x * x + m[1].x * y + m[2].x * z;
+                    output.y[i] = m[0].y * x + m[1].y * y + m[2].y * z;
+                    output.z[i] = m[0].z * x + m[1].z * y + m[2].z * z;
+                }
+            }
+
+            void ComputeAabbsScalar(const float4x4* matrices, const_float3_stream localMin, const_float3_stream localMax, float3_stream worldMin, float3_stream worldMax, size_t begin, size_t count)
+            {
+                // Transform the center and project the extents on the absolute matrix (Arvo), equal to the bounds of the transformed corners.
+                for (size_t i = begin; i < count; ++i)
+                {
+                    const float4x4& m = matrices[i];
+                    const float cx = (localMin.x[i] + localMax.x[i]) * 0.5f;
+                    const float cy = (localMin.y[i] + localMax.y[i]) * 0.5f;
+                    const float cz = (localMin.z[i] + localMax.z[i]) * 0.5f;
+                    const float ex = (localMax.x[i] - localMin.x[i]) * 0.5f;
+                    const float ey = (localMax.y[i] - localMin.y[i]) * 0.5f;
+                    const float ez = (localMax.z[i] - localMin.z[i]) * 0.5f;
+
+                    for (int r = 0; r < 3; ++r)
+                    {
+                        const float center = m[0][r] * cx + m[1][r] * cy + m[2][r] * cz + m[3][r];
+                        const float extent = std::abs(m[0][r]) * ex + std::abs(m[1][r]) * ey + std::abs(m[2][r]) * ez;
+                        float* minOut = r == 0 ? worldMin.x : (r == 1 ? worldMin.y : worldMin.z);
+                        float* maxOut = r == 0 ? worldMax.x : (r == 1 ? worldMax.y : worldMax.z);
+                        minOut[i] = center - extent;
+                        maxOut[i] = center + extent;
+                    }
+                }
+            }
+
+            void NormalizeScalar(const_float3_stream input, float3_stream output, size_t begin, size_t count)
+            {
+                for (size_t i = begin; i < count; ++i)
+                {
+                    const float x = input.x[i], y = input.y[i], z = input.z[i];
+                    const float lengthSquared = x * x + y * y + z * z;
+                    const float scale = lengthSquared > 0.0f ? 1.0f / std::sqrt(lengthSquared) : 0.0f;
+                    output.x[i] = x * scale;
+                    output.y[i] = y * scale;
+                    output.z[i] = z * scale;
+                }
+            }
+
+            void MultiplyScalar(const float4x4* a, const float4x4* b, float4x4* output, size_t begin, size_t count)
+            {
+                for (size_t i = begin; i < count; ++i)
+                {
+                    float4x4 result;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        for (int r = 0; r < 4; ++r)
+                        {
+                            result[c][r] = a[i][0][r] * b[i][c][0] + a[i][1][r] * b[i][c][1] + a[i][2][r] * b[i][c][2] + a[i][3][r] * b[i][c][3];
+                        }
+                    }
+                    output[i] = result;
+                }
+            }
+
+            void NlerpScalar(const_float4_stream a, const_float4_stream b, const float* t, float tScalar, float4_stream output, size_t begin, size_t count)
+            {
+                for (size_t i = begin; i < count; ++i)
+                {
+                    const float weight = t != nullptr ? t[i] : tScalar;
+                    const float cosTheta = a.x[i] * b.x[i] + a.y[i] * b.y[i] + a.z[i] * b.z[i] + a.w[i] * b.w[i];
+                    const float sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+                    const float x = a.x[i] + (b.x[i] * sign - a.x[i]) * weight;
+                    const float y = a.y[i] + (b.y[i] * sign - a.y[i]) * weight;
+                    const float z = a.z[i] + (b.z[i] * sign - a.z[i]) * weight;
+                    const float w = a.w[i] + (b.w[i] * sign - a.w[i]) * weight;
+                    const float lengthSquared = x * x + y * y + z * z + w * w;
+                    const float scale = lengthSquared > 0.0f ? 1.0f / std::sqrt(lengthSquared) : 0.0f;
+                    output.x[i] = x * scale;
+                    output.y[i] = y * scale;
+                    output.z[i] = z * scale;
+                    output.w[i] = w * scale;
+                }
+            }
+
+            /// Returns t * sin(t * theta) / (t * sin(theta)) as a polynomial in t^2 and cos(theta) - 1.
+            inline float SlerpWeight(float t, float cosThetaMinusOne)
+            {
+                const float tSquared = t * t;
+                float result = 1.0f;
+                for (int i = 7; i >= 0; --i)
+                {
+                    result = 1.0f + (kSlerpU[i] * tSquared - kSlerpV[i]) * cosThetaMinusOne * result;
+                }
+                return t * result;
+            }
+
+            void SlerpScalar(const_float4_stream a, const_float4_stream b, const float* t, float tScalar, float4_stream output, size_t begin, size_t count)
+            {
+                for (size_t i = begin; i < count; ++i)
+                {
+                    const float weight = t != nullptr ? t[i] : tScalar;
+                    const float cosTheta = a.x[i] * b.x[i] + a.y[i] * b.y[i] + a.z[i] * b.z[i] + a.w[i] * b.w[i];
+                    const float cosThetaMinusOne = std::abs(cosTheta) - 1.0f;
+                    const float weightA = SlerpWeight(1.0f - weight, cosThetaMinusOne);
+                    const float weightB = cosTheta < 0.0f ? -SlerpWeight(weight, cosThetaMinusOne) : SlerpWeight(weight, cosThetaMinusOne);
+                    output.x[i] = a.x[i] * weightA + b.x[i] * weightB;
+                    output.y[i] = a.y[i] * weightA + b.y[i] * weightB;
+                    output.z[i] = a.z[i] * weightA + b.z[i] * weightB;
+                    output.w[i] = a.w[i] * weightA + b.w[i] * weightB;
+                }
+            }
+
+            const Kernels s_scalarKernels = { Isa::Scalar, TransformPointsScalar, TransformVectorsScalar, ComputeAabbsScalar, NormalizeScalar, MultiplyScalar, NlerpScalar, SlerpScalar };
+
+#if defined(ALIMER_BATCH_X86)
+            /* AVX2 + FMA kernels, 8 elements per iteration. */
+            ALIMER_TARGET_AVX2 void TransformAVX2(const float4x4& m, const_float3_stream input, float3_stream output, size_t count, bool points)
+            {
+                const __m256 m00 = _mm256_set1_ps(m[0].x), m01 = _mm256_set1_ps(m[0].y), m02 = _mm256_set1_ps(m[0].z);
+                const __m256 m10 = _mm256_set1_ps(m[1].x), m11 = _mm256_set1_ps(m[1].y), m12 = _mm256_set1_ps(m[1].z);
+                const __m256 m20 = _mm256_set1_ps(m[2].x), m21 = _mm256_set1_ps(m[2].y), m22 = _mm256_set1_ps(m[2].z);
+                const __m256 m30 = points ? _mm256_set1_ps(m[3].x) : _mm256_setzero_ps();
+                const __m256 m31 = points ? _mm256_set1_ps(m[3].y) : _mm256_setzero_ps();
+                const __m256 m32 = points ? _mm256_set1_ps(m[3].z) : _mm256_setzero_ps();
+
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m256 x = _mm256_loadu_ps(input.x + i);
+                    const __m256 y = _mm256_loadu_ps(input.y + i);
+                    const __m256 z = _mm256_loadu_ps(input.z + i);
+                    _mm256_storeu_ps(output.x + i, _mm256_fmadd_ps(m00, x, _mm256_fmadd_ps(m10, y, _mm256_fmadd_ps(m20, z, m30))));
+                    _mm256_storeu_ps(output.y + i, _mm256_fmadd_ps(m01, x, _mm256_fmadd_ps(m11, y, _mm256_fmadd_ps(m21, z, m31))));
+                    _mm256_storeu_ps(output.z + i, _mm256_fmadd_ps(m02, x, _mm256_fmadd_ps(m12, y, _mm256_fmadd_ps(m22, z, m32))));
+                }
+
+                if (points)
+                    TransformPointsScalar(m, input, output, i, count);
+                else
+                    TransformVectorsScalar(m, input, output, i, count);
+            }
+
+            void TransformPointsAVX2(const float4x4& m, const_float3_stream input, float3_stream output, size_t, size_t count)
+            {
+                TransformAVX2(m, input, output, count, true);
+            }
+
+            void TransformVectorsAVX2(const float4x4& m, const_float3_stream input, float3_stream output, size_t, size_t count)
+            {
+                TransformAVX2(m, input, output, count, false);
+            }
+
+            ALIMER_TARGET_AVX2 void ComputeAabbsAVX2(const float4x4* matrices, const_float3_stream localMin, const_float3_stream localMax, float3_stream worldMin, float3_stream worldMax, size_t, size_t count)
+            {
+                // Gather one matrix element from 8 consecutive matrices, 16 floats apart.
+                const __m256i stride = _mm256_setr_epi32(0, 16, 32, 48, 64, 80, 96, 112);
+                const __m256 half = _mm256_set1_ps(0.5f);
+                const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    const float* base = &matrices[i][0].x;
+                    const __m256 minX = _mm256_loadu_ps(localMin.x + i), maxX = _mm256_loadu_ps(localMax.x + i);
+                    const __m256 minY = _mm256_loadu_ps(localMin.y + i), maxY = _mm256_loadu_ps(localMax.y + i);
+                    const __m256 minZ = _mm256_loadu_ps(localMin.z + i), maxZ = _mm256_loadu_ps(localMax.z + i);
+                    const __m256 cx = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half);
+                    const __m256 cy = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half);
+                    const __m256 cz = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half);
+                    const __m256 ex = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half);
+                    const __m256 ey = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half);
+                    const __m256 ez = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half);
+
+                    float* minOut[3] = { worldMin.x + i, worldMin.y + i, worldMin.z + i };
+                    float* maxOut[3] = { worldMax.x + i, worldMax.y + i, worldMax.z + i };
+                    for (int r = 0; r < 3; ++r)
+                    {
+                        const __m256 c0 = _mm256_i32gather_ps(base + r, stride, 4);
+                        const __m256 c1 = _mm256_i32gather_ps(base + 4 + r, stride, 4);
+                        const __m256 c2 = _mm256_i32gather_ps(base + 8 + r, stride, 4);
+                        const __m256 c3 = _mm256_i32gather_ps(base + 12 + r, stride, 4);
+
+                        const __m256 center = _mm256_fmadd_ps(c0, cx, _mm256_fmadd_ps(c1, cy, _mm256_fmadd_ps(c2, cz, c3)));
+                        const __m256 extent = _mm256_fmadd_ps(_mm256_and_ps(c0, absMask), ex,
+                            _mm256_fmadd_ps(_mm256_and_ps(c1, absMask), ey, _mm256_mul_ps(_mm256_and_ps(c2, absMask), ez)));
+                        _mm256_storeu_ps(minOut[r], _mm256_sub_ps(center, extent));
+                        _mm256_storeu_ps(maxOut[r], _mm256_add_ps(center, extent));
+                    }
+                }
+
+                ComputeAabbsScalar(matrices, localMin, localMax, worldMin, worldMax, i, count);
+            }
+
+            ALIMER_TARGET_AVX2 void NormalizeAVX2(const_float3_stream input, float3_stream output, size_t, size_t count)
+            {
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 half = _mm256_set1_ps(0.5f);
+                const __m256 threeHalves = _mm256_set1_ps(1.5f);
+
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m256 x = _mm256_loadu_ps(input.x + i);
+                    const __m256 y = _mm256_loadu_ps(input.y + i);
+                    const __m256 z = _mm256_loadu_ps(input.z + i);
+                    const __m256 lengthSquared = _mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_mul_ps(z, z)));
+
+                    // Estimate plus one Newton-Raphson step, zero where the length is zero.
+                    __m256 scale = _mm256_rsqrt_ps(lengthSquared);
+                    const __m256 halfScale = _mm256_mul_ps(_mm256_mul_ps(half, lengthSquared), scale);
+                    scale = _mm256_mul_ps(scale, _mm256_fnmadd_ps(halfScale, scale, threeHalves));
+                    scale = _mm256_and_ps(scale, _mm256_cmp_ps(lengthSquared, zero, _CMP_GT_OQ));
+
+                    _mm256_storeu_ps(output.x + i, _mm256_mul_ps(x, scale));
+                    _mm256_storeu_ps(output.y + i, _mm256_mul_ps(y, scale));
+                    _mm256_storeu_ps(output.z + i, _mm256_mul_ps(z, scale));
+                }
+
+                NormalizeScalar(input, output, i, count);
+            }
+
+            ALIMER_TARGET_AVX2 void MultiplyAVX2(const float4x4* a, const float4x4* b, float4x4* output, size_t, size_t count)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    // Each column of a in both halves, two result columns per register.
+                    const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][0].x));
+                    const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][1].x));
+                    const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][2].x));
+                    const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[i][3].x));
+                    const __m256 b01 = _mm256_loadu_ps(&b[i][0].x);
+                    const __m256 b23 = _mm256_loadu_ps(&b[i][2].x);
+
+                    __m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, _MM_SHUFFLE(0, 0, 0, 0)));
+                    __m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, _MM_SHUFFLE(0, 0, 0, 0)));
+                    r01 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b01, _MM_SHUFFLE(1, 1, 1, 1)), r01);
+                    r23 = _mm256_fmadd_ps(a1, _mm256_permute_ps(b23, _MM_SHUFFLE(1, 1, 1, 1)), r23);
+                    r01 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b01, _MM_SHUFFLE(2, 2, 2, 2)), r01);
+                    r23 = _mm256_fmadd_ps(a2, _mm256_permute_ps(b23, _MM_SHUFFLE(2, 2, 2, 2)), r23);
+                    r01 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b01, _MM_SHUFFLE(3, 3, 3, 3)), r01);
+                    r23 = _mm256_fmadd_ps(a3, _mm256_permute_ps(b23, _MM_SHUFFLE(3, 3, 3, 3)), r23);
+
+                    _mm256_storeu_ps(&output[i][0].x, r01);
+                    _mm256_storeu_ps(&output[i][2].x, r23);
+                }
+            }
+
+            ALIMER_TARGET_AVX2 void NlerpAVX2(const_float4_stream a, const_float4_stream b, const float* t, float tScalar, float4_stream output, size_t, size_t count)
+            {
+                const __m256 signMask = _mm256_set1_ps(-0.0f);
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 half = _mm256_set1_ps(0.5f);
+                const __m256 threeHalves = _mm256_set1_ps(1.5f);
+                const __m256 weightScalar = _mm256_set1_ps(tScalar);
+
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m256 weight = t != nullptr ? _mm256_loadu_ps(t + i) : weightScalar;
+                    const __m256 ax = _mm256_loadu_ps(a.x + i), ay = _mm256_loadu_ps(a.y + i), az = _mm256_loadu_ps(a.z + i), aw = _mm256_loadu_ps(a.w + i);
+                    __m256 bx = _mm256_loadu_ps(b.x + i), by = _mm256_loadu_ps(b.y + i), bz = _mm256_loadu_ps(b.z + i), bw = _mm256_loadu_ps(b.w + i);
+
+                    // Flip b into the same hemisphere as a.
+                    const __m256 cosTheta = _mm256_fmadd_ps(ax, bx, _mm256_fmadd_ps(ay, by, _mm256_fmadd_ps(az, bz, _mm256_mul_ps(aw, bw))));
+                    const __m256 sign = _mm256_and_ps(cosTheta, signMask);
+                    bx = _mm256_xor_ps(bx, sign);
+                    by = _mm256_xor_ps(by, sign);
+                    bz = _mm256_xor_ps(bz, sign);
+                    bw = _mm256_xor_ps(bw, sign);
+
+                    const __m256 x = _mm256_fmadd_ps(_mm256_sub_ps(bx, ax), weight, ax);
+                    const __m256 y = _mm256_fmadd_ps(_mm256_sub_ps(by, ay), weight, ay);
+                    const __m256 z = _mm256_fmadd_ps(_mm256_sub_ps(bz, az), weight, az);
+                    const __m256 w = _mm256_fmadd_ps(_mm256_sub_ps(bw, aw), weight, aw);
+                    const __m256 lengthSquared = _mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_fmadd_ps(z, z, _mm256_mul_ps(w, w))));
+
+                    __m256 scale = _mm256_rsqrt_ps(lengthSquared);
+                    const __m256 halfScale = _mm256_mul_ps(_mm256_mul_ps(half, lengthSquared), scale);
+                    scale = _mm256_mul_ps(scale, _mm256_fnmadd_ps(halfScale, scale, threeHalves));
+                    scale = _mm256_and_ps(scale, _mm256_cmp_ps(lengthSquared, zero, _CMP_GT_OQ));
+
+                    _mm256_storeu_ps(output.x + i, _mm256_mul_ps(x, scale));
+                    _mm256_storeu_ps(output.y + i, _mm256_mul_ps(y, scale));
+                    _mm256_storeu_ps(output.z + i, _mm256_mul_ps(z, scale));
+                    _mm256_storeu_ps(output.w + i, _mm256_mul_ps(w, scale));
+                }
+
+                NlerpScalar(a, b, t, tScalar, output, i, count);
+            }
+
+            ALIMER_TARGET_AVX2 inline __m256 SlerpWeightAVX2(__m256 t, __m256 cosThetaMinusOne)
+            {
+                const __m256 tSquared = _mm256_mul_ps(t, t);
+                const __m256 one = _mm256_set1_ps(1.0f);
+                __m256 result = one;
+                for (int i = 7; i >= 0; --i)
+                {
+                    const __m256 term = _mm256_mul_ps(_mm256_fmsub_ps(_mm256_set1_ps(kSlerpU[i]), tSquared, _mm256_set1_ps(kSlerpV[i])), cosThetaMinusOne);
+                    result = _mm256_fmadd_ps(term, result, one);
+                }
+                return _mm256_mul_ps(t, result);
+            }
+
+            ALIMER_TARGET_AVX2 void SlerpAVX2(const_float4_stream a, const_float4_stream b, const float* t, float tScalar, float4_stream output, size_t, size_t count)
+            {
+                const __m256 signMask = _mm256_set1_ps(-0.0f);
+                const __m256 one = _mm256_set1_ps(1.0f);
+                const __m256 weightScalar = _mm256_set1_ps(tScalar);
+
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m256 weight = t != nullptr ? _mm256_loadu_ps(t + i) : weightScalar;
+                    const __m256 ax = _mm256_loadu_ps(a.x + i), ay = _mm256_loadu_ps(a.y + i), az = _mm256_loadu_ps(a.z + i), aw = _mm256_loadu_ps(a.w + i);
+                    const __m256 bx = _mm256_loadu_ps(b.x + i), by = _mm256_loadu_ps(b.y + i), bz = _mm256_loadu_ps(b.z + i), bw = _mm256_loadu_ps(b.w + i);
+
+                    const __m256 cosTheta = _mm256_fmadd_ps(ax, bx, _mm256_fmadd_ps(ay, by, _mm256_fmadd_ps(az, bz, _mm256_mul_ps(aw, bw))));
+                    const __m256 sign = _mm256_and_ps(cosTheta, signMask);
+                    const __m256 cosThetaMinusOne = _mm256_sub_ps(_mm256_andnot_ps(signMask, cosTheta), one);
+
+                    const __m256 weightA = SlerpWeightAVX2(_mm256_sub_ps(one, weight), cosThetaMinusOne);
+                    const __m256 weightB = _mm256_xor_ps(SlerpWeightAVX2(weight, cosThetaMinusOne), sign);
+
+                    _mm256_storeu_ps(output.x + i, _mm256_fmadd_ps(ax, weightA, _mm256_mul_ps(bx, weightB)));
+                    _mm256_storeu_ps(output.y + i, _mm256_fmadd_ps(ay, weightA, _mm256_mul_ps(by, weightB)));
+                    _mm256_storeu_ps(output.z + i, _mm256_fmadd_ps(az, weightA, _mm256_mul_ps(bz, weightB)));
+                    _mm256_storeu_ps(output.w + i, _mm256_fmadd_ps(aw, weightA, _mm256_mul_ps(bw, weightB)));
+                }
+
+                SlerpScalar(a, b, t, tScalar, output, i, count);
+            }
+
+            const Kernels s_avx2Kernels = { Isa::AVX2, TransformPointsAVX2, TransformVectorsAVX2, ComputeAabbsAVX2, NormalizeAVX2, MultiplyAVX2, NlerpAVX2, SlerpAVX2 };
+
+            /* AVX-512 kernels, 16 elements per iteration, tails use masked loads and stores. */
+            ALIMER_TARGET_AVX512 void TransformAVX512(const float4x4& m, const_float3_stream input, float3_stream output, size_t count, bool points)
+            {
+                const __m512 m00 = _mm512_set1_ps(m[0].x), m01 = _mm512_set1_ps(m[0].y), m02 = _mm512_set1_ps(m[0].z);
+                const __m512 m10 = _mm512_set1_ps(m[1].x), m11 = _mm512_set1_ps(m[1].y), m12 = _mm512_set1_ps(m[1].z);
+                const __m512 m20 = _mm512_set1_ps(m[2].x), m21 = _mm512_set1_ps(m[2].y), m22 = _mm512_set1_ps(m[2].z);
+                const __m512 m30 = points ? _mm512_set1_ps(m[3].x) : _mm512_setzero_ps();
+                const __m512 m31 = points ? _mm512_set1_ps(m[3].y) : _mm512_setzero_ps();
+                const __m512 m32 = points ? _mm512_set1_ps(m[3].z) : _mm512_setzero_ps();
+
+                for (size_t i = 0; i < count; i += 16)
+                {
+                    const __mmask16 mask = count - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (count - i)) - 1);
+                    const __m512 x = _mm512_maskz_loadu_ps(mask, input.x + i);
+                    const __m512 y = _mm512_maskz_loadu_ps(mask, input.y + i);
+                    const __m512 z = _mm512_maskz_loadu_ps(mask, input.z + i);
+                    _mm512_mask_storeu_ps(output.x + i, mask, _mm512_fmadd_ps(m00, x, _mm512_fmadd_ps(m10, y, _mm512_fmadd_ps(m20, z, m30))));
+                    _mm512_mask_storeu_ps(output.y + i, mask, _mm512_fmadd_ps(m01, x, _mm512_fmadd_ps(m11, y, _mm512_fmadd_ps(m21, z, m31))));
+                    _mm512_mask_storeu_ps(output.z + i, mask, _mm512_fmadd_ps(m02, x, _mm512_fmadd_ps(m12, y, _mm512_fmadd_ps(m22, z, m32))));
+                }
+            }
+
+            void TransformPointsAVX512(const float4x4& m, const_float3_stream input, float3_stream output, size_t, size_t count)
+            {
+                TransformAVX512(m, input, output, count, true);
+            }
+
+            void TransformVectorsAVX512(const float4x4& m, const_float3_stream input, float3_stream output, size_t, size_t count)
+            {
+                TransformAVX512(m, input, output, count, false);
+            }
+
+            ALIMER_TARGET_AVX512 void ComputeAabbsAVX512(const float4x4* matrices, const_float3_stream localMin, const_float3_stream localMax, float3_stream worldMin, float3_stream worldMax, size_t, size_t count)
+            {
+                const __m512i stride = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(16));
+                const __m512 half = _mm512_set1_ps(0.5f);
+
+                for (size_t i = 0; i < count; i += 16)
+                {
+                    const __mmask16 mask = count - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (count - i)) - 1);
+                    const float* base = &matrices[i][0].x;
+                    const __m512 minX = _mm512_maskz_loadu_ps(mask, localMin.x + i), maxX = _mm512_maskz_loadu_ps(mask, localMax.x + i);
+                    const __m512 minY = _mm512_maskz_loadu_ps(mask, localMin.y + i), maxY = _mm512_maskz_loadu_ps(mask, localMax.y + i);
+                    const __m512 minZ = _mm512_maskz_loadu_ps(mask, localMin.z + i), maxZ = _mm512_maskz_loadu_ps(mask, localMax.z + i);
+                    const __m512 cx = _mm512_mul_ps(_mm512_add_ps(minX, maxX), half);
+                    const __m512 cy = _mm512_mul_ps(_mm512_add_ps(minY, maxY), half);
+                    const __m512 cz = _mm512_mul_ps(_mm512_add_ps(minZ, maxZ), half);
+                    const __m512 ex = _mm512_mul_ps(_mm512_sub_ps(maxX, minX), half);
+                    const __m512 ey = _mm512_mul_ps(_mm512_sub_ps(maxY, minY), half);
+                    const __m512 ez = _mm512_mul_ps(_mm512_sub_ps(maxZ, minZ), half);
+
+                    float* minOut[3] = { worldMin.x + i, worldMin.y + i, worldMin.z + i };
+                    float* maxOut[3] = { worldMax.x + i, worldMax.y + i, worldMax.z + i };
+                    for (int r = 0; r < 3; ++r)
+                    {
+                        const __m512 zero = _mm512_setzero_ps();
+                        const __m512 c0 = _mm512_mask_i32gather_ps(zero, mask, stride, base + r, 4);
+                        const __m512 c1 = _mm512_mask_i32gather_ps(zero, mask, stride, base + 4 + r, 4);
+                        const __m512 c2 = _mm512_mask_i32gather_ps(zero, mask, stride, base + 8 + r, 4);
+                        const __m512 c3 = _mm512_mask_i32gather_ps(zero, mask, stride, base + 12 + r, 4);
+
+                        const __m512 center = _mm512_fmadd_ps(c0, cx, _mm512_fmadd_ps(c1, cy, _mm512_fmadd_ps(c2, cz, c3)));
+                        const __m512 extent = _mm512_fmadd_ps(_mm512_abs_ps(c0), ex,
+                            _mm512_fmadd_ps(_mm512_abs_ps(c1), ey, _mm512_mul_ps(_mm512_abs_ps(c2), ez)));
+                        _mm512_mask_storeu_ps(minOut[r], mask, _mm512_sub_ps(center, extent));
+                        _mm512_mask_storeu_ps(maxOut[r], mask, _mm512_add_ps(center, extent));
+                    }
+                }
+            }
+
+            ALIMER_TARGET_AVX512 void NormalizeAVX512(const_float3_stream input, float3_stream output, size_t, size_t count)
+            {
+                const __m512 zero = _mm512_setzero_ps();
+                const __m512 half = _mm512_set1_ps(0.5f);
+                const __m512 threeHalves = _mm512_set1_ps(1.5f);
+
+                for (size_t i = 0; i < count; i += 16)
+                {
+                    const __mmask16 mask = count - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (count - i)) - 1);
+                    const __m512 x = _mm512_maskz_loadu_ps(mask, input.x + i);
+                    const __m512 y = _mm512_maskz_loadu_ps(mask, input.y + i);
+                    const __m512 z = _mm512_maskz_loadu_ps(mask, input.z + i);
+                    const __m512 lengthSquared = _mm512_fmadd_ps(x, x, _mm512_fmadd_ps(y, y, _mm512_mul_ps(z, z)));
+
+                    __m512 scale = _mm512_rsqrt14_ps(lengthSquared);
+                    const __m512 halfScale = _mm512_mul_ps(_mm512_mul_ps(half, lengthSquared), scale);
+                    scale = _mm512_mul_ps(scale, _mm512_fnmadd_ps(halfScale, scale, threeHalves));
+                    scale = _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(lengthSquared, zero, _CMP_GT_OQ), scale);
+
+                    _mm512_mask_storeu_ps(output.x + i, mask, _mm512_mul_ps(x, scale));
+                    _mm512_mask_storeu_ps(output.y + i, mask, _mm512_mul_ps(y, scale));
+                    _mm512_mask_storeu_ps(output.z + i, mask, _mm512_mul_ps(z, scale));
+                }
+            }
+
+            ALIMER_TARGET_AVX512 void MultiplyAVX512(const float4x4* a, const float4x4* b, float4x4* output, size_t, size_t count)
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    // The whole of b in one register, each column of a in all four lanes.
+                    const __m512 a0 = _mm512_broadcast_f32x4(_mm_loadu_ps(&a[i][0].x));
+                    const __m512 a1 = _mm512_broadcast_f32x4(_mm_loadu_ps(&a[i][1].x));
+                    const __m512 a2 = _mm512_broadcast_f32x4(_mm_loadu_ps(&a[i][2].x));
+                    const __m512 a3 = _mm512_broadcast_f32x4(_mm_loadu_ps(&a[i][3].x));
+                    const __m512 bm = _mm512_loadu_ps(&b[i][0].x);
+
+                    __m512 r = _mm512_mul_ps(a0, _mm512_permute_ps(bm, _MM_SHUFFLE(0, 0, 0, 0)));
+                    r = _mm512_fmadd_ps(a1, _mm512_permute_ps(bm, _MM_SHUFFLE(1, 1, 1, 1)), r);
+                    r = _mm512_fmadd_ps(a2, _mm512_permute_ps(bm, _MM_SHUFFLE(2, 2, 2, 2)), r);
+                    r = _mm512_fmadd_ps(a3, _mm512_permute_ps(bm, _MM_SHUFFLE(3, 3, 3, 3)), r);
+                    _mm512_storeu_ps(&output[i][0].x, r);
+                }
+            }
+
+            ALIMER_TARGET_AVX512 void NlerpAVX512(const_float4_stream a, const_float4_stream b, const float* t, float tScalar, float4_stream output, size_t, size_t count)
+            {
+                const __m512i signMask = _mm512_set1_epi32(int32_t(0x80000000u));
+                const __m512 zero = _mm512_setzero_ps();
+                const __m512 half = _mm512_set1_ps(0.5f);
+                const __m512 threeHalves = _mm512_set1_ps(1.5f);
+                const __m512 weightScalar = _mm512_set1_ps(tScalar);
+
+                for (size_t i = 0; i < count; i += 16)
+                {
+                    const __mmask16 mask = count - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (count - i)) - 1);
+                    const __m512 weight = t != nullptr ? _mm512_maskz_loadu_ps(mask, t + i) : weightScalar;
+                    const __m512 ax = _mm512_maskz_loadu_ps(mask, a.x + i), ay = _mm512_maskz_loadu_ps(mask, a.y + i);
+                    const __m512 az = _mm512_maskz_loadu_ps(mask, a.z + i), aw = _mm512_maskz_loadu_ps(mask, a.w + i);
+                    __m512 bx = _mm512_maskz_loadu_ps(mask, b.x + i), by = _mm512_maskz_loadu_ps(mask, b.y + i);
+                    __m512 bz = _mm512_maskz_loadu_ps(mask, b.z + i), bw = _mm512_maskz_loadu_ps(mask, b.w + i);
+
+                    const __m512 cosTheta = _mm512_fmadd_ps(ax, bx, _mm512_fmadd_ps(ay, by, _mm512_fmadd_ps(az, bz, _mm512_mul_ps(aw, bw))));
+                    const __m512i sign = _mm512_and_epi32(_mm512_castps_si512(cosTheta), signMask);
+                    bx = _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(bx), sign));
+                    by = _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(by), sign));
+                    bz = _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(bz), sign));
+                    bw = _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(bw), sign));
+
+                    const __m512 x = _mm512_fmadd_ps(_mm512_sub_ps(bx, ax), weight, ax);
+                    const __m512 y = _mm512_fmadd_ps(_mm512_sub_ps(by, ay), weight, ay);
+                    const __m512 z = _mm512_fmadd_ps(_mm512_sub_ps(bz, az), weight, az);
+                    const __m512 w = _mm512_fmadd_ps(_mm512_sub_ps(bw, aw), weight, aw);
+                    const __m512 lengthSquared = _mm512_fmadd_ps(x, x, _mm512_fmadd_ps(y, y, _mm512_fmadd_ps(z, z, _mm512_mul_ps(w, w))));
+
+                    __m512 scale = _mm512_rsqrt14_ps(lengthSquared);
+                    const __m512 halfScale = _mm512_mul_ps(_mm512_mul_ps(half, lengthSquared), scale);
+                    scale = _mm512_mul_ps(scale, _mm512_fnmadd_ps(halfScale, scale, threeHalves));
+                    scale = _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(lengthSquared, zero, _CMP_GT_OQ), scale);
+
+                    _mm512_mask_storeu_ps(output.x + i, mask, _mm512_mul_ps(x, scale));
+                    _mm512_mask_storeu_ps(output.y + i, mask, _mm512_mul_ps(y, scale));
+                    _mm512_mask_storeu_ps(output.z + i, mask, _mm512_mul_ps(z, scale));
+                    _mm512_mask_storeu_ps(output.w + i, mask, _mm512_mul_ps(w, scale));
+                }
+            }
+
+            ALIMER_TARGET_AVX512 inline __m512 SlerpWeightAVX512(__m512 t, __m512 cosThetaMinusOne)
+            {
+                const __m512 tSquared = _mm512_mul_ps(t, t);
+                const __m512 one = _mm512_set1_ps(1.0f);
+                __m512 result = one;
+                for (int i = 7; i >= 0; --i)
+                {
+                    const __m512 term = _mm512_mul_ps(_mm512_fmsub_ps(_mm512_set1_ps(kSlerpU[i]), tSquared, _mm512_set1_ps(kSlerpV[i])), cosThetaMinusOne);
+                    result = _mm512_fmadd_ps(term, result, one);
+                }
+                return _mm512_mul_ps(t, result);
+            }
+
+            ALIMER_TARGET_AVX512 void SlerpAVX512(const_float4_stream a, const_float4_stream b, const float* t, float tScalar, float4_stream output, size_t, size_t count)
+            {
+                const __m512i signMask = _mm512_set1_epi32(int32_t(0x80000000u));
+                const __m512 one = _mm512_set1_ps(1.0f);
+                const __m512 weightScalar = _mm512_set1_ps(tScalar);
+
+                for (size_t i = 0; i < count; i += 16)
+                {
+                    const __mmask16 mask = count - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1u << (count - i)) - 1);
+                    const __m512 weight = t != nullptr ? _mm512_maskz_loadu_ps(mask, t + i) : weightScalar;
+                    const __m512 ax = _mm512_maskz_loadu_ps(mask, a.x + i), ay = _mm512_maskz_loadu_ps(mask, a.y + i);
+                    const __m512 az = _mm512_maskz_loadu_ps(mask, a.z + i), aw = _mm512_maskz_loadu_ps(mask, a.w + i);
+                    const __m512 bx = _mm512_maskz_loadu_ps(mask, b.x + i), by = _mm512_maskz_loadu_ps(mask, b.y + i);
+                    const __m512 bz = _mm512_maskz_loadu_ps(mask, b.z + i), bw = _mm512_maskz_loadu_ps(mask, b.w + i);
+
+                    const __m512 cosTheta = _mm512_fmadd_ps(ax, bx, _mm512_fmadd_ps(ay, by, _mm512_fmadd_ps(az, bz, _mm512_mul_ps(aw, bw))));
+                    const __m512i sign = _mm512_and_epi32(_mm512_castps_si512(cosTheta), signMask);
+                    const __m512 cosThetaMinusOne = _mm512_sub_ps(_mm512_abs_ps(cosTheta), one);
+
+                    const __m512 weightA = SlerpWeightAVX512(_mm512_sub_ps(one, weight), cosThetaMinusOne);
+                    const __m512 weightB = _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(SlerpWeightAVX512(weight, cosThetaMinusOne)), sign));
+
+                    _mm512_mask_storeu_ps(output.x + i, mask, _mm512_fmadd_ps(ax, weightA, _mm512_mul_ps(bx, weightB)));
+                    _mm512_mask_storeu_ps(output.y + i, mask, _mm512_fmadd_ps(ay, weightA, _mm512_mul_ps(by, weightB)));
+                    _mm512_mask_storeu_ps(output.z + i, mask, _mm512_fmadd_ps(az, weightA, _mm512_mul_ps(bz, weightB)));
+                    _mm512_mask_storeu_ps(output.w + i, mask, _mm512_fmadd_ps(aw, weightA, _mm512_mul_ps(bw, weightB)));
+                }
+            }
+
+            const Kernels s_avx512Kernels = { Isa::AVX512, TransformPointsAVX512, TransformVectorsAVX512, ComputeAabbsAVX512, NormalizeAVX512, MultiplyAVX512, NlerpAVX512, SlerpAVX512 };
+#endif
+
+            const Kernels* GetKernels(Isa isa)
+            {
+                switch (isa)
+                {
+#if defined(ALIMER_BATCH_X86)
+                case Isa::AVX2:
+                    return &s_avx2Kernels;
+                case Isa::AVX512:
+                    return &s_avx512Kernels;
+#endif
+                default:
+                    return &s_scalarKernels;
+                }
+            }
+
+            std::atomic<const Kernels*> s_kernels{ nullptr };
+
+            /// Kernel table, selected once from the CPU features unless SetIsa overrides it.
+            const Kernels& GetActiveKernels()
+            {
+                const Kernels* kernels = s_kernels.load(std::memory_order_acquire);
+                if (kernels == nullptr)
+                {
+                    kernels = GetKernels(GetSupportedIsa());
+                    s_kernels.store(kernels, std::memory_order_release);
+                }
+
+                return *kernels;
+            }
+        }
+
+        Isa GetIsa()
+        {
+            return GetActiveKernels().isa;
+        }
+
+        Isa GetSupportedIsa()
+        {
+#if defined(ALIMER_BATCH_X86)
+            const CpuFeatures& features = Platform::GetCpuFeatures();
+            if (features.avx512f)
+                return Isa::AVX512;
+
+            if (features.avx2 && features.fma)
+                return Isa::AVX2;
+#endif
+
+            return Isa::Scalar;
+        }
+
+        bool SetIsa(Isa isa)
+        {
+            if (static_cast<uint32_t>(isa) > static_cast<uint32_t>(GetSupportedIsa()))
+                return false;
+
+            s_kernels.store(GetKernels(isa), std::memory_order_release);
+            return true;
+        }
+
+        const char* GetIsaName(Isa isa)
+        {
+            switch (isa)
+            {
+            case Isa::AVX2:
+                return "AVX2";
+            case Isa::AVX512:
+                return "AVX-512";
+            default:
+                return "Scalar";
+            }
+        }
+
+        void transform_points(const float4x4& m, const_float3_stream input, float3_stream output, size_t count)
+        {
+            GetActiveKernels().transformPoints(m, input, output, 0, count);
+        }
+
+        void transform_vectors(const float4x4& m, const_float3_stream input, float3_stream output, size_t count)
+        {
+            GetActiveKernels().transformVectors(m, input, output, 0, count);
+        }
+
+        void compute_aabbs(const float4x4* matrices, const_float3_stream localMin, const_float3_stream localMax, float3_stream worldMin, float3_stream worldMax, size_t count)
+        {
+            GetActiveKernels().computeAabbs(matrices, localMin, localMax, worldMin, worldMax, 0, count);
+        }
+
+        void normalize(const_float3_stream input, float3_stream output, size_t count)
+        {
+            GetActiveKernels().normalize(input, output, 0, count);
+        }
+
+        void multiply(const float4x4* a, const float4x4* b, float4x4* output, size_t count)
+        {
+            GetActiveKernels().multiply(a, b, output, 0, count);
+        }
+
+        void nlerp(const_float4_stream a, const_float4_stream b, const float* t, float4_stream output, size_t count)
+        {
+            ALIMER_ASSERT(t != nullptr || count == 0);
+            GetActiveKernels().nlerp(a, b, t, 0.0f, output, 0, count);
+        }
+
+        void nlerp(const_float4_stream a, const_float4_stream b, float t, float4_stream output, size_t count)
+        {
+            GetActiveKernels().nlerp(a, b, nullptr, t, output, 0, count);
+        }
+
+        void slerp(const_float4_stream a, const_float4_stream b, const float* t, float4_stream output, size_t count)
+        {
+            ALIMER_ASSERT(t != nullptr || count == 0);
+            GetActiveKernels().slerp(a, b, t, 0.0f, output, 0, count);
+        }
+
+        void slerp(const_float4_stream a, const_float4_stream b, float t, float4_stream output, size_t count)
+        {
+            GetActiveKernels().slerp(a, b, nullptr, t, output, 0, count);
+        }
+    }
+}
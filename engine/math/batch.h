@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "math/math.h"
+
+namespace alimer
+{
+    /// Kernels over structure of arrays streams, dispatched at runtime to the best instruction set the CPU supports.
+    namespace batch
+    {
+        /// Instruction set used by the batch kernels.
+        enum class Isa : uint32_t
+        {
+            Scalar,
+            AVX2,
+            AVX512
+        };
+
+        /// Writable x, y and z component arrays.
+        struct float3_stream
+        {
+            float* x;
+            float* y;
+            float* z;
+        };
+
+        /// Read only x, y and z component arrays.
+        struct const_float3_stream
+        {
+            const float* x;
+            const float* y;
+            const float* z;
+
+            const_float3_stream() = default;
+            const_float3_stream(const float* x_, const float* y_, const float* z_) : x(x_), y(y_), z(z_) {}
+            const_float3_stream(const float3_stream& other) : x(other.x), y(other.y), z(other.z) {}
+        };
+
+        /// Writable x, y, z and w component arrays, used for quaternions.
+        struct float4_stream
+        {
+            float* x;
+            float* y;
+            float* z;
+            float* w;
+        };
+
+        /// Read only x, y, z and w component arrays.
+        struct const_float4_stream
+        {
+            const float* x;
+            const float* y;
+            const float* z;
+            const float* w;
+
+            const_float4_stream() = default;
+            const_float4_stream(const float* x_, const float* y_, const float* z_, const float* w_) : x(x_), y(y_), z(z_), w(w_) {}
+            const_float4_stream(const float4_stream& other) : x(other.x), y(other.y), z(other.z), w(other.w) {}
+        };
+
+        /// Return the instruction set the kernels run with, picked from the CPU features on first use.
+        ALIMER_API Isa GetIsa();
+
+        /// Return the best instruction set supported by the CPU.
+        ALIMER_API Isa GetSupportedIsa();
+
+        /// Force an instruction set, fails if the CPU doesn't support it.
+        ALIMER_API bool SetIsa(Isa isa);
+
+        /// Return the name of an instruction set.
+        ALIMER_API const char* GetIsaName(Isa isa);
+
+        /// Transform count points (w = 1) by a matrix, output may alias input.
+        ALIMER_API void transform_points(const float4x4& m, const_float3_stream input, float3_stream output, size_t count);
+
+        /// Transform count direction vectors (w = 0) by a matrix, output may alias input.
+        ALIMER_API void transform_vectors(const float4x4& m, const_float3_stream input, float3_stream output, size_t count);
+
+        /// Compute the world space bounds of count local boxes, same result as the bounds of the 8 transformed corners.
+        ALIMER_API void compute_aabbs(const float4x4* matrices,
+            const_float3_stream localMin, const_float3_stream localMax,
+            float3_stream worldMin, float3_stream worldMax, size_t count);
+
+        /// Normalize count vectors, zero length vectors stay zero. Output may alias input.
+        ALIMER_API void normalize(const_float3_stream input, float3_stream output, size_t count);
+
+        /// Compute output[i] = a[i] * b[i] for count matrices, output may alias a or b.
+        ALIMER_API void multiply(const float4x4* a, const float4x4* b, float4x4* output, size_t count);
+
+        /// Normalized linear interpolation of count quaternions along the shortest path, one weight per element.
+        ALIMER_API void nlerp(const_float4_stream a, const_float4_stream b, const float* t, float4_stream output, size_t count);
+
+        /// Normalized linear interpolation of count quaternions with a single weight.
+        ALIMER_API void nlerp(const_float4_stream a, const_float4_stream b, float t, float4_stream output, size_t count);
+
+        /// Spherical linear interpolation of count unit quaternions along the shortest path, one weight per element.
+        /// Uses a branch free polynomial approximation (Eberly): error is below 1e-6 up to 120 degrees apart and 3e-5 at worst.
+        ALIMER_API void slerp(const_float4_stream a, const_float4_stream b, const float* t, float4_stream output, size_t count);
+
+        /// Spherical linear interpolation of count unit quaternions with a single weight.
+        ALIMER_API void slerp(const_float4_stream a, const_float4_stream b, float t, float4_stream output, size_t count);
+    }
+}
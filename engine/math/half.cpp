@@ -0,0 +1,122 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "math/half.h"
+#include "core/Platform.h"
+
+#if !defined(ALIMER_NO_SIMD) && (defined(_M_X64) || defined(__x86_64__))
+#   define ALIMER_HALF_F16C
+#   include <immintrin.h>
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       define ALIMER_TARGET_F16C
+#   else
+#       define ALIMER_TARGET_F16C __attribute__((target("avx,f16c")))
+#   endif
+#elif !defined(ALIMER_NO_SIMD) && (defined(__aarch64__) || defined(_M_ARM64))
+#   define ALIMER_HALF_NEON
+#   include <arm_neon.h>
+#endif
+
+namespace alimer
+{
+    namespace
+    {
+#if defined(ALIMER_HALF_F16C)
+        bool HasF16C()
+        {
+#if defined(__F16C__)
+            return true;
+#else
+            static const bool supported = Platform::GetCpuFeatures().f16c;
+            return supported;
+#endif
+        }
+
+        /// Converts the multiple of 8 prefix, returns how many values were converted.
+        ALIMER_TARGET_F16C size_t ConvertToHalfF16C(const float* input, half* output, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i packed = _mm256_cvtps_ph(_mm256_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), packed);
+            }
+            return i;
+        }
+
+        ALIMER_TARGET_F16C size_t ConvertToFloatF16C(const half* input, float* output, size_t count)
+        {
+            size_t i = 0;
+            for (; i + 8 <= count; i += 8)
+            {
+                const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+                _mm256_storeu_ps(output + i, _mm256_cvtph_ps(packed));
+            }
+            return i;
+        }
+#endif
+    }
+
+    void convert_to_half(const float* input, half* output, size_t count)
+    {
+        size_t i = 0;
+#if defined(ALIMER_HALF_F16C)
+        if (HasF16C())
+        {
+            i = ConvertToHalfF16C(input, output, count);
+        }
+#elif defined(ALIMER_HALF_NEON)
+        for (; i + 4 <= count; i += 4)
+        {
+            const float16x4_t packed = vcvt_f16_f32(vld1q_f32(input + i));
+            vst1_u16(reinterpret_cast<uint16_t*>(output + i), vreinterpret_u16_f16(packed));
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            output[i].bits = float_to_half_bits(input[i]);
+        }
+    }
+
+    void convert_to_float(const half* input, float* output, size_t count)
+    {
+        size_t i = 0;
+#if defined(ALIMER_HALF_F16C)
+        if (HasF16C())
+        {
+            i = ConvertToFloatF16C(input, output, count);
+        }
+#elif defined(ALIMER_HALF_NEON)
+        for (; i + 4 <= count; i += 4)
+        {
+            const float16x4_t packed = vreinterpret_f16_u16(vld1_u16(reinterpret_cast<const uint16_t*>(input + i)));
+            vst1q_f32(output + i, vcvt_f32_f16(packed));
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            output[i] = half_bits_to_float(input[i].bits);
+        }
+    }
+}
@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "core/Preprocessor.h"
+#include <cstring>
+
+namespace alimer
+{
+    /// Convert a float to IEEE 754 binary16 bits, rounding to nearest even. NaN stays NaN, overflow gives infinity.
+    inline uint16_t float_to_half_bits(float value)
+    {
+        uint32_t f;
+        memcpy(&f, &value, sizeof(f));
+        const uint32_t sign = f & 0x80000000u;
+        f ^= sign;
+
+        uint16_t result;
+        if (f >= 0x47800000u)
+        {
+            // 65536 or more rounds to infinity, NaN keeps the top of its payload like F16C does.
+            result = f > 0x7f800000u ? uint16_t(0x7e00u | ((f >> 13) & 0x3ffu)) : uint16_t(0x7c00u);
+        }
+        else if (f < 0x38800000u)
+        {
+            // Subnormal or zero, let the FPU round by adding a magic number that shifts the mantissa into place.
+            const uint32_t denormMagicBits = ((127 - 15) + (23 - 10) + 1) << 23;
+            float denormMagic, scaled;
+            memcpy(&denormMagic, &denormMagicBits, sizeof(denormMagic));
+            memcpy(&scaled, &f, sizeof(scaled));
+            scaled += denormMagic;
+            memcpy(&f, &scaled, sizeof(f));
+            result = uint16_t(f - denormMagicBits);
+        }
+        else
+        {
+            // Rebias the exponent and round the dropped 13 bits, ties go to the even mantissa.
+            const uint32_t mantissaOdd = (f >> 13) & 1u;
+            f += (uint32_t(15 - 127) << 23) + 0xfffu + mantissaOdd;
+            result = uint16_t(f >> 13);
+        }
+
+        return uint16_t(result | (sign >> 16));
+    }
+
+    /// Convert IEEE 754 binary16 bits to a float, exact for every value. Signaling NaNs become quiet.
+    inline float half_bits_to_float(uint16_t value)
+    {
+        const uint32_t shiftedExponent = 0x7c00u << 13;
+        uint32_t f = uint32_t(value & 0x7fffu) << 13;
+        const uint32_t exponent = f & shiftedExponent;
+        f += uint32_t(127 - 15) << 23;
+
+        if (exponent == shiftedExponent)
+        {
+            // Infinity or NaN.
+            f += uint32_t(128 - 16) << 23;
+            if ((value & 0x3ffu) != 0)
+                f |= 0x400000u;
+        }
+        else if (exponent == 0)
+        {
+            // Zero or subnormal, renormalize through the FPU.
+            const uint32_t magicBits = 113u << 23;
+            float magic, result;
+            f += 1u << 23;
+            memcpy(&magic, &magicBits, sizeof(magic));
+            memcpy(&result, &f, sizeof(result));
+            result -= magic;
+            memcpy(&f, &result, sizeof(f));
+        }
+
+        f |= uint32_t(value & 0x8000u) << 16;
+        float result;
+        memcpy(&result, &f, sizeof(result));
+        return result;
+    }
+
+    /// IEEE 754 half precision float, for storage only, convert to float to do math.
+    struct half
+    {
+        uint16_t bits;
+
+        half() = default;
+        explicit half(float value) : bits(float_to_half_bits(value)) {}
+        explicit operator float() const { return half_bits_to_float(bits); }
+
+        /// Construct from raw binary16 bits.
+        static half FromBits(uint16_t bits)
+        {
+            half result;
+            result.bits = bits;
+            return result;
+        }
+
+        bool operator==(const half& rhs) const { return bits == rhs.bits; }
+        bool operator!=(const half& rhs) const { return bits != rhs.bits; }
+    };
+
+    static_assert(sizeof(half) == 2, "half must be 2 bytes");
+
+    /// Convert count floats to half, using F16C or NEON when the CPU has it. Results match float_to_half_bits.
+    ALIMER_API void convert_to_half(const float* input, half* output, size_t count);
+
+    /// Convert count halfs to float, using F16C or NEON when the CPU has it.
+    ALIMER_API void convert_to_float(const half* input, float* output, size_t count);
+}
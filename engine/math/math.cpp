@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "math/math.h"
+
+namespace alimer
+{
+    void transform(const float4x4& m, const float4* input, float4* output, size_t count)
+    {
+        size_t i = 0;
+#if defined(ALIMER_SIMD_AVX)
+        // Two vectors per iteration, each column is broadcast to both halves.
+        const __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m.columns[0].data));
+        const __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m.columns[1].data));
+        const __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m.columns[2].data));
+        const __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m.columns[3].data));
+        for (; i + 2 <= count; i += 2)
+        {
+            const __m256 v = _mm256_loadu_ps(input[i].data);
+            __m256 r = _mm256_mul_ps(c0, _mm256_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+            r = _mm256_add_ps(r, _mm256_mul_ps(c1, _mm256_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+            r = _mm256_add_ps(r, _mm256_mul_ps(c2, _mm256_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+            r = _mm256_add_ps(r, _mm256_mul_ps(c3, _mm256_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+            _mm256_storeu_ps(output[i].data, r);
+        }
+#endif
+
+        const simd::float4v columns[4] = { to_simd(m.columns[0]), to_simd(m.columns[1]), to_simd(m.columns[2]), to_simd(m.columns[3]) };
+        for (; i < count; ++i)
+        {
+            simd::store(output[i].data, transform(columns, to_simd(input[i])));
+        }
+    }
+
+    void transform_points(const float4x4& m, const float3* input, float3* output, size_t count)
+    {
+        const simd::float4v c0 = to_simd(m.columns[0]);
+        const simd::float4v c1 = to_simd(m.columns[1]);
+        const simd::float4v c2 = to_simd(m.columns[2]);
+        const simd::float4v c3 = to_simd(m.columns[3]);
+
+        // float3 is not padded, load components one by one and store through a scratch vector.
+        for (size_t i = 0; i < count; ++i)
+        {
+            simd::float4v r = simd::madd(c0, simd::splat(input[i].x), c3);
+            r = simd::madd(c1, simd::splat(input[i].y), r);
+            r = simd::madd(c2, simd::splat(input[i].z), r);
+
+            float4 result = from_simd(r);
+            output[i] = result.xyz();
+        }
+    }
+}
@@ -22,8 +22,10 @@
 
 #pragma once
 
+#include "core/Assert.h"
+#include "math/simd.h"
+#include "math/half.h"
 #include <stdint.h>
-#include <assert.h>
 #include <cmath>
 
 #ifdef _MSC_VER
@@ -51,7 +53,7 @@ namespace alimer
     template <typename T> T asin(T v) { return std::asin(v); }
     template <typename T> T acos(T v) { return std::acos(v); }
     template <typename T> T atan(T v) { return std::atan(v); }
-    template <typename T> T log2(T v) { retuhrn std::log2(v); }
+    template <typename T> T log2(T v) { return std::log2(v); }
     template <typename T> T log10(T v) { return std::log10(v); }
     template <typename T> T log(T v) { return std::log(v); }
     template <typename T> T exp2(T v) { return std::exp2(v); }
@@ -113,6 +115,12 @@ namespace alimer
             y = T(u.y);
         }
 
+        explicit constexpr tvec2(T v)
+        {
+            x = v;
+            y = v;
+        }
+
         constexpr tvec2(T x_, T y_)
         {
             x = x_;
@@ -120,13 +128,13 @@ namespace alimer
         }
 
         inline constexpr T const& operator[](size_t i) const noexcept {
-            assert(i < SIZE);
-            return v[i];
+            ALIMER_ASSERT(i < SIZE);
+            return data[i];
         }
 
         inline constexpr T& operator[](size_t i) noexcept {
-            assert(i < SIZE);
-            return v[i];
+            ALIMER_ASSERT(i < SIZE);
+            return data[i];
         }
 
         inline constexpr tvec2 xx() const { return tvec2(x, x); }
@@ -177,12 +185,12 @@ namespace alimer
             z = T(u.z);
         }
 
-        /*inline tvec3(const tvec2<T>& v, T z_) noexcept
+        inline tvec3(const tvec2<T>& v, T z_) noexcept
         {
             x = v.x;
             y = v.y;
             z = z_;
-        }*/
+        }
 
         // array access
         inline constexpr T const& operator[](size_t i) const noexcept {
@@ -194,10 +202,13 @@ namespace alimer
             ALIMER_ASSERT(i < SIZE);
             return data[i];
         }
+
+        inline tvec2<T> xy() const { return tvec2<T>(x, y); }
     };
 
+    /// Four component vector, 16 byte components are aligned so they load straight into SIMD registers.
     template <typename T>
-    struct tvec4
+    struct alignas(sizeof(T) * 4 == 16 ? 16 : alignof(T)) tvec4
     {
     public:
         static constexpr size_t SIZE = 4;
@@ -297,8 +308,419 @@ namespace alimer
             ALIMER_ASSERT(i < SIZE);
             return data[i];
         }
+
+        inline tvec2<T> xy() const { return tvec2<T>(x, y); }
+        inline tvec3<T> xyz() const { return tvec3<T>(x, y, z); }
+    };
+
+    // Component wise arithmetic, defined for every vector size.
+#define ALIMER_VECTOR_OPERATOR(op) \
+    template <typename T> inline tvec2<T> operator op(const tvec2<T>& a, const tvec2<T>& b) { return tvec2<T>(a.x op b.x, a.y op b.y); } \
+    template <typename T> inline tvec2<T> operator op(const tvec2<T>& a, T b) { return tvec2<T>(a.x op b, a.y op b); } \
+    template <typename T> inline tvec2<T> operator op(T a, const tvec2<T>& b) { return tvec2<T>(a op b.x, a op b.y); } \
+    template <typename T> inline tvec2<T>& operator op##=(tvec2<T>& a, const tvec2<T>& b) { return a = a op b; } \
+    template <typename T> inline tvec2<T>& operator op##=(tvec2<T>& a, T b) { return a = a op b; } \
+    template <typename T> inline tvec3<T> operator op(const tvec3<T>& a, const tvec3<T>& b) { return tvec3<T>(a.x op b.x, a.y op b.y, a.z op b.z); } \
+    template <typename T> inline tvec3<T> operator op(const tvec3<T>& a, T b) { return tvec3<T>(a.x op b, a.y op b, a.z op b); } \
+    template <typename T> inline tvec3<T> operator op(T a, const tvec3<T>& b) { return tvec3<T>(a op b.x, a op b.y, a op b.z); } \
+    template <typename T> inline tvec3<T>& operator op##=(tvec3<T>& a, const tvec3<T>& b) { return a = a op b; } \
+    template <typename T> inline tvec3<T>& operator op##=(tvec3<T>& a, T b) { return a = a op b; } \
+    template <typename T> inline tvec4<T> operator op(const tvec4<T>& a, const tvec4<T>& b) { return tvec4<T>(a.x op b.x, a.y op b.y, a.z op b.z, a.w op b.w); } \
+    template <typename T> inline tvec4<T> operator op(const tvec4<T>& a, T b) { return tvec4<T>(a.x op b, a.y op b, a.z op b, a.w op b); } \
+    template <typename T> inline tvec4<T> operator op(T a, const tvec4<T>& b) { return tvec4<T>(a op b.x, a op b.y, a op b.z, a op b.w); } \
+    template <typename T> inline tvec4<T>& operator op##=(tvec4<T>& a, const tvec4<T>& b) { return a = a op b; } \
+    template <typename T> inline tvec4<T>& operator op##=(tvec4<T>& a, T b) { return a = a op b; }
+
+    ALIMER_VECTOR_OPERATOR(+)
+    ALIMER_VECTOR_OPERATOR(-)
+    ALIMER_VECTOR_OPERATOR(*)
+    ALIMER_VECTOR_OPERATOR(/)
+#undef ALIMER_VECTOR_OPERATOR
+
+    template <typename T> inline tvec2<T> operator-(const tvec2<T>& v) { return tvec2<T>(-v.x, -v.y); }
+    template <typename T> inline tvec3<T> operator-(const tvec3<T>& v) { return tvec3<T>(-v.x, -v.y, -v.z); }
+    template <typename T> inline tvec4<T> operator-(const tvec4<T>& v) { return tvec4<T>(-v.x, -v.y, -v.z, -v.w); }
+
+    template <typename T> inline bool operator==(const tvec2<T>& a, const tvec2<T>& b) { return a.x == b.x && a.y == b.y; }
+    template <typename T> inline bool operator==(const tvec3<T>& a, const tvec3<T>& b) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+    template <typename T> inline bool operator==(const tvec4<T>& a, const tvec4<T>& b) { return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w; }
+    template <typename T> inline bool operator!=(const tvec2<T>& a, const tvec2<T>& b) { return !(a == b); }
+    template <typename T> inline bool operator!=(const tvec3<T>& a, const tvec3<T>& b) { return !(a == b); }
+    template <typename T> inline bool operator!=(const tvec4<T>& a, const tvec4<T>& b) { return !(a == b); }
+
+    template <typename T> inline T dot(const tvec2<T>& a, const tvec2<T>& b) { return a.x * b.x + a.y * b.y; }
+    template <typename T> inline T dot(const tvec3<T>& a, const tvec3<T>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    template <typename T> inline T dot(const tvec4<T>& a, const tvec4<T>& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+    template <typename T> inline tvec3<T> cross(const tvec3<T>& a, const tvec3<T>& b)
+    {
+        return tvec3<T>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+
+    template <typename TVec> inline auto length_squared(const TVec& v) -> decltype(dot(v, v)) { return dot(v, v); }
+    template <typename TVec> inline auto length(const TVec& v) -> decltype(dot(v, v)) { return std::sqrt(dot(v, v)); }
+    template <typename TVec> inline TVec normalize(const TVec& v) { return v / length(v); }
+
+    template <typename T> inline tvec2<T> min(const tvec2<T>& a, const tvec2<T>& b) { return tvec2<T>(min(a.x, b.x), min(a.y, b.y)); }
+    template <typename T> inline tvec3<T> min(const tvec3<T>& a, const tvec3<T>& b) { return tvec3<T>(min(a.x, b.x), min(a.y, b.y), min(a.z, b.z)); }
+    template <typename T> inline tvec4<T> min(const tvec4<T>& a, const tvec4<T>& b) { return tvec4<T>(min(a.x, b.x), min(a.y, b.y), min(a.z, b.z), min(a.w, b.w)); }
+    template <typename T> inline tvec2<T> max(const tvec2<T>& a, const tvec2<T>& b) { return tvec2<T>(max(a.x, b.x), max(a.y, b.y)); }
+    template <typename T> inline tvec3<T> max(const tvec3<T>& a, const tvec3<T>& b) { return tvec3<T>(max(a.x, b.x), max(a.y, b.y), max(a.z, b.z)); }
+    template <typename T> inline tvec4<T> max(const tvec4<T>& a, const tvec4<T>& b) { return tvec4<T>(max(a.x, b.x), max(a.y, b.y), max(a.z, b.z), max(a.w, b.w)); }
+
+    template <typename T> inline tvec2<T> lerp(const tvec2<T>& a, const tvec2<T>& b, T t) { return a + (b - a) * t; }
+    template <typename T> inline tvec3<T> lerp(const tvec3<T>& a, const tvec3<T>& b, T t) { return a + (b - a) * t; }
+    template <typename T> inline tvec4<T> lerp(const tvec4<T>& a, const tvec4<T>& b, T t) { return a + (b - a) * t; }
+
+    /// 2x2 column major matrix, m[column][row].
+    template <typename T>
+    struct tmat2
+    {
+        static constexpr size_t SIZE = 2;
+
+        tvec2<T> columns[SIZE];
+
+        tmat2() = default;
+
+        explicit tmat2(T diagonal)
+        {
+            columns[0] = tvec2<T>(diagonal, T(0));
+            columns[1] = tvec2<T>(T(0), diagonal);
+        }
+
+        tmat2(const tvec2<T>& c0, const tvec2<T>& c1)
+        {
+            columns[0] = c0;
+            columns[1] = c1;
+        }
+
+        inline const tvec2<T>& operator[](size_t i) const noexcept {
+            ALIMER_ASSERT(i < SIZE);
+            return columns[i];
+        }
+
+        inline tvec2<T>& operator[](size_t i) noexcept {
+            ALIMER_ASSERT(i < SIZE);
+            return columns[i];
+        }
+
+        static tmat2 identity() { return tmat2(T(1)); }
     };
 
+    /// 3x3 column major matrix, m[column][row].
+    template <typename T>
+    struct tmat3
+    {
+        static constexpr size_t SIZE = 3;
+
+        tvec3<T> columns[SIZE];
+
+        tmat3() = default;
+
+        explicit tmat3(T diagonal)
+        {
+            columns[0] = tvec3<T>(diagonal, T(0), T(0));
+            columns[1] = tvec3<T>(T(0), diagonal, T(0));
+            columns[2] = tvec3<T>(T(0), T(0), diagonal);
+        }
+
+        tmat3(const tvec3<T>& c0, const tvec3<T>& c1, const tvec3<T>& c2)
+        {
+            columns[0] = c0;
+            columns[1] = c1;
+            columns[2] = c2;
+        }
+
+        /// Upper left 3x3 part of a 4x4 matrix.
+        explicit tmat3(const tmat4<T>& m);
+
+        inline const tvec3<T>& operator[](size_t i) const noexcept {
+            ALIMER_ASSERT(i < SIZE);
+            return columns[i];
+        }
+
+        inline tvec3<T>& operator[](size_t i) noexcept {
+            ALIMER_ASSERT(i < SIZE);
+            return columns[i];
+        }
+
+        static tmat3 identity() { return tmat3(T(1)); }
+    };
+
+    /// 4x4 column major matrix, m[column][row], transforms column vectors as m * v.
+    template <typename T>
+    struct tmat4
+    {
+        static constexpr size_t SIZE = 4;
+
+        tvec4<T> columns[SIZE];
+
+        tmat4() = default;
+
+        explicit tmat4(T diagonal)
+        {
+            columns[0] = tvec4<T>(diagonal, T(0), T(0), T(0));
+            columns[1] = tvec4<T>(T(0), diagonal, T(0), T(0));
+            columns[2] = tvec4<T>(T(0), T(0), diagonal, T(0));
+            columns[3] = tvec4<T>(T(0), T(0), T(0), diagonal);
+        }
+
+        tmat4(const tvec4<T>& c0, const tvec4<T>& c1, const tvec4<T>& c2, const tvec4<T>& c3)
+        {
+            columns[0] = c0;
+            columns[1] = c1;
+            columns[2] = c2;
+            columns[3] = c3;
+        }
+
+        inline const tvec4<T>& operator[](size_t i) const noexcept {
+            ALIMER_ASSERT(i < SIZE);
+            return columns[i];
+        }
+
+        inline tvec4<T>& operator[](size_t i) noexcept {
+            ALIMER_ASSERT(i < SIZE);
+            return columns[i];
+        }
+
+        /// Return pointer to the 16 components in column order.
+        const T* Data() const { return columns[0].data; }
+
+        static tmat4 identity() { return tmat4(T(1)); }
+
+        static tmat4 translation(const tvec3<T>& t)
+        {
+            tmat4 result(T(1));
+            result.columns[3] = tvec4<T>(t, T(1));
+            return result;
+        }
+
+        static tmat4 scale(const tvec3<T>& s)
+        {
+            tmat4 result(T(1));
+            result.columns[0].x = s.x;
+            result.columns[1].y = s.y;
+            result.columns[2].z = s.z;
+            return result;
+        }
+
+        /// Rotation of radians around a normalized axis, counter clockwise looking down the axis.
+        static tmat4 rotation(const tvec3<T>& axis, T radians)
+        {
+            const T c = std::cos(radians);
+            const T s = std::sin(radians);
+            const tvec3<T> t = axis * (T(1) - c);
+
+            tmat4 result(T(1));
+            result.columns[0] = tvec4<T>(t.x * axis.x + c, t.x * axis.y + s * axis.z, t.x * axis.z - s * axis.y, T(0));
+            result.columns[1] = tvec4<T>(t.y * axis.x - s * axis.z, t.y * axis.y + c, t.y * axis.z + s * axis.x, T(0));
+            result.columns[2] = tvec4<T>(t.z * axis.x + s * axis.y, t.z * axis.y - s * axis.x, t.z * axis.z + c, T(0));
+            return result;
+        }
+
+        /// Right handed perspective projection with a [0, 1] depth range.
+        static tmat4 perspective(T fovY, T aspectRatio, T zNear, T zFar)
+        {
+            const T h = T(1) / std::tan(fovY * T(0.5));
+            const T range = zFar / (zNear - zFar);
+
+            tmat4 result(T(0));
+            result.columns[0].x = h / aspectRatio;
+            result.columns[1].y = h;
+            result.columns[2].z = range;
+            result.columns[2].w = T(-1);
+            result.columns[3].z = range * zNear;
+            return result;
+        }
+
+        /// Right handed view matrix.
+        static tmat4 look_at(const tvec3<T>& eye, const tvec3<T>& target, const tvec3<T>& up)
+        {
+            const tvec3<T> f = normalize(target - eye);
+            const tvec3<T> s = normalize(cross(f, up));
+            const tvec3<T> u = cross(s, f);
+
+            return tmat4(
+                tvec4<T>(s.x, u.x, -f.x, T(0)),
+                tvec4<T>(s.y, u.y, -f.y, T(0)),
+                tvec4<T>(s.z, u.z, -f.z, T(0)),
+                tvec4<T>(-dot(s, eye), -dot(u, eye), dot(f, eye), T(1)));
+        }
+    };
+
+    template <typename T>
+    tmat3<T>::tmat3(const tmat4<T>& m)
+    {
+        columns[0] = m.columns[0].xyz();
+        columns[1] = m.columns[1].xyz();
+        columns[2] = m.columns[2].xyz();
+    }
+
+    template <typename TMat, size_t N = TMat::SIZE>
+    inline TMat multiply_matrix(const TMat& a, const TMat& b)
+    {
+        TMat result;
+        for (size_t c = 0; c < N; ++c)
+        {
+            result.columns[c] = a.columns[0] * b.columns[c][0];
+            for (size_t k = 1; k < N; ++k)
+            {
+                result.columns[c] += a.columns[k] * b.columns[c][k];
+            }
+        }
+        return result;
+    }
+
+    template <typename T> inline tmat2<T> operator*(const tmat2<T>& a, const tmat2<T>& b) { return multiply_matrix(a, b); }
+    template <typename T> inline tmat3<T> operator*(const tmat3<T>& a, const tmat3<T>& b) { return multiply_matrix(a, b); }
+    template <typename T> inline tmat4<T> operator*(const tmat4<T>& a, const tmat4<T>& b) { return multiply_matrix(a, b); }
+
+    template <typename T> inline tvec2<T> operator*(const tmat2<T>& m, const tvec2<T>& v) { return m.columns[0] * v.x + m.columns[1] * v.y; }
+    template <typename T> inline tvec3<T> operator*(const tmat3<T>& m, const tvec3<T>& v) { return m.columns[0] * v.x + m.columns[1] * v.y + m.columns[2] * v.z; }
+    template <typename T> inline tvec4<T> operator*(const tmat4<T>& m, const tvec4<T>& v)
+    {
+        return m.columns[0] * v.x + m.columns[1] * v.y + m.columns[2] * v.z + m.columns[3] * v.w;
+    }
+
+    template <typename TMat, size_t N = TMat::SIZE>
+    inline bool equal_matrix(const TMat& a, const TMat& b)
+    {
+        for (size_t c = 0; c < N; ++c)
+        {
+            if (a.columns[c] != b.columns[c])
+                return false;
+        }
+        return true;
+    }
+
+    template <typename T> inline bool operator==(const tmat2<T>& a, const tmat2<T>& b) { return equal_matrix(a, b); }
+    template <typename T> inline bool operator==(const tmat3<T>& a, const tmat3<T>& b) { return equal_matrix(a, b); }
+    template <typename T> inline bool operator==(const tmat4<T>& a, const tmat4<T>& b) { return equal_matrix(a, b); }
+    template <typename T> inline bool operator!=(const tmat2<T>& a, const tmat2<T>& b) { return !equal_matrix(a, b); }
+    template <typename T> inline bool operator!=(const tmat3<T>& a, const tmat3<T>& b) { return !equal_matrix(a, b); }
+    template <typename T> inline bool operator!=(const tmat4<T>& a, const tmat4<T>& b) { return !equal_matrix(a, b); }
+
+    template <typename TMat, size_t N = TMat::SIZE>
+    inline TMat transpose(const TMat& m)
+    {
+        TMat result;
+        for (size_t c = 0; c < N; ++c)
+        {
+            for (size_t r = 0; r < N; ++r)
+            {
+                result.columns[c][r] = m.columns[r][c];
+            }
+        }
+        return result;
+    }
+
+    template <typename T> inline T determinant(const tmat2<T>& m)
+    {
+        return m[0][0] * m[1][1] - m[1][0] * m[0][1];
+    }
+
+    template <typename T> inline T determinant(const tmat3<T>& m)
+    {
+        return dot(m[0], cross(m[1], m[2]));
+    }
+
+    template <typename T> inline T determinant(const tmat4<T>& m)
+    {
+        const T s0 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+        const T s1 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        const T s2 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        const T s3 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        const T s4 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        const T s5 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+        const T c0 = m[1][1] * s0 - m[1][2] * s1 + m[1][3] * s2;
+        const T c1 = m[1][0] * s0 - m[1][2] * s3 + m[1][3] * s4;
+        const T c2 = m[1][0] * s1 - m[1][1] * s3 + m[1][3] * s5;
+        const T c3 = m[1][0] * s2 - m[1][1] * s4 + m[1][2] * s5;
+        return m[0][0] * c0 - m[0][1] * c1 + m[0][2] * c2 - m[0][3] * c3;
+    }
+
+    template <typename T> inline tmat2<T> inverse(const tmat2<T>& m)
+    {
+        const T invDet = T(1) / determinant(m);
+        return tmat2<T>(
+            tvec2<T>(m[1][1], -m[0][1]) * invDet,
+            tvec2<T>(-m[1][0], m[0][0]) * invDet);
+    }
+
+    template <typename T> inline tmat3<T> inverse(const tmat3<T>& m)
+    {
+        // Rows of the inverse are the cross products of the columns.
+        const tvec3<T> r0 = cross(m[1], m[2]);
+        const tvec3<T> r1 = cross(m[2], m[0]);
+        const tvec3<T> r2 = cross(m[0], m[1]);
+        const T invDet = T(1) / dot(m[0], r0);
+        return transpose(tmat3<T>(r0 * invDet, r1 * invDet, r2 * invDet));
+    }
+
+    /// Inverse by cofactor expansion, the result is undefined for singular matrices.
+    template <typename T> inline tmat4<T> inverse(const tmat4<T>& m)
+    {
+        const T a00 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+        const T a01 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        const T a02 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        const T a03 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        const T a04 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        const T a05 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+        const T a06 = m[1][2] * m[3][3] - m[3][2] * m[1][3];
+        const T a07 = m[1][1] * m[3][3] - m[3][1] * m[1][3];
+        const T a08 = m[1][1] * m[3][2] - m[3][1] * m[1][2];
+        const T a09 = m[1][0] * m[3][3] - m[3][0] * m[1][3];
+        const T a10 = m[1][0] * m[3][2] - m[3][0] * m[1][2];
+        const T a11 = m[1][0] * m[3][1] - m[3][0] * m[1][1];
+        const T a12 = m[1][2] * m[2][3] - m[2][2] * m[1][3];
+        const T a13 = m[1][1] * m[2][3] - m[2][1] * m[1][3];
+        const T a14 = m[1][1] * m[2][2] - m[2][1] * m[1][2];
+        const T a15 = m[1][0] * m[2][3] - m[2][0] * m[1][3];
+        const T a16 = m[1][0] * m[2][2] - m[2][0] * m[1][2];
+        const T a17 = m[1][0] * m[2][1] - m[2][0] * m[1][1];
+
+        tmat4<T> result;
+        result[0][0] = +(m[1][1] * a00 - m[1][2] * a01 + m[1][3] * a02);
+        result[1][0] = -(m[1][0] * a00 - m[1][2] * a03 + m[1][3] * a04);
+        result[2][0] = +(m[1][0] * a01 - m[1][1] * a03 + m[1][3] * a05);
+        result[3][0] = -(m[1][0] * a02 - m[1][1] * a04 + m[1][2] * a05);
+
+        result[0][1] = -(m[0][1] * a00 - m[0][2] * a01 + m[0][3] * a02);
+        result[1][1] = +(m[0][0] * a00 - m[0][2] * a03 + m[0][3] * a04);
+        result[2][1] = -(m[0][0] * a01 - m[0][1] * a03 + m[0][3] * a05);
+        result[3][1] = +(m[0][0] * a02 - m[0][1] * a04 + m[0][2] * a05);
+
+        result[0][2] = +(m[0][1] * a06 - m[0][2] * a07 + m[0][3] * a08);
+        result[1][2] = -(m[0][0] * a06 - m[0][2] * a09 + m[0][3] * a10);
+        result[2][2] = +(m[0][0] * a07 - m[0][1] * a09 + m[0][3] * a11);
+        result[3][2] = -(m[0][0] * a08 - m[0][1] * a10 + m[0][2] * a11);
+
+        result[0][3] = -(m[0][1] * a12 - m[0][2] * a13 + m[0][3] * a14);
+        result[1][3] = +(m[0][0] * a12 - m[0][2] * a15 + m[0][3] * a16);
+        result[2][3] = -(m[0][0] * a13 - m[0][1] * a15 + m[0][3] * a17);
+        result[3][3] = +(m[0][0] * a14 - m[0][1] * a16 + m[0][2] * a17);
+
+        const T invDet = T(1) / (m[0][0] * result[0][0] + m[0][1] * result[1][0] + m[0][2] * result[2][0] + m[0][3] * result[3][0]);
+        for (size_t c = 0; c < 4; ++c)
+        {
+            result[c] *= invDet;
+        }
+        return result;
+    }
+
+    /// Transform a point, w is taken as one and the result is not projected.
+    template <typename T> inline tvec3<T> transform_point(const tmat4<T>& m, const tvec3<T>& p)
+    {
+        return (m * tvec4<T>(p, T(1))).xyz();
+    }
+
+    /// Transform a direction, translation is ignored.
+    template <typename T> inline tvec3<T> transform_vector(const tmat4<T>& m, const tvec3<T>& v)
+    {
+        return (m * tvec4<T>(v, T(0))).xyz();
+    }
+
     using uint = uint32_t;
     using float2 = tvec2<float>;
     using float3 = tvec3<float>;
@@ -328,7 +750,9 @@ namespace alimer
     using short3 = tvec3<int16_t>;
     using short4 = tvec4<int16_t>;
 
-    //using half2 = tvec2<half>;
+    using half2 = tvec2<half>;
+    using half3 = tvec3<half>;
+    using half4 = tvec4<half>;
     using ubyte2 = tvec2<uint8_t>;
     using ubyte3 = tvec3<uint8_t>;
     using ubyte4 = tvec4<uint8_t>;
@@ -339,6 +763,181 @@ namespace alimer
     using bool2 = tvec2<bool>;
     using bool3 = tvec3<bool>;
     using bool4 = tvec4<bool>;
+
+    // SIMD implementations for float4 and float4x4, preferred over the generic templates by overload resolution.
+    inline simd::float4v to_simd(const float4& v) { return simd::load(v.data); }
+    inline float4 from_simd(simd::float4v v)
+    {
+        float4 result;
+        simd::store(result.data, v);
+        return result;
+    }
+
+    inline float4 operator+(const float4& a, const float4& b) { return from_simd(simd::add(to_simd(a), to_simd(b))); }
+    inline float4 operator-(const float4& a, const float4& b) { return from_simd(simd::sub(to_simd(a), to_simd(b))); }
+    inline float4 operator*(const float4& a, const float4& b) { return from_simd(simd::mul(to_simd(a), to_simd(b))); }
+    inline float4 operator/(const float4& a, const float4& b) { return from_simd(simd::div(to_simd(a), to_simd(b))); }
+    inline float4 operator*(const float4& a, float b) { return from_simd(simd::mul(to_simd(a), simd::splat(b))); }
+    inline float4 operator*(float a, const float4& b) { return from_simd(simd::mul(simd::splat(a), to_simd(b))); }
+    inline float4 operator/(const float4& a, float b) { return from_simd(simd::div(to_simd(a), simd::splat(b))); }
+    inline float4& operator+=(float4& a, const float4& b) { return a = a + b; }
+    inline float4& operator-=(float4& a, const float4& b) { return a = a - b; }
+    inline float4& operator*=(float4& a, const float4& b) { return a = a * b; }
+    inline float4& operator*=(float4& a, float b) { return a = a * b; }
+    inline float4 operator-(const float4& v) { return from_simd(simd::negate(to_simd(v))); }
+    inline bool operator==(const float4& a, const float4& b) { return simd::equal(to_simd(a), to_simd(b)); }
+    inline bool operator!=(const float4& a, const float4& b) { return !simd::equal(to_simd(a), to_simd(b)); }
+
+    inline float dot(const float4& a, const float4& b) { return simd::get_x(simd::dot4(to_simd(a), to_simd(b))); }
+    inline float4 min(const float4& a, const float4& b) { return from_simd(simd::min(to_simd(a), to_simd(b))); }
+    inline float4 max(const float4& a, const float4& b) { return from_simd(simd::max(to_simd(a), to_simd(b))); }
+    inline float4 lerp(const float4& a, const float4& b, float t)
+    {
+        const simd::float4v va = to_simd(a);
+        return from_simd(simd::madd(simd::sub(to_simd(b), va), simd::splat(t), va));
+    }
+
+    inline float4 normalize(const float4& v)
+    {
+        const simd::float4v value = to_simd(v);
+        return from_simd(simd::div(value, simd::sqrt(simd::dot4(value, value))));
+    }
+
+    /// m * v, one broadcast and multiply-add per column.
+    inline simd::float4v transform(const simd::float4v columns[4], simd::float4v v)
+    {
+        simd::float4v result = simd::mul(columns[0], simd::splat_lane<0>(v));
+        result = simd::madd(columns[1], simd::splat_lane<1>(v), result);
+        result = simd::madd(columns[2], simd::splat_lane<2>(v), result);
+        return simd::madd(columns[3], simd::splat_lane<3>(v), result);
+    }
+
+    inline float4 operator*(const float4x4& m, const float4& v)
+    {
+        const simd::float4v columns[4] = { to_simd(m.columns[0]), to_simd(m.columns[1]), to_simd(m.columns[2]), to_simd(m.columns[3]) };
+        return from_simd(transform(columns, to_simd(v)));
+    }
+
+    inline float4x4 operator*(const float4x4& a, const float4x4& b)
+    {
+        float4x4 result;
+#if defined(ALIMER_SIMD_AVX)
+        // Two result columns per iteration, the columns of a are broadcast to both halves.
+        const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.columns[0].data));
+        const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.columns[1].data));
+        const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.columns[2].data));
+        const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.columns[3].data));
+        for (size_t c = 0; c < 4; c += 2)
+        {
+            const __m256 bc = _mm256_loadu_ps(b.columns[c].data);
+            __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(bc, bc, _MM_SHUFFLE(0, 0, 0, 0)));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_shuffle_ps(bc, bc, _MM_SHUFFLE(1, 1, 1, 1))));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_shuffle_ps(bc, bc, _MM_SHUFFLE(2, 2, 2, 2))));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_shuffle_ps(bc, bc, _MM_SHUFFLE(3, 3, 3, 3))));
+            _mm256_storeu_ps(result.columns[c].data, r);
+        }
+#else
+        const simd::float4v columns[4] = { to_simd(a.columns[0]), to_simd(a.columns[1]), to_simd(a.columns[2]), to_simd(a.columns[3]) };
+        for (size_t c = 0; c < 4; ++c)
+        {
+            simd::store(result.columns[c].data, transform(columns, to_simd(b.columns[c])));
+        }
+#endif
+        return result;
+    }
+
+    inline float4x4 transpose(const float4x4& m)
+    {
+        simd::float4v c0 = to_simd(m.columns[0]);
+        simd::float4v c1 = to_simd(m.columns[1]);
+        simd::float4v c2 = to_simd(m.columns[2]);
+        simd::float4v c3 = to_simd(m.columns[3]);
+        simd::transpose(c0, c1, c2, c3);
+
+        float4x4 result;
+        simd::store(result.columns[0].data, c0);
+        simd::store(result.columns[1].data, c1);
+        simd::store(result.columns[2].data, c2);
+        simd::store(result.columns[3].data, c3);
+        return result;
+    }
+
+    /// Inverse with the 2x2 block method, the result is undefined for singular matrices.
+    inline float4x4 inverse(const float4x4& m)
+    {
+        using namespace simd;
+
+        // 2x2 blocks stored as (m00, m01, m10, m11), 2x2 products of these are 2x2 matrix products.
+        struct Block
+        {
+            static ALIMER_SIMD_INLINE float4v Mul(float4v a, float4v b)
+            {
+                return add(mul(a, swizzle<0, 3, 0, 3>(b)), mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+            }
+
+            /// adjugate(a) * b
+            static ALIMER_SIMD_INLINE float4v AdjMul(float4v a, float4v b)
+            {
+                return sub(mul(swizzle<3, 3, 0, 0>(a), b), mul(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+            }
+
+            /// a * adjugate(b)
+            static ALIMER_SIMD_INLINE float4v MulAdj(float4v a, float4v b)
+            {
+                return sub(mul(a, swizzle<3, 0, 3, 0>(b)), mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+            }
+        };
+
+        const float4v c0 = to_simd(m.columns[0]);
+        const float4v c1 = to_simd(m.columns[1]);
+        const float4v c2 = to_simd(m.columns[2]);
+        const float4v c3 = to_simd(m.columns[3]);
+
+        const float4v A = shuffle<0, 1, 0, 1>(c0, c1);
+        const float4v B = shuffle<2, 3, 2, 3>(c0, c1);
+        const float4v C = shuffle<0, 1, 0, 1>(c2, c3);
+        const float4v D = shuffle<2, 3, 2, 3>(c2, c3);
+
+        // Block determinants as (|A|, |B|, |C|, |D|).
+        const float4v detSub = sub(
+            mul(shuffle<0, 2, 0, 2>(c0, c2), shuffle<1, 3, 1, 3>(c1, c3)),
+            mul(shuffle<1, 3, 1, 3>(c0, c2), shuffle<0, 2, 0, 2>(c1, c3)));
+        const float4v detA = splat_lane<0>(detSub);
+        const float4v detB = splat_lane<1>(detSub);
+        const float4v detC = splat_lane<2>(detSub);
+        const float4v detD = splat_lane<3>(detSub);
+
+        const float4v D_C = Block::AdjMul(D, C);
+        const float4v A_B = Block::AdjMul(A, B);
+        float4v X = sub(mul(detD, A), Block::Mul(B, D_C));
+        float4v W = sub(mul(detA, D), Block::Mul(C, A_B));
+        float4v Y = sub(mul(detB, C), Block::MulAdj(D, A_B));
+        float4v Z = sub(mul(detC, B), Block::MulAdj(A, D_C));
+
+        // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+        const float4v trace = horizontal_sum(mul(A_B, swizzle<0, 2, 1, 3>(D_C)));
+        const float4v detM = sub(add(mul(detA, detD), mul(detB, detC)), trace);
+        const float4v rDetM = div(set(1.0f, -1.0f, -1.0f, 1.0f), detM);
+
+        X = mul(X, rDetM);
+        Y = mul(Y, rDetM);
+        Z = mul(Z, rDetM);
+        W = mul(W, rDetM);
+
+        // Apply the adjugate and scatter the blocks back to columns in one shuffle.
+        float4x4 result;
+        store(result.columns[0].data, shuffle<3, 1, 3, 1>(X, Y));
+        store(result.columns[1].data, shuffle<2, 0, 2, 0>(X, Y));
+        store(result.columns[2].data, shuffle<3, 1, 3, 1>(Z, W));
+        store(result.columns[3].data, shuffle<2, 0, 2, 0>(Z, W));
+        return result;
+    }
+
+    /// Transform count vectors by m, input and output may be the same array.
+    ALIMER_API void transform(const float4x4& m, const float4* input, float4* output, size_t count);
+
+    /// Transform count points with w taken as one, the results are not projected.
+    ALIMER_API void transform_points(const float4x4& m, const float3* input, float3* output, size_t count);
 } 
 
 #ifdef _MSC_VER
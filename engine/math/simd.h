@@ -0,0 +1,301 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "config.h"
+#include "core/Preprocessor.h"
+#include <cmath>
+
+// Instruction set used by the math types, picked from the compiler target or the ALIMER_SIMD CMake setting.
+#if !defined(ALIMER_NO_SIMD)
+#   if defined(__AVX__) && !defined(ALIMER_SIMD_AVX)
+#       define ALIMER_SIMD_AVX
+#   endif
+#   if (defined(__SSE4_1__) || defined(ALIMER_SIMD_AVX)) && !defined(ALIMER_SIMD_SSE41)
+#       define ALIMER_SIMD_SSE41
+#   endif
+#   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(ALIMER_SIMD_SSE41)
+#       define ALIMER_SIMD_SSE2
+#   elif defined(__ARM_NEON) || defined(_M_ARM64)
+#       define ALIMER_SIMD_NEON
+#   endif
+#endif
+
+#if defined(ALIMER_SIMD_AVX)
+#   include <immintrin.h>
+#elif defined(ALIMER_SIMD_SSE41)
+#   include <smmintrin.h>
+#elif defined(ALIMER_SIMD_SSE2)
+#   include <emmintrin.h>
+#elif defined(ALIMER_SIMD_NEON)
+#   include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#   define ALIMER_SIMD_INLINE __forceinline
+#else
+#   define ALIMER_SIMD_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace alimer
+{
+    /// Thin wrappers over 4-wide float registers, every backend implements the same set of operations.
+    namespace simd
+    {
+#if defined(ALIMER_SIMD_SSE2)
+        using float4v = __m128;
+
+        ALIMER_SIMD_INLINE float4v load(const float* data) { return _mm_loadu_ps(data); }
+        ALIMER_SIMD_INLINE float4v load_aligned(const float* data) { return _mm_load_ps(data); }
+        ALIMER_SIMD_INLINE void store(float* data, float4v v) { _mm_storeu_ps(data, v); }
+        ALIMER_SIMD_INLINE void store_aligned(float* data, float4v v) { _mm_store_ps(data, v); }
+        ALIMER_SIMD_INLINE float4v set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+        ALIMER_SIMD_INLINE float4v splat(float value) { return _mm_set1_ps(value); }
+        ALIMER_SIMD_INLINE float4v zero() { return _mm_setzero_ps(); }
+        ALIMER_SIMD_INLINE float get_x(float4v v) { return _mm_cvtss_f32(v); }
+
+        ALIMER_SIMD_INLINE float4v add(float4v a, float4v b) { return _mm_add_ps(a, b); }
+        ALIMER_SIMD_INLINE float4v sub(float4v a, float4v b) { return _mm_sub_ps(a, b); }
+        ALIMER_SIMD_INLINE float4v mul(float4v a, float4v b) { return _mm_mul_ps(a, b); }
+        ALIMER_SIMD_INLINE float4v div(float4v a, float4v b) { return _mm_div_ps(a, b); }
+        ALIMER_SIMD_INLINE float4v min(float4v a, float4v b) { return _mm_min_ps(a, b); }
+        ALIMER_SIMD_INLINE float4v max(float4v a, float4v b) { return _mm_max_ps(a, b); }
+        ALIMER_SIMD_INLINE float4v sqrt(float4v v) { return _mm_sqrt_ps(v); }
+        ALIMER_SIMD_INLINE float4v negate(float4v v) { return _mm_xor_ps(v, _mm_set1_ps(-0.0f)); }
+        ALIMER_SIMD_INLINE float4v abs(float4v v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+
+        /// a * b + c, fused when FMA is available.
+        ALIMER_SIMD_INLINE float4v madd(float4v a, float4v b, float4v c)
+        {
+#if defined(__FMA__)
+            return _mm_fmadd_ps(a, b, c);
+#else
+            return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+        }
+
+        /// Return true if all lanes are equal.
+        ALIMER_SIMD_INLINE bool equal(float4v a, float4v b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)) == 0xf; }
+
+        /// Lanes (a[X], a[Y], a[Z], a[W]).
+        template <int X, int Y, int Z, int W>
+        ALIMER_SIMD_INLINE float4v swizzle(float4v a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(W, Z, Y, X)); }
+
+        /// Lanes (a[X], a[Y], b[Z], b[W]).
+        template <int X, int Y, int Z, int W>
+        ALIMER_SIMD_INLINE float4v shuffle(float4v a, float4v b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X)); }
+
+        /// Dot product of all four lanes, splatted to every lane.
+        ALIMER_SIMD_INLINE float4v dot4(float4v a, float4v b)
+        {
+#if defined(ALIMER_SIMD_SSE41)
+            return _mm_dp_ps(a, b, 0xff);
+#else
+            float4v m = _mm_mul_ps(a, b);
+            m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+#endif
+        }
+
+        /// Dot product of the first three lanes, splatted to every lane.
+        ALIMER_SIMD_INLINE float4v dot3(float4v a, float4v b)
+        {
+#if defined(ALIMER_SIMD_SSE41)
+            return _mm_dp_ps(a, b, 0x7f);
+#else
+            const float4v m = _mm_mul_ps(a, b);
+            const float4v yz = _mm_add_ss(_mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2)));
+            const float4v sum = _mm_add_ss(m, yz);
+            return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+#endif
+        }
+
+        ALIMER_SIMD_INLINE void transpose(float4v& r0, float4v& r1, float4v& r2, float4v& r3)
+        {
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        }
+
+#elif defined(ALIMER_SIMD_NEON)
+        using float4v = float32x4_t;
+
+        ALIMER_SIMD_INLINE float4v load(const float* data) { return vld1q_f32(data); }
+        ALIMER_SIMD_INLINE float4v load_aligned(const float* data) { return vld1q_f32(data); }
+        ALIMER_SIMD_INLINE void store(float* data, float4v v) { vst1q_f32(data, v); }
+        ALIMER_SIMD_INLINE void store_aligned(float* data, float4v v) { vst1q_f32(data, v); }
+        ALIMER_SIMD_INLINE float4v set(float x, float y, float z, float w) { const float data[4] = { x, y, z, w }; return vld1q_f32(data); }
+        ALIMER_SIMD_INLINE float4v splat(float value) { return vdupq_n_f32(value); }
+        ALIMER_SIMD_INLINE float4v zero() { return vdupq_n_f32(0.0f); }
+        ALIMER_SIMD_INLINE float get_x(float4v v) { return vgetq_lane_f32(v, 0); }
+
+        ALIMER_SIMD_INLINE float4v add(float4v a, float4v b) { return vaddq_f32(a, b); }
+        ALIMER_SIMD_INLINE float4v sub(float4v a, float4v b) { return vsubq_f32(a, b); }
+        ALIMER_SIMD_INLINE float4v mul(float4v a, float4v b) { return vmulq_f32(a, b); }
+        ALIMER_SIMD_INLINE float4v min(float4v a, float4v b) { return vminq_f32(a, b); }
+        ALIMER_SIMD_INLINE float4v max(float4v a, float4v b) { return vmaxq_f32(a, b); }
+        ALIMER_SIMD_INLINE float4v negate(float4v v) { return vnegq_f32(v); }
+        ALIMER_SIMD_INLINE float4v abs(float4v v) { return vabsq_f32(v); }
+        ALIMER_SIMD_INLINE float4v madd(float4v a, float4v b, float4v c) { return vmlaq_f32(c, a, b); }
+        ALIMER_SIMD_INLINE bool equal(float4v a, float4v b)
+        {
+            const uint32x4_t mask = vceqq_f32(a, b);
+            const uint32x2_t half = vand_u32(vget_low_u32(mask), vget_high_u32(mask));
+            return (vget_lane_u32(half, 0) & vget_lane_u32(half, 1)) == 0xffffffffu;
+        }
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+        ALIMER_SIMD_INLINE float4v div(float4v a, float4v b) { return vdivq_f32(a, b); }
+        ALIMER_SIMD_INLINE float4v sqrt(float4v v) { return vsqrtq_f32(v); }
+#else
+        /// ARMv7 has no vector divide, refine the reciprocal estimate twice.
+        ALIMER_SIMD_INLINE float4v div(float4v a, float4v b)
+        {
+            float4v r = vrecpeq_f32(b);
+            r = vmulq_f32(vrecpsq_f32(b, r), r);
+            r = vmulq_f32(vrecpsq_f32(b, r), r);
+            return vmulq_f32(a, r);
+        }
+
+        ALIMER_SIMD_INLINE float4v sqrt(float4v v)
+        {
+            float4v r = vrsqrteq_f32(v);
+            r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+            r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+            // Zero times infinity is NaN, keep zero lanes at zero.
+            const uint32x4_t isZero = vceqq_f32(v, vdupq_n_f32(0.0f));
+            return vbslq_f32(isZero, v, vmulq_f32(v, r));
+        }
+#endif
+
+        template <int X, int Y, int Z, int W>
+        ALIMER_SIMD_INLINE float4v swizzle(float4v a)
+        {
+#if defined(__clang__)
+            return __builtin_shufflevector(a, a, X, Y, Z, W);
+#else
+            const float data[4] = { vgetq_lane_f32(a, X), vgetq_lane_f32(a, Y), vgetq_lane_f32(a, Z), vgetq_lane_f32(a, W) };
+            return vld1q_f32(data);
+#endif
+        }
+
+        template <int X, int Y, int Z, int W>
+        ALIMER_SIMD_INLINE float4v shuffle(float4v a, float4v b)
+        {
+#if defined(__clang__)
+            return __builtin_shufflevector(a, b, X, Y, Z + 4, W + 4);
+#else
+            const float data[4] = { vgetq_lane_f32(a, X), vgetq_lane_f32(a, Y), vgetq_lane_f32(b, Z), vgetq_lane_f32(b, W) };
+            return vld1q_f32(data);
+#endif
+        }
+
+        ALIMER_SIMD_INLINE float4v dot4(float4v a, float4v b)
+        {
+            const float32x4_t m = vmulq_f32(a, b);
+            const float32x2_t sum = vadd_f32(vget_low_f32(m), vget_high_f32(m));
+            return vdupq_lane_f32(vpadd_f32(sum, sum), 0);
+        }
+
+        ALIMER_SIMD_INLINE float4v dot3(float4v a, float4v b)
+        {
+            return dot4(vsetq_lane_f32(0.0f, a, 3), b);
+        }
+
+        ALIMER_SIMD_INLINE void transpose(float4v& r0, float4v& r1, float4v& r2, float4v& r3)
+        {
+            const float32x4x2_t t01 = vtrnq_f32(r0, r1);
+            const float32x4x2_t t23 = vtrnq_f32(r2, r3);
+            r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+            r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+            r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+            r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+        }
+
+#else
+        /// Scalar fallback with the same interface.
+        struct float4v
+        {
+            float v[4];
+        };
+
+        ALIMER_SIMD_INLINE float4v load(const float* data) { return { { data[0], data[1], data[2], data[3] } }; }
+        ALIMER_SIMD_INLINE float4v load_aligned(const float* data) { return load(data); }
+        ALIMER_SIMD_INLINE void store(float* data, float4v a) { data[0] = a.v[0]; data[1] = a.v[1]; data[2] = a.v[2]; data[3] = a.v[3]; }
+        ALIMER_SIMD_INLINE void store_aligned(float* data, float4v a) { store(data, a); }
+        ALIMER_SIMD_INLINE float4v set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+        ALIMER_SIMD_INLINE float4v splat(float value) { return { { value, value, value, value } }; }
+        ALIMER_SIMD_INLINE float4v zero() { return splat(0.0f); }
+        ALIMER_SIMD_INLINE float get_x(float4v a) { return a.v[0]; }
+
+#define ALIMER_SIMD_SCALAR_OP(name, expression) \
+        ALIMER_SIMD_INLINE float4v name(float4v a, float4v b) \
+        { \
+            float4v r; \
+            for (int i = 0; i < 4; ++i) { const float x = a.v[i]; const float y = b.v[i]; r.v[i] = (expression); } \
+            return r; \
+        }
+
+        ALIMER_SIMD_SCALAR_OP(add, x + y)
+        ALIMER_SIMD_SCALAR_OP(sub, x - y)
+        ALIMER_SIMD_SCALAR_OP(mul, x * y)
+        ALIMER_SIMD_SCALAR_OP(div, x / y)
+        ALIMER_SIMD_SCALAR_OP(min, y < x ? y : x)
+        ALIMER_SIMD_SCALAR_OP(max, x < y ? y : x)
+#undef ALIMER_SIMD_SCALAR_OP
+
+        ALIMER_SIMD_INLINE float4v sqrt(float4v a) { return { { std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3]) } }; }
+        ALIMER_SIMD_INLINE float4v negate(float4v a) { return { { -a.v[0], -a.v[1], -a.v[2], -a.v[3] } }; }
+        ALIMER_SIMD_INLINE float4v abs(float4v a) { return { { std::fabs(a.v[0]), std::fabs(a.v[1]), std::fabs(a.v[2]), std::fabs(a.v[3]) } }; }
+        ALIMER_SIMD_INLINE float4v madd(float4v a, float4v b, float4v c) { return add(mul(a, b), c); }
+        ALIMER_SIMD_INLINE bool equal(float4v a, float4v b) { return a.v[0] == b.v[0] && a.v[1] == b.v[1] && a.v[2] == b.v[2] && a.v[3] == b.v[3]; }
+
+        template <int X, int Y, int Z, int W>
+        ALIMER_SIMD_INLINE float4v swizzle(float4v a) { return { { a.v[X], a.v[Y], a.v[Z], a.v[W] } }; }
+
+        template <int X, int Y, int Z, int W>
+        ALIMER_SIMD_INLINE float4v shuffle(float4v a, float4v b) { return { { a.v[X], a.v[Y], b.v[Z], b.v[W] } }; }
+
+        ALIMER_SIMD_INLINE float4v dot4(float4v a, float4v b) { return splat(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3]); }
+        ALIMER_SIMD_INLINE float4v dot3(float4v a, float4v b) { return splat(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]); }
+
+        ALIMER_SIMD_INLINE void transpose(float4v& r0, float4v& r1, float4v& r2, float4v& r3)
+        {
+            const float4v t0 = r0, t1 = r1, t2 = r2, t3 = r3;
+            r0 = { { t0.v[0], t1.v[0], t2.v[0], t3.v[0] } };
+            r1 = { { t0.v[1], t1.v[1], t2.v[1], t3.v[1] } };
+            r2 = { { t0.v[2], t1.v[2], t2.v[2], t3.v[2] } };
+            r3 = { { t0.v[3], t1.v[3], t2.v[3], t3.v[3] } };
+        }
+#endif
+
+        /// Splat a single lane to every lane.
+        template <int Lane>
+        ALIMER_SIMD_INLINE float4v splat_lane(float4v a) { return swizzle<Lane, Lane, Lane, Lane>(a); }
+
+        /// Sum of all four lanes, splatted to every lane.
+        ALIMER_SIMD_INLINE float4v horizontal_sum(float4v a)
+        {
+            a = add(a, swizzle<1, 0, 3, 2>(a));
+            return add(a, swizzle<2, 3, 0, 1>(a));
+        }
+    }
+}
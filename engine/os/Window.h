@@ -25,6 +25,7 @@
 #include "core/Utils.h"
 #include "math/math.h"
 #include "math/size.h"
+#include <limits>
 #include <string>
 
 #if ALIMER_WINDOWS
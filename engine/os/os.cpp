@@ -21,8 +21,8 @@
 //
 
 #include "os.h"
-#include <cstring>
-#include <deque>
+#include "core/Stopwatch.h"
+#include <atomic>
 
 #if defined(GLFW_BACKEND)
 #include "glfw/os_glfw.h"
@@ -36,41 +36,122 @@ namespace alimer
     {
         namespace
         {
-            auto get_event_queue() noexcept -> std::deque<Event>&
+            /// Bounded lock-free ring of pending events, any thread pushes and the main thread pops.
+            /// Each cell carries a sequence number telling producers and the consumer whose turn it is.
+            class EventQueue
             {
-                static std::deque<Event> eventQueue;
-                return eventQueue;
-            }
+            public:
+                static constexpr size_t kCapacity = 1024;
+                static constexpr size_t kMask = kCapacity - 1;
 
-            bool popEvent(Event& e) noexcept
-            {
-                auto& event_queue = get_event_queue();
-                // Pop the first event of the queue, if it is not empty
-                if (!event_queue.empty())
+                EventQueue()
+                {
+                    for (size_t i = 0; i < kCapacity; ++i)
+                    {
+                        cells[i].sequence.store(i, std::memory_order_relaxed);
+                    }
+                }
+
+                bool Push(const Event& e)
+                {
+                    Cell* cell;
+                    size_t position = enqueuePosition.load(std::memory_order_relaxed);
+                    for (;;)
+                    {
+                        cell = &cells[position & kMask];
+                        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                        const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                        if (difference == 0)
+                        {
+                            // The cell is free, claim it unless another producer got there first.
+                            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                                break;
+                        }
+                        else if (difference < 0)
+                        {
+                            // The consumer has not released this cell yet, the queue is full.
+                            return false;
+                        }
+                        else
+                        {
+                            position = enqueuePosition.load(std::memory_order_relaxed);
+                        }
+                    }
+
+                    cell->event = e;
+                    cell->sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+
+                bool Pop(Event& e)
                 {
-                    e = event_queue.front();
-                    event_queue.pop_front();
+                    Cell& cell = cells[dequeuePosition & kMask];
+                    if (cell.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+                        return false;
+
+                    e = cell.event;
+                    cell.sequence.store(dequeuePosition + kCapacity, std::memory_order_release);
+                    ++dequeuePosition;
                     return true;
                 }
-                return false;
+
+            private:
+                struct Cell
+                {
+                    std::atomic<size_t> sequence;
+                    Event event{};
+                };
+
+                Cell cells[kCapacity];
+                /// Producers and the consumer write on separate cache lines.
+                alignas(64) std::atomic<size_t> enqueuePosition{ 0 };
+                alignas(64) size_t dequeuePosition = 0;
+            };
+
+            auto get_event_queue() noexcept -> EventQueue&
+            {
+                static EventQueue eventQueue;
+                return eventQueue;
             }
         }
 
-        void push_event(const Event& e)
+        bool push_event(const Event& e)
         {
-            get_event_queue().emplace_back(e);
+            if (e.timestamp != 0)
+                return get_event_queue().Push(e);
+
+            Event stamped = e;
+            stamped.timestamp = Stopwatch::GetTimestamp();
+            return get_event_queue().Push(stamped);
         }
 
-        void push_event(Event&& e)
+        bool push_event(Event&& e)
         {
-            get_event_queue().emplace_back(std::move(e));
+            if (e.timestamp == 0)
+                e.timestamp = Stopwatch::GetTimestamp();
+
+            return get_event_queue().Push(e);
         }
 
         auto poll_event(Event& e) noexcept -> bool
         {
             pump_events();
 
-            return popEvent(e);
+            return get_event_queue().Pop(e);
+        }
+
+        auto poll_events(Event* events, size_t maxCount) noexcept -> size_t
+        {
+            pump_events();
+
+            EventQueue& queue = get_event_queue();
+            size_t count = 0;
+            while (count < maxCount && queue.Pop(events[count]))
+            {
+                count++;
+            }
+
+            return count;
         }
     } // namespace os
 } // namespace alimer
@@ -75,11 +75,16 @@ namespace alimer
             };
 
             Type type;
+            /// Stopwatch timestamp of when the event happened, filled in by push_event when left at zero.
+            uint64_t timestamp{};
         };
 
-        void push_event(Event&& e);
-        void push_event(const Event& e);
+        /// Queue an event, safe to call from any thread. Returns false and drops the event when the queue is full.
+        bool push_event(Event&& e);
+        bool push_event(const Event& e);
         auto poll_event(Event& e) noexcept -> bool;
+        /// Pump the platform once and move up to maxCount pending events into events, returns how many were written.
+        auto poll_events(Event* events, size_t maxCount) noexcept -> size_t;
 
         std::string get_clipboard_text() noexcept;
         void set_clipboard_text(const std::string& text);
@@ -0,0 +1,247 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Benchmark.h"
+#include "core/JobSystem.h"
+#include "core/Stopwatch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+namespace alimer
+{
+    namespace benchmark
+    {
+        /// Minimum measured time for a benchmark run, in seconds.
+        static constexpr double kMinTime = 0.1;
+
+        std::vector<BenchmarkInfo>& GetBenchmarks()
+        {
+            static std::vector<BenchmarkInfo> benchmarks;
+            return benchmarks;
+        }
+
+        int Register(const char* name, BenchmarkFunction function, std::vector<int64_t> args)
+        {
+            GetBenchmarks().push_back({ name, function, std::move(args) });
+            return 0;
+        }
+
+        void CheckFailed(const char* condition, const char* file, int line)
+        {
+            fprintf(stderr, "%s(%d): check failed: %s\n", file, line, condition);
+            fflush(stdout);
+            abort();
+        }
+
+        static double Measure(BenchmarkFunction function, State& state)
+        {
+            const uint64_t start = Stopwatch::GetTimestamp();
+            function(state);
+            const uint64_t end = Stopwatch::GetTimestamp();
+            return double(end - start) / double(Stopwatch::GetFrequency());
+        }
+
+        struct Result
+        {
+            std::string name;
+            uint64_t iterations;
+            double seconds;
+            uint64_t itemsProcessed;
+            uint64_t bytesProcessed;
+        };
+
+        static Result Run(const BenchmarkInfo& info, int64_t arg, bool hasArg)
+        {
+            State state;
+            state.arg = arg;
+
+            // A run without iterations keeps one time setup, such as cached fixtures, out of the measurement.
+            state.iterations = 0;
+            info.function(state);
+            state.iterations = 1;
+
+            // Grow the iteration count until the run is long enough to be measured reliably.
+            double seconds = 0.0;
+            for (;;)
+            {
+                state.itemsProcessed = 0;
+                state.bytesProcessed = 0;
+                seconds = Measure(info.function, state);
+                if (seconds >= kMinTime || state.iterations >= (1ull << 40))
+                    break;
+
+                double scale = seconds > 0.0 ? (kMinTime * 1.4) / seconds : 10.0;
+                if (scale > 10.0)
+                    scale = 10.0;
+                if (scale < 2.0)
+                    scale = 2.0;
+                state.iterations = static_cast<uint64_t>(double(state.iterations) * scale);
+            }
+
+            char name[256];
+            if (hasArg)
+            {
+                snprintf(name, sizeof(name), "%s/%lld", info.name.c_str(), static_cast<long long>(arg));
+            }
+            else
+            {
+                snprintf(name, sizeof(name), "%s", info.name.c_str());
+            }
+
+            printf("%-48s %14.2f ns %14llu", name,
+                seconds * 1e9 / double(state.iterations),
+                static_cast<unsigned long long>(state.iterations));
+
+            if (state.itemsProcessed)
+            {
+                printf(" %12.3f M items/s", double(state.itemsProcessed) / seconds * 1e-6);
+            }
+
+            if (state.bytesProcessed)
+            {
+                printf(" %12.3f MB/s", double(state.bytesProcessed) / seconds / (1024.0 * 1024.0));
+            }
+
+            printf("\n");
+            return { name, state.iterations, seconds, state.itemsProcessed, state.bytesProcessed };
+        }
+
+        static void WriteJsonString(FILE* file, const std::string& value)
+        {
+            fputc('"', file);
+            for (char c : value)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    fputc('\\', file);
+                }
+                fputc(c, file);
+            }
+            fputc('"', file);
+        }
+
+        /// Write results in the Google Benchmark JSON layout so existing compare scripts can diff runs.
+        static bool WriteJson(const char* fileName, const std::vector<Result>& results)
+        {
+            FILE* file = fopen(fileName, "w");
+            if (file == nullptr)
+            {
+                fprintf(stderr, "Failed to open '%s'\n", fileName);
+                return false;
+            }
+
+            char date[64] = {};
+            const time_t now = time(nullptr);
+            strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+            fprintf(file, "{\n  \"context\": {\n    \"date\": \"%s\",\n    \"num_cpus\": %u,\n    \"library_build_type\": \"%s\"\n  },\n",
+                date, std::thread::hardware_concurrency(),
+#if defined(NDEBUG)
+                "release"
+#else
+                "debug"
+#endif
+            );
+
+            fputs("  \"benchmarks\": [", file);
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                const Result& result = results[i];
+                const double nanoseconds = result.seconds * 1e9 / double(result.iterations);
+                fputs(i > 0 ? ",\n    {\"name\": " : "\n    {\"name\": ", file);
+                WriteJsonString(file, result.name);
+                fprintf(file, ", \"iterations\": %llu, \"real_time\": %.4f, \"cpu_time\": %.4f, \"time_unit\": \"ns\"",
+                    static_cast<unsigned long long>(result.iterations), nanoseconds, nanoseconds);
+
+                if (result.itemsProcessed)
+                {
+                    fprintf(file, ", \"items_per_second\": %.4f", double(result.itemsProcessed) / result.seconds);
+                }
+
+                if (result.bytesProcessed)
+                {
+                    fprintf(file, ", \"bytes_per_second\": %.4f", double(result.bytesProcessed) / result.seconds);
+                }
+
+                fputc('}', file);
+            }
+            fputs("\n  ]\n}\n", file);
+
+            fclose(file);
+            return true;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace alimer;
+
+    // alimer_bench [filter] [--json <file>]
+    const char* filter = nullptr;
+    const char* jsonFile = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonFile = argv[++i];
+        }
+        else
+        {
+            filter = argv[i];
+        }
+    }
+
+    JobSystem::Initialize();
+
+    std::vector<benchmark::Result> results;
+    printf("%-48s %17s %14s\n", "Benchmark", "Time", "Iterations");
+    for (const benchmark::BenchmarkInfo& info : benchmark::GetBenchmarks())
+    {
+        if (filter != nullptr && strstr(info.name.c_str(), filter) == nullptr)
+            continue;
+
+        if (info.args.empty())
+        {
+            results.push_back(benchmark::Run(info, 0, false));
+        }
+        else
+        {
+            for (int64_t arg : info.args)
+            {
+                results.push_back(benchmark::Run(info, arg, true));
+            }
+        }
+    }
+
+    JobSystem::Shutdown();
+
+    if (jsonFile != nullptr && !benchmark::WriteJson(jsonFile, results))
+    {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "core/Preprocessor.h"
+#include <string>
+#include <vector>
+
+namespace alimer
+{
+    namespace benchmark
+    {
+        /// State passed to a benchmark function, run the measured code state.iterations times.
+        class State final
+        {
+        public:
+            /// Number of iterations to run.
+            uint64_t iterations = 1;
+            /// Argument the benchmark was registered with.
+            int64_t arg = 0;
+            /// Items processed by all iterations, used to report throughput.
+            uint64_t itemsProcessed = 0;
+            /// Bytes processed by all iterations, used to report bandwidth.
+            uint64_t bytesProcessed = 0;
+        };
+
+        using BenchmarkFunction = void(*)(State& state);
+
+        struct BenchmarkInfo
+        {
+            std::string name;
+            BenchmarkFunction function;
+            std::vector<int64_t> args;
+        };
+
+        /// Register a benchmark, run once per argument.
+        int Register(const char* name, BenchmarkFunction function, std::vector<int64_t> args = {});
+
+        /// Return all registered benchmarks.
+        std::vector<BenchmarkInfo>& GetBenchmarks();
+
+        /// Report a failed ALIMER_BENCHMARK_CHECK and abort the run.
+        [[noreturn]] void CheckFailed(const char* condition, const char* file, int line);
+
+        /// Keep the compiler from optimizing away a value.
+        template <typename T>
+        inline void DoNotOptimize(const T& value)
+        {
+#if defined(_MSC_VER)
+            static volatile char sink;
+            sink = *reinterpret_cast<const volatile char*>(&value);
+#else
+            asm volatile("" : : "r,m"(value) : "memory");
+#endif
+        }
+    }
+}
+
+#define ALIMER_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define ALIMER_BENCHMARK_CONCAT(a, b) ALIMER_BENCHMARK_CONCAT_IMPL(a, b)
+
+/// Abort when a benchmark computed a wrong result, unlike ALIMER_ASSERT this is checked in release builds too.
+#define ALIMER_BENCHMARK_CHECK(condition) \
+    do { if (!(condition)) { alimer::benchmark::CheckFailed(#condition, __FILE__, __LINE__); } } while (0)
+
+/// Register a benchmark function, optional arguments run it once per value.
+#define ALIMER_BENCHMARK(function, ...) \
+    static int ALIMER_BENCHMARK_CONCAT(s_benchmark_, __LINE__) = alimer::benchmark::Register(#function, function, { __VA_ARGS__ })
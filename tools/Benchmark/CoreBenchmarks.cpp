@@ -0,0 +1,408 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Benchmark.h"
+#include "core/FrameAllocator.h"
+#include "core/HandlePool.h"
+#include "core/Hash.h"
+#include "core/StringId.h"
+#include "core/Object.h"
+#include "core/Stopwatch.h"
+#include <string>
+#include <vector>
+
+namespace alimer
+{
+    namespace
+    {
+        class BenchObject0 : public Object { ALIMER_OBJECT(BenchObject0, Object); };
+        class BenchObject1 : public BenchObject0 { ALIMER_OBJECT(BenchObject1, BenchObject0); };
+        class BenchObject2 : public BenchObject1 { ALIMER_OBJECT(BenchObject2, BenchObject1); };
+        class BenchObject3 : public BenchObject2 { ALIMER_OBJECT(BenchObject3, BenchObject2); };
+        class BenchObject4 : public BenchObject3 { ALIMER_OBJECT(BenchObject4, BenchObject3); };
+        class BenchObject5 : public BenchObject4 { ALIMER_OBJECT(BenchObject5, BenchObject4); };
+        class BenchObject6 : public BenchObject5 { ALIMER_OBJECT(BenchObject6, BenchObject5); };
+        class BenchObject7 : public BenchObject6 { ALIMER_OBJECT(BenchObject7, BenchObject6); };
+        class BenchUnrelated : public Object { ALIMER_OBJECT(BenchUnrelated, Object); };
+
+#define BENCH_DEEP_OBJECT(index, baseIndex) \
+        class BenchDeep##index : public BenchDeep##baseIndex { ALIMER_OBJECT(BenchDeep##index, BenchDeep##baseIndex); }
+
+        class BenchDeep0 : public Object { ALIMER_OBJECT(BenchDeep0, Object); };
+        BENCH_DEEP_OBJECT(1, 0); BENCH_DEEP_OBJECT(2, 1); BENCH_DEEP_OBJECT(3, 2); BENCH_DEEP_OBJECT(4, 3);
+        BENCH_DEEP_OBJECT(5, 4); BENCH_DEEP_OBJECT(6, 5); BENCH_DEEP_OBJECT(7, 6); BENCH_DEEP_OBJECT(8, 7);
+        BENCH_DEEP_OBJECT(9, 8); BENCH_DEEP_OBJECT(10, 9); BENCH_DEEP_OBJECT(11, 10); BENCH_DEEP_OBJECT(12, 11);
+        BENCH_DEEP_OBJECT(13, 12); BENCH_DEEP_OBJECT(14, 13); BENCH_DEEP_OBJECT(15, 14); BENCH_DEEP_OBJECT(16, 15);
+        BENCH_DEEP_OBJECT(17, 16); BENCH_DEEP_OBJECT(18, 17); BENCH_DEEP_OBJECT(19, 18); BENCH_DEEP_OBJECT(20, 19);
+        BENCH_DEEP_OBJECT(21, 20); BENCH_DEEP_OBJECT(22, 21); BENCH_DEEP_OBJECT(23, 22); BENCH_DEEP_OBJECT(24, 23);
+        BENCH_DEEP_OBJECT(25, 24); BENCH_DEEP_OBJECT(26, 25); BENCH_DEEP_OBJECT(27, 26); BENCH_DEEP_OBJECT(28, 27);
+        BENCH_DEEP_OBJECT(29, 28); BENCH_DEEP_OBJECT(30, 29); BENCH_DEEP_OBJECT(31, 30);
+
+#undef BENCH_DEEP_OBJECT
+
+        std::vector<uint8_t> MakeKey(int64_t size)
+        {
+            std::vector<uint8_t> key(static_cast<size_t>(size));
+            for (size_t i = 0; i < key.size(); ++i)
+            {
+                key[i] = static_cast<uint8_t>(i * 31u + 7u);
+            }
+            return key;
+        }
+
+        /// Hash a key of the argument size in bytes.
+        void Hash_Murmur32(benchmark::State& state)
+        {
+            const std::vector<uint8_t> key = MakeKey(state.arg);
+            uint32_t seed = 0;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                seed = murmur32(key.data(), static_cast<uint32_t>(key.size()), seed);
+            }
+
+            benchmark::DoNotOptimize(seed);
+            state.bytesProcessed = state.iterations * key.size();
+        }
+
+        void Hash_Murmur64(benchmark::State& state)
+        {
+            const std::vector<uint8_t> key = MakeKey(state.arg);
+            uint64_t seed = 0;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                seed = murmur64(key.data(), key.size(), seed);
+            }
+
+            benchmark::DoNotOptimize(seed);
+            state.bytesProcessed = state.iterations * key.size();
+        }
+
+        void Hash_Hash64(benchmark::State& state)
+        {
+            const std::vector<uint8_t> key = MakeKey(state.arg);
+            uint64_t seed = 0;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                seed = hash64(key.data(), key.size(), seed);
+            }
+
+            benchmark::DoNotOptimize(seed);
+            state.bytesProcessed = state.iterations * key.size();
+        }
+
+        void Hash_Hash128(benchmark::State& state)
+        {
+            const std::vector<uint8_t> key = MakeKey(state.arg);
+            Hash128 hash = {};
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                hash = hash128(key.data(), key.size(), hash.low);
+            }
+
+            benchmark::DoNotOptimize(hash);
+            state.bytesProcessed = state.iterations * key.size();
+        }
+
+        /// Feed the key in 4 KB pieces, as when hashing a file while it streams in.
+        void Hash_HasherStream(benchmark::State& state)
+        {
+            const std::vector<uint8_t> key = MakeKey(state.arg);
+            const size_t pieceSize = 4096;
+            Hasher hasher;
+            uint64_t seed = 0;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                hasher.Reset(seed);
+                for (size_t offset = 0; offset < key.size(); offset += pieceSize)
+                {
+                    hasher.Update(key.data() + offset, key.size() - offset < pieceSize ? key.size() - offset : pieceSize);
+                }
+                seed = hasher.Final64();
+            }
+
+            benchmark::DoNotOptimize(seed);
+            state.bytesProcessed = state.iterations * key.size();
+        }
+
+        /// Typical identifier lengths used for resource and type names.
+        const char* kShortName = "Position";
+        const char* kLongName = "Textures/Environment/SkyboxCubemap_Diffuse";
+
+        void StringId32_FromCString(benchmark::State& state)
+        {
+            const char* name = state.arg == 0 ? kShortName : kLongName;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                StringId32 id(name);
+                benchmark::DoNotOptimize(id);
+            }
+        }
+
+        void StringId32_FromString(benchmark::State& state)
+        {
+            const std::string name = state.arg == 0 ? kShortName : kLongName;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                StringId32 id(name);
+                benchmark::DoNotOptimize(id);
+            }
+        }
+
+        void StringId64_FromCString(benchmark::State& state)
+        {
+            const char* name = state.arg == 0 ? kShortName : kLongName;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                StringId64 id(name);
+                benchmark::DoNotOptimize(id);
+            }
+        }
+
+        void StringId64_FromString(benchmark::State& state)
+        {
+            const std::string name = state.arg == 0 ? kShortName : kLongName;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                StringId64 id(name);
+                benchmark::DoNotOptimize(id);
+            }
+        }
+
+        /// Copy and destroy, one AddRef and Release pair.
+        void RefPtr_Copy(benchmark::State& state)
+        {
+            RefPtr<BenchObject0> object(new BenchObject0());
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                RefPtr<BenchObject0> copy(object);
+                benchmark::DoNotOptimize(copy);
+            }
+        }
+
+        void RefPtr_Move(benchmark::State& state)
+        {
+            RefPtr<BenchObject0> object(new BenchObject0());
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                RefPtr<BenchObject0> moved(std::move(object));
+                benchmark::DoNotOptimize(moved);
+                object = std::move(moved);
+            }
+        }
+
+        /// Allocate an object and release the last reference.
+        void RefPtr_CreateRelease(benchmark::State& state)
+        {
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                RefPtr<BenchObject0> object(new BenchObject0());
+                benchmark::DoNotOptimize(object);
+            }
+        }
+
+        /// The argument is how many levels up the queried base class is, 8 tests an unrelated type.
+        void TypeInfo_IsTypeOf(benchmark::State& state)
+        {
+            const TypeInfo* bases[] = {
+                BenchObject7::GetTypeInfoStatic(), BenchObject6::GetTypeInfoStatic(), BenchObject5::GetTypeInfoStatic(),
+                BenchObject4::GetTypeInfoStatic(), BenchObject3::GetTypeInfoStatic(), BenchObject2::GetTypeInfoStatic(),
+                BenchObject1::GetTypeInfoStatic(), BenchObject0::GetTypeInfoStatic(), BenchUnrelated::GetTypeInfoStatic()
+            };
+
+            const TypeInfo* typeInfo = BenchObject7::GetTypeInfoStatic();
+            const TypeInfo* base = bases[state.arg];
+            bool result = false;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                benchmark::DoNotOptimize(typeInfo);
+                result = typeInfo->IsTypeOf(base);
+                benchmark::DoNotOptimize(result);
+            }
+        }
+
+        /// 32 level hierarchy, the argument is how many levels up from the leaf the queried class is, 32 tests an unrelated type.
+        void TypeInfo_IsTypeOfDeep(benchmark::State& state)
+        {
+            const TypeInfo* typeInfo = BenchDeep31::GetTypeInfoStatic();
+            const TypeInfo* base = typeInfo;
+            for (int64_t level = 0; level < state.arg && base != nullptr; ++level)
+            {
+                base = base->GetBaseTypeInfo();
+            }
+            if (state.arg >= 32)
+            {
+                base = BenchUnrelated::GetTypeInfoStatic();
+            }
+
+            bool result = false;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                benchmark::DoNotOptimize(typeInfo);
+                result = typeInfo->IsTypeOf(base);
+                benchmark::DoNotOptimize(result);
+            }
+        }
+
+        /// Cast the leaf of the 32 level hierarchy to its root class.
+        void Object_CastDeep(benchmark::State& state)
+        {
+            RefPtr<Object> object(new BenchDeep31());
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                BenchDeep0* cast = object->Cast<BenchDeep0>();
+                benchmark::DoNotOptimize(cast);
+            }
+        }
+
+        void Object_CastHit(benchmark::State& state)
+        {
+            RefPtr<Object> object(new BenchObject7());
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                BenchObject0* cast = object->Cast<BenchObject0>();
+                benchmark::DoNotOptimize(cast);
+            }
+        }
+
+        void Object_CastMiss(benchmark::State& state)
+        {
+            RefPtr<Object> object(new BenchObject7());
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                BenchUnrelated* cast = object->Cast<BenchUnrelated>();
+                benchmark::DoNotOptimize(cast);
+            }
+        }
+
+        /// Virtual type query, the hash is a compile time constant.
+        void Object_GetType(benchmark::State& state)
+        {
+            RefPtr<Object> object(new BenchObject7());
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                StringId32 type = object->GetType();
+                benchmark::DoNotOptimize(type);
+            }
+        }
+
+        /// One frame of mixed size and alignment allocations. Every pointer must be aligned,
+        /// and once the buffers have grown no allocation may fall back to the heap.
+        void FrameAllocator_Frame(benchmark::State& state)
+        {
+            constexpr uint32_t kAllocationCount = 256;
+            constexpr uint64_t kWarmupFrames = 2 * FrameAllocator::kMaxBufferCount;
+
+            // Start small so the first frames overflow to the heap and the buffers grow.
+            FrameAllocator::Initialize(64 * 1024);
+            for (uint64_t frame = 0; frame < kWarmupFrames + state.iterations; ++frame)
+            {
+                FrameAllocator::NextFrame();
+                for (uint32_t i = 0; i < kAllocationCount; ++i)
+                {
+                    const size_t alignment = size_t(16) << (i % 4);
+                    void* data = FrameAllocator::Allocate((i * 37) % 2048 + 1, alignment);
+                    ALIMER_BENCHMARK_CHECK((reinterpret_cast<uintptr_t>(data) & (alignment - 1)) == 0);
+                    benchmark::DoNotOptimize(data);
+                }
+
+                void* large = FrameAllocator::Allocate(32 * 1024, 256);
+                ALIMER_BENCHMARK_CHECK((reinterpret_cast<uintptr_t>(large) & 255) == 0);
+                benchmark::DoNotOptimize(large);
+
+                if (frame >= kWarmupFrames)
+                {
+                    ALIMER_BENCHMARK_CHECK(FrameAllocator::GetStats().overflow == 0);
+                }
+            }
+
+            FrameAllocator::Shutdown();
+            state.itemsProcessed = state.iterations * (kAllocationCount + 1);
+        }
+
+        /// Free the oldest of a fixed set of live handles and allocate a new one, every iteration.
+        /// Slots start just below the 32-bit generation limit so every run wraps. Freed handles must be rejected
+        /// for as long as they are remembered, and no live handle may be null.
+        void HandlePool_Churn(benchmark::State& state)
+        {
+            struct Resource {};
+            constexpr uint32_t kLiveCount = 1024;
+            constexpr uint32_t kStaleCount = 4096;
+
+            HandlePool<Resource, uint32_t> pool(0, ~0u - 64);
+            std::vector<Handle<Resource>> live(kLiveCount);
+            std::vector<Handle<Resource>> stale(kStaleCount);
+            for (uint32_t i = 0; i < kLiveCount; ++i)
+            {
+                live[i] = pool.Allocate(i);
+            }
+
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                Handle<Resource>& handle = live[i % kLiveCount];
+                ALIMER_BENCHMARK_CHECK(pool.Get<0>(handle) == static_cast<uint32_t>(i));
+                ALIMER_BENCHMARK_CHECK(pool.Free(handle));
+                ALIMER_BENCHMARK_CHECK(!pool.Free(handle));
+
+                Handle<Resource>& oldest = stale[i % kStaleCount];
+                ALIMER_BENCHMARK_CHECK(oldest.IsNull() || !pool.IsValid(oldest));
+                oldest = handle;
+
+                handle = pool.Allocate(static_cast<uint32_t>(i + kLiveCount));
+                ALIMER_BENCHMARK_CHECK(!handle.IsNull() && handle.GetGeneration() != 0 && handle != oldest);
+            }
+
+            ALIMER_BENCHMARK_CHECK(pool.GetCount() == kLiveCount);
+            state.itemsProcessed = state.iterations;
+        }
+
+        void Stopwatch_GetTimestamp(benchmark::State& state)
+        {
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                uint64_t timestamp = Stopwatch::GetTimestamp();
+                benchmark::DoNotOptimize(timestamp);
+            }
+        }
+    }
+
+    ALIMER_BENCHMARK(Hash_Murmur32, 8, 64, 1024, 64 * 1024);
+    ALIMER_BENCHMARK(Hash_Murmur64, 8, 64, 1024, 64 * 1024);
+    ALIMER_BENCHMARK(Hash_Hash64, 8, 64, 1024, 64 * 1024);
+    ALIMER_BENCHMARK(Hash_Hash128, 8, 64, 1024, 64 * 1024);
+    ALIMER_BENCHMARK(Hash_HasherStream, 64 * 1024, 4 * 1024 * 1024);
+    ALIMER_BENCHMARK(StringId32_FromCString, 0, 1);
+    ALIMER_BENCHMARK(StringId32_FromString, 0, 1);
+    ALIMER_BENCHMARK(StringId64_FromCString, 0, 1);
+    ALIMER_BENCHMARK(StringId64_FromString, 0, 1);
+    ALIMER_BENCHMARK(RefPtr_Copy);
+    ALIMER_BENCHMARK(RefPtr_Move);
+    ALIMER_BENCHMARK(RefPtr_CreateRelease);
+    ALIMER_BENCHMARK(TypeInfo_IsTypeOf, 0, 1, 4, 7, 8);
+    ALIMER_BENCHMARK(TypeInfo_IsTypeOfDeep, 0, 16, 31, 32);
+    ALIMER_BENCHMARK(Object_CastHit);
+    ALIMER_BENCHMARK(Object_CastMiss);
+    ALIMER_BENCHMARK(Object_CastDeep);
+    ALIMER_BENCHMARK(Object_GetType);
+    ALIMER_BENCHMARK(FrameAllocator_Frame);
+    ALIMER_BENCHMARK(HandlePool_Churn);
+    ALIMER_BENCHMARK(Stopwatch_GetTimestamp);
+}
@@ -0,0 +1,304 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Benchmark.h"
+#include "graphics/BlockCompression.h"
+#include "graphics/GPUBuffer.h"
+#include "graphics/GPUDevice.h"
+#include "graphics/Texture.h"
+#include "graphics/MipGeneration.h"
+#include "graphics/PixelFormatConversion.h"
+#include <thread>
+#include <vector>
+
+namespace alimer
+{
+    namespace
+    {
+        static constexpr uint32_t kImageSize = 1024;
+
+        /// Texture with no backend data, only tracked by the device.
+        class TrackedTexture final : public Texture
+        {
+        public:
+            TrackedTexture(GPUDevice* device, const TextureDescriptor* descriptor)
+                : Texture(device, descriptor)
+            {
+            }
+        };
+
+        /// Convert a kImageSize square image, the pixels are filled with a gradient through the source format.
+        void ConvertImage(benchmark::State& state, PixelFormat sourceFormat, PixelFormat destinationFormat)
+        {
+            const uint32_t sourcePitch = kImageSize * GetFormatBitsPerPixel(sourceFormat) / 8;
+            const uint32_t destinationPitch = kImageSize * GetFormatBitsPerPixel(destinationFormat) / 8;
+
+            std::vector<uint8_t> gradient(kImageSize * kImageSize * 4);
+            for (size_t i = 0; i < gradient.size(); ++i)
+            {
+                gradient[i] = uint8_t(i * 7 + i / kImageSize);
+            }
+
+            std::vector<uint8_t> source(size_t(sourcePitch) * kImageSize);
+            std::vector<uint8_t> destination(size_t(destinationPitch) * kImageSize);
+            ConvertPixels(PixelFormat::RGBA8Unorm, gradient.data(), kImageSize * 4, sourceFormat, source.data(), sourcePitch, kImageSize, kImageSize);
+
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                ConvertPixels(sourceFormat, source.data(), sourcePitch, destinationFormat, destination.data(), destinationPitch, kImageSize, kImageSize);
+                benchmark::DoNotOptimize(destination[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kImageSize * kImageSize;
+            state.bytesProcessed = state.iterations * source.size();
+        }
+
+        void PixelConvert_RGBA8ToBGRA8(benchmark::State& state)
+        {
+            ConvertImage(state, PixelFormat::RGBA8Unorm, PixelFormat::BGRA8Unorm);
+        }
+
+        void PixelConvert_RGBA8ToRGBA16Float(benchmark::State& state)
+        {
+            ConvertImage(state, PixelFormat::RGBA8Unorm, PixelFormat::RGBA16Float);
+        }
+
+        void PixelConvert_RGBA16FloatToRGBA8(benchmark::State& state)
+        {
+            ConvertImage(state, PixelFormat::RGBA16Float, PixelFormat::RGBA8Unorm);
+        }
+
+        void PixelConvert_RGB10A2ToRGBA32Float(benchmark::State& state)
+        {
+            ConvertImage(state, PixelFormat::RGB10A2Unorm, PixelFormat::RGBA32Float);
+        }
+
+        void PixelConvert_SrgbDecode(benchmark::State& state)
+        {
+            ConvertImage(state, PixelFormat::RGBA8UnormSrgb, PixelFormat::RGBA32Float);
+        }
+
+        void PixelConvert_SrgbEncode(benchmark::State& state)
+        {
+            ConvertImage(state, PixelFormat::RGBA32Float, PixelFormat::RGBA8UnormSrgb);
+        }
+
+        /// Compress a kImageSize square image with smooth gradients and some noise, as photographic textures have.
+        void CompressImage(benchmark::State& state, PixelFormat format, BlockCompressionQuality quality)
+        {
+            const bool hdr = format == PixelFormat::BC6HRGBUfloat || format == PixelFormat::BC6HRGBSfloat;
+            const PixelFormat sourceFormat = hdr ? PixelFormat::RGBA32Float : PixelFormat::RGBA8Unorm;
+            const uint32_t sourcePitch = kImageSize * GetFormatBitsPerPixel(sourceFormat) / 8;
+            const uint32_t destinationPitch = (kImageSize / 4) * GetFormatBlockSize(format);
+
+            std::vector<uint8_t> pixels(kImageSize * kImageSize * 4);
+            for (uint32_t y = 0; y < kImageSize; ++y)
+            {
+                for (uint32_t x = 0; x < kImageSize; ++x)
+                {
+                    uint8_t* pixel = &pixels[(y * kImageSize + x) * 4];
+                    pixel[0] = uint8_t(x / 4 + ((x * y) & 7));
+                    pixel[1] = uint8_t(y / 4);
+                    pixel[2] = uint8_t((x + y) / 8);
+                    pixel[3] = uint8_t(255 - x / 8);
+                }
+            }
+
+            std::vector<uint8_t> source(size_t(sourcePitch) * kImageSize);
+            std::vector<uint8_t> destination(size_t(destinationPitch) * (kImageSize / 4));
+            ConvertPixels(PixelFormat::RGBA8Unorm, pixels.data(), kImageSize * 4, sourceFormat, source.data(), sourcePitch, kImageSize, kImageSize);
+
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                CompressBlocks(sourceFormat, source.data(), sourcePitch, format, destination.data(), destinationPitch, kImageSize, kImageSize, quality);
+                benchmark::DoNotOptimize(destination[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kImageSize * kImageSize;
+            state.bytesProcessed = state.iterations * source.size();
+        }
+
+        void Compress_BC1Fast(benchmark::State& state)
+        {
+            CompressImage(state, PixelFormat::BC1RGBAUnorm, BlockCompressionQuality::Fast);
+        }
+
+        void Compress_BC1High(benchmark::State& state)
+        {
+            CompressImage(state, PixelFormat::BC1RGBAUnorm, BlockCompressionQuality::High);
+        }
+
+        void Compress_BC3High(benchmark::State& state)
+        {
+            CompressImage(state, PixelFormat::BC3RGBAUnorm, BlockCompressionQuality::High);
+        }
+
+        void Compress_BC5High(benchmark::State& state)
+        {
+            CompressImage(state, PixelFormat::BC5RGUnorm, BlockCompressionQuality::High);
+        }
+
+        void Compress_BC6HHigh(benchmark::State& state)
+        {
+            CompressImage(state, PixelFormat::BC6HRGBUfloat, BlockCompressionQuality::High);
+        }
+
+        void Compress_BC7Fast(benchmark::State& state)
+        {
+            CompressImage(state, PixelFormat::BC7RGBAUnorm, BlockCompressionQuality::Fast);
+        }
+
+        void Compress_BC7High(benchmark::State& state)
+        {
+            CompressImage(state, PixelFormat::BC7RGBAUnorm, BlockCompressionQuality::High);
+        }
+
+        /// Build the full mip chain of a kImageSize square sRGB image.
+        void GenerateMips(benchmark::State& state, MipFilter filter)
+        {
+            std::vector<uint8_t> source(kImageSize * kImageSize * 4);
+            for (size_t i = 0; i < source.size(); ++i)
+            {
+                source[i] = uint8_t(i * 7 + i / kImageSize);
+            }
+
+            std::vector<uint8_t> chain(GetMipChainSize(PixelFormat::RGBA8UnormSrgb, kImageSize, kImageSize, GetMipLevelCount(kImageSize, kImageSize)));
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                GenerateMipChain(PixelFormat::RGBA8UnormSrgb, source.data(), kImageSize * 4, kImageSize, kImageSize, 0, filter, chain.data());
+                benchmark::DoNotOptimize(chain[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kImageSize * kImageSize;
+            state.bytesProcessed = state.iterations * source.size();
+        }
+
+        void Mips_Box(benchmark::State& state)
+        {
+            GenerateMips(state, MipFilter::Box);
+        }
+
+        void Mips_Kaiser(benchmark::State& state)
+        {
+            GenerateMips(state, MipFilter::Kaiser);
+        }
+
+        void Mips_Lanczos(benchmark::State& state)
+        {
+            GenerateMips(state, MipFilter::Lanczos);
+        }
+
+        /// Destroy one buffer per frame through the deferred release queue, the queue has to drain as frames end.
+        void GPUDevice_DeferredRelease(benchmark::State& state)
+        {
+            static constexpr uint32_t kMaxDrainFrames = 1000;
+
+            RefPtr<GPUDevice> device = GPUDevice::Create(nullptr, GPUDevice::Desc());
+            ALIMER_BENCHMARK_CHECK(device.IsNotNull());
+            const uint64_t baseResources = device->GetStats().resources;
+
+            BufferDescriptor bufferDescriptor = {};
+            bufferDescriptor.usage = BufferUsage::Uniform;
+            bufferDescriptor.size = 256;
+
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                RefPtr<GPUBuffer> buffer(new GPUBuffer(device.Get(), &bufferDescriptor));
+                device->DeferDestroy(buffer.Get());
+                buffer.Reset();
+                device->EndFrame();
+            }
+
+            // A real GPU finishes the frame fences asynchronously, keep ending frames until everything is released.
+            uint32_t drainFrames = 0;
+            while (device->GetStats().pendingReleases != 0 && drainFrames++ < kMaxDrainFrames)
+            {
+                std::this_thread::yield();
+                device->EndFrame();
+            }
+
+            const GPUDevice::Stats stats = device->GetStats();
+            ALIMER_BENCHMARK_CHECK(stats.pendingReleases == 0);
+            ALIMER_BENCHMARK_CHECK(stats.resources == baseResources);
+            state.itemsProcessed = state.iterations;
+        }
+
+        /// Create and destroy resources, the tracked memory has to follow, then let resources outlive their device.
+        void GPUDevice_ResourceTracking(benchmark::State& state)
+        {
+            RefPtr<GPUDevice> device = GPUDevice::Create(nullptr, GPUDevice::Desc());
+            ALIMER_BENCHMARK_CHECK(device.IsNotNull());
+            const uint64_t baseMemory = device->GetStats().memoryUsage;
+
+            BufferDescriptor bufferDescriptor = {};
+            bufferDescriptor.usage = BufferUsage::Vertex;
+            bufferDescriptor.size = 64 * 1024;
+
+            // 256x256 BC1 with a full chain: 8 bytes per 4x4 block, 1x1 to 4x4 levels take a block each, two layers.
+            TextureDescriptor textureDescriptor = {};
+            textureDescriptor.extent = { 256u, 256u, 2u };
+            textureDescriptor.format = PixelFormat::BC1RGBAUnorm;
+            textureDescriptor.mipLevels = 0;
+            const uint64_t textureSize = 2 * 8 * (64 * 64 + 32 * 32 + 16 * 16 + 8 * 8 + 4 * 4 + 2 * 2 + 1 + 1 + 1);
+
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                RefPtr<GPUBuffer> buffer(new GPUBuffer(device.Get(), &bufferDescriptor));
+                RefPtr<Texture> texture(new TrackedTexture(device.Get(), &textureDescriptor));
+                ALIMER_BENCHMARK_CHECK(buffer->GetSize() == bufferDescriptor.size);
+                ALIMER_BENCHMARK_CHECK(texture->GetSize() == textureSize);
+                ALIMER_BENCHMARK_CHECK(device->GetStats().memoryUsage == baseMemory + bufferDescriptor.size + textureSize);
+
+                buffer.Reset();
+                texture.Reset();
+                ALIMER_BENCHMARK_CHECK(device->GetStats().memoryUsage == baseMemory);
+            }
+
+            // The device destructor detaches the resources still alive, releasing them later must not touch it.
+            RefPtr<GPUBuffer> survivor(new GPUBuffer(device.Get(), &bufferDescriptor));
+            device.Reset();
+            ALIMER_BENCHMARK_CHECK(survivor->GetDevice() == nullptr);
+            survivor.Reset();
+
+            state.itemsProcessed = state.iterations * 2;
+        }
+    }
+
+    ALIMER_BENCHMARK(PixelConvert_RGBA8ToBGRA8);
+    ALIMER_BENCHMARK(PixelConvert_RGBA8ToRGBA16Float);
+    ALIMER_BENCHMARK(PixelConvert_RGBA16FloatToRGBA8);
+    ALIMER_BENCHMARK(PixelConvert_RGB10A2ToRGBA32Float);
+    ALIMER_BENCHMARK(PixelConvert_SrgbDecode);
+    ALIMER_BENCHMARK(PixelConvert_SrgbEncode);
+    ALIMER_BENCHMARK(Compress_BC1Fast);
+    ALIMER_BENCHMARK(Compress_BC1High);
+    ALIMER_BENCHMARK(Compress_BC3High);
+    ALIMER_BENCHMARK(Compress_BC5High);
+    ALIMER_BENCHMARK(Compress_BC6HHigh);
+    ALIMER_BENCHMARK(Compress_BC7Fast);
+    ALIMER_BENCHMARK(Compress_BC7High);
+    ALIMER_BENCHMARK(Mips_Box);
+    ALIMER_BENCHMARK(Mips_Kaiser);
+    ALIMER_BENCHMARK(Mips_Lanczos);
+    ALIMER_BENCHMARK(GPUDevice_DeferredRelease);
+    ALIMER_BENCHMARK(GPUDevice_ResourceTracking);
+}
@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Benchmark.h"
+#include "core/FlatHashMap.h"
+#include "core/Hash.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace alimer
+{
+    namespace
+    {
+        /// std::unordered_map gets the same pass-through hash so both tables skip rehashing the id.
+        struct StringIdHasher
+        {
+            size_t operator()(StringId32 key) const { return key.Value(); }
+        };
+
+        using FlatMap = FlatHashMap<StringId32, uint32_t>;
+        using StdMap = std::unordered_map<StringId32, uint32_t, StringIdHasher>;
+
+        /// Ids hashed from their index, like names hashed from strings.
+        std::vector<StringId32> MakeKeys(uint32_t count, uint32_t seed)
+        {
+            std::vector<StringId32> keys(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                keys[i] = StringId32(murmur32(&i, sizeof(i), seed));
+            }
+            return keys;
+        }
+
+        void AddEntry(FlatMap& map, StringId32 key, uint32_t value)
+        {
+            map.Insert(key, value);
+        }
+
+        void AddEntry(StdMap& map, StringId32 key, uint32_t value)
+        {
+            map.emplace(key, value);
+        }
+
+        /// Table filled with arg entries, cached since the runner calls a benchmark once per iteration count.
+        template <typename Map>
+        struct Fixture
+        {
+            uint32_t count = 0;
+            std::vector<StringId32> hits;
+            std::vector<StringId32> misses;
+            std::unique_ptr<Map> map;
+
+            static Fixture& Get(uint32_t count)
+            {
+                static Fixture fixture;
+                if (fixture.count != count)
+                {
+                    fixture.map.reset(new Map());
+                    fixture.hits = MakeKeys(count, 0);
+                    fixture.misses = MakeKeys(count, 1);
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        AddEntry(*fixture.map, fixture.hits[i], i);
+                    }
+
+                    // Random probe order so large tables measure cache misses rather than insertion order.
+                    std::shuffle(fixture.hits.begin(), fixture.hits.end(), std::mt19937(count));
+                    fixture.count = count;
+                }
+                return fixture;
+            }
+        };
+
+        template <typename Map, typename FindFunction>
+        void Find(benchmark::State& state, bool hit, const FindFunction& find)
+        {
+            Fixture<Map>& fixture = Fixture<Map>::Get(uint32_t(state.arg));
+            const std::vector<StringId32>& keys = hit ? fixture.hits : fixture.misses;
+            const size_t count = keys.size();
+            size_t index = 0;
+            uint32_t sum = 0;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                sum += find(*fixture.map, keys[index]);
+                if (++index == count)
+                    index = 0;
+            }
+
+            benchmark::DoNotOptimize(sum);
+            state.itemsProcessed = state.iterations;
+        }
+
+        uint32_t FindFlat(const FlatMap& map, StringId32 key)
+        {
+            const uint32_t* value = map.Find(key);
+            return value != nullptr ? *value : 0;
+        }
+
+        uint32_t FindStd(const StdMap& map, StringId32 key)
+        {
+            auto it = map.find(key);
+            return it != map.end() ? it->second : 0;
+        }
+
+        void FlatHashMap_FindHit(benchmark::State& state)
+        {
+            Find<FlatMap>(state, true, FindFlat);
+        }
+
+        void FlatHashMap_FindMiss(benchmark::State& state)
+        {
+            Find<FlatMap>(state, false, FindFlat);
+        }
+
+        void UnorderedMap_FindHit(benchmark::State& state)
+        {
+            Find<StdMap>(state, true, FindStd);
+        }
+
+        void UnorderedMap_FindMiss(benchmark::State& state)
+        {
+            Find<StdMap>(state, false, FindStd);
+        }
+
+        /// Fill an empty table with arg entries, growing from the default capacity.
+        template <typename Map>
+        void Insert(benchmark::State& state)
+        {
+            const std::vector<StringId32> keys = MakeKeys(uint32_t(state.arg), 0);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                Map map;
+                for (uint32_t k = 0; k < keys.size(); ++k)
+                {
+                    AddEntry(map, keys[k], k);
+                }
+                benchmark::DoNotOptimize(map);
+            }
+            state.itemsProcessed = state.iterations * keys.size();
+        }
+
+        void FlatHashMap_Insert(benchmark::State& state)
+        {
+            Insert<FlatMap>(state);
+        }
+
+        void UnorderedMap_Insert(benchmark::State& state)
+        {
+            Insert<StdMap>(state);
+        }
+    }
+
+    ALIMER_BENCHMARK(FlatHashMap_FindHit, 1000, 100000, 10000000);
+    ALIMER_BENCHMARK(UnorderedMap_FindHit, 1000, 100000, 10000000);
+    ALIMER_BENCHMARK(FlatHashMap_FindMiss, 1000, 100000, 10000000);
+    ALIMER_BENCHMARK(UnorderedMap_FindMiss, 1000, 100000, 10000000);
+    ALIMER_BENCHMARK(FlatHashMap_Insert, 1000, 100000, 10000000);
+    ALIMER_BENCHMARK(UnorderedMap_Insert, 1000, 100000, 10000000);
+}
@@ -0,0 +1,146 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Benchmark.h"
+#include "core/JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace alimer
+{
+    namespace
+    {
+        void EmptyJob(void* data, uint32_t begin, uint32_t end)
+        {
+        }
+
+        /// Restart the job system with the given total thread count.
+        void SetThreadCount(uint32_t threadCount)
+        {
+            if (JobSystem::IsInitialized() && JobSystem::GetThreadCount() == threadCount)
+                return;
+
+            JobSystem::Shutdown();
+            JobSystem::Initialize(threadCount - 1);
+        }
+
+        /// Scheduling overhead of a single empty job, submitted and waited in batches.
+        void JobSystem_RunEmpty(benchmark::State& state)
+        {
+            constexpr uint64_t kBatchSize = 256;
+
+            JobCounter counter;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                JobSystem::Run(EmptyJob, nullptr, &counter);
+                if ((i % kBatchSize) == kBatchSize - 1)
+                {
+                    JobSystem::Wait(counter);
+                }
+            }
+
+            JobSystem::Wait(counter);
+            state.itemsProcessed = state.iterations;
+        }
+
+        /// Run and wait a single empty job, measures the round trip latency.
+        void JobSystem_RunWait(benchmark::State& state)
+        {
+            JobCounter counter;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                JobSystem::Run(EmptyJob, nullptr, &counter);
+                JobSystem::Wait(counter);
+            }
+        }
+
+        /// Submit more jobs than a thread can keep in flight, every job must still run exactly once.
+        void JobSystem_RunOverflow(benchmark::State& state)
+        {
+            constexpr uint32_t kJobCount = JobSystem::kMaxJobsPerThread * 3;
+            static std::vector<std::atomic<uint32_t>> runs(kJobCount);
+
+            SetThreadCount(2);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                for (std::atomic<uint32_t>& count : runs)
+                {
+                    count.store(0, std::memory_order_relaxed);
+                }
+
+                JobCounter counter;
+                for (uint32_t index = 0; index < kJobCount; ++index)
+                {
+                    JobSystem::Run([](void* data, uint32_t begin, uint32_t end) {
+                        static_cast<std::atomic<uint32_t>*>(data)[begin].fetch_add(1, std::memory_order_relaxed);
+                        }, runs.data(), index, index + 1, &counter);
+                }
+
+                JobSystem::Wait(counter);
+                for (const std::atomic<uint32_t>& count : runs)
+                {
+                    ALIMER_BENCHMARK_CHECK(count.load(std::memory_order_relaxed) == 1);
+                }
+            }
+
+            state.itemsProcessed = state.iterations * kJobCount;
+        }
+
+        /// Fixed amount of work split with ParallelFor, the argument is the total thread count.
+        void JobSystem_ParallelForScaling(benchmark::State& state)
+        {
+            constexpr uint32_t kCount = 1 << 20;
+            static std::vector<float> values(kCount, 1.0f);
+
+            SetThreadCount(static_cast<uint32_t>(state.arg));
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                JobSystem::ParallelFor(kCount, 1024, [](uint32_t index) {
+                    values[index] = std::sqrt(values[index] + 1.0f);
+                    });
+            }
+
+            benchmark::DoNotOptimize(values[0]);
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        std::vector<int64_t> GetThreadCounts()
+        {
+            std::vector<int64_t> counts;
+            const int64_t coreCount = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+            for (int64_t count = 1; count < coreCount; count *= 2)
+            {
+                counts.push_back(count);
+            }
+
+            counts.push_back(coreCount);
+            return counts;
+        }
+    }
+
+    ALIMER_BENCHMARK(JobSystem_RunEmpty);
+    ALIMER_BENCHMARK(JobSystem_RunWait);
+    ALIMER_BENCHMARK(JobSystem_RunOverflow);
+    static int s_scalingBenchmark = benchmark::Register("JobSystem_ParallelForScaling", JobSystem_ParallelForScaling, GetThreadCounts());
+}
@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Benchmark.h"
+#include "core/Log.h"
+#include <cstdio>
+#if defined(_WIN32)
+#   include <io.h>
+#   define dup _dup
+#   define dup2 _dup2
+#   define close _close
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+namespace alimer
+{
+    namespace
+    {
+        /// Send the log output to the null device while a benchmark runs, so the terminal doesn't dominate the timing.
+        class ScopedNullOutput final
+        {
+        public:
+            ScopedNullOutput()
+            {
+                fflush(stdout);
+                fflush(stderr);
+                FILE* null = fopen(kNullDevice, "w");
+                for (int fd = 0; fd < 2; ++fd)
+                {
+                    savedOutput[fd] = dup(fd + 1);
+                    if (null != nullptr)
+                    {
+                        dup2(fileno(null), fd + 1);
+                    }
+                }
+
+                if (null != nullptr)
+                {
+                    fclose(null);
+                }
+            }
+
+            ~ScopedNullOutput()
+            {
+                fflush(stdout);
+                fflush(stderr);
+                for (int fd = 0; fd < 2; ++fd)
+                {
+                    dup2(savedOutput[fd], fd + 1);
+                    close(savedOutput[fd]);
+                }
+            }
+
+        private:
+#if defined(_WIN32)
+            static constexpr const char* kNullDevice = "NUL";
+#else
+            static constexpr const char* kNullDevice = "/dev/null";
+#endif
+            /// Saved stdout and stderr.
+            int savedOutput[2];
+        };
+
+        /// Message below the logger level, the cost every disabled log call pays.
+        void Logger_Filtered(benchmark::State& state)
+        {
+            Logger* logger = Log::GetDefault();
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                logger->LogFormat(LogLevel::Trace, "Filtered message %llu", static_cast<unsigned long long>(i));
+            }
+        }
+
+        /// Formatted messages written directly from the calling thread.
+        void Logger_Sync(benchmark::State& state)
+        {
+            ScopedNullOutput output;
+            Logger* logger = Log::GetDefault();
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                logger->LogFormat(LogLevel::Info, "Frame %llu took %.3f ms", static_cast<unsigned long long>(i), 16.6);
+            }
+
+            state.itemsProcessed = state.iterations;
+        }
+
+        /// Keeps the async writer running across the runs of a benchmark, so thread start and stop stay out of the timing.
+        class ScopedAsyncLog final
+        {
+        public:
+            ScopedAsyncLog()
+            {
+                AsyncLogDesc desc;
+                desc.overflowPolicy = LogOverflowPolicy::Block;
+                Log::StartAsync(desc);
+            }
+
+            ~ScopedAsyncLog()
+            {
+                Log::StopAsync();
+            }
+        };
+
+        /// Formatted messages through the async writer, includes draining everything before returning.
+        void Logger_Async(benchmark::State& state)
+        {
+            static ScopedAsyncLog asyncLog;
+            ScopedNullOutput output;
+
+            Logger* logger = Log::GetDefault();
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                logger->LogFormat(LogLevel::Info, "Frame %llu took %.3f ms", static_cast<unsigned long long>(i), 16.6);
+            }
+
+            // Written before the output is restored.
+            Log::Flush();
+            state.itemsProcessed = state.iterations;
+        }
+
+        /// Deferred formatting through the binary log, arguments are copied and formatted by LogDecoder.
+        void BinaryLog_Write(benchmark::State& state)
+        {
+            const char* fileName = "alimer_bench.albl";
+            BinaryLog::Open(fileName);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                ALIMER_LOG_BINARY(LogLevel::Info, "Frame %llu took %.3f ms", static_cast<unsigned long long>(i), 16.6);
+            }
+
+            BinaryLog::Close();
+            remove(fileName);
+            state.itemsProcessed = state.iterations;
+        }
+    }
+
+    ALIMER_BENCHMARK(Logger_Filtered);
+    ALIMER_BENCHMARK(Logger_Sync);
+    ALIMER_BENCHMARK(Logger_Async);
+    ALIMER_BENCHMARK(BinaryLog_Write);
+}
@@ -0,0 +1,514 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Benchmark.h"
+#include "math/math.h"
+#include "math/batch.h"
+#include "math/Quaternion.h"
+#include <vector>
+
+namespace alimer
+{
+    namespace
+    {
+        static constexpr size_t kCount = 4096;
+
+        std::vector<float4> MakeVectors(float offset)
+        {
+            std::vector<float4> values(kCount);
+            for (size_t i = 0; i < kCount; ++i)
+            {
+                const float value = float(i) * 0.25f + offset;
+                values[i] = float4(value, value + 1.0f, value + 2.0f, 1.0f);
+            }
+            return values;
+        }
+
+        /// Component wise a * b + c over arrays of float4.
+        void Math_Float4MultiplyAdd(benchmark::State& state)
+        {
+            const std::vector<float4> a = MakeVectors(0.0f);
+            const std::vector<float4> b = MakeVectors(1.0f);
+            std::vector<float4> c = MakeVectors(2.0f);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    for (size_t k = 0; k < float4::SIZE; ++k)
+                    {
+                        c[j].data[k] = a[j].data[k] * b[j].data[k] + c[j].data[k];
+                    }
+                }
+                benchmark::DoNotOptimize(c[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_Float4Dot(benchmark::State& state)
+        {
+            const std::vector<float4> a = MakeVectors(0.0f);
+            const std::vector<float4> b = MakeVectors(1.0f);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                float sum = 0.0f;
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    sum += a[j].x * b[j].x + a[j].y * b[j].y + a[j].z * b[j].z + a[j].w * b[j].w;
+                }
+                benchmark::DoNotOptimize(sum);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_LerpClamp(benchmark::State& state)
+        {
+            std::vector<float> values(kCount);
+            for (size_t i = 0; i < kCount; ++i)
+            {
+                values[i] = float(i) / float(kCount);
+            }
+
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                float sum = 0.0f;
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    sum += clamp(lerp(-1.0f, 2.0f, values[j]), 0.0f, 1.0f);
+                }
+                benchmark::DoNotOptimize(sum);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_SinCos(benchmark::State& state)
+        {
+            std::vector<float> angles(kCount);
+            for (size_t i = 0; i < kCount; ++i)
+            {
+                angles[i] = radians(float(i % 360));
+            }
+
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                float sum = 0.0f;
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    sum += sin(angles[j]) * cos(angles[j]);
+                }
+                benchmark::DoNotOptimize(sum);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        std::vector<float4x4> MakeMatrices()
+        {
+            std::vector<float4x4> values(kCount);
+            for (size_t i = 0; i < kCount; ++i)
+            {
+                const float angle = float(i) * 0.01f;
+                values[i] = float4x4::translation(float3(float(i), 1.0f, 2.0f))
+                    * float4x4::rotation(normalize(float3(1.0f, 2.0f, 3.0f)), angle)
+                    * float4x4::scale(float3(1.0f + angle));
+            }
+            return values;
+        }
+
+        /// Same work as Math_Float4MultiplyAdd through the SIMD operators.
+        void Math_Float4Operators(benchmark::State& state)
+        {
+            const std::vector<float4> a = MakeVectors(0.0f);
+            const std::vector<float4> b = MakeVectors(1.0f);
+            std::vector<float4> c = MakeVectors(2.0f);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    c[j] = a[j] * b[j] + c[j];
+                }
+                benchmark::DoNotOptimize(c[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_Float4x4Multiply(benchmark::State& state)
+        {
+            const std::vector<float4x4> matrices = MakeMatrices();
+            float4x4 result = float4x4::identity();
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    result = matrices[j] * result;
+                }
+                benchmark::DoNotOptimize(result);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_Float4x4Inverse(benchmark::State& state)
+        {
+            const std::vector<float4x4> matrices = MakeMatrices();
+            std::vector<float4x4> result(kCount);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    result[j] = inverse(matrices[j]);
+                }
+                benchmark::DoNotOptimize(result[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_Float4x4Transpose(benchmark::State& state)
+        {
+            const std::vector<float4x4> matrices = MakeMatrices();
+            std::vector<float4x4> result(kCount);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    result[j] = transpose(matrices[j]);
+                }
+                benchmark::DoNotOptimize(result[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        /// Batch transform of float4 vectors by a single matrix.
+        void Math_TransformBatch(benchmark::State& state)
+        {
+            const float4x4 matrix = MakeMatrices()[7];
+            const std::vector<float4> input = MakeVectors(0.0f);
+            std::vector<float4> output(kCount);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                transform(matrix, input.data(), output.data(), kCount);
+                benchmark::DoNotOptimize(output[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        /// Structure of arrays input for the batch kernels.
+        struct BatchData
+        {
+            std::vector<float> x, y, z;
+            std::vector<float> maxX, maxY, maxZ;
+            std::vector<float> outX, outY, outZ;
+            std::vector<float> outMaxX, outMaxY, outMaxZ;
+
+            BatchData()
+                : x(kCount), y(kCount), z(kCount), maxX(kCount), maxY(kCount), maxZ(kCount)
+                , outX(kCount), outY(kCount), outZ(kCount), outMaxX(kCount), outMaxY(kCount), outMaxZ(kCount)
+            {
+                for (size_t i = 0; i < kCount; ++i)
+                {
+                    x[i] = float(i) * 0.25f;
+                    y[i] = x[i] + 1.0f;
+                    z[i] = x[i] + 2.0f;
+                    maxX[i] = x[i] + 1.0f;
+                    maxY[i] = y[i] + 2.0f;
+                    maxZ[i] = z[i] + 3.0f;
+                }
+            }
+
+            batch::const_float3_stream Input() const { return { x.data(), y.data(), z.data() }; }
+            batch::const_float3_stream InputMax() const { return { maxX.data(), maxY.data(), maxZ.data() }; }
+            batch::float3_stream Output() { return { outX.data(), outY.data(), outZ.data() }; }
+            batch::float3_stream OutputMax() { return { outMaxX.data(), outMaxY.data(), outMaxZ.data() }; }
+        };
+
+        /// Select the kernels for a benchmark run, the argument is the batch::Isa. Levels the CPU lacks fall back to the best supported one.
+        class ScopedBatchIsa final
+        {
+        public:
+            explicit ScopedBatchIsa(int64_t arg)
+                : previous(batch::GetIsa())
+            {
+                const uint32_t supported = static_cast<uint32_t>(batch::GetSupportedIsa());
+                batch::SetIsa(static_cast<batch::Isa>(arg < supported ? static_cast<uint32_t>(arg) : supported));
+            }
+
+            ~ScopedBatchIsa()
+            {
+                batch::SetIsa(previous);
+            }
+
+        private:
+            batch::Isa previous;
+        };
+
+        void Math_BatchTransformPoints(benchmark::State& state)
+        {
+            ScopedBatchIsa isa(state.arg);
+            const float4x4 matrix = MakeMatrices()[7];
+            BatchData data;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                batch::transform_points(matrix, data.Input(), data.Output(), kCount);
+                benchmark::DoNotOptimize(data.outX[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_BatchComputeAabbs(benchmark::State& state)
+        {
+            ScopedBatchIsa isa(state.arg);
+            const std::vector<float4x4> matrices = MakeMatrices();
+            BatchData data;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                batch::compute_aabbs(matrices.data(), data.Input(), data.InputMax(), data.Output(), data.OutputMax(), kCount);
+                benchmark::DoNotOptimize(data.outMaxX[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_BatchNormalize(benchmark::State& state)
+        {
+            ScopedBatchIsa isa(state.arg);
+            BatchData data;
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                batch::normalize(data.Input(), data.Output(), kCount);
+                benchmark::DoNotOptimize(data.outX[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_BatchMultiply(benchmark::State& state)
+        {
+            ScopedBatchIsa isa(state.arg);
+            const std::vector<float4x4> a = MakeMatrices();
+            const std::vector<float4x4> b(a.rbegin(), a.rend());
+            std::vector<float4x4> result(kCount);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                batch::multiply(a.data(), b.data(), result.data(), kCount);
+                benchmark::DoNotOptimize(result[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        std::vector<Quaternion> MakeRotations(float offset)
+        {
+            std::vector<Quaternion> values(kCount);
+            for (size_t i = 0; i < kCount; ++i)
+            {
+                values[i] = Quaternion::FromEuler(float3(float(i) * 0.01f + offset, float(i) * 0.02f, offset));
+            }
+            return values;
+        }
+
+        /// Quaternions split into component arrays for the batch kernels.
+        struct QuaternionStream
+        {
+            std::vector<float> x, y, z, w;
+
+            explicit QuaternionStream(const std::vector<Quaternion>& values)
+                : x(values.size()), y(values.size()), z(values.size()), w(values.size())
+            {
+                for (size_t i = 0; i < values.size(); ++i)
+                {
+                    x[i] = values[i].x;
+                    y[i] = values[i].y;
+                    z[i] = values[i].z;
+                    w[i] = values[i].w;
+                }
+            }
+
+            batch::const_float4_stream Input() const { return { x.data(), y.data(), z.data(), w.data() }; }
+            batch::float4_stream Output() { return { x.data(), y.data(), z.data(), w.data() }; }
+        };
+
+        /// Blend two poses one rotation at a time, the baseline for the batch kernels.
+        void Math_QuaternionSlerp(benchmark::State& state)
+        {
+            const std::vector<Quaternion> a = MakeRotations(0.0f);
+            const std::vector<Quaternion> b = MakeRotations(0.5f);
+            std::vector<Quaternion> result(kCount);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    result[j] = Quaternion::Slerp(a[j], b[j], 0.3f);
+                }
+                benchmark::DoNotOptimize(result[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_QuaternionNlerp(benchmark::State& state)
+        {
+            const std::vector<Quaternion> a = MakeRotations(0.0f);
+            const std::vector<Quaternion> b = MakeRotations(0.5f);
+            std::vector<Quaternion> result(kCount);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    result[j] = Quaternion::Nlerp(a[j], b[j], 0.3f);
+                }
+                benchmark::DoNotOptimize(result[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_BatchSlerp(benchmark::State& state)
+        {
+            ScopedBatchIsa isa(state.arg);
+            const QuaternionStream a(MakeRotations(0.0f));
+            const QuaternionStream b(MakeRotations(0.5f));
+            QuaternionStream result(MakeRotations(0.0f));
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                batch::slerp(a.Input(), b.Input(), 0.3f, result.Output(), kCount);
+                benchmark::DoNotOptimize(result.x[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_BatchNlerp(benchmark::State& state)
+        {
+            ScopedBatchIsa isa(state.arg);
+            const QuaternionStream a(MakeRotations(0.0f));
+            const QuaternionStream b(MakeRotations(0.5f));
+            QuaternionStream result(MakeRotations(0.0f));
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                batch::nlerp(a.Input(), b.Input(), 0.3f, result.Output(), kCount);
+                benchmark::DoNotOptimize(result.x[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        std::vector<float> MakeFloats()
+        {
+            std::vector<float> values(kCount);
+            for (size_t i = 0; i < kCount; ++i)
+            {
+                values[i] = (float(i) - 2048.0f) * 0.37f;
+            }
+            return values;
+        }
+
+        /// Per element conversion, the baseline for the bulk converters.
+        void Math_FloatToHalfScalar(benchmark::State& state)
+        {
+            const std::vector<float> input = MakeFloats();
+            std::vector<half> output(kCount);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    output[j] = half(input[j]);
+                }
+                benchmark::DoNotOptimize(output[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_FloatToHalf(benchmark::State& state)
+        {
+            const std::vector<float> input = MakeFloats();
+            std::vector<half> output(kCount);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                convert_to_half(input.data(), output.data(), kCount);
+                benchmark::DoNotOptimize(output[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_HalfToFloatScalar(benchmark::State& state)
+        {
+            std::vector<half> input(kCount);
+            convert_to_half(MakeFloats().data(), input.data(), kCount);
+            std::vector<float> output(kCount);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                for (size_t j = 0; j < kCount; ++j)
+                {
+                    output[j] = float(input[j]);
+                }
+                benchmark::DoNotOptimize(output[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+
+        void Math_HalfToFloat(benchmark::State& state)
+        {
+            std::vector<half> input(kCount);
+            convert_to_half(MakeFloats().data(), input.data(), kCount);
+            std::vector<float> output(kCount);
+            for (uint64_t i = 0; i < state.iterations; ++i)
+            {
+                convert_to_float(input.data(), output.data(), kCount);
+                benchmark::DoNotOptimize(output[0]);
+            }
+
+            state.itemsProcessed = state.iterations * kCount;
+        }
+    }
+
+    ALIMER_BENCHMARK(Math_Float4MultiplyAdd);
+    ALIMER_BENCHMARK(Math_Float4Operators);
+    ALIMER_BENCHMARK(Math_Float4x4Multiply);
+    ALIMER_BENCHMARK(Math_Float4x4Inverse);
+    ALIMER_BENCHMARK(Math_Float4x4Transpose);
+    ALIMER_BENCHMARK(Math_TransformBatch);
+    ALIMER_BENCHMARK(Math_BatchTransformPoints, 0, 1, 2);
+    ALIMER_BENCHMARK(Math_BatchComputeAabbs, 0, 1, 2);
+    ALIMER_BENCHMARK(Math_BatchNormalize, 0, 1, 2);
+    ALIMER_BENCHMARK(Math_BatchMultiply, 0, 1, 2);
+    ALIMER_BENCHMARK(Math_QuaternionSlerp);
+    ALIMER_BENCHMARK(Math_QuaternionNlerp);
+    ALIMER_BENCHMARK(Math_BatchSlerp, 0, 1, 2);
+    ALIMER_BENCHMARK(Math_BatchNlerp, 0, 1, 2);
+    ALIMER_BENCHMARK(Math_FloatToHalfScalar);
+    ALIMER_BENCHMARK(Math_FloatToHalf);
+    ALIMER_BENCHMARK(Math_HalfToFloatScalar);
+    ALIMER_BENCHMARK(Math_HalfToFloat);
+    ALIMER_BENCHMARK(Math_Float4Dot);
+    ALIMER_BENCHMARK(Math_LerpClamp);
+    ALIMER_BENCHMARK(Math_SinCos);
+}
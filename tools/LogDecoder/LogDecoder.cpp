@@ -0,0 +1,331 @@
+//
+// Copyright (c) 2020 Amer Koleci and contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "core/BinaryLog.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace alimer;
+using namespace alimer::BinaryLogFormat;
+
+namespace
+{
+    struct Format
+    {
+        LogLevel level;
+        uint32_t line;
+        std::string file;
+        std::string format;
+    };
+
+    struct Message
+    {
+        uint64_t timestamp;
+        LogLevel level;
+        std::string text;
+    };
+
+    struct Arg
+    {
+        ArgType type;
+        int64_t i;
+        uint64_t u;
+        double d;
+        std::string s;
+    };
+
+    const char* GetLevelName(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevel::Trace: return "Trace";
+        case LogLevel::Debug: return "Debug";
+        case LogLevel::Info: return "Info";
+        case LogLevel::Warning: return "Warning";
+        case LogLevel::Error: return "Error";
+        default: return "Unknown";
+        }
+    }
+
+    bool ReadArgs(const uint8_t* data, uint32_t size, std::vector<Arg>& args)
+    {
+        const uint8_t* end = data + size;
+        while (data < end)
+        {
+            Arg arg = {};
+            arg.type = static_cast<ArgType>(*data++);
+            switch (arg.type)
+            {
+            case ArgType::Int32: { int32_t v; memcpy(&v, data, 4); arg.i = v; arg.u = static_cast<uint32_t>(v); data += 4; break; }
+            case ArgType::UInt32: { uint32_t v; memcpy(&v, data, 4); arg.u = v; arg.i = v; data += 4; break; }
+            case ArgType::Int64: memcpy(&arg.i, data, 8); arg.u = static_cast<uint64_t>(arg.i); data += 8; break;
+            case ArgType::UInt64:
+            case ArgType::Pointer: memcpy(&arg.u, data, 8); arg.i = static_cast<int64_t>(arg.u); data += 8; break;
+            case ArgType::Double: memcpy(&arg.d, data, 8); data += 8; break;
+            case ArgType::String:
+            {
+                uint16_t length;
+                memcpy(&length, data, 2);
+                arg.s.assign(reinterpret_cast<const char*>(data + 2), length);
+                data += 2 + length;
+                break;
+            }
+            default:
+                return false;
+            }
+
+            args.push_back(std::move(arg));
+        }
+
+        return data == end;
+    }
+
+    /// Format one conversion, length modifiers are replaced to match the stored argument.
+    void FormatArg(std::string& output, std::string spec, char conversion, const Arg& arg)
+    {
+        spec.erase(std::remove_if(spec.begin(), spec.end(), [](char c) {
+            return c == 'h' || c == 'l' || c == 'L' || c == 'q' || c == 'j' || c == 'z' || c == 't';
+            }), spec.end());
+
+        char buffer[2048];
+        switch (conversion)
+        {
+        case 'd': case 'i':
+            spec += "lld";
+            snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<long long>(arg.i));
+            break;
+        case 'u': case 'x': case 'X': case 'o':
+            spec += "ll";
+            spec += conversion;
+            snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<unsigned long long>(arg.type == ArgType::Int32 ? static_cast<uint32_t>(arg.i) : arg.u));
+            break;
+        case 'c':
+            spec += 'c';
+            snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<int>(arg.i));
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec += conversion;
+            snprintf(buffer, sizeof(buffer), spec.c_str(), arg.d);
+            break;
+        case 's':
+            spec += 's';
+            snprintf(buffer, sizeof(buffer), spec.c_str(), arg.type == ArgType::String ? arg.s.c_str() : "(invalid)");
+            break;
+        case 'p':
+            snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(arg.u));
+            break;
+        default:
+            snprintf(buffer, sizeof(buffer), "%s", "(invalid)");
+            break;
+        }
+
+        output += buffer;
+    }
+
+    std::string FormatMessage(const std::string& format, const std::vector<Arg>& args)
+    {
+        std::string output;
+        size_t argIndex = 0;
+
+        for (size_t i = 0; i < format.size(); ++i)
+        {
+            if (format[i] != '%')
+            {
+                output += format[i];
+                continue;
+            }
+
+            if (i + 1 < format.size() && format[i + 1] == '%')
+            {
+                output += '%';
+                ++i;
+                continue;
+            }
+
+            // Collect flags, width, precision and length up to the conversion character.
+            std::string spec = "%";
+            size_t j = i + 1;
+            for (; j < format.size() && strchr("diouxXcfFeEgGaAsp", format[j]) == nullptr; ++j)
+            {
+                if (format[j] == '*')
+                {
+                    spec += argIndex < args.size() ? std::to_string(args[argIndex++].i) : "0";
+                }
+                else
+                {
+                    spec += format[j];
+                }
+            }
+
+            if (j == format.size())
+            {
+                output += format.substr(i);
+                break;
+            }
+
+            if (argIndex < args.size())
+            {
+                FormatArg(output, spec, format[j], args[argIndex++]);
+            }
+            else
+            {
+                output += "(missing)";
+            }
+
+            i = j;
+        }
+
+        return output;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: LogDecoder <binary log> [output file]\n");
+        return EXIT_FAILURE;
+    }
+
+    FILE* input = fopen(argv[1], "rb");
+    if (input == nullptr)
+    {
+        fprintf(stderr, "Failed to open '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    FileHeader header;
+    if (fread(&header, sizeof(header), 1, input) != 1 || header.magic != kMagic || header.version != kVersion)
+    {
+        fprintf(stderr, "'%s' is not a binary log\n", argv[1]);
+        fclose(input);
+        return EXIT_FAILURE;
+    }
+
+    std::unordered_map<uint32_t, Format> formats;
+    std::vector<Message> messages;
+    std::vector<uint8_t> argsData;
+    std::vector<Arg> args;
+    bool truncated = false;
+
+    RecordType type;
+    while (fread(&type, sizeof(type), 1, input) == 1)
+    {
+        if (type == RecordType::Format)
+        {
+            FormatRecord record;
+            Format format;
+            if (fread(&record, sizeof(record), 1, input) != 1)
+            {
+                truncated = true;
+                break;
+            }
+
+            format.level = record.level;
+            format.line = record.line;
+            format.file.resize(record.fileLength);
+            format.format.resize(record.formatLength);
+            if ((record.fileLength && fread(&format.file[0], record.fileLength, 1, input) != 1)
+                || (record.formatLength && fread(&format.format[0], record.formatLength, 1, input) != 1))
+            {
+                truncated = true;
+                break;
+            }
+
+            formats[record.formatId] = std::move(format);
+        }
+        else if (type == RecordType::Message)
+        {
+            MessageRecord record;
+            if (fread(&record, sizeof(record), 1, input) != 1)
+            {
+                truncated = true;
+                break;
+            }
+
+            argsData.resize(record.argsSize);
+            if (record.argsSize && fread(argsData.data(), record.argsSize, 1, input) != 1)
+            {
+                truncated = true;
+                break;
+            }
+
+            auto it = formats.find(record.formatId);
+            args.clear();
+            Message message;
+            message.timestamp = record.timestamp;
+            if (it == formats.end() || !ReadArgs(argsData.data(), record.argsSize, args))
+            {
+                message.level = LogLevel::Error;
+                message.text = "(corrupted record)";
+            }
+            else
+            {
+                message.level = it->second.level;
+                message.text = FormatMessage(it->second.format, args);
+            }
+
+            messages.push_back(std::move(message));
+        }
+        else
+        {
+            truncated = true;
+            break;
+        }
+    }
+
+    fclose(input);
+
+    if (truncated)
+    {
+        fprintf(stderr, "Warning: '%s' is truncated or corrupted, decoded %zu messages\n", argv[1], messages.size());
+    }
+
+    FILE* output = argc > 2 ? fopen(argv[2], "w") : stdout;
+    if (output == nullptr)
+    {
+        fprintf(stderr, "Failed to open '%s'\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    // Threads flush their buffers independently, restore the recording order.
+    std::stable_sort(messages.begin(), messages.end(), [](const Message& a, const Message& b) {
+        return a.timestamp < b.timestamp;
+        });
+
+    const uint64_t start = messages.empty() ? 0 : messages.front().timestamp;
+    for (const Message& message : messages)
+    {
+        const double seconds = double(message.timestamp - start) / double(header.timestampFrequency);
+        fprintf(output, "[%12.6f] [%s] %s\n", seconds, GetLevelName(message.level), message.text.c_str());
+    }
+
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+
+    return EXIT_SUCCESS;
+}